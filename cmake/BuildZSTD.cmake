@@ -10,6 +10,15 @@ macro(zstd_build)
         third_party/zstd/lib/compress/huf_compress.c
         third_party/zstd/lib/compress/fse_compress.c
     )
+    # Dictionary builder, used by vinyl to train page dictionaries.
+    file(GLOB zstd_dict_src
+        ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/dictBuilder/*.c)
+    foreach(src pool.c threading.c)
+        if (EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common/${src})
+            list(APPEND zstd_dict_src third_party/zstd/lib/common/${src})
+        endif()
+    endforeach()
+    list(APPEND zstd_src ${zstd_dict_src})
 
     if (CC_HAS_WNO_IMPLICIT_FALLTHROUGH)
         set_source_files_properties(${zstd_src}
@@ -20,7 +29,8 @@ macro(zstd_build)
     set(ZSTD_LIBRARIES zstd)
     set(ZSTD_INCLUDE_DIRS
             ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib
-            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common)
+            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common
+            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/dictBuilder)
     include_directories(${ZSTD_INCLUDE_DIRS})
     find_package_message(ZSTD "Using bundled ZSTD"
         "${ZSTD_LIBRARIES}:${ZSTD_INCLUDE_DIRS}")
@@ -36,6 +36,10 @@ box.cfg {
     -- by default username is "guest"
     -- replication_source="127.0.0.1:3102";
 
+    -- Ask the master to compress the replication stream with
+    -- zstd at this level, 0 disables compression
+    replication_compression = 0;
+
     -- The server will sleep for io_collect_interval seconds
     -- between iterations of the event loop
     io_collect_interval = nil;
@@ -43,6 +47,9 @@ box.cfg {
     -- The size of the read-ahead buffer associated with a client connection
     readahead = 16320;
 
+    -- The number of threads serving client connections
+    net_threads = 1;
+
     ----------------------
     -- Memtx configuration
     ----------------------
@@ -76,6 +83,14 @@ box.cfg {
 
     -- How much memory Vinyl engine can use for caches, in bytes.
     vinyl_cache = 128 * 1024 * 1024; -- 128Mb
+    vinyl_page_cache = 128 * 1024 * 1024; -- 128Mb
+
+    -- How many pages of a run to read ahead on a sequential scan.
+    vinyl_read_ahead = 4;
+
+    -- Read run files bypassing the OS page cache, so that the
+    -- memory used for caching is limited by vinyl_page_cache.
+    vinyl_direct_io = false;
 
     -- The maximum number of background workers for compaction.
     vinyl_threads = 2;
@@ -97,6 +112,12 @@ box.cfg {
     -- How many log records to store in a single write-ahead log file
     rows_per_wal = 5000000;
 
+    -- In "fsync" mode, how long a write may wait for other writes
+    -- to share one fdatasync with, in seconds (0 = sync every batch),
+    -- and how many bytes may be waiting before syncing at once
+    wal_group_commit_delay = 0;
+    wal_group_commit_size = 1048576;
+
     -- The interval between actions by the snapshot daemon, in seconds
     checkpoint_interval = 60 * 60; -- one hour
 
@@ -347,6 +347,17 @@ key_opts_create(struct key_opts *opts, const char *map)
 	if (opts->run_size_ratio <= 1)
 		tnt_raise(ClientError, ER_WRONG_SPACE_OPTIONS, INDEX_OPTS,
 			  "run_size_ratio must be > 1");
+	if (opts->compactionbuf[0] != '\0') {
+		opts->compaction = STR2ENUM(compaction_type,
+					    opts->compactionbuf);
+		if (opts->compaction == compaction_type_MAX)
+			tnt_raise(ClientError, ER_WRONG_INDEX_OPTIONS,
+				  INDEX_OPTS, "compaction must be one of "
+				  "'tiered', 'leveled' or 'time_window'");
+	}
+	if (opts->compaction_window <= 0)
+		tnt_raise(ClientError, ER_WRONG_INDEX_OPTIONS, INDEX_OPTS,
+			  "compaction_window must be > 0");
 	return map;
 }
 
@@ -985,7 +996,7 @@ ModifySpace::prepare(struct alter_space *alter)
 	if (def.exact_field_count != 0 &&
 	    def.exact_field_count != alter->old_space->def.exact_field_count &&
 	    space_index(alter->old_space, 0) != NULL &&
-	    space_size(alter->old_space) > 0) {
+	    !space_is_empty(alter->old_space)) {
 
 		tnt_raise(ClientError, ER_ALTER_SPACE,
 			  space_name(alter->old_space),
@@ -1000,11 +1011,24 @@ ModifySpace::prepare(struct alter_space *alter)
 	}
 	if (def.opts.temporary != alter->old_space->def.opts.temporary &&
 	    space_index(alter->old_space, 0) != NULL &&
-	    space_size(alter->old_space) > 0) {
+	    !space_is_empty(alter->old_space)) {
 		tnt_raise(ClientError, ER_ALTER_SPACE,
 			  space_name(alter->old_space),
 			  "can not switch temporary flag on a non-empty space");
 	}
+	/*
+	 * Secondary indexes of a space that defers deletes may
+	 * contain stale entries, and count() only checks for them
+	 * while the option is set.
+	 */
+	if (!def.opts.defer_deletes &&
+	    alter->old_space->def.opts.defer_deletes &&
+	    alter->old_space->index_count > 1) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  space_name(alter->old_space),
+			  "can not switch defer_deletes flag off on a space "
+			  "with secondary indexes");
+	}
 }
 
 /** Amend the definition of the new space. */
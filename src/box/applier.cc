@@ -46,9 +46,18 @@
 #include "trigger.h"
 #include "xrow_io.h"
 #include "error.h"
+#include "txn.h"
+#include "space.h"
+#include "schema.h"
+#include "cfg.h"
 
 /* TODO: add configuration options */
 static const int RECONNECT_DELAY = 1;
+/**
+ * The max number of rows the applier groups into one
+ * transaction.
+ */
+static const int APPLIER_TXN_ROWS_MAX = 1024;
 
 STRS(applier_state, applier_STATE);
 
@@ -287,6 +296,240 @@ finish:
 	applier_set_state(applier, APPLIER_READY);
 }
 
+/**
+ * Find the space a row received from the master is for.
+ * Return NULL if the row must be applied in a transaction
+ * of its own: DDL can't be a part of a multi-statement
+ * transaction, and errors in malformed rows are reported
+ * when they are applied.
+ */
+static struct space *
+applier_row_space(struct xrow_header *row)
+{
+	if (row->bodycnt != 1)
+		return NULL;
+	struct request request;
+	request_create(&request, row->type);
+	if (request_decode(&request, (const char *) row->body[0].iov_base,
+			   row->body[0].iov_len) != 0)
+		return NULL;
+	if (request.space_id >= BOX_SYSTEM_ID_MIN &&
+	    request.space_id <= BOX_SYSTEM_ID_MAX)
+		return NULL;
+	return space_by_id(request.space_id);
+}
+
+/**
+ * Commit the transaction of the applied rows, if any.
+ *
+ * The replica set vclock is promoted before a row is applied,
+ * see applier_subscribe(). If the commit fails, the transaction
+ * is rolled back and the vclock component of @a replica_id is
+ * moved back to @a prev_lsn, the value it had before the rows
+ * of the transaction, so that the rows are received again when
+ * replication is resumed.
+ */
+static void
+applier_txn_commit(uint32_t replica_id, int64_t prev_lsn)
+{
+	struct txn *txn = in_txn();
+	if (txn == NULL)
+		return;
+	int64_t lsn = vclock_get(&replicaset_vclock, replica_id);
+	try {
+		txn_commit(txn);
+	} catch (Exception *e) {
+		txn_rollback();
+		/*
+		 * Unless another applier has received newer
+		 * rows of the same instance meanwhile.
+		 */
+		if (vclock_get(&replicaset_vclock, replica_id) == lsn)
+			vclock_rollback(&replicaset_vclock, replica_id,
+					prev_lsn);
+		throw;
+	}
+}
+
+/**
+ * Apply a row received from the master. If @a batch is set,
+ * apply it in the current transaction, starting one if
+ * necessary.
+ */
+static void
+applier_apply_row(struct applier *applier, struct xrow_header *row,
+		  bool batch)
+{
+	if (!batch) {
+		xstream_write_xc(applier->subscribe_stream, row);
+		return;
+	}
+	/*
+	 * The row is written to WAL at commit, make a copy
+	 * for the transaction. The body stays in the input
+	 * buffer, which is not reset until commit.
+	 */
+	struct xrow_header *copy = (struct xrow_header *)
+		region_alloc_xc(&fiber()->gc, sizeof(*copy));
+	*copy = *row;
+	if (in_txn() == NULL)
+		txn_begin(false);
+	xstream_write_xc(applier->subscribe_stream, copy);
+}
+
+/**
+ * Decompress a batch of rows sent by the master into
+ * applier->zbuf.
+ */
+static void
+applier_decompress(struct applier *applier, const char *data, uint32_t len)
+{
+	ZSTD_inBuffer input = {data, len, 0};
+	struct ibuf *zbuf = &applier->zbuf;
+	ZSTD_initDStream(applier->zdctx);
+	size_t rc;
+	do {
+		ibuf_reserve_xc(zbuf, ZSTD_DStreamOutSize());
+		ZSTD_outBuffer output = {zbuf->wpos, ibuf_unused(zbuf), 0};
+		rc = ZSTD_decompressStream(applier->zdctx, &output, &input);
+		if (ZSTD_isError(rc)) {
+			tnt_raise(ClientError, ER_DECOMPRESSION,
+				  ZSTD_getErrorName(rc));
+		}
+		zbuf->wpos += output.pos;
+		if (rc != 0 && input.pos == input.size &&
+		    output.pos < output.size) {
+			tnt_raise(ClientError, ER_DECOMPRESSION,
+				  "truncated frame");
+		}
+	} while (rc != 0);
+}
+
+/**
+ * Read the next row of the SUBSCRIBE stream. If the stream
+ * is compressed, the master sends rows in batches, each
+ * prefixed with its compressed size (MP_UINT) and compressed
+ * into a single zstd frame. Rows sent by iproto rather than
+ * the relay, such as errors, are not compressed.
+ */
+static void
+applier_read_xrow(struct applier *applier, struct xrow_header *row)
+{
+	struct ibuf *in = &applier->iobuf->in;
+	if (applier->compression == 0)
+		return coio_read_xrow(&applier->io, in, row);
+
+	struct ibuf *zbuf = &applier->zbuf;
+	if (ibuf_used(zbuf) == 0) {
+		ibuf_reset(zbuf);
+		uint32_t len = coio_read_packet(&applier->io, in);
+		/*
+		 * Errors, e.g. if the relay fails, are sent as
+		 * plain rows. A row starts with its header map,
+		 * a zstd frame with the magic number.
+		 */
+		if (len > 0 && mp_typeof(*in->rpos) == MP_MAP) {
+			xrow_header_decode_xc(row, (const char **) &in->rpos,
+					      in->rpos + len);
+			return;
+		}
+		applier_decompress(applier, in->rpos, len);
+		in->rpos += len;
+	}
+	/* A batch never ends in the middle of a row. */
+	if (!xrow_read_buffered(zbuf, row)) {
+		tnt_raise(ClientError, ER_INVALID_MSGPACK,
+			  "compressed batch");
+	}
+}
+
+/**
+ * Decode the next row of the SUBSCRIBE stream if it has
+ * already been read, without reading from the socket.
+ */
+static bool
+applier_read_xrow_buffered(struct applier *applier, struct xrow_header *row)
+{
+	if (applier->compression == 0)
+		return xrow_read_buffered(&applier->iobuf->in, row);
+	return xrow_read_buffered(&applier->zbuf, row);
+}
+
+/**
+ * Apply @a row and the rows following it which have already
+ * been read from the master, in one transaction if possible.
+ */
+static void
+applier_apply_rows(struct applier *applier, struct xrow_header *row)
+{
+	int txn_rows = 0;
+	uint32_t txn_replica_id = REPLICA_ID_NIL;
+	int64_t txn_prev_lsn = 0;
+	try {
+		do {
+			applier->lag = ev_now(loop()) - row->tm;
+			applier->last_row_time = ev_now(loop());
+
+			if (iproto_type_is_error(row->type))
+				xrow_decode_error(row);  /* error */
+			/* Replication request. */
+			if (row->replica_id == REPLICA_ID_NIL ||
+			    row->replica_id >= VCLOCK_MAX) {
+				/*
+				 * A safety net, this can only occur
+				 * if we're fed a strangely broken xlog.
+				 */
+				tnt_raise(ClientError, ER_UNKNOWN_REPLICA,
+					  int2str(row->replica_id),
+					  tt_uuid_str(&REPLICASET_UUID));
+			}
+			if (vclock_get(&replicaset_vclock,
+				       row->replica_id) >= row->lsn)
+				continue;
+			/*
+			 * All rows of a transaction must come from
+			 * the same instance and belong to spaces of
+			 * the same engine.
+			 */
+			struct space *space = applier_row_space(row);
+			struct txn *txn = in_txn();
+			if (txn != NULL &&
+			    (space == NULL ||
+			     row->replica_id != txn_replica_id ||
+			     (txn->engine != NULL &&
+			      txn->engine != space->handler->engine))) {
+				applier_txn_commit(txn_replica_id, txn_prev_lsn);
+				txn_rows = 0;
+			}
+			if (in_txn() == NULL) {
+				txn_replica_id = row->replica_id;
+				txn_prev_lsn = vclock_get(&replicaset_vclock,
+							  row->replica_id);
+			}
+			/**
+			 * Promote the replica set vclock before
+			 * applying the row, so that other appliers
+			 * skip it. If there is an exception
+			 * (conflict) applying the row, the row is
+			 * skipped when the replication is resumed.
+			 * If the transaction fails to commit, the
+			 * vclock is moved back, see
+			 * applier_txn_commit().
+			 */
+			vclock_follow(&replicaset_vclock, row->replica_id,
+				      row->lsn);
+			applier_apply_row(applier, row, space != NULL);
+			txn_rows++;
+		} while (txn_rows < APPLIER_TXN_ROWS_MAX &&
+			 applier_read_xrow_buffered(applier, row));
+		applier_txn_commit(txn_replica_id, txn_prev_lsn);
+	} catch (Exception *e) {
+		/* Keep the rows applied before the failed one. */
+		applier_txn_commit(txn_replica_id, txn_prev_lsn);
+		throw;
+	}
+}
+
 /**
  * Execute and process SUBSCRIBE request (follow updates from a master).
  */
@@ -301,8 +544,10 @@ applier_subscribe(struct applier *applier)
 	struct xrow_header row;
 
 	xrow_encode_subscribe(&row, &REPLICASET_UUID, &INSTANCE_UUID,
-			      &replicaset_vclock);
+			      &replicaset_vclock,
+			      MAX(cfg_geti("replication_compression"), 0));
 	coio_write_xrow(coio, &row);
+	applier->compression = 0;
 	applier_set_state(applier, APPLIER_FOLLOW);
 
 	/*
@@ -318,11 +563,21 @@ applier_subscribe(struct applier *applier)
 		}
 		/*
 		 * In case of successful subscribe, the server
-		 * responds with its current vclock.
+		 * responds with its current vclock and the
+		 * compression level of the stream, if it agreed
+		 * to compress it.
 		 */
 		struct vclock vclock;
 		vclock_create(&vclock);
-		xrow_decode_vclock(&row, &vclock);
+		xrow_decode_subscribe(&row, NULL, NULL, &vclock,
+				      &applier->compression);
+	}
+	if (applier->compression != 0 && applier->zdctx == NULL) {
+		applier->zdctx = ZSTD_createDStream();
+		if (applier->zdctx == NULL) {
+			tnt_raise(ClientError, ER_DECOMPRESSION,
+				  "failed to create context");
+		}
 	}
 	/**
 	 * Tarantool < 1.6.7:
@@ -337,37 +592,17 @@ applier_subscribe(struct applier *applier)
 
 	/*
 	 * Process a stream of rows from the binary log.
+	 *
+	 * Rows which have already been read into the input
+	 * buffer are applied in one transaction, so that
+	 * they pay for a single WAL write. The transaction is
+	 * committed before the applier reads from the socket
+	 * again. If a row fails, the rows applied before it
+	 * are committed and the error is raised.
 	 */
 	while (true) {
-		coio_read_xrow(coio, &iobuf->in, &row);
-		applier->lag = ev_now(loop()) - row.tm;
-		applier->last_row_time = ev_now(loop());
-
-		if (iproto_type_is_error(row.type))
-			xrow_decode_error(&row);  /* error */
-		/* Replication request. */
-		if (row.replica_id == REPLICA_ID_NIL ||
-		    row.replica_id >= VCLOCK_MAX) {
-			/*
-			 * A safety net, this can only occur
-			 * if we're fed a strangely broken xlog.
-			 */
-			tnt_raise(ClientError, ER_UNKNOWN_REPLICA,
-				  int2str(row.replica_id),
-				  tt_uuid_str(&REPLICASET_UUID));
-		}
-		if (vclock_get(&replicaset_vclock, row.replica_id) < row.lsn) {
-			/**
-			 * Promote the replica set vclock before
-			 * applying the row. If there is an
-			 * exception (conflict) applying the row,
-			 * the row is skipped when the replication
-			 * is resumed.
-			 */
-			vclock_follow(&replicaset_vclock, row.replica_id,
-				      row.lsn);
-			xstream_write_xc(applier->subscribe_stream, &row);
-		}
+		applier_read_xrow(applier, &row);
+		applier_apply_rows(applier, &row);
 		iobuf_reset(iobuf);
 		fiber_gc();
 	}
@@ -378,6 +613,7 @@ applier_disconnect(struct applier *applier, enum applier_state state)
 {
 	coio_close(loop(), &applier->io);
 	iobuf_reset(applier->iobuf);
+	ibuf_reset(&applier->zbuf);
 	applier_set_state(applier, state);
 	fiber_gc();
 }
@@ -497,6 +733,7 @@ applier_new(const char *uri, struct xstream *join_stream,
 	}
 	coio_init(&applier->io, -1);
 	applier->iobuf = iobuf_new();
+	ibuf_create(&applier->zbuf, &cord()->slabc, ZSTD_DStreamOutSize());
 
 	/* uri_parse() sets pointers to applier->source buffer */
 	snprintf(applier->source, sizeof(applier->source), "%s", uri);
@@ -519,6 +756,9 @@ applier_delete(struct applier *applier)
 {
 	assert(applier->reader == NULL);
 	iobuf_delete(applier->iobuf);
+	ibuf_destroy(&applier->zbuf);
+	if (applier->zdctx != NULL)
+		ZSTD_freeDStream(applier->zdctx);
 	assert(applier->io.fd == -1);
 	ipc_channel_destroy(&applier->pause);
 	trigger_destroy(&applier->on_state);
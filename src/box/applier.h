@@ -33,6 +33,7 @@
 
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <small/ibuf.h>
 
 #include "trivia/util.h"
 #include "uri.h"
@@ -41,6 +42,7 @@
 #include "third_party/tarantool_ev.h"
 #include "vclock.h"
 #include "ipc.h"
+#include "zstd.h"
 
 struct xstream;
 
@@ -96,6 +98,15 @@ struct applier {
 	struct ev_io io;
 	/** Input/output buffer for buffered IO */
 	struct iobuf *iobuf;
+	/**
+	 * Zstd level of the replication stream as acknowledged
+	 * by the master, 0 if the stream is not compressed.
+	 */
+	uint32_t compression;
+	/** Decompression context, created on demand. */
+	ZSTD_DStream *zdctx;
+	/** Rows decompressed from the stream. */
+	struct ibuf zbuf;
 	/** Triggers invoked on state change */
 	struct rlist on_state;
 	/** Channel used by applier_connect_all() and applier_resume() */
@@ -386,6 +386,15 @@ box_check_readahead(int readahead)
 	}
 }
 
+static void
+box_check_net_threads(int net_threads)
+{
+	if (net_threads < 1 || net_threads > IPROTO_THREADS_MAX) {
+		tnt_raise(ClientError, ER_CFG, "net_threads",
+			  "specified value is out of bounds");
+	}
+}
+
 static int64_t
 box_check_wal_max_rows(int64_t wal_max_rows)
 {
@@ -408,22 +417,52 @@ box_check_wal_max_size(int64_t wal_max_size)
 	return wal_max_size;
 }
 
+static double
+box_check_wal_group_commit_delay(double delay)
+{
+	if (delay < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_group_commit_delay",
+			  "the value must not be negative");
+	}
+	return delay;
+}
+
+static int64_t
+box_check_wal_group_commit_size(int64_t size)
+{
+	if (size < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_group_commit_size",
+			  "the value must not be negative");
+	}
+	return size;
+}
+
 void
 box_check_config()
 {
 	box_check_log(cfg_gets("log"));
 	box_check_uri(cfg_gets("listen"), "listen");
 	box_check_replication();
+	if (cfg_geti("replication_compression") < 0) {
+		tnt_raise(ClientError, ER_CFG, "replication_compression",
+			  "must be >= 0");
+	}
 	box_check_readahead(cfg_geti("readahead"));
+	box_check_net_threads(cfg_geti("net_threads"));
 	box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
+	box_check_wal_group_commit_delay(cfg_getd("wal_group_commit_delay"));
+	box_check_wal_group_commit_size(cfg_geti64("wal_group_commit_size"));
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
 	if (cfg_geti64("vinyl_page_size") > cfg_geti64("vinyl_range_size"))
 		tnt_raise(ClientError, ER_CFG, "vinyl_page_size",
 			  "can't be greater than vinyl_range_size");
 	if (cfg_geti("vinyl_threads") < 2)
 		tnt_raise(ClientError, ER_CFG, "vinyl_threads", "must be >= 2");
+	if (cfg_geti("vinyl_read_ahead") < 0)
+		tnt_raise(ClientError, ER_CFG, "vinyl_read_ahead",
+			  "must be >= 0");
 }
 
 /*
@@ -861,7 +900,8 @@ space_truncate(struct space *space)
 		TupleRefNil ref(tuple);
 		uint32_t bsize;
 		const char *data = tuple_data_range(tuple, &bsize);
-		if (box_insert(BOX_INDEX_ID, data, data + bsize, NULL))
+		if (data == NULL ||
+		    box_insert(BOX_INDEX_ID, data, data + bsize, NULL))
 			diag_raise();
 	}
 }
@@ -1250,8 +1290,9 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	struct tt_uuid replicaset_uuid = uuid_nil, replica_uuid = uuid_nil;
 	struct vclock replica_clock;
 	vclock_create(&replica_clock);
+	uint32_t compression = 0;
 	xrow_decode_subscribe(header, &replicaset_uuid, &replica_uuid,
-			      &replica_clock);
+			      &replica_clock, &compression);
 
 	/* Forbid connection to itself */
 	if (tt_uuid_is_equal(&replica_uuid, &INSTANCE_UUID))
@@ -1286,6 +1327,13 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 			  "wal_mode = 'none'");
 	}
 
+	/*
+	 * The replica may ask for a compressed stream. Agree
+	 * on the level we support, the replica learns it from
+	 * the response. Older replicas never ask.
+	 */
+	compression = MIN(compression, (uint32_t) ZSTD_maxCLevel());
+
 	/*
 	 * Send a response to SUBSCRIBE request, tell
 	 * the replica how many rows we have in stock for it,
@@ -1294,7 +1342,7 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	struct xrow_header row;
 	struct vclock current_vclock;
 	wal_checkpoint(&current_vclock, true);
-	xrow_encode_vclock(&row, &current_vclock);
+	xrow_encode_subscribe_response(&row, &current_vclock, compression);
 	/*
 	 * Identify the message with the replica id of this
 	 * instance, this is the only way for a replica to find
@@ -1317,7 +1365,8 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	 * a stall in updates (in this case replica may hang
 	 * indefinitely).
 	 */
-	relay_subscribe(io->fd, header->sync, replica, &replica_clock);
+	relay_subscribe(io->fd, header->sync, replica, &replica_clock,
+			compression);
 }
 
 /** Insert a new cluster into _schema */
@@ -1535,7 +1584,7 @@ box_cfg_xc(void)
 
 	replication_init();
 	port_init();
-	iproto_init();
+	iproto_init(cfg_geti("net_threads"));
 	wal_thread_start();
 
 	title("loading");
@@ -1666,8 +1715,13 @@ box_cfg_xc(void)
 	int64_t wal_max_rows = box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	int64_t wal_max_size = box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
+	double group_commit_delay =
+		box_check_wal_group_commit_delay(cfg_getd("wal_group_commit_delay"));
+	int64_t group_commit_size =
+		box_check_wal_group_commit_size(cfg_geti64("wal_group_commit_size"));
 	wal_init(wal_mode, cfg_gets("wal_dir"), &INSTANCE_UUID,
-		 &replicaset_vclock, wal_max_rows, wal_max_size);
+		 &replicaset_vclock, wal_max_rows, wal_max_size,
+		 group_commit_delay, group_commit_size);
 
 	rmean_cleanup(rmean_box);
 
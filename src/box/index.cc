@@ -194,6 +194,12 @@ Index::size() const
 	return 0;
 }
 
+bool
+Index::isEmpty() const
+{
+	return size() == 0;
+}
+
 struct tuple *
 Index::min(const char* /* key */, uint32_t /* part_count */) const
 {
@@ -224,6 +230,13 @@ Index::count(enum iterator_type /* type */, const char* /* key */,
 	return 0;
 }
 
+size_t
+Index::approximateCount(enum iterator_type type, const char *key,
+			uint32_t part_count) const
+{
+	return count(type, key, part_count);
+}
+
 struct tuple *
 Index::findByKey(const char *key, uint32_t part_count) const
 {
@@ -457,6 +470,30 @@ box_index_count(uint32_t space_id, uint32_t index_id, int type,
 	}
 }
 
+ssize_t
+box_index_count_approximate(uint32_t space_id, uint32_t index_id, int type,
+			    const char *key, const char *key_end)
+{
+	assert(key != NULL && key_end != NULL);
+	mp_tuple_assert(key, key_end);
+	enum iterator_type itype = (enum iterator_type) type;
+	try {
+		struct space *space;
+		Index *index = check_index(space_id, index_id, &space);
+		uint32_t part_count = mp_decode_array(&key);
+		if (key_validate(index->index_def, itype, key, part_count))
+			diag_raise();
+		/* Start transaction in the engine */
+		struct txn *txn = txn_begin_ro_stmt(space);
+		ssize_t count = index->approximateCount(itype, key, part_count);
+		txn_commit_ro_stmt(txn);
+		return count;
+	} catch (Exception *) {
+		txn_rollback_stmt();
+		return -1; /* handled by box.error() in Lua */
+	}
+}
+
 /* }}} */
 
 /* {{{ Iterators ************************************************/
@@ -243,6 +243,20 @@ box_index_count(uint32_t space_id, uint32_t index_id, int type,
 
 /** \endcond public */
 
+/**
+ * Estimate the number of tuples matching the provided key.
+ * Unlike box_index_count() the result may be inexact, but
+ * it is computed without reading the matching tuples.
+ *
+ * \retval -1 on error (check box_error_last())
+ * \retval >=0 on success
+ * \sa \code box.space[space_id].index[index_id]:count(key,
+ *     { iterator = type, approximate = true }) \endcode
+ */
+ssize_t
+box_index_count_approximate(uint32_t space_id, uint32_t index_id, int type,
+			    const char *key, const char *key_end);
+
 extern const char *iterator_type_strs[];
 
 #if defined(__cplusplus)
@@ -336,11 +350,24 @@ public:
 	Index& operator=(const Index&) = delete;
 
 	virtual size_t size() const;
+	/**
+	 * Return true if the index has no tuples. Unlike size(),
+	 * it is supported by all engines. The default
+	 * implementation uses size().
+	 */
+	virtual bool isEmpty() const;
 	virtual struct tuple *min(const char *key, uint32_t part_count) const;
 	virtual struct tuple *max(const char *key, uint32_t part_count) const;
 	virtual struct tuple *random(uint32_t rnd) const;
 	virtual size_t count(enum iterator_type type, const char *key,
 			     uint32_t part_count) const;
+	/**
+	 * Estimate the number of tuples matching the key without
+	 * iterating over them. The default implementation is exact.
+	 */
+	virtual size_t approximateCount(enum iterator_type type,
+					const char *key,
+					uint32_t part_count) const;
 	virtual struct tuple *findByKey(const char *key, uint32_t part_count) const;
 	virtual struct tuple *findByTuple(struct tuple *tuple) const;
 	virtual struct tuple *replace(struct tuple *old_tuple,
@@ -62,6 +62,19 @@
 /* The number of iproto messages in flight */
 enum { IPROTO_MSG_MAX = 768 };
 
+/**
+ * SELECT responses with tuples of this size on average or
+ * larger are written to the socket right from the tuple memory,
+ * see iproto_flush_zcopy(). Smaller tuples are cheaper to copy
+ * than to pin and to write with an iovec per tuple.
+ */
+enum { IPROTO_ZCOPY_TUPLE_SIZE_MIN = 512 };
+
+/** The max number of tuples written by one writev(). */
+enum { IPROTO_ZCOPY_IOV_MAX = 64 };
+
+struct iproto_thread;
+
 /* {{{ iproto_msg - declaration */
 
 /**
@@ -98,32 +111,34 @@ struct iproto_msg: public cmsg
 	 * and the connection must be closed.
 	 */
 	bool close_connection;
+	/**
+	 * True if this is a SELECT response, which tuples are
+	 * not copied to the output buffer. They are written
+	 * right after write_end and stay referenced until
+	 * then.
+	 */
+	bool zcopy;
+	/** Tuples of a zero-copy response. */
+	struct port port;
+	/** The tuple to continue writing a zero-copy response at. */
+	struct port_entry *zcopy_entry;
+	/** How many bytes of zcopy_entry tuple are written. */
+	uint32_t zcopy_offset;
+	/** Link in iproto_connection::zcopy_queue. */
+	struct rlist in_zcopy;
 };
 
-static struct mempool iproto_msg_pool;
-
 static struct iproto_msg *
-iproto_msg_new(struct iproto_connection *con)
-{
-	struct iproto_msg *msg =
-		(struct iproto_msg *) mempool_alloc_xc(&iproto_msg_pool);
-	msg->connection = con;
-	return msg;
-}
+iproto_msg_new(struct iproto_connection *con);
 
 /**
  * Resume stopped connections, if any.
  */
 static void
-iproto_resume();
-
+iproto_resume(struct iproto_thread *thread);
 
 static inline void
-iproto_msg_delete(struct cmsg *msg)
-{
-	mempool_free(&iproto_msg_pool, msg);
-	iproto_resume();
-}
+iproto_msg_delete(struct cmsg *msg);
 
 struct IprotoMsgGuard {
 	struct iproto_msg *msg;
@@ -136,25 +151,7 @@ struct IprotoMsgGuard {
 
 /* }}} */
 
-/* {{{ iproto connection and requests */
-
-/**
- * A single global queue for all requests in all connections. All
- * requests from all connections are processed concurrently.
- * Is also used as a queue for just established connections and to
- * execute disconnect triggers. A few notes about these triggers:
- * - they need to be run in a fiber
- * - unlike an ordinary request failure, on_connect trigger
- *   failure must lead to connection close.
- * - on_connect trigger must be processed before any other
- *   request on this connection.
- */
-static struct cpipe tx_pipe;
-static struct cpipe net_pipe;
-/* A pointer to the transaction processor cord. */
-struct cord *tx_cord;
-
-struct rmean *rmean_net;
+/* {{{ iproto thread */
 
 enum rmean_net_name {
 	IPROTO_SENT,
@@ -164,6 +161,76 @@ enum rmean_net_name {
 
 const char *rmean_net_strings[IPROTO_LAST] = { "SENT", "RECEIVED" };
 
+/**
+ * A network io thread. Client connections are spread among
+ * threads in round-robin order by the first thread, which
+ * accepts them. A connection stays in its thread until it
+ * is closed, so requests of a connection are never
+ * reordered.
+ */
+struct iproto_thread {
+	/** The thread cord. */
+	struct cord cord;
+	/** Thread number, 0 is the acceptor thread. */
+	int id;
+	/** Name of the thread cbus endpoint. */
+	char endpoint_name[FIBER_NAME_MAX];
+	/**
+	 * A queue for all requests in all connections of the
+	 * thread. All requests from all connections are
+	 * processed concurrently.
+	 * Is also used as a queue for just established
+	 * connections and to execute disconnect triggers. A few
+	 * notes about these triggers:
+	 * - they need to be run in a fiber
+	 * - unlike an ordinary request failure, on_connect
+	 *   trigger failure must lead to connection close.
+	 * - on_connect trigger must be processed before any
+	 *   other request on this connection.
+	 */
+	struct cpipe tx_pipe;
+	/** A pipe from tx to this thread. */
+	struct cpipe net_pipe;
+	/**
+	 * A pipe from the acceptor thread to this thread, to
+	 * hand over accepted connections.
+	 */
+	struct cpipe accept_pipe;
+	/** The max number of requests of the thread in flight. */
+	size_t msg_max;
+	struct mempool msg_pool;
+	struct mempool connection_pool;
+	/** Connections with input stopped by throttling. */
+	struct rlist stopped_connections;
+	/** Network statistics of the thread. */
+	struct rmean *rmean;
+	/*
+	 * Routes of messages, by request type. Each thread
+	 * has own routes, since the way back from tx leads
+	 * to the thread's pipe.
+	 */
+	struct cmsg_hop disconnect_route[2];
+	struct cmsg_hop misc_route[2];
+	struct cmsg_hop select_route[2];
+	struct cmsg_hop zcopy_release_route[2];
+	struct cmsg_hop process1_route[2];
+	struct cmsg_hop sync_route[2];
+	struct cmsg_hop connect_route[2];
+	const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX];
+};
+
+static struct iproto_thread *iproto_threads;
+static int iproto_thread_count;
+/** The thread to pass the next accepted connection to. */
+static int iproto_next_thread;
+
+/* A pointer to the transaction processor cord. */
+struct cord *tx_cord;
+
+/* }}} */
+
+/* {{{ iproto connection and requests */
+
 /** Context of a single client connection. */
 struct iproto_connection
 {
@@ -192,13 +259,36 @@ struct iproto_connection
 	/** Logical session. */
 	struct session *session;
 	ev_loop *loop;
+	/** The network thread serving the connection. */
+	struct iproto_thread *thread;
 	/* Pre-allocated disconnect msg. */
 	struct iproto_msg *disconnect;
 	struct rlist in_stop_list;
+	/**
+	 * Zero-copy responses which tuples are not written
+	 * yet, in order of iobuf->out.wend.
+	 */
+	struct rlist zcopy_queue;
 };
 
-static struct mempool iproto_connection_pool;
-static RLIST_HEAD(stopped_connections);
+static struct iproto_msg *
+iproto_msg_new(struct iproto_connection *con)
+{
+	struct iproto_msg *msg = (struct iproto_msg *)
+		mempool_alloc_xc(&con->thread->msg_pool);
+	msg->connection = con;
+	msg->zcopy = false;
+	return msg;
+}
+
+static inline void
+iproto_msg_delete(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct iproto_thread *thread = msg->connection->thread;
+	mempool_free(&thread->msg_pool, msg);
+	iproto_resume(thread);
+}
 
 /**
  * Returns true if we have enough spare messages
@@ -206,11 +296,11 @@ static RLIST_HEAD(stopped_connections);
  * discounted: they are mostly reserved and idle.
  */
 static inline bool
-iproto_stop_input()
+iproto_stop_input(struct iproto_thread *thread)
 {
-	size_t connection_count = mempool_count(&iproto_connection_pool);
-	size_t request_count = mempool_count(&iproto_msg_pool);
-	return request_count > connection_count + IPROTO_MSG_MAX;
+	size_t connection_count = mempool_count(&thread->connection_pool);
+	size_t request_count = mempool_count(&thread->msg_pool);
+	return request_count > connection_count + thread->msg_max;
 }
 
 /**
@@ -220,20 +310,20 @@ iproto_stop_input()
  * object in the message pool.
  */
 static void
-iproto_resume()
+iproto_resume(struct iproto_thread *thread)
 {
 	/*
 	 * Most of the time we have nothing to do here: throttling
 	 * is not active.
 	 */
-	if (rlist_empty(&stopped_connections))
+	if (rlist_empty(&thread->stopped_connections))
 		return;
-	if (iproto_stop_input())
+	if (iproto_stop_input(thread))
 		return;
 
 	struct iproto_connection *con;
-	con = rlist_first_entry(&stopped_connections, struct iproto_connection,
-				in_stop_list);
+	con = rlist_first_entry(&thread->stopped_connections,
+				struct iproto_connection, in_stop_list);
 	ev_feed_event(con->loop, &con->input, EV_READ);
 }
 
@@ -264,7 +354,7 @@ iproto_connection_stop(struct iproto_connection *con)
 {
 	assert(rlist_empty(&con->in_stop_list));
 	ev_io_stop(con->loop, &con->input);
-	rlist_add_tail(&stopped_connections, &con->in_stop_list);
+	rlist_add_tail(&con->thread->stopped_connections, &con->in_stop_list);
 }
 
 static void
@@ -290,7 +380,7 @@ iproto_connection_delete(struct iproto_connection *con)
 	iobuf_delete_mt(con->iobuf[1]);
 	if (con->disconnect)
 		iproto_msg_delete(con->disconnect);
-	mempool_free(&iproto_connection_pool, con);
+	mempool_free(&con->thread->connection_pool, con);
 }
 
 static void
@@ -302,11 +392,19 @@ tx_process_select(struct cmsg *msg);
 static void
 net_send_msg(struct cmsg *msg);
 
+static void
+tx_release_zcopy(struct cmsg *msg);
+
 static void
 tx_process_join_subscribe(struct cmsg *msg);
 static void
 net_end_join_subscribe(struct cmsg *msg);
 
+static void
+tx_process_connect(struct cmsg *msg);
+static void
+net_send_greeting(struct cmsg *msg);
+
 static void
 tx_fiber_init(struct session *session, uint64_t sync)
 {
@@ -347,58 +445,56 @@ static void
 net_finish_disconnect(struct cmsg *m)
 {
 	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct iproto_thread *thread = msg->connection->thread;
 	/* Runs the trigger, which may yield. */
 	iproto_connection_delete(msg->connection);
-	iproto_msg_delete(msg);
+	/* The connection is gone, don't use iproto_msg_delete(). */
+	mempool_free(&thread->msg_pool, msg);
+	iproto_resume(thread);
 }
 
-static const struct cmsg_hop disconnect_route[] = {
-	{ tx_process_disconnect, &net_pipe },
-	{ net_finish_disconnect, NULL },
-};
-
-static const struct cmsg_hop misc_route[] = {
-	{ tx_process_misc, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop select_route[] = {
-	{ tx_process_select, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop process1_route[] = {
-	{ tx_process1, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
-	NULL,                                   /* IPROTO_OK */
-	select_route,                           /* IPROTO_SELECT */
-	process1_route,                         /* IPROTO_INSERT */
-	process1_route,                         /* IPROTO_REPLACE */
-	process1_route,                         /* IPROTO_UPDATE */
-	process1_route,                         /* IPROTO_DELETE */
-	misc_route,                             /* IPROTO_CALL_16 */
-	misc_route,                             /* IPROTO_AUTH */
-	misc_route,                             /* IPROTO_EVAL */
-	process1_route,                         /* IPROTO_UPSERT */
-	misc_route                              /* IPROTO_CALL */
-};
-
-static const struct cmsg_hop sync_route[] = {
-	{ tx_process_join_subscribe, &net_pipe },
-	{ net_end_join_subscribe, NULL },
-};
+/** Initialize message routes of a network thread. */
+static void
+iproto_thread_init_routes(struct iproto_thread *thread)
+{
+	struct cpipe *net_pipe = &thread->net_pipe;
+	thread->disconnect_route[0] = { tx_process_disconnect, net_pipe };
+	thread->disconnect_route[1] = { net_finish_disconnect, NULL };
+	thread->misc_route[0] = { tx_process_misc, net_pipe };
+	thread->misc_route[1] = { net_send_msg, NULL };
+	thread->select_route[0] = { tx_process_select, net_pipe };
+	thread->select_route[1] = { net_send_msg, NULL };
+	thread->zcopy_release_route[0] = { tx_release_zcopy, net_pipe };
+	thread->zcopy_release_route[1] = { iproto_msg_delete, NULL };
+	thread->process1_route[0] = { tx_process1, net_pipe };
+	thread->process1_route[1] = { net_send_msg, NULL };
+	thread->sync_route[0] = { tx_process_join_subscribe, net_pipe };
+	thread->sync_route[1] = { net_end_join_subscribe, NULL };
+	thread->connect_route[0] = { tx_process_connect, net_pipe };
+	thread->connect_route[1] = { net_send_greeting, NULL };
+
+	const struct cmsg_hop **dml_route = thread->dml_route;
+	dml_route[IPROTO_OK] = NULL;
+	dml_route[IPROTO_SELECT] = thread->select_route;
+	dml_route[IPROTO_INSERT] = thread->process1_route;
+	dml_route[IPROTO_REPLACE] = thread->process1_route;
+	dml_route[IPROTO_UPDATE] = thread->process1_route;
+	dml_route[IPROTO_DELETE] = thread->process1_route;
+	dml_route[IPROTO_CALL_16] = thread->misc_route;
+	dml_route[IPROTO_AUTH] = thread->misc_route;
+	dml_route[IPROTO_EVAL] = thread->misc_route;
+	dml_route[IPROTO_UPSERT] = thread->process1_route;
+	dml_route[IPROTO_CALL] = thread->misc_route;
+}
 
 static struct iproto_connection *
-iproto_connection_new(const char *name, int fd)
+iproto_connection_new(struct iproto_thread *thread, int fd)
 {
-	(void) name;
 	struct iproto_connection *con = (struct iproto_connection *)
-		mempool_alloc_xc(&iproto_connection_pool);
+		mempool_alloc_xc(&thread->connection_pool);
 	con->input.data = con->output.data = con;
 	con->loop = loop();
+	con->thread = thread;
 	ev_io_init(&con->input, iproto_connection_on_input, fd, EV_READ);
 	ev_io_init(&con->output, iproto_connection_on_output, fd, EV_WRITE);
 	con->iobuf[0] = iobuf_new_mt(&tx_cord->slabc);
@@ -406,12 +502,26 @@ iproto_connection_new(const char *name, int fd)
 	con->parse_size = 0;
 	con->session = NULL;
 	rlist_create(&con->in_stop_list);
+	rlist_create(&con->zcopy_queue);
 	/* It may be very awkward to allocate at close. */
 	con->disconnect = iproto_msg_new(con);
-	cmsg_init(con->disconnect, disconnect_route);
+	cmsg_init(con->disconnect, thread->disconnect_route);
 	return con;
 }
 
+/**
+ * Send a zero-copy response message to tx to unreference
+ * its tuples. The request must have been discarded from
+ * the input buffer.
+ */
+static inline void
+iproto_zcopy_release(struct iproto_msg *msg)
+{
+	struct iproto_thread *thread = msg->connection->thread;
+	cmsg_init(msg, thread->zcopy_release_route);
+	cpipe_push(&thread->tx_pipe, msg);
+}
+
 /**
  * Initiate a connection shutdown. This method may
  * be invoked many times, and does the internal
@@ -436,6 +546,17 @@ iproto_connection_close(struct iproto_connection *con)
 		 * is done only once.
 		 */
 		con->iobuf[0]->in.wpos -= con->parse_size;
+		/*
+		 * Nothing is going to be written anymore,
+		 * unpin tuples of pending zero-copy responses.
+		 */
+		struct iproto_msg *zc, *tmp;
+		rlist_foreach_entry_safe(zc, &con->zcopy_queue,
+					 in_zcopy, tmp) {
+			rlist_del(&zc->in_zcopy);
+			zc->iobuf->in.rpos += zc->len;
+			iproto_zcopy_release(zc);
+		}
 	}
 	/*
 	 * If the connection has no outstanding requests in the
@@ -453,7 +574,7 @@ iproto_connection_close(struct iproto_connection *con)
 		assert(con->disconnect != NULL);
 		struct iproto_msg *msg = con->disconnect;
 		con->disconnect = NULL;
-		cpipe_push(&tx_pipe, msg);
+		cpipe_push(&con->thread->tx_pipe, msg);
 	}
 	rlist_del(&con->in_stop_list);
 }
@@ -555,6 +676,7 @@ static void
 iproto_decode_msg(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input)
 {
+	struct iproto_thread *thread = msg->connection->thread;
 	xrow_header_decode_xc(&msg->header, pos, reqend);
 	assert(*pos == reqend);
 	request_create(&msg->request, msg->header.type);
@@ -585,15 +707,15 @@ iproto_decode_msg(struct iproto_msg *msg, const char **pos, const char *reqend,
 		request_decode_xc(&msg->request,
 				 (const char *) msg->header.body[0].iov_base,
 				 msg->header.body[0].iov_len);
-		assert(msg->header.type < sizeof(dml_route)/sizeof(*dml_route));
-		cmsg_init(msg, dml_route[msg->header.type]);
+		assert(msg->header.type < lengthof(thread->dml_route));
+		cmsg_init(msg, thread->dml_route[msg->header.type]);
 		break;
 	case IPROTO_PING:
-		cmsg_init(msg, misc_route);
+		cmsg_init(msg, thread->misc_route);
 		break;
 	case IPROTO_JOIN:
 	case IPROTO_SUBSCRIBE:
-		cmsg_init(msg, sync_route);
+		cmsg_init(msg, thread->sync_route);
 		*stop_input = true;
 		break;
 	default:
@@ -631,7 +753,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 
 		try {
 			iproto_decode_msg(msg, &pos, reqend, &stop_input);
-			cpipe_push_input(&tx_pipe, guard.release());
+			cpipe_push_input(&con->thread->tx_pipe, guard.release());
 			n_requests++;
 		} catch (Exception *e) {
 			/*
@@ -689,7 +811,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		 */
 		ev_feed_event(con->loop, &con->input, EV_READ);
 	}
-	cpipe_flush_input(&tx_pipe);
+	cpipe_flush_input(&con->thread->tx_pipe);
 }
 
 static void
@@ -708,7 +830,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 		 * resume one more connection which might have
 		 * input.
 		 */
-		iproto_resume();
+		iproto_resume(con->thread);
 	}
 	/*
 	 * Throttle if there are too many pending requests,
@@ -717,7 +839,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	 * another fiber waiting for write to complete).
 	 * Ignore iproto_connection->disconnect messages.
 	 */
-	if (iproto_stop_input()) {
+	if (iproto_stop_input(con->thread)) {
 		iproto_connection_stop(con);
 		return;
 	}
@@ -742,7 +864,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			return;
 		}
 		/* Count statistics */
-		rmean_collect(rmean_net, IPROTO_RECEIVED, nrd);
+		rmean_collect(con->thread->rmean, IPROTO_RECEIVED, nrd);
 
 		/* Update the read position and connection state. */
 		in->wpos += nrd;
@@ -757,11 +879,35 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	}
 }
 
+/**
+ * Get the first zero-copy response of the iobuf which tuples
+ * are not written yet, if any.
+ */
+static inline struct iproto_msg *
+iproto_connection_zcopy(struct iproto_connection *con, struct iobuf *iobuf)
+{
+	struct iproto_msg *msg;
+	rlist_foreach_entry(msg, &con->zcopy_queue, in_zcopy) {
+		if (msg->iobuf == iobuf)
+			return msg;
+	}
+	return NULL;
+}
+
+/** Return true if the iobuf has output not written yet. */
+static inline bool
+iproto_connection_has_output(struct iproto_connection *con,
+			     struct iobuf *iobuf)
+{
+	return obuf_used(&iobuf->out) > 0 ||
+	       iproto_connection_zcopy(con, iobuf) != NULL;
+}
+
 /** Get the iobuf which is currently being flushed. */
 static inline struct iobuf *
 iproto_connection_output_iobuf(struct iproto_connection *con)
 {
-	if (obuf_used(&con->iobuf[1]->out) > 0)
+	if (iproto_connection_has_output(con, con->iobuf[1]))
 		return con->iobuf[1];
 	/*
 	 * Don't try to write from a newer buffer if an older one
@@ -770,11 +916,65 @@ iproto_connection_output_iobuf(struct iproto_connection *con)
 	 * pieces of replies from both buffers.
 	 */
 	if (ibuf_used(&con->iobuf[1]->in) == 0 &&
-	    obuf_used(&con->iobuf[0]->out) > 0)
+	    iproto_connection_has_output(con, con->iobuf[0]))
 		return con->iobuf[0];
 	return NULL;
 }
 
+/**
+ * writev() tuples of a zero-copy response to the socket. When
+ * all of them are written, discard the request and send the
+ * message to tx to unreference the tuples.
+ */
+static int
+iproto_flush_zcopy(struct iproto_msg *msg, struct iproto_connection *con)
+{
+	int fd = con->output.fd;
+	struct iovec iov[IPROTO_ZCOPY_IOV_MAX];
+	int iovcnt = 0;
+	uint32_t offset = msg->zcopy_offset;
+	for (struct port_entry *e = msg->zcopy_entry;
+	     e != NULL && iovcnt < IPROTO_ZCOPY_IOV_MAX; e = e->next) {
+		/* Compressed tuples are copied to the output buffer. */
+		assert(!tuple_is_compressed(e->tuple));
+		iov[iovcnt].iov_base = (void *) (tuple_data(e->tuple) + offset);
+		iov[iovcnt].iov_len = e->tuple->bsize - offset;
+		iovcnt++;
+		offset = 0;
+	}
+
+	ssize_t nwr = sio_writev(fd, iov, iovcnt);
+
+	/* Count statistics */
+	rmean_collect(con->thread->rmean, IPROTO_SENT, nwr);
+	if (nwr <= 0)
+		return -1;
+	/* Advance the write position. */
+	size_t left = nwr;
+	while (left > 0) {
+		uint32_t tail = msg->zcopy_entry->tuple->bsize -
+				msg->zcopy_offset;
+		if (left < tail) {
+			msg->zcopy_offset += left;
+			break;
+		}
+		left -= tail;
+		msg->zcopy_entry = msg->zcopy_entry->next;
+		msg->zcopy_offset = 0;
+	}
+	if (msg->zcopy_entry != NULL)
+		return -1;
+	struct iobuf *iobuf = msg->iobuf;
+	rlist_del(&msg->in_zcopy);
+	/* Discard request (see iproto_enqueue_batch()) */
+	iobuf->in.rpos += msg->len;
+	iproto_zcopy_release(msg);
+	/* Quickly recycle the buffer if it's idle. */
+	if (iobuf_is_idle(iobuf))
+		iobuf_reset_mt(iobuf);
+	return 0;
+}
+
 /** writev() to the socket and handle the result. */
 
 static int
@@ -783,6 +983,17 @@ iproto_flush(struct iobuf *iobuf, struct iproto_connection *con)
 	int fd = con->output.fd;
 	struct obuf_svp *begin = &iobuf->out.wpos;
 	struct obuf_svp *end = &iobuf->out.wend;
+	/*
+	 * Tuples of a zero-copy response go right after its
+	 * part of the output buffer: write the buffer up to
+	 * them, then the tuples.
+	 */
+	struct iproto_msg *zc = iproto_connection_zcopy(con, iobuf);
+	if (zc != NULL) {
+		if (begin->used == zc->write_end.used)
+			return iproto_flush_zcopy(zc, con);
+		end = &zc->write_end;
+	}
 	assert(begin->used < end->used);
 	struct iovec iov[SMALL_OBUF_IOV_MAX+1];
 	struct iovec *src = iobuf->out.iov;
@@ -799,7 +1010,7 @@ iproto_flush(struct iobuf *iobuf, struct iproto_connection *con)
 	ssize_t nwr = sio_writev(fd, iov, iovcnt);
 
 	/* Count statistics */
-	rmean_collect(rmean_net, IPROTO_SENT, nwr);
+	rmean_collect(con->thread->rmean, IPROTO_SENT, nwr);
 	if (nwr > 0) {
 		if (begin->used + nwr == end->used) {
 			if (ibuf_used(&iobuf->in) == 0) {
@@ -894,7 +1105,8 @@ tx_process_select(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct obuf *out = &msg->iobuf->out;
 	struct obuf_svp svp;
-	struct port port;
+	struct port *port = &msg->port;
+	uint32_t data_len;
 	int rc;
 	struct request *req = &msg->request;
 
@@ -903,17 +1115,41 @@ tx_process_select(struct cmsg *m)
 	if (tx_check_schema(msg->header.schema_id))
 		goto error;
 
-	port_create(&port);
-	rc = box_select((struct port *) &port,
-			req->space_id, req->index_id,
+	port_create(port);
+	rc = box_select(port, req->space_id, req->index_id,
 			req->iterator, req->offset, req->limit,
 			req->key, req->key_end);
 	if (rc < 0 || iproto_prepare_select(out, &svp) != 0) {
-		port_destroy(&port);
+		port_destroy(port);
 		goto error;
 	}
-	port_dump(&port, out);
-	iproto_reply_select(out, &svp, msg->header.sync, port.size);
+	data_len = 0;
+	for (struct port_entry *e = port->first; e != NULL; e = e->next) {
+		/*
+		 * Compressed tuples are decompressed in tx, by
+		 * port_dump().
+		 */
+		if (tuple_is_compressed(e->tuple)) {
+			data_len = 0;
+			break;
+		}
+		data_len += e->tuple->bsize;
+	}
+	if (port->size > 0 &&
+	    data_len >= port->size * IPROTO_ZCOPY_TUPLE_SIZE_MIN) {
+		/*
+		 * Leave the tuples referenced, the net thread
+		 * writes them from the tuple memory.
+		 */
+		iproto_reply_select_len(out, &svp, msg->header.sync,
+					port->size, data_len);
+		msg->zcopy = true;
+		msg->zcopy_entry = port->first;
+		msg->zcopy_offset = 0;
+	} else {
+		port_dump(port, out);
+		iproto_reply_select(out, &svp, msg->header.sync, port->size);
+	}
 	msg->write_end = obuf_create_svp(out);
 	return;
 error:
@@ -922,6 +1158,14 @@ error:
 	msg->write_end = obuf_create_svp(out);
 }
 
+/** Unreference tuples of a zero-copy response. */
+static void
+tx_release_zcopy(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	port_destroy(&msg->port);
+}
+
 static void
 tx_process_misc(struct cmsg *m)
 {
@@ -1009,9 +1253,27 @@ net_send_msg(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
 	struct iobuf *iobuf = msg->iobuf;
+	iobuf->out.wend = msg->write_end;
+	if (msg->zcopy && evio_has_fd(&con->output)) {
+		/*
+		 * The request is discarded when the tuples
+		 * are written, see iproto_flush_zcopy().
+		 */
+		rlist_add_tail_entry(&con->zcopy_queue, msg, in_zcopy);
+		if (! ev_is_active(&con->output))
+			ev_feed_event(con->loop, &con->output, EV_WRITE);
+		return;
+	}
 	/* Discard request (see iproto_enqueue_batch()) */
 	iobuf->in.rpos += msg->len;
-	iobuf->out.wend = msg->write_end;
+	if (msg->zcopy) {
+		/*
+		 * The connection is closed. Release the message
+		 * before the disconnect is queued.
+		 */
+		iproto_zcopy_release(msg);
+		msg = NULL;
+	}
 
 	if (evio_has_fd(&con->output)) {
 		if (! ev_is_active(&con->output))
@@ -1019,7 +1281,8 @@ net_send_msg(struct cmsg *m)
 	} else if (iproto_connection_is_idle(con)) {
 		iproto_connection_close(con);
 	}
-	iproto_msg_delete(msg);
+	if (msg != NULL)
+		iproto_msg_delete(msg);
 }
 
 static void
@@ -1089,7 +1352,7 @@ net_send_greeting(struct cmsg *m)
 						 obuf_iovcnt(out));
 
 			/* Count statistics */
-			rmean_collect(rmean_net, IPROTO_SENT, nwr);
+			rmean_collect(con->thread->rmean, IPROTO_SENT, nwr);
 		} catch (Exception *e) {
 			e->log();
 		}
@@ -1110,37 +1373,78 @@ net_send_greeting(struct cmsg *m)
 	iproto_msg_delete(msg);
 }
 
-static const struct cmsg_hop connect_route[] = {
-	{ tx_process_connect, &net_pipe },
-	{ net_send_greeting, NULL },
-};
-
 /** }}} */
 
 /**
- * Create a connection and start input.
+ * Create a connection in the current network thread and
+ * start the handshake.
  */
 static void
-iproto_on_accept(struct evio_service * /* service */, int fd,
-		 struct sockaddr *addr, socklen_t addrlen)
+iproto_connection_start(struct iproto_thread *thread, int fd)
 {
-	char name[SERVICE_NAME_MAXLEN];
-	snprintf(name, sizeof(name), "%s/%s", "iobuf",
-		sio_strfaddr(addr, addrlen));
-
-	struct iproto_connection *con;
-
-	con = iproto_connection_new(name, fd);
+	struct iproto_connection *con = iproto_connection_new(thread, fd);
 	/*
 	 * Ignore msg allocation failure - the queue size is
 	 * fixed so there is a limited number of msgs in
 	 * use, all stored in just a few blocks of the memory pool.
 	 */
 	struct iproto_msg *msg = iproto_msg_new(con);
-	cmsg_init(msg, connect_route);
+	cmsg_init(msg, thread->connect_route);
 	msg->iobuf = con->iobuf[0];
 	msg->close_connection = false;
-	cpipe_push(&tx_pipe, msg);
+	cpipe_push(&thread->tx_pipe, msg);
+}
+
+/** A connection handed over by the acceptor thread. */
+struct iproto_accept_msg: public cmsg
+{
+	struct iproto_thread *thread;
+	int fd;
+};
+
+static void
+net_accept_f(struct cmsg *m)
+{
+	struct iproto_accept_msg *msg = (struct iproto_accept_msg *) m;
+	struct iproto_thread *thread = msg->thread;
+	int fd = msg->fd;
+	free(msg);
+	try {
+		iproto_connection_start(thread, fd);
+	} catch (Exception *e) {
+		close(fd);
+		e->log();
+	}
+}
+
+static const struct cmsg_hop accept_route[] = {
+	{ net_accept_f, NULL },
+};
+
+/**
+ * Accept a connection and pass it to the next network
+ * thread in round-robin order.
+ */
+static void
+iproto_on_accept(struct evio_service * /* service */, int fd,
+		 struct sockaddr * /* addr */, socklen_t /* addrlen */)
+{
+	struct iproto_thread *thread = &iproto_threads[iproto_next_thread];
+	iproto_next_thread = (iproto_next_thread + 1) % iproto_thread_count;
+	if (thread->id != 0) {
+		struct iproto_accept_msg *msg = (struct iproto_accept_msg *)
+			malloc(sizeof(*msg));
+		if (msg != NULL) {
+			cmsg_init(msg, accept_route);
+			msg->thread = thread;
+			msg->fd = fd;
+			cpipe_push(&thread->accept_pipe, msg);
+			return;
+		}
+		/* Serve the connection in this thread then. */
+		thread = &iproto_threads[0];
+	}
+	iproto_connection_start(thread, fd);
 }
 
 static struct evio_service binary; /* iproto binary listener */
@@ -1150,64 +1454,127 @@ static struct evio_service binary; /* iproto binary listener */
  * begin serving the message bus.
  */
 static int
-net_cord_f(va_list /* ap */)
+net_cord_f(va_list ap)
 {
+	struct iproto_thread *thread = va_arg(ap, struct iproto_thread *);
 	/* Got to be called in every thread using iobuf */
 	iobuf_init();
-	mempool_create(&iproto_msg_pool, &cord()->slabc,
+	mempool_create(&thread->msg_pool, &cord()->slabc,
 		       sizeof(struct iproto_msg));
-	mempool_create(&iproto_connection_pool, &cord()->slabc,
+	mempool_create(&thread->connection_pool, &cord()->slabc,
 		       sizeof(struct iproto_connection));
+	rlist_create(&thread->stopped_connections);
 
-	evio_service_init(loop(), &binary, "binary",
-			  iproto_on_accept, NULL);
-
+	if (thread->id == 0) {
+		evio_service_init(loop(), &binary, "binary",
+				  iproto_on_accept, NULL);
+	}
 
 	/* Init statistics counter */
-	rmean_net = rmean_new(rmean_net_strings, IPROTO_LAST);
+	thread->rmean = rmean_new(rmean_net_strings, IPROTO_LAST);
 
-	if (rmean_net == NULL) {
+	if (thread->rmean == NULL) {
 		tnt_raise(OutOfMemory, sizeof(struct rmean),
 			  "rmean", "struct rmean");
 	}
 
 	struct cbus_endpoint endpoint;
-	/* Create "net" endpoint. */
-	cbus_endpoint_create(&endpoint, "net", fiber_schedule_cb, fiber());
+	/* Create the thread endpoint, "net" for the first thread. */
+	cbus_endpoint_create(&endpoint, thread->endpoint_name,
+			     fiber_schedule_cb, fiber());
 	/* Create a pipe to "tx" thread. */
-	cpipe_create(&tx_pipe, "tx");
-	cpipe_set_max_input(&tx_pipe, IPROTO_MSG_MAX/2);
+	cpipe_create(&thread->tx_pipe, "tx");
+	cpipe_set_max_input(&thread->tx_pipe, thread->msg_max / 2);
+	if (thread->id == 0) {
+		/* Create pipes to pass connections to other threads. */
+		for (int i = 1; i < iproto_thread_count; i++) {
+			struct iproto_thread *other = &iproto_threads[i];
+			cpipe_create(&other->accept_pipe,
+				     other->endpoint_name);
+		}
+	}
 	/* Process incomming messages. */
 	cbus_loop(&endpoint);
 
-	cpipe_destroy(&tx_pipe);
+	if (thread->id == 0) {
+		for (int i = 1; i < iproto_thread_count; i++)
+			cpipe_destroy(&iproto_threads[i].accept_pipe);
+	}
+	cpipe_destroy(&thread->tx_pipe);
 	/*
 	 * Nothing to do in the fiber so far, the service
 	 * will take care of creating events for incoming
 	 * connections.
 	 */
-	if (evio_service_is_active(&binary))
+	if (thread->id == 0 && evio_service_is_active(&binary))
 		evio_service_stop(&binary);
 
-	rmean_delete(rmean_net);
+	rmean_delete(thread->rmean);
 	return 0;
 }
 
-/** Initialize the iproto subsystem and start network io thread */
 void
-iproto_init()
+iproto_init(int thread_count)
 {
+	assert(thread_count > 0);
 	tx_cord = cord();
 
-	static struct cord net_cord;
-	if (cord_costart(&net_cord, "iproto", net_cord_f, NULL))
-		panic("failed to initialize iproto thread");
-
-	/* Create a pipe to "net" thread. */
-	cpipe_create(&net_pipe, "net");
-	cpipe_set_max_input(&net_pipe, IPROTO_MSG_MAX/2);
+	iproto_threads = (struct iproto_thread *)
+		calloc(thread_count, sizeof(*iproto_threads));
+	if (iproto_threads == NULL)
+		panic("failed to allocate iproto threads");
+	iproto_thread_count = thread_count;
+	for (int i = 0; i < thread_count; i++) {
+		struct iproto_thread *thread = &iproto_threads[i];
+		thread->id = i;
+		/*
+		 * Share the limit on requests in flight among
+		 * threads, it protects the tx fiber pool.
+		 */
+		thread->msg_max = MAX(IPROTO_MSG_MAX / thread_count, 2);
+		if (i == 0) {
+			snprintf(thread->endpoint_name,
+				 sizeof(thread->endpoint_name), "net");
+		} else {
+			snprintf(thread->endpoint_name,
+				 sizeof(thread->endpoint_name), "net%d", i);
+		}
+		iproto_thread_init_routes(thread);
+	}
+	for (int i = 0; i < thread_count; i++) {
+		struct iproto_thread *thread = &iproto_threads[i];
+		char name[FIBER_NAME_MAX];
+		if (i == 0)
+			snprintf(name, sizeof(name), "iproto");
+		else
+			snprintf(name, sizeof(name), "iproto%d", i);
+		if (cord_costart(&thread->cord, name, net_cord_f, thread))
+			panic("failed to initialize iproto thread");
+
+		/* Create a pipe to "net" thread. */
+		cpipe_create(&thread->net_pipe, thread->endpoint_name);
+		cpipe_set_max_input(&thread->net_pipe, thread->msg_max / 2);
+	}
 }
 
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx)
+{
+	for (size_t name = 0; name < IPROTO_LAST; name++) {
+		int64_t mean = 0, total = 0;
+		for (int i = 0; i < iproto_thread_count; i++) {
+			struct rmean *rmean = iproto_threads[i].rmean;
+			if (rmean == NULL)
+				continue;
+			mean += rmean_mean(rmean, name);
+			total += rmean_total(rmean, name);
+		}
+		int rc = cb(rmean_net_strings[name], mean, total, cb_ctx);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
 /**
  * Since there is no way to "synchronously" change the
  * state of the io thread, to change the listen port
@@ -1252,7 +1619,8 @@ iproto_bind(const char *uri)
 {
 	static struct iproto_bind_msg m;
 	m.uri = uri;
-	if (cbus_call(&net_pipe, &tx_pipe, &m, iproto_do_bind,
+	struct iproto_thread *thread = &iproto_threads[0];
+	if (cbus_call(&thread->net_pipe, &thread->tx_pipe, &m, iproto_do_bind,
 		      NULL, TIMEOUT_INFINITY))
 		diag_raise();
 }
@@ -1262,7 +1630,8 @@ iproto_listen()
 {
 	/* Declare static to avoid stack corruption on fiber cancel. */
 	static struct cbus_call_msg m;
-	if (cbus_call(&net_pipe, &tx_pipe, &m, iproto_do_listen,
+	struct iproto_thread *thread = &iproto_threads[0];
+	if (cbus_call(&thread->net_pipe, &thread->tx_pipe, &m, iproto_do_listen,
 		      NULL, TIMEOUT_INFINITY))
 		diag_raise();
 }
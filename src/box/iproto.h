@@ -30,8 +30,37 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include "rmean.h"
+
+enum {
+	/**
+	 * The max number of network threads, box.cfg.net_threads.
+	 * The limit on requests in flight is shared among threads,
+	 * so more threads would starve each of messages.
+	 */
+	IPROTO_THREADS_MAX = 64,
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Iterate over network statistics (iproto & cbus), summed
+ * up over all network threads. @sa rmean_foreach().
+ */
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+
+/**
+ * Initialize the iproto subsystem and start @a thread_count
+ * network threads.
+ */
 void
-iproto_init();
+iproto_init(int thread_count);
 
 void
 iproto_bind(const char *uri);
@@ -39,4 +68,6 @@ iproto_bind(const char *uri);
 void
 iproto_listen();
 
+#endif /* defined(__cplusplus) */
+
 #endif
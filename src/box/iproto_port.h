@@ -49,6 +49,15 @@ iproto_prepare_select(struct obuf *buf, struct obuf_svp *svp);
 void
 iproto_reply_select(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
 		    uint32_t count);
+
+/**
+ * Write select header to a preallocated buffer, for a body
+ * which tuples are not in the buffer: @a data_len bytes of
+ * them are sent after it by other means.
+ */
+void
+iproto_reply_select_len(struct obuf *buf, struct obuf_svp *svp,
+			uint64_t sync, uint32_t count, uint32_t data_len);
 #if defined(__cplusplus)
 } /*  extern "C" */
 
@@ -83,10 +83,12 @@ const char *mp_type_strs[] = {
 	/* .MP_EXT    = */ "extension",
 };
 
-const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
+const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE", "FHASH" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *compaction_type_strs[] = { "tiered", "leveled", "time_window" };
+
 const char *func_language_strs[] = {"LUA", "C"};
 
 const uint32_t key_mp_type[] = {
@@ -119,6 +121,11 @@ const struct key_opts key_opts_default = {
 	/* .page_size           = */ 0,
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
+	/* .compactionbuf       = */ { '\0' },
+	/* .compaction          = */ COMPACTION_TIERED,
+	/* .compaction_window   = */ 86400,
+	/* .prefix_bloom        = */ false,
+	/* .zstd_dict           = */ false,
 	/* .lsn                 = */ 0,
 };
 
@@ -131,6 +138,10 @@ const struct opt_def key_opts_reg[] = {
 	OPT_DEF("page_size", OPT_INT, struct key_opts, page_size),
 	OPT_DEF("run_count_per_level", OPT_INT, struct key_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct key_opts, run_size_ratio),
+	OPT_DEF("compaction", OPT_STR, struct key_opts, compactionbuf),
+	OPT_DEF("compaction_window", OPT_INT, struct key_opts, compaction_window),
+	OPT_DEF("prefix_bloom", OPT_BOOL, struct key_opts, prefix_bloom),
+	OPT_DEF("zstd_dict", OPT_BOOL, struct key_opts, zstd_dict),
 	OPT_DEF("lsn", OPT_INT, struct key_opts, lsn),
 	{ NULL, opt_type_MAX, 0, 0 },
 };
@@ -402,10 +413,16 @@ key_validate_parts(struct index_def *index_def, const char *key,
 
 const struct space_opts space_opts_default = {
 	/* .temporary = */ false,
+	/* .defer_deletes = */ false,
+	/* .compression = */ false,
+	/* .fixed_layout = */ false,
 };
 
 const struct opt_def space_opts_reg[] = {
 	OPT_DEF("temporary", OPT_BOOL, struct space_opts, temporary),
+	OPT_DEF("defer_deletes", OPT_BOOL, struct space_opts, defer_deletes),
+	OPT_DEF("compression", OPT_BOOL, struct space_opts, compression),
+	OPT_DEF("fixed_layout", OPT_BOOL, struct space_opts, fixed_layout),
 	{ NULL, opt_type_MAX, 0, 0 }
 };
 
@@ -438,6 +455,16 @@ space_def_check(struct space_def *def, uint32_t namelen, uint32_t engine_namelen
 				  def->name,
 			         "space does not support temporary flag");
 	}
+	if (def->opts.compression && strcmp(def->engine_name, "memtx") != 0) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  def->name,
+			  "space does not support compression");
+	}
+	if (def->opts.fixed_layout && strcmp(def->engine_name, "memtx") != 0) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  def->name,
+			  "space does not support fixed layout");
+	}
 }
 
 bool
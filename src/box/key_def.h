@@ -128,6 +128,7 @@ enum index_type {
 	TREE,     /* TREE Index */
 	BITSET,   /* BITSET Index */
 	RTREE,    /* R-Tree Index */
+	FHASH,    /* HASH Index with chunked open addressing */
 	index_type_MAX,
 };
 
@@ -162,6 +163,18 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Vinyl compaction strategy, see vy_range_update_compact_priority(). */
+enum compaction_type {
+	/* Several runs per level: low write amplification */
+	COMPACTION_TIERED,
+	/* One run per level: low read amplification */
+	COMPACTION_LEVELED,
+	/* Runs written in different time windows are never merged */
+	COMPACTION_TIME_WINDOW,
+	compaction_type_MAX
+};
+extern const char *compaction_type_strs[];
+
 /** Descriptor of a single part in a multipart key. */
 struct key_part {
 	uint32_t fieldno;
@@ -201,6 +214,27 @@ struct key_opts {
 	 * previous one.
 	 */
 	double run_size_ratio;
+	/**
+	 * Vinyl compaction strategy.
+	 */
+	char compactionbuf[16];
+	enum compaction_type compaction;
+	/**
+	 * Length of a time window, in seconds, for the time
+	 * window compaction strategy.
+	 */
+	int64_t compaction_window;
+	/**
+	 * If set, vinyl runs store a bloom filter for each
+	 * prefix of the key, so that lookups by a partial key
+	 * can skip runs too.
+	 */
+	bool prefix_bloom;
+	/**
+	 * If set, vinyl trains a zstd dictionary on pages of
+	 * written runs and compresses new runs with it.
+	 */
+	bool zstd_dict;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -358,6 +392,27 @@ struct space_opts {
 	 * - changes are not part of a snapshot
 	 */
 	bool temporary;
+	/**
+	 * Vinyl only: DELETE by the primary key doesn't look up
+	 * the old tuple to delete it from secondary indexes.
+	 * Stale secondary index entries are filtered out on read
+	 * by checking the primary index. Applies only if all
+	 * secondary indexes are non-unique and the space has
+	 * no on_replace triggers.
+	 */
+	bool defer_deletes;
+	/**
+	 * Memtx only: tuple fields following the last indexed
+	 * field are compressed with zstd if the tuple is large
+	 * enough. Indexed fields are stored as is.
+	 */
+	bool compression;
+	/**
+	 * Memtx only: tuples store a native copy of each indexed
+	 * unsigned, integer and number field at a constant offset,
+	 * so that comparators don't decode MessagePack.
+	 */
+	bool fixed_layout;
 };
 
 extern const struct space_opts space_opts_default;
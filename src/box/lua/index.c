@@ -224,6 +224,30 @@ lbox_index_count(lua_State *L)
 	return 1;
 }
 
+static int
+lbox_index_count_approximate(lua_State *L)
+{
+	if (lua_gettop(L) != 4 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    !lua_isnumber(L, 3)) {
+		return luaL_error(L, "usage index.count_approximate(space_id, "
+		       "index_id, iterator, key)");
+	}
+
+	uint32_t space_id = lua_tointeger(L, 1);
+	uint32_t index_id = lua_tointeger(L, 2);
+	uint32_t iterator = lua_tointeger(L, 3);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 4, &key_len);
+
+	ssize_t count = box_index_count_approximate(space_id, index_id,
+						    iterator, key,
+						    key + key_len);
+	if (count == -1)
+		return luaT_error(L);
+	lua_pushinteger(L, count);
+	return 1;
+}
+
 static void
 box_index_init_iterator_types(struct lua_State *L, int idx)
 {
@@ -324,6 +348,7 @@ box_lua_index_init(struct lua_State *L)
 		{"min", lbox_index_min},
 		{"max", lbox_index_max},
 		{"count", lbox_index_count},
+		{"count_approximate", lbox_index_count_approximate},
 		{"iterator", lbox_index_iterator},
 		{"iterator_next", lbox_iterator_next},
 		{"truncate", lbox_truncate},
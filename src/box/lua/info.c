@@ -41,6 +41,7 @@
 #include <lualib.h>
 
 #include "box/applier.h"
+#include "box/relay.h"
 #include "box/wal.h"
 #include "box/replication.h"
 #include "main.h"
@@ -64,6 +65,34 @@ lbox_pushvclock(struct lua_State *L, struct vclock *vclock)
 	luaL_setmaphint(L, -1); /* compact flow */
 }
 
+static void
+lbox_pushrelay(lua_State *L, struct relay *relay)
+{
+	struct relay_stat *stat = &relay->stat;
+
+	lua_createtable(L, 0, 5);
+
+	lua_pushstring(L, "rows");
+	luaL_pushuint64(L, stat->rows);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "bytes");
+	luaL_pushuint64(L, stat->bytes_sent);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "bytes_saved");
+	luaL_pushint64(L, (int64_t) stat->bytes - stat->bytes_sent);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "throughput");
+	lua_pushnumber(L, stat->throughput);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "compression");
+	lua_pushinteger(L, relay->compression);
+	lua_settable(L, -3);
+}
+
 static void
 lbox_pushreplica(lua_State *L, struct replica *replica)
 {
@@ -75,6 +104,16 @@ lbox_pushreplica(lua_State *L, struct replica *replica)
 	lua_pushstring(L, tt_uuid_str(&replica->uuid));
 	lua_settable(L, -3);
 
+	/* Relay to the replica, if it is subscribed */
+	if (replica->relay != NULL) {
+		lua_pushstring(L, "relay");
+		lbox_pushrelay(L, replica->relay);
+		lua_settable(L, -3);
+	}
+
+	if (applier == NULL)
+		return;
+
 	/* Get applier state in lower case */
 	static char status[16];
 	char *d = status;
@@ -117,7 +156,8 @@ lbox_info_replication(struct lua_State *L)
 
 	replicaset_foreach(replica) {
 		/* Applier hasn't received replica id yet */
-		if (replica->id == REPLICA_ID_NIL || replica->applier == NULL)
+		if (replica->id == REPLICA_ID_NIL ||
+		    (replica->applier == NULL && replica->relay == NULL))
 			continue;
 
 		lbox_pushreplica(L, replica);
@@ -20,6 +20,9 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 128 * 1024 * 1024,
+    vinyl_read_ahead    = 4,
+    vinyl_direct_io     = false,
     vinyl_threads       = 2,
     vinyl_run_count_per_level = 2,
     vinyl_run_size_ratio      = 3.5,
@@ -31,14 +34,18 @@ local default_cfg = {
     log_level           = 5,
     io_collect_interval = nil,
     readahead           = 16320,
+    net_threads         = 1,
     snap_io_rate_limit  = nil, -- no limit
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     rows_per_wal        = 500000,
     wal_max_size        = 1024 * 1024 * 1024 * 256,
+    wal_group_commit_delay = 0,
+    wal_group_commit_size = 1024 * 1024,
     wal_dir_rescan_delay= 2,
     force_recovery      = false,
     replication         = nil,
+    replication_compression = 0,
     custom_proc_title   = nil,
     pid_file            = nil,
     background          = false,
@@ -66,6 +73,9 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
+    vinyl_read_ahead          = 'number',
+    vinyl_direct_io           = 'boolean',
     vinyl_threads             = 'number',
     vinyl_run_count_per_level = 'number',
     vinyl_run_size_ratio      = 'number',
@@ -78,14 +88,18 @@ local template_cfg = {
     log_level           = 'number',
     io_collect_interval = 'number',
     readahead           = 'number',
+    net_threads         = 'number',
     snap_io_rate_limit  = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     rows_per_wal        = 'number',
     wal_max_size        = 'number',
+    wal_group_commit_delay = 'number',
+    wal_group_commit_size = 'number',
     wal_dir_rescan_delay= 'number',
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
+    replication_compression = 'number',
     custom_proc_title   = 'string',
     pid_file            = 'string',
     background          = 'boolean',
@@ -144,6 +158,8 @@ local dynamic_cfg = {
     checkpoint_count        = box.internal.snapshot_daemon.set_checkpoint_count,
     -- do nothing, affects new replicas, which query this value on start
     wal_dir_rescan_delay    = function() end,
+    -- do nothing, affects new connections to masters
+    replication_compression = function() end,
     custom_proc_title       = function()
         require('title').update(box.cfg.custom_proc_title)
     end,
@@ -155,6 +171,7 @@ local dynamic_cfg_skip_at_load = {
     listen                  = true,
     replication             = true,
     wal_dir_rescan_delay    = true,
+    replication_compression = true,
     custom_proc_title       = true,
     force_recovery          = true,
 }
@@ -241,6 +241,9 @@ box.schema.space.create = function(name, options)
         user = 'string, number',
         format = 'table',
         temporary = 'boolean',
+        defer_deletes = 'boolean',
+        compression = 'boolean',
+        fixed_layout = 'boolean',
     }
     local options_defaults = {
         engine = 'memtx',
@@ -282,6 +285,9 @@ box.schema.space.create = function(name, options)
     -- filter out global parameters from the options array
     local space_options = setmetatable({
         temporary = options.temporary and true or nil,
+        defer_deletes = options.defer_deletes and true or nil,
+        compression = options.compression and true or nil,
+        fixed_layout = options.fixed_layout and true or nil,
     }, { __serialize = 'map' })
     _space:insert{id, uid, name, options.engine, options.field_count,
         space_options, format}
@@ -394,6 +400,10 @@ box.schema.index.create = function(space_id, name, options)
         range_size = 'number',
         run_count_per_level = 'number',
         run_size_ratio = 'number',
+        compaction = 'string',
+        compaction_window = 'number',
+        prefix_bloom = 'boolean',
+        zstd_dict = 'boolean',
     }
     check_param_table(options, options_template)
     local options_defaults = {
@@ -464,6 +474,10 @@ box.schema.index.create = function(space_id, name, options)
             range_size = options.range_size,
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
+            compaction = options.compaction,
+            compaction_window = options.compaction_window,
+            prefix_bloom = options.prefix_bloom,
+            zstd_dict = options.zstd_dict,
             lsn = box.info.cluster.signature,
     }
     local field_type_aliases = {
@@ -838,9 +852,20 @@ function box.schema.space.bless(space)
             ffi.gc(cdata, builtin.box_iterator_free))
     end
 
+    -- estimate the subtree size without reading tuples
+    local function count_approximate(index, key, opts)
+        key = keify(key)
+        local itype = check_iterator_type(opts, #key == 0);
+        return internal.count_approximate(index.space_id, index.id,
+                                          itype, key);
+    end
+
     -- index subtree size
     index_mt.count_ffi = function(index, key, opts)
         check_index_arg(index, 'count')
+        if type(opts) == 'table' and opts.approximate then
+            return count_approximate(index, key, opts)
+        end
         local pkey, pkey_end = tuple_encode(key)
         local itype = check_iterator_type(opts, pkey + 1 >= pkey_end);
         local count = builtin.box_index_count(index.space_id, index.id,
@@ -852,6 +877,9 @@ function box.schema.space.bless(space)
     end
     index_mt.count_luac = function(index, key, opts)
         check_index_arg(index, 'count')
+        if type(opts) == 'table' and opts.approximate then
+            return count_approximate(index, key, opts)
+        end
         key = keify(key)
         local itype = check_iterator_type(opts, #key == 0);
         return internal.count(index.space_id, index.id, itype, key);
@@ -44,6 +44,8 @@
 
 extern struct small_alloc memtx_alloc;
 extern struct mempool memtx_index_extent_pool;
+extern uint64_t memtx_tuple_zsize;
+extern uint64_t memtx_tuple_zsize_raw;
 
 static int
 small_stats_noop_cb(const struct mempool_stats *stats, void *cb_ctx)
@@ -164,6 +166,20 @@ lbox_slab_info(struct lua_State *L)
 	lua_pushstring(L, ratio_buf);
 	lua_settable(L, -3);
 
+	/** Size of compressed tuple data, see space compression. */
+	lua_pushstring(L, "items_compressed");
+	luaL_pushuint64(L, memtx_tuple_zsize);
+	lua_settable(L, -3);
+
+	/** Compressed size of such tuples to their raw size. */
+	ratio = 100 * ((double) memtx_tuple_zsize
+		/ ((double) memtx_tuple_zsize_raw + 0.0001));
+	snprintf(ratio_buf, sizeof(ratio_buf), "%0.1lf%%", ratio);
+
+	lua_pushstring(L, "items_compressed_ratio");
+	lua_pushstring(L, ratio_buf);
+	lua_settable(L, -3);
+
 	/** How much address space has been already touched
 	 * (tuples and indexes) */
 	lua_pushstring(L, "arena_size");
@@ -165,7 +165,8 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 		lua_pushnumber(L, index_def->iid);
 		lua_newtable(L);		/* space.index[k] */
 
-		if (index_def->type == HASH || index_def->type == TREE) {
+		if (index_def->type == HASH || index_def->type == TREE ||
+		    index_def->type == FHASH) {
 			lua_pushboolean(L, index_def->opts.is_unique);
 			lua_setfield(L, -2, "unique");
 		} else if (index_def->type == RTREE) {
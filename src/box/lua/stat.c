@@ -39,12 +39,12 @@
 #include <lualib.h>
 
 #include "lua/utils.h"
+#include "box/iproto.h"
 
 extern struct rmean *rmean_box;
 extern struct rmean *rmean_error;
-/** network statistics (iproto & cbus) */
-extern struct rmean *rmean_net;
 extern struct rmean *rmean_tx_wal_bus;
+extern struct rmean *rmean_wal;
 
 static void
 fill_stat_item(struct lua_State *L, int rps, int64_t total)
@@ -113,14 +113,32 @@ static int
 lbox_stat_net_index(struct lua_State *L)
 {
 	luaL_checkstring(L, -1);
-	return rmean_foreach(rmean_net, seek_stat_item, L);
+	return iproto_rmean_foreach(seek_stat_item, L);
 }
 
 static int
 lbox_stat_net_call(struct lua_State *L)
 {
 	lua_newtable(L);
-	rmean_foreach(rmean_net, set_stat_item, L);
+	iproto_rmean_foreach(set_stat_item, L);
+	return 1;
+}
+
+static int
+lbox_stat_wal_index(struct lua_State *L)
+{
+	luaL_checkstring(L, -1);
+	if (rmean_wal == NULL)
+		return 0;
+	return rmean_foreach(rmean_wal, seek_stat_item, L);
+}
+
+static int
+lbox_stat_wal_call(struct lua_State *L)
+{
+	lua_newtable(L);
+	if (rmean_wal != NULL)
+		rmean_foreach(rmean_wal, set_stat_item, L);
 	return 1;
 }
 
@@ -136,6 +154,12 @@ static const struct luaL_reg lbox_stat_net_meta [] = {
 	{NULL, NULL}
 };
 
+static const struct luaL_reg lbox_stat_wal_meta [] = {
+	{"__index", lbox_stat_wal_index},
+	{"__call",  lbox_stat_wal_call},
+	{NULL, NULL}
+};
+
 /** Initialize box.stat package. */
 void
 box_lua_stat_init(struct lua_State *L)
@@ -158,5 +182,12 @@ box_lua_stat_init(struct lua_State *L)
 	luaL_register(L, NULL, lbox_stat_net_meta);
 	lua_setmetatable(L, -2);
 	lua_pop(L, 1); /* stat net module */
+
+	luaL_register_module(L, "box.stat.wal", statlib);
+
+	lua_newtable(L);
+	luaL_register(L, NULL, lbox_stat_wal_meta);
+	lua_setmetatable(L, -2);
+	lua_pop(L, 1); /* stat wal module */
 }
 
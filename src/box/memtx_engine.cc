@@ -32,9 +32,15 @@
 #include "memtx_space.h"
 #include "memtx_tuple.h"
 
+#include <pmatomic.h>
+#if defined(HAVE_OPENMP)
+#include <omp.h>
+#endif /* defined(HAVE_OPENMP) */
+
 #include "coeio.h"
 #include "coeio_file.h"
 #include "scoped_guard.h"
+#include "tt_pthread.h"
 
 #include "tuple.h"
 #include "txn.h"
@@ -87,35 +93,173 @@ memtx_end_build_primary_key(struct space *space, void *param)
 
 /**
  * Secondary indexes are built in bulk after all data is
- * recovered. This function enables secondary keys on a space.
- * Data dictionary spaces are an exception, they are fully
- * built right from the start.
+ * recovered. Data dictionary spaces are an exception, they are
+ * fully built right from the start.
+ *
+ * Secondary keys of all spaces are built at once, in three
+ * steps: the indexes are fed with tuples in the tx thread,
+ * then they are sorted concurrently by a pool of worker
+ * threads, and finally the index structures are built in
+ * the tx thread again, since index memory allocation is not
+ * thread-safe. Sorting is by far the most expensive step,
+ * so the build scales with the number of cores.
  */
-void
-memtx_build_secondary_keys(struct space *space, void *param)
+struct memtx_build_state {
+	MemtxEngine *engine;
+	/** Secondary indexes of all spaces being built. */
+	MemtxIndex **indexes;
+	uint32_t index_count;
+	/** Position of the next index to sort, shared by workers. */
+	uint32_t next;
+#if defined(HAVE_OPENMP)
+	/** Number of OpenMP threads a worker may use to sort. */
+	int omp_threads;
+#endif
+};
+
+/** Return true if secondary keys of the space are not built yet. */
+static bool
+memtx_space_needs_build(struct space *space, MemtxEngine *engine)
 {
 	struct MemtxSpace *handler = (struct MemtxSpace *) space->handler;
-	if (handler->engine != param || space_index(space, 0) == NULL ||
-	    handler->replace == memtx_replace_all_keys)
+	return handler->engine == engine && space_index(space, 0) != NULL &&
+	       handler->replace != memtx_replace_all_keys;
+}
+
+static void
+memtx_build_count_f(struct space *space, void *param)
+{
+	struct memtx_build_state *state = (struct memtx_build_state *) param;
+	if (memtx_space_needs_build(space, state->engine))
+		state->index_count += space->index_count - 1;
+}
+
+static void
+memtx_build_begin_f(struct space *space, void *param)
+{
+	struct memtx_build_state *state = (struct memtx_build_state *) param;
+	if (!memtx_space_needs_build(space, state->engine) ||
+	    space->index_count <= 1)
 		return;
 
-	if (space->index_id_max > 0) {
-		MemtxIndex *pk = (MemtxIndex *) space->index[0];
-		uint32_t n_tuples = pk->size();
+	MemtxIndex *pk = (MemtxIndex *) space->index[0];
+	if (pk->size() > 0) {
+		say_info("Building secondary indexes in space '%s'...",
+			 space_name(space));
+	}
+	/*
+	 * Tuples recovered before an index was created may
+	 * have the fields it indexes compressed.
+	 */
+	memtx_space_restore_tuples(space, 1, space->format);
+	for (uint32_t j = 1; j < space->index_count; j++) {
+		MemtxIndex *index = (MemtxIndex *) space->index[j];
+		index_build_begin(index, pk);
+		state->indexes[state->index_count++] = index;
+	}
+}
 
-		if (n_tuples > 0) {
-			say_info("Building secondary indexes in space '%s'...",
-				 space_name(space));
+static void *
+memtx_build_sort_f(void *arg)
+{
+	struct memtx_build_state *state = (struct memtx_build_state *) arg;
+#if defined(HAVE_OPENMP)
+	omp_set_num_threads(state->omp_threads);
+#endif
+	uint32_t i;
+	while ((i = pm_atomic_fetch_add(&state->next, 1)) < state->index_count)
+		state->indexes[i]->sortBuild();
+	return NULL;
+}
+
+static void
+memtx_build_sort(struct memtx_build_state *state)
+{
+	long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	if (ncpu < 1)
+		ncpu = 1;
+	uint32_t thread_count = state->index_count;
+	if (thread_count > ncpu)
+		thread_count = ncpu;
+#if defined(HAVE_OPENMP)
+	/* qsort_arg() is parallel itself, don't oversubscribe. */
+	state->omp_threads = MAX(ncpu / thread_count, 1);
+#endif
+	struct cord *cords = NULL;
+	if (thread_count > 1)
+		cords = (struct cord *) calloc(thread_count, sizeof(*cords));
+	uint32_t started = 0;
+	while (cords != NULL && started < thread_count) {
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "build_%u", started);
+		if (cord_start(&cords[started], name,
+			       memtx_build_sort_f, state) != 0) {
+			error_log(diag_last_error(diag_get()));
+			break;
 		}
+		started++;
+	}
+	if (started == 0) {
+		/*
+		 * Failed to start any worker: endBuild()
+		 * will sort the indexes in the tx thread.
+		 */
+		free(cords);
+		return;
+	}
+	int rc = 0;
+	for (uint32_t i = 0; i < started; i++) {
+		if (cord_cojoin(&cords[i]) != 0)
+			rc = -1;
+	}
+	free(cords);
+	if (rc != 0)
+		diag_raise();
+}
+
+static void
+memtx_build_end_f(struct space *space, void *param)
+{
+	struct memtx_build_state *state = (struct memtx_build_state *) param;
+	if (!memtx_space_needs_build(space, state->engine))
+		return;
+
+	MemtxIndex *pk = (MemtxIndex *) space->index[0];
+	for (uint32_t j = 1; j < space->index_count; j++)
+		((MemtxIndex *) space->index[j])->endBuild();
 
-		for (uint32_t j = 1; j < space->index_count; j++)
-			index_build((MemtxIndex *) space->index[j], pk);
+	if (space->index_count > 1 && pk->size() > 0)
+		say_info("Space '%s': done", space_name(space));
 
-		if (n_tuples > 0) {
-			say_info("Space '%s': done", space_name(space));
+	struct MemtxSpace *handler = (struct MemtxSpace *) space->handler;
+	handler->replace = memtx_replace_all_keys;
+}
+
+/** Enable secondary keys on all spaces of the engine. */
+static void
+memtx_build_secondary_keys(MemtxEngine *engine)
+{
+	struct memtx_build_state state;
+	memset(&state, 0, sizeof(state));
+	state.engine = engine;
+	space_foreach(memtx_build_count_f, &state);
+	if (state.index_count > 0) {
+		state.indexes = (MemtxIndex **)
+			malloc(state.index_count * sizeof(*state.indexes));
+		if (state.indexes == NULL) {
+			tnt_raise(OutOfMemory, state.index_count *
+				  sizeof(*state.indexes), "malloc",
+				  "memtx_build_state");
 		}
 	}
-	handler->replace = memtx_replace_all_keys;
+	auto indexes_guard = make_scoped_guard([&]{
+		free(state.indexes);
+	});
+	state.index_count = 0;
+	space_foreach(memtx_build_begin_f, &state);
+	if (state.index_count > 0)
+		memtx_build_sort(&state);
+	space_foreach(memtx_build_end_f, &state);
 }
 
 MemtxEngine::MemtxEngine(const char *snap_dirname, bool force_recovery,
@@ -149,6 +293,276 @@ MemtxEngine::lastCheckpoint(struct vclock *vclock)
 	return xdir_last_vclock(&m_snap_dir, vclock);
 }
 
+enum {
+	/** Max number of rows in a snapshot reader batch. */
+	SNAPSHOT_BATCH_ROWS_MAX = 1024,
+	/** Default size of row data of a snapshot reader batch. */
+	SNAPSHOT_BATCH_SIZE = 512 * 1024,
+	/** Max number of batches read ahead by the reader. */
+	SNAPSHOT_READ_AHEAD_MAX = 16,
+};
+
+/** A batch of decoded snapshot rows. */
+struct snapshot_batch {
+	/** Link in snapshot_reader::batches. */
+	struct stailq_entry in_reader;
+	struct xrow_header rows[SNAPSHOT_BATCH_ROWS_MAX];
+	int row_count;
+	/** Row bodies, referenced by rows. */
+	char *data;
+	size_t size;
+	size_t capacity;
+};
+
+/**
+ * Snapshot reader. Reads, decompresses and decodes the
+ * snapshot file in a separate thread, so that the tx thread
+ * is busy only with building tuples and indexes.
+ */
+struct snapshot_reader {
+	const char *filename;
+	bool force_recovery;
+	struct cord cord;
+	pthread_mutex_t mutex;
+	/** Signalled when there is a batch or the reader is done. */
+	pthread_cond_t cond;
+	/** Signalled when a batch is consumed or on stop. */
+	pthread_cond_t consumed_cond;
+	/** Batches read but not consumed yet. */
+	struct stailq batches;
+	int batch_count;
+	/** Set when the file is opened and meta is read. */
+	bool is_opened;
+	/** Set when the reader has no more batches. */
+	bool is_done;
+	/** Set by the tx thread to abort reading. */
+	bool is_stopped;
+	/** Set if the EOF marker has been found. */
+	bool is_eof;
+	struct tt_uuid instance_uuid;
+	/** The reader error, if any. */
+	struct diag diag;
+};
+
+static void
+snapshot_batch_delete(struct snapshot_batch *batch)
+{
+	free(batch->data);
+	free(batch);
+}
+
+static size_t
+snapshot_row_size(const struct xrow_header *row)
+{
+	size_t size = 0;
+	for (int i = 0; i < row->bodycnt; i++)
+		size += row->body[i].iov_len;
+	return size;
+}
+
+static struct snapshot_batch *
+snapshot_batch_new(size_t size)
+{
+	struct snapshot_batch *batch =
+		(struct snapshot_batch *) malloc(sizeof(*batch));
+	if (batch == NULL) {
+		diag_set(OutOfMemory, sizeof(*batch), "malloc",
+			 "snapshot batch");
+		return NULL;
+	}
+	batch->row_count = 0;
+	batch->size = 0;
+	batch->capacity = MAX(size, (size_t) SNAPSHOT_BATCH_SIZE);
+	batch->data = (char *) malloc(batch->capacity);
+	if (batch->data == NULL) {
+		diag_set(OutOfMemory, batch->capacity, "malloc",
+			 "snapshot batch");
+		free(batch);
+		return NULL;
+	}
+	return batch;
+}
+
+static bool
+snapshot_batch_fits(struct snapshot_batch *batch,
+		    const struct xrow_header *row)
+{
+	return batch->row_count < SNAPSHOT_BATCH_ROWS_MAX &&
+	       batch->size + snapshot_row_size(row) <= batch->capacity;
+}
+
+/**
+ * Copy a row to the batch. The row body points to the cursor
+ * buffer, which is reused by the next read.
+ */
+static void
+snapshot_batch_add(struct snapshot_batch *batch,
+		   const struct xrow_header *row)
+{
+	assert(snapshot_batch_fits(batch, row));
+	struct xrow_header *copy = &batch->rows[batch->row_count++];
+	*copy = *row;
+	for (int i = 0; i < row->bodycnt; i++) {
+		char *body = batch->data + batch->size;
+		memcpy(body, row->body[i].iov_base, row->body[i].iov_len);
+		copy->body[i].iov_base = body;
+		batch->size += row->body[i].iov_len;
+	}
+}
+
+/**
+ * Hand a batch over to the tx thread, waiting if it lags
+ * behind too much.
+ * @retval 0 success
+ * @retval -1 the reader is stopped
+ */
+static int
+snapshot_reader_push(struct snapshot_reader *reader,
+		     struct snapshot_batch *batch)
+{
+	tt_pthread_mutex_lock(&reader->mutex);
+	while (reader->batch_count >= SNAPSHOT_READ_AHEAD_MAX &&
+	       !reader->is_stopped)
+		tt_pthread_cond_wait(&reader->consumed_cond, &reader->mutex);
+	bool is_stopped = reader->is_stopped;
+	if (!is_stopped) {
+		stailq_add_tail_entry(&reader->batches, batch, in_reader);
+		reader->batch_count++;
+		tt_pthread_cond_signal(&reader->cond);
+	}
+	tt_pthread_mutex_unlock(&reader->mutex);
+	if (is_stopped) {
+		snapshot_batch_delete(batch);
+		return -1;
+	}
+	return 0;
+}
+
+static void *
+snapshot_reader_f(void *arg)
+{
+	struct snapshot_reader *reader = (struct snapshot_reader *) arg;
+	struct xlog_cursor cursor;
+	int rc = xlog_cursor_open(&cursor, reader->filename);
+
+	tt_pthread_mutex_lock(&reader->mutex);
+	if (rc == 0) {
+		reader->instance_uuid = cursor.meta.instance_uuid;
+	} else {
+		diag_move(diag_get(), &reader->diag);
+		reader->is_done = true;
+	}
+	reader->is_opened = true;
+	tt_pthread_cond_signal(&reader->cond);
+	tt_pthread_mutex_unlock(&reader->mutex);
+	if (rc != 0)
+		return NULL;
+
+	struct snapshot_batch *batch = NULL;
+	struct xrow_header row;
+	while ((rc = xlog_cursor_next(&cursor, &row,
+				      reader->force_recovery)) == 0) {
+		if (batch != NULL && !snapshot_batch_fits(batch, &row)) {
+			rc = snapshot_reader_push(reader, batch);
+			batch = NULL;
+			if (rc != 0)
+				break;
+		}
+		if (batch == NULL) {
+			batch = snapshot_batch_new(snapshot_row_size(&row));
+			if (batch == NULL) {
+				rc = -1;
+				break;
+			}
+		}
+		snapshot_batch_add(batch, &row);
+	}
+	if (rc > 0 && batch != NULL) {
+		/* End of file, hand over the last batch. */
+		snapshot_reader_push(reader, batch);
+	} else if (batch != NULL) {
+		snapshot_batch_delete(batch);
+	}
+
+	tt_pthread_mutex_lock(&reader->mutex);
+	if (rc < 0)
+		diag_move(diag_get(), &reader->diag);
+	reader->is_eof = cursor.state == XLOG_CURSOR_EOF;
+	reader->is_done = true;
+	tt_pthread_cond_signal(&reader->cond);
+	tt_pthread_mutex_unlock(&reader->mutex);
+	xlog_cursor_close(&cursor, false);
+	return NULL;
+}
+
+static void
+snapshot_reader_create(struct snapshot_reader *reader, const char *filename,
+		       bool force_recovery)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->filename = filename;
+	reader->force_recovery = force_recovery;
+	tt_pthread_mutex_init(&reader->mutex, NULL);
+	tt_pthread_cond_init(&reader->cond, NULL);
+	tt_pthread_cond_init(&reader->consumed_cond, NULL);
+	stailq_create(&reader->batches);
+	diag_create(&reader->diag);
+}
+
+static void
+snapshot_reader_destroy(struct snapshot_reader *reader)
+{
+	struct snapshot_batch *batch, *next;
+	stailq_foreach_entry_safe(batch, next, &reader->batches, in_reader)
+		snapshot_batch_delete(batch);
+	diag_destroy(&reader->diag);
+	tt_pthread_cond_destroy(&reader->consumed_cond);
+	tt_pthread_cond_destroy(&reader->cond);
+	tt_pthread_mutex_destroy(&reader->mutex);
+}
+
+/** Abort reading and wait for the reader thread to exit. */
+static void
+snapshot_reader_stop(struct snapshot_reader *reader)
+{
+	tt_pthread_mutex_lock(&reader->mutex);
+	reader->is_stopped = true;
+	tt_pthread_cond_signal(&reader->consumed_cond);
+	tt_pthread_mutex_unlock(&reader->mutex);
+	cord_join(&reader->cord);
+}
+
+/** Wait until the reader has opened the file. */
+static void
+snapshot_reader_open(struct snapshot_reader *reader)
+{
+	tt_pthread_mutex_lock(&reader->mutex);
+	while (!reader->is_opened)
+		tt_pthread_cond_wait(&reader->cond, &reader->mutex);
+	tt_pthread_mutex_unlock(&reader->mutex);
+}
+
+/**
+ * Get the next batch of rows.
+ * @retval NULL no more rows, check reader->diag for errors
+ */
+static struct snapshot_batch *
+snapshot_reader_next(struct snapshot_reader *reader)
+{
+	struct snapshot_batch *batch = NULL;
+	tt_pthread_mutex_lock(&reader->mutex);
+	while (stailq_empty(&reader->batches) && !reader->is_done)
+		tt_pthread_cond_wait(&reader->cond, &reader->mutex);
+	if (!stailq_empty(&reader->batches)) {
+		batch = stailq_shift_entry(&reader->batches,
+					   struct snapshot_batch, in_reader);
+		reader->batch_count--;
+		tt_pthread_cond_signal(&reader->consumed_cond);
+	}
+	tt_pthread_mutex_unlock(&reader->mutex);
+	return batch;
+}
+
 void
 MemtxEngine::recoverSnapshot()
 {
@@ -163,29 +577,48 @@ MemtxEngine::recoverSnapshot()
 						    NONE);
 
 	say_info("recovering from `%s'", filename);
-	struct xlog_cursor cursor;
-	xlog_cursor_open_xc(&cursor, filename);
-	INSTANCE_UUID = cursor.meta.instance_uuid;
+	struct snapshot_reader reader;
+	snapshot_reader_create(&reader, filename, m_snap_dir.force_recovery);
+	if (cord_start(&reader.cord, "snap_reader", snapshot_reader_f,
+		       &reader) != 0) {
+		snapshot_reader_destroy(&reader);
+		diag_raise();
+	}
 	auto reader_guard = make_scoped_guard([&]{
-		xlog_cursor_close(&cursor, false);
+		snapshot_reader_stop(&reader);
+		snapshot_reader_destroy(&reader);
 	});
+	snapshot_reader_open(&reader);
+	if (!diag_is_empty(&reader.diag)) {
+		diag_move(&reader.diag, diag_get());
+		diag_raise();
+	}
+	INSTANCE_UUID = reader.instance_uuid;
 
-	struct xrow_header row;
+	struct snapshot_batch *batch;
 	uint64_t row_count = 0;
-	while (xlog_cursor_next_xc(&cursor, &row,
-				   m_snap_dir.force_recovery) == 0) {
-		try {
-			recoverSnapshotRow(&row);
-		} catch (ClientError *e) {
-			if (!m_snap_dir.force_recovery)
-				throw;
-			say_error("can't apply row: ");
-			e->log();
+	while ((batch = snapshot_reader_next(&reader)) != NULL) {
+		auto batch_guard = make_scoped_guard([=]{
+			snapshot_batch_delete(batch);
+		});
+		for (int i = 0; i < batch->row_count; i++) {
+			try {
+				recoverSnapshotRow(&batch->rows[i]);
+			} catch (ClientError *e) {
+				if (!m_snap_dir.force_recovery)
+					throw;
+				say_error("can't apply row: ");
+				e->log();
+			}
+			++row_count;
+			if (row_count % 100000 == 0)
+				say_info("%.1fM rows processed",
+					 row_count / 1000000.);
 		}
-		++row_count;
-		if (row_count % 100000 == 0)
-			say_info("%.1fM rows processed",
-				 row_count / 1000000.);
+	}
+	if (!diag_is_empty(&reader.diag)) {
+		diag_move(&reader.diag, diag_get());
+		diag_raise();
 	}
 
 	/**
@@ -193,7 +626,7 @@ MemtxEngine::recoverSnapshot()
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (cursor.state != XLOG_CURSOR_EOF)
+	if (!reader.is_eof)
 		panic("snapshot `%s' has no EOF marker", filename);
 
 }
@@ -268,7 +701,7 @@ MemtxEngine::beginFinalRecovery()
 		 * unique keys.
 		 */
 		m_state = MEMTX_OK;
-		space_foreach(memtx_build_secondary_keys, this);
+		memtx_build_secondary_keys(this);
 	}
 }
 
@@ -284,7 +717,7 @@ MemtxEngine::endRecovery()
 	if (m_state != MEMTX_OK) {
 		assert(m_state == MEMTX_FINAL_RECOVERY);
 		m_state = MEMTX_OK;
-		space_foreach(memtx_build_secondary_keys, this);
+		memtx_build_secondary_keys(this);
 	}
 }
 
@@ -363,6 +796,12 @@ MemtxEngine::buildSecondaryKey(struct space *old_space,
 			return;
 	}
 	Index *pk = index_find_xc(old_space, 0);
+	/*
+	 * Fields of a compressed tuple can be indexed only
+	 * if they are stored uncompressed.
+	 */
+	memtx_space_restore_tuples(old_space, old_space->index_count,
+				   new_space->format);
 
 	/* Now deal with any kind of add index during normal operation. */
 	struct iterator *it = pk->allocIterator();
@@ -379,6 +818,8 @@ MemtxEngine::buildSecondaryKey(struct space *old_space,
 	/* Build the new index. */
 	struct tuple *tuple;
 	struct tuple_format *format = new_space->format;
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
 	while ((tuple = it->next(it))) {
 		/*
 		 * Check that the tuple is OK according to the
@@ -386,6 +827,7 @@ MemtxEngine::buildSecondaryKey(struct space *old_space,
 		 */
 		if (tuple_validate(format, tuple))
 			diag_raise();
+		region_truncate(region, used);
 		/*
 		 * @todo: better message if there is a duplicate.
 		 */
@@ -401,6 +843,7 @@ MemtxEngine::checkIndexDef(struct space *space, struct index_def *index_def)
 {
 	switch (index_def->type) {
 	case HASH:
+	case FHASH:
 		if (! index_def->opts.is_unique) {
 			tnt_raise(ClientError, ER_MODIFY_INDEX,
 				  index_def->name,
@@ -460,7 +903,7 @@ MemtxEngine::checkIndexDef(struct space *space, struct index_def *index_def)
 			  space_name(space));
 		break;
 	}
-	/* Only HASH and TREE indexes checks parts there */
+	/* Only HASH, FHASH and TREE indexes checks parts there */
 	/* Just check that there are no ARRAY parts */
 	for (uint32_t i = 0; i < index_def->key_def.part_count; i++) {
 		if (index_def->key_def.parts[i].type == FIELD_TYPE_ARRAY) {
@@ -590,9 +1033,280 @@ MemtxEngine::bootstrap()
 		recoverSnapshotRow(&row);
 }
 
+enum {
+	/** Size of a block of rows compressed by a worker. */
+	CHECKPOINT_BLOCK_SIZE = 128 * 1024,
+	/** Max number of snapshot compression threads. */
+	CHECKPOINT_WORKERS_MAX = 8,
+};
+
+/**
+ * A block of snapshot rows, encoded by the snapshot thread,
+ * compressed by a worker thread and written to the file by
+ * the snapshot thread in the order of submission.
+ */
+struct checkpoint_block {
+	/** Link in checkpoint_writer::input. */
+	struct stailq_entry in_input;
+	/** Link in checkpoint_writer::pending. */
+	struct stailq_entry in_pending;
+	/** Encoded rows. */
+	char *rows;
+	size_t size;
+	size_t capacity;
+	/** Ready to write transaction block, set by a worker. */
+	char *data;
+	ssize_t data_size;
+	/** Set when the worker is done with the block. */
+	bool is_ready;
+	/** Compression error, if data_size < 0. */
+	struct diag diag;
+};
+
+/**
+ * Snapshot writer. Rows are accumulated in blocks, which are
+ * compressed in parallel by a pool of worker threads and
+ * appended to the snapshot file strictly in the original
+ * order, so the file is indistinguishable from one written
+ * by a single thread.
+ */
+struct checkpoint_writer {
+	struct xlog *xlog;
+	/** Protects input, is_stopped and block readiness. */
+	pthread_mutex_t mutex;
+	/** Signalled when there is input or on stop. */
+	pthread_cond_t cond;
+	/** Signalled when a block is compressed. */
+	pthread_cond_t done_cond;
+	/** Blocks waiting for a worker. */
+	struct stailq input;
+	/**
+	 * Blocks submitted but not written yet, in file order.
+	 * Accessed only by the snapshot thread.
+	 */
+	struct stailq pending;
+	int pending_count;
+	bool is_stopped;
+	/** The block being filled by the snapshot thread. */
+	struct checkpoint_block *current;
+	struct cord workers[CHECKPOINT_WORKERS_MAX];
+	int worker_count;
+};
+
 static void
-checkpoint_write_row(struct xlog *l, struct xrow_header *row)
+checkpoint_block_delete(struct checkpoint_block *block)
 {
+	diag_destroy(&block->diag);
+	free(block->rows);
+	free(block->data);
+	free(block);
+}
+
+static void *
+checkpoint_worker_f(void *arg)
+{
+	struct checkpoint_writer *writer = (struct checkpoint_writer *) arg;
+	ZSTD_CCtx *zctx = ZSTD_createCCtx();
+	tt_pthread_mutex_lock(&writer->mutex);
+	while (true) {
+		while (stailq_empty(&writer->input) && !writer->is_stopped)
+			tt_pthread_cond_wait(&writer->cond, &writer->mutex);
+		if (writer->is_stopped)
+			break;
+		struct checkpoint_block *block =
+			stailq_shift_entry(&writer->input,
+					   struct checkpoint_block, in_input);
+		tt_pthread_mutex_unlock(&writer->mutex);
+
+		block->data = (char *) malloc(xlog_tx_encode_bound(block->size));
+		if (block->data == NULL) {
+			diag_set(OutOfMemory, xlog_tx_encode_bound(block->size),
+				 "malloc", "snapshot block");
+			block->data_size = -1;
+		} else if (zctx == NULL) {
+			diag_set(OutOfMemory, sizeof(ZSTD_CCtx *),
+				 "ZSTD_createCCtx", "snapshot compressor");
+			block->data_size = -1;
+		} else {
+			block->data_size = xlog_tx_encode(zctx, block->rows,
+							  block->size,
+							  block->data);
+		}
+		if (block->data_size < 0)
+			diag_move(diag_get(), &block->diag);
+
+		tt_pthread_mutex_lock(&writer->mutex);
+		block->is_ready = true;
+		tt_pthread_cond_broadcast(&writer->done_cond);
+	}
+	tt_pthread_mutex_unlock(&writer->mutex);
+	if (zctx != NULL)
+		ZSTD_freeCCtx(zctx);
+	return NULL;
+}
+
+static void
+checkpoint_writer_create(struct checkpoint_writer *writer, struct xlog *xlog)
+{
+	writer->xlog = xlog;
+	tt_pthread_mutex_init(&writer->mutex, NULL);
+	tt_pthread_cond_init(&writer->cond, NULL);
+	tt_pthread_cond_init(&writer->done_cond, NULL);
+	stailq_create(&writer->input);
+	stailq_create(&writer->pending);
+	writer->pending_count = 0;
+	writer->is_stopped = false;
+	writer->current = NULL;
+	writer->worker_count = 0;
+
+	/*
+	 * Leave half of the cores to the rest of the instance,
+	 * the snapshot is a background activity.
+	 */
+	long worker_count = sysconf(_SC_NPROCESSORS_ONLN) / 2;
+	worker_count = MIN(MAX(worker_count, 1), CHECKPOINT_WORKERS_MAX);
+	for (int i = 0; i < worker_count; i++) {
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "snapshot_%d", i);
+		if (cord_start(&writer->workers[i], name,
+			       checkpoint_worker_f, writer) != 0) {
+			/*
+			 * Continue with fewer workers or, if none
+			 * started, write rows in this thread.
+			 */
+			error_log(diag_last_error(diag_get()));
+			break;
+		}
+		writer->worker_count++;
+	}
+}
+
+static void
+checkpoint_writer_destroy(struct checkpoint_writer *writer)
+{
+	tt_pthread_mutex_lock(&writer->mutex);
+	writer->is_stopped = true;
+	tt_pthread_cond_broadcast(&writer->cond);
+	tt_pthread_mutex_unlock(&writer->mutex);
+	for (int i = 0; i < writer->worker_count; i++)
+		cord_join(&writer->workers[i]);
+
+	struct checkpoint_block *block, *next;
+	stailq_foreach_entry_safe(block, next, &writer->pending, in_pending)
+		checkpoint_block_delete(block);
+	if (writer->current != NULL)
+		checkpoint_block_delete(writer->current);
+	tt_pthread_cond_destroy(&writer->done_cond);
+	tt_pthread_cond_destroy(&writer->cond);
+	tt_pthread_mutex_destroy(&writer->mutex);
+}
+
+/**
+ * Wait until the oldest submitted block is compressed
+ * and append it to the snapshot file.
+ */
+static void
+checkpoint_writer_write_block(struct checkpoint_writer *writer)
+{
+	assert(!stailq_empty(&writer->pending));
+	struct checkpoint_block *block =
+		stailq_first_entry(&writer->pending,
+				   struct checkpoint_block, in_pending);
+	tt_pthread_mutex_lock(&writer->mutex);
+	while (!block->is_ready)
+		tt_pthread_cond_wait(&writer->done_cond, &writer->mutex);
+	tt_pthread_mutex_unlock(&writer->mutex);
+
+	stailq_shift(&writer->pending);
+	writer->pending_count--;
+	auto guard = make_scoped_guard([=]{ checkpoint_block_delete(block); });
+	if (block->data_size < 0) {
+		diag_move(&block->diag, diag_get());
+		diag_raise();
+	}
+	if (xlog_write_tx(writer->xlog, block->data, block->data_size) < 0)
+		diag_raise();
+}
+
+/** Hand the current block over to the workers. */
+static void
+checkpoint_writer_submit(struct checkpoint_writer *writer)
+{
+	struct checkpoint_block *block = writer->current;
+	if (block == NULL)
+		return;
+	writer->current = NULL;
+	stailq_add_tail_entry(&writer->pending, block, in_pending);
+	writer->pending_count++;
+
+	tt_pthread_mutex_lock(&writer->mutex);
+	stailq_add_tail_entry(&writer->input, block, in_input);
+	tt_pthread_cond_signal(&writer->cond);
+	tt_pthread_mutex_unlock(&writer->mutex);
+
+	/* Bound the memory used by blocks in flight. */
+	while (writer->pending_count > 2 * writer->worker_count)
+		checkpoint_writer_write_block(writer);
+}
+
+/** Append an encoded row to the current block. */
+static void
+checkpoint_writer_add_row(struct checkpoint_writer *writer,
+			  const struct xrow_header *row)
+{
+	struct checkpoint_block *block = writer->current;
+	if (block == NULL) {
+		block = (struct checkpoint_block *) calloc(1, sizeof(*block));
+		if (block == NULL) {
+			tnt_raise(OutOfMemory, sizeof(*block),
+				  "malloc", "snapshot block");
+		}
+		diag_create(&block->diag);
+		writer->current = block;
+	}
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_header_encode_xc(row, iov, 0);
+	size_t row_size = 0;
+	for (int i = 0; i < iovcnt; i++)
+		row_size += iov[i].iov_len;
+	if (block->size + row_size > block->capacity) {
+		size_t capacity = MAX(block->capacity * 2,
+				      CHECKPOINT_BLOCK_SIZE + row_size);
+		while (capacity < block->size + row_size)
+			capacity *= 2;
+		char *rows = (char *) realloc(block->rows, capacity);
+		if (rows == NULL) {
+			tnt_raise(OutOfMemory, capacity,
+				  "realloc", "snapshot block");
+		}
+		block->rows = rows;
+		block->capacity = capacity;
+	}
+	for (int i = 0; i < iovcnt; i++) {
+		memcpy(block->rows + block->size, iov[i].iov_base,
+		       iov[i].iov_len);
+		block->size += iov[i].iov_len;
+	}
+	if (block->size >= CHECKPOINT_BLOCK_SIZE)
+		checkpoint_writer_submit(writer);
+}
+
+/** Write out all rows added to the writer. */
+static void
+checkpoint_writer_flush(struct checkpoint_writer *writer)
+{
+	checkpoint_writer_submit(writer);
+	while (!stailq_empty(&writer->pending))
+		checkpoint_writer_write_block(writer);
+	if (xlog_flush(writer->xlog) < 0)
+		diag_raise();
+}
+
+static void
+checkpoint_write_row(struct checkpoint_writer *writer,
+		     struct xrow_header *row)
+{
+	struct xlog *l = writer->xlog;
 	static ev_tstamp last = 0;
 	if (last == 0) {
 		ev_now_update(loop());
@@ -611,10 +1325,15 @@ checkpoint_write_row(struct xlog *l, struct xrow_header *row)
 	row->lsn = ++l->rows;
 	row->sync = 0; /* don't write sync to wal */
 
-	ssize_t written = xlog_write_row(l, row);
-	fiber_gc();
-	if (written < 0) {
-		diag_raise();
+	if (writer->worker_count > 0) {
+		checkpoint_writer_add_row(writer, row);
+		fiber_gc();
+	} else {
+		ssize_t written = xlog_write_row(l, row);
+		fiber_gc();
+		if (written < 0) {
+			diag_raise();
+		}
 	}
 
 	if (l->rows % 100000 == 0)
@@ -623,7 +1342,8 @@ checkpoint_write_row(struct xlog *l, struct xrow_header *row)
 }
 
 static void
-checkpoint_write_tuple(struct xlog *l, uint32_t n, struct tuple *tuple)
+checkpoint_write_tuple(struct checkpoint_writer *writer, uint32_t n,
+		       struct tuple *tuple)
 {
 	struct request_replace_body body;
 	body.m_body = 0x82; /* map of two elements. */
@@ -639,10 +1359,16 @@ checkpoint_write_tuple(struct xlog *l, uint32_t n, struct tuple *tuple)
 	row.bodycnt = 2;
 	row.body[0].iov_base = &body;
 	row.body[0].iov_len = sizeof(body);
+	/* A compressed tuple is decompressed on the region. */
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
 	uint32_t bsize;
 	row.body[1].iov_base = (char *) tuple_data_range(tuple, &bsize);
+	if (row.body[1].iov_base == NULL)
+		diag_raise();
 	row.body[1].iov_len = bsize;
-	checkpoint_write_row(l, &row);
+	checkpoint_write_row(writer, &row);
+	region_truncate(region, used);
 }
 
 struct checkpoint_entry {
@@ -730,17 +1456,23 @@ checkpoint_f(va_list ap)
 	auto guard = make_scoped_guard([&]{ xlog_close(&snap, false); });
 	snap.rate_limit = ckpt->snap_io_rate_limit;
 
+	struct checkpoint_writer writer;
+	checkpoint_writer_create(&writer, &snap);
+	auto writer_guard = make_scoped_guard([&]{
+		checkpoint_writer_destroy(&writer);
+	});
+
 	say_info("saving snapshot `%s'", snap.filename);
 	struct checkpoint_entry *entry;
 	rlist_foreach_entry(entry, &ckpt->entries, link) {
 		struct tuple *tuple;
 		struct iterator *it = entry->iterator;
 		for (tuple = it->next(it); tuple; tuple = it->next(it)) {
-			checkpoint_write_tuple(&snap, space_id(entry->space),
+			checkpoint_write_tuple(&writer, space_id(entry->space),
 					       tuple);
 		}
 	}
-	xlog_flush(&snap);
+	checkpoint_writer_flush(&writer);
 	say_info("done");
 	return 0;
 }
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "memtx_fhash.h"
+#include "say.h"
+#include "tuple.h"
+#include "tuple_compare.h"
+#include "memtx_engine.h"
+#include "space.h"
+#include "schema.h" /* space_cache_find() */
+#include "errinj.h"
+
+static inline bool
+equal(struct tuple *tuple_a, struct tuple *tuple_b,
+      const struct key_def *key_def)
+{
+	return tuple_compare(tuple_a, tuple_b, key_def) == 0;
+}
+
+static inline bool
+equal_key(struct tuple *tuple, const char *key,
+	  const struct key_def *key_def)
+{
+	return tuple_compare_with_key(tuple, key, key_def->part_count,
+				      key_def) == 0;
+}
+
+#define FHASH_NAME _index
+#define FHASH_DATA_TYPE struct tuple *
+#define FHASH_KEY_TYPE const char *
+#define FHASH_CMP_ARG_TYPE struct key_def *
+#define FHASH_EQUAL(a, b, c) equal(a, b, c)
+#define FHASH_EQUAL_KEY(a, b, c) equal_key(a, b, c)
+#define FHASH_INDEX_EXTENT_SIZE MEMTX_EXTENT_SIZE
+#include "salad/fhash.h"
+
+/* {{{ MemtxFHash Iterators ***************************************/
+
+struct fhash_iterator {
+	struct iterator base; /* Must be the first member. */
+	struct fhash_index_core *hash_table;
+	struct fhash_index_iterator iterator;
+};
+
+static void
+fhash_iterator_free(struct iterator *iterator)
+{
+	assert(iterator->free == fhash_iterator_free);
+	free(iterator);
+}
+
+static struct tuple *
+fhash_iterator_ge(struct iterator *ptr)
+{
+	assert(ptr->free == fhash_iterator_free);
+	struct fhash_iterator *it = (struct fhash_iterator *) ptr;
+	struct tuple **res =
+		fhash_index_iterator_get_and_next(it->hash_table,
+						  &it->iterator);
+	return res ? *res : 0;
+}
+
+static struct tuple *
+fhash_iterator_gt(struct iterator *ptr)
+{
+	assert(ptr->free == fhash_iterator_free);
+	ptr->next = fhash_iterator_ge;
+	struct fhash_iterator *it = (struct fhash_iterator *) ptr;
+	struct tuple **res =
+		fhash_index_iterator_get_and_next(it->hash_table,
+						  &it->iterator);
+	if (!res)
+		return 0;
+	res = fhash_index_iterator_get_and_next(it->hash_table,
+						&it->iterator);
+	return res ? *res : 0;
+}
+
+static struct tuple *
+fhash_iterator_eq_next(MAYBE_UNUSED struct iterator *it)
+{
+	return NULL;
+}
+
+static struct tuple *
+fhash_iterator_eq(struct iterator *it)
+{
+	it->next = fhash_iterator_eq_next;
+	return fhash_iterator_ge(it);
+}
+
+/* }}} */
+
+/* {{{ MemtxFHash *************************************************/
+
+MemtxFHash::MemtxFHash(struct index_def *index_def_arg)
+	: MemtxIndex(index_def_arg)
+{
+	memtx_index_arena_init();
+	hash_table = (struct fhash_index_core *) malloc(sizeof(*hash_table));
+	if (hash_table == NULL) {
+		tnt_raise(OutOfMemory, sizeof(*hash_table),
+			  "MemtxFHash", "hash_table");
+	}
+	fhash_index_create(hash_table, FHASH_INDEX_EXTENT_SIZE,
+			   memtx_index_extent_alloc, memtx_index_extent_free,
+			   NULL, &this->index_def->key_def);
+}
+
+MemtxFHash::~MemtxFHash()
+{
+	fhash_index_destroy(hash_table);
+	free(hash_table);
+}
+
+void
+MemtxFHash::reserve(uint32_t size_hint)
+{
+	/*
+	 * Allocate all home chunks at once to avoid rehashing
+	 * while the snapshot is loaded.
+	 */
+	if (fhash_index_reserve(hash_table, size_hint) != 0) {
+		tnt_raise(OutOfMemory, (ssize_t)size_hint,
+			  "MemtxFHash", "reserve");
+	}
+}
+
+size_t
+MemtxFHash::size() const
+{
+	return hash_table->count;
+}
+
+size_t
+MemtxFHash::bsize() const
+{
+	return fhash_index_extent_count(hash_table) * FHASH_INDEX_EXTENT_SIZE;
+}
+
+struct tuple *
+MemtxFHash::random(uint32_t rnd) const
+{
+	struct tuple **res = fhash_index_random(hash_table, rnd);
+	return res ? *res : NULL;
+}
+
+struct tuple *
+MemtxFHash::findByKey(const char *key, uint32_t part_count) const
+{
+	assert(index_def->opts.is_unique && part_count == index_def->key_def.part_count);
+	(void) part_count;
+
+	uint32_t h = key_hash(key, index_def);
+	struct tuple **res = fhash_index_find_key(hash_table, h, key);
+	return res ? *res : NULL;
+}
+
+struct tuple *
+MemtxFHash::replace(struct tuple *old_tuple, struct tuple *new_tuple,
+		    enum dup_replace_mode mode)
+{
+	uint32_t errcode;
+
+	if (new_tuple) {
+		uint32_t h = tuple_hash(new_tuple, index_def);
+		struct tuple *dup_tuple = NULL;
+		int rc = fhash_index_replace(hash_table, h, new_tuple,
+					     &dup_tuple);
+		if (rc == 0)
+			dup_tuple = NULL;
+
+		ERROR_INJECT(ERRINJ_INDEX_ALLOC,
+		{
+			struct tuple *replaced;
+			if (rc == 0) {
+				fhash_index_delete_value(hash_table, h,
+							 new_tuple);
+			} else if (rc == 1) {
+				fhash_index_replace(hash_table, h, dup_tuple,
+						    &replaced);
+			}
+			rc = -1;
+		});
+
+		if (rc < 0) {
+			tnt_raise(OutOfMemory, (ssize_t)hash_table->count,
+				  "hash_table", "key");
+		}
+		errcode = replace_check_dup(old_tuple, dup_tuple, mode);
+
+		if (errcode) {
+			struct tuple *replaced;
+			if (dup_tuple == NULL) {
+				rc = fhash_index_delete_value(hash_table, h,
+							      new_tuple);
+			} else {
+				rc = fhash_index_replace(hash_table, h,
+							 dup_tuple, &replaced);
+				rc = rc == 1 ? 0 : -1;
+			}
+			if (rc != 0) {
+				panic("Failed to allocate memory in "
+				      "recover of int hash_table");
+			}
+			struct space *sp = space_cache_find(index_def->space_id);
+			tnt_raise(ClientError, errcode, index_name(this),
+				  space_name(sp));
+		}
+
+		if (dup_tuple)
+			return dup_tuple;
+	}
+
+	if (old_tuple) {
+		uint32_t h = tuple_hash(old_tuple, index_def);
+		int res = fhash_index_delete_value(hash_table, h, old_tuple);
+		assert(res == 0); (void) res;
+	}
+	return old_tuple;
+}
+
+struct iterator *
+MemtxFHash::allocIterator() const
+{
+	struct fhash_iterator *it = (struct fhash_iterator *)
+			calloc(1, sizeof(*it));
+	if (it == NULL) {
+		tnt_raise(OutOfMemory, sizeof(struct fhash_iterator),
+			  "MemtxFHash", "iterator");
+	}
+
+	it->base.next = fhash_iterator_ge;
+	it->base.free = fhash_iterator_free;
+	it->hash_table = hash_table;
+	fhash_index_iterator_begin(it->hash_table, &it->iterator);
+	return (struct iterator *) it;
+}
+
+void
+MemtxFHash::initIterator(struct iterator *ptr, enum iterator_type type,
+			 const char *key, uint32_t part_count) const
+{
+	assert(part_count == 0 || key != NULL);
+	(void) part_count;
+	assert(ptr->free == fhash_iterator_free);
+
+	struct fhash_iterator *it = (struct fhash_iterator *) ptr;
+
+	switch (type) {
+	case ITER_GT:
+		if (part_count != 0) {
+			fhash_index_iterator_key(it->hash_table, &it->iterator,
+						 key_hash(key, index_def), key);
+			it->base.next = fhash_iterator_gt;
+		} else {
+			fhash_index_iterator_begin(it->hash_table,
+						   &it->iterator);
+			it->base.next = fhash_iterator_ge;
+		}
+		break;
+	case ITER_ALL:
+		fhash_index_iterator_begin(it->hash_table, &it->iterator);
+		it->base.next = fhash_iterator_ge;
+		break;
+	case ITER_EQ:
+		assert(part_count > 0);
+		fhash_index_iterator_key(it->hash_table, &it->iterator,
+					 key_hash(key, index_def), key);
+		it->base.next = fhash_iterator_eq;
+		break;
+	default:
+		return Index::initIterator(ptr, type, key, part_count);
+	}
+}
+
+void
+MemtxFHash::createReadViewForIterator(struct iterator *iterator)
+{
+	struct fhash_iterator *it = (struct fhash_iterator *) iterator;
+	fhash_index_iterator_freeze(it->hash_table, &it->iterator);
+}
+
+void
+MemtxFHash::destroyReadViewForIterator(struct iterator *iterator)
+{
+	struct fhash_iterator *it = (struct fhash_iterator *) iterator;
+	fhash_index_iterator_destroy(it->hash_table, &it->iterator);
+}
+
+/* }}} */
@@ -0,0 +1,81 @@
+#ifndef TARANTOOL_BOX_MEMTX_FHASH_H_INCLUDED
+#define TARANTOOL_BOX_MEMTX_FHASH_H_INCLUDED
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "memtx_index.h"
+
+struct fhash_index_core;
+
+/**
+ * Unique hash index stored in a chunked open addressing hash
+ * table, see salad/fhash.h. Unlike MemtxHash, the table keeps
+ * tuple hashes next to each other, so most lookups compare only
+ * the hashes of one chunk and dereference a single tuple.
+ */
+class MemtxFHash: public MemtxIndex {
+public:
+	MemtxFHash(struct index_def *index_def);
+	virtual ~MemtxFHash() override;
+
+	virtual void reserve(uint32_t size_hint) override;
+	virtual size_t size() const override;
+	virtual struct tuple *random(uint32_t rnd) const override;
+	virtual struct tuple *findByKey(const char *key,
+					uint32_t part_count) const override;
+	virtual struct tuple *replace(struct tuple *old_tuple,
+				      struct tuple *new_tuple,
+				      enum dup_replace_mode mode) override;
+
+	virtual struct iterator *allocIterator() const override;
+	virtual void initIterator(struct iterator *iterator,
+				  enum iterator_type type,
+				  const char *key,
+				  uint32_t part_count) const override;
+
+	/**
+	 * Create a read view for iterator so further index modifications
+	 * will not affect the iterator iteration.
+	 */
+	virtual void createReadViewForIterator(struct iterator *iterator) override;
+	/**
+	 * Destroy a read view of an iterator. Must be called for iterators,
+	 * for which createReadViewForIterator was called.
+	 */
+	virtual void destroyReadViewForIterator(struct iterator *iterator) override;
+
+	virtual size_t bsize() const override;
+
+protected:
+	struct fhash_index_core *hash_table;
+};
+
+#endif /* TARANTOOL_BOX_MEMTX_FHASH_H_INCLUDED */
@@ -51,6 +51,10 @@ MemtxIndex::buildNext(struct tuple *tuple)
 	replace(NULL, tuple, DUP_INSERT);
 }
 
+void
+MemtxIndex::sortBuild()
+{}
+
 void
 MemtxIndex::endBuild()
 {}
@@ -87,7 +91,7 @@ MemtxIndex::count(enum iterator_type type, const char *key,
 }
 
 void
-index_build(MemtxIndex *index, MemtxIndex *pk)
+index_build_begin(MemtxIndex *index, MemtxIndex *pk)
 {
 	uint32_t n_tuples = pk->size();
 	uint32_t estimated_tuples = n_tuples * 1.2;
@@ -106,6 +110,12 @@ index_build(MemtxIndex *index, MemtxIndex *pk)
 	struct tuple *tuple;
 	while ((tuple = it->next(it)))
 		index->buildNext(tuple);
+}
 
+void
+index_build(MemtxIndex *index, MemtxIndex *pk)
+{
+	index_build_begin(index, pk);
+	index->sortBuild();
 	index->endBuild();
 }
@@ -66,6 +66,15 @@ public:
 	 */
 	virtual void reserve(uint32_t /* size_hint */);
 	virtual void buildNext(struct tuple *tuple);
+	/**
+	 * Optional step between buildNext() and endBuild():
+	 * prepare the collected data for endBuild(), e.g. sort it.
+	 * Unlike the rest of the build methods, it must not
+	 * allocate index memory or touch any state shared with
+	 * other indexes, so that it can be called from a worker
+	 * thread concurrently with sortBuild() of other indexes.
+	 */
+	virtual void sortBuild();
 	virtual void endBuild();
 protected:
 	/*
@@ -75,6 +84,14 @@ protected:
 	mutable struct iterator *m_position;
 };
 
+/**
+ * Feed the contents of another index to this index, i.e.
+ * the first half of index_build(). Must be followed by
+ * sortBuild() and endBuild().
+ */
+void
+index_build_begin(MemtxIndex *index, MemtxIndex *pk);
+
 /** Build this index based on the contents of another index. */
 void
 index_build(MemtxIndex *index, MemtxIndex *pk);
@@ -35,6 +35,7 @@
 #include "tuple_compare.h"
 #include "xrow.h"
 #include "memtx_hash.h"
+#include "memtx_fhash.h"
 #include "memtx_tree.h"
 #include "memtx_rtree.h"
 #include "memtx_bitset.h"
@@ -233,6 +234,65 @@ memtx_replace_all_keys(struct txn_stmt *stmt, struct space *space,
 	stmt->bsize_change = space_bsize_update(space, old_tuple, new_tuple);
 }
 
+/**
+ * Replace a compressed tuple in the first @a index_count
+ * indexes of the space with a copy stored with @a format.
+ * The tuple is logically the same, so the change isn't
+ * logged. Iterators stay valid, since the primary key
+ * replaces the tuple in place.
+ */
+static void
+memtx_restore_tuple(struct space *space, uint32_t index_count,
+		    struct tuple_format *format, struct tuple *old_tuple)
+{
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	uint32_t bsize;
+	const char *data = tuple_data_range(old_tuple, &bsize);
+	if (data == NULL)
+		diag_raise();
+	struct tuple *new_tuple = memtx_tuple_new_xc(format, data,
+						     data + bsize);
+	region_truncate(region, used);
+	tuple_ref(new_tuple);
+	memtx_index_extent_reserve(RESERVE_EXTENTS_BEFORE_REPLACE);
+	uint32_t i = 0;
+	try {
+		for (; i < index_count; i++) {
+			space->index[i]->replace(old_tuple, new_tuple,
+						 i == 0 ? DUP_REPLACE :
+						 DUP_INSERT);
+		}
+	} catch (Exception *e) {
+		/* Rollback all changes */
+		for (; i > 0; i--) {
+			Index *index = space->index[i - 1];
+			index->replace(new_tuple, old_tuple, DUP_INSERT);
+		}
+		tuple_unref(new_tuple);
+		throw;
+	}
+	tuple_unref(old_tuple);
+}
+
+void
+memtx_space_restore_tuples(struct space *space, uint32_t index_count,
+			   struct tuple_format *format)
+{
+	if (format->zformat == NULL)
+		return;
+	Index *pk = index_find_xc(space, 0);
+	struct iterator *it = pk->allocIterator();
+	IteratorGuard guard(it);
+	pk->initIterator(it, ITER_ALL, NULL, 0);
+	struct tuple *tuple;
+	while ((tuple = it->next(it))) {
+		struct tuple_format *old_format = tuple_format(tuple);
+		if (old_format->is_compressed &&
+		    old_format->field_count < format->field_count)
+			memtx_restore_tuple(space, index_count, format, tuple);
+	}
+}
 
 MemtxSpace::MemtxSpace(Engine *e)
 	: Handler(e)
@@ -308,6 +368,8 @@ MemtxSpace::prepareUpdate(struct txn_stmt *stmt, struct space *space,
 	/* Update the tuple; legacy, request ops are in request->tuple */
 	uint32_t new_size = 0, bsize;
 	const char *old_data = tuple_data_range(stmt->old_tuple, &bsize);
+	if (old_data == NULL)
+		diag_raise();
 	const char *new_data =
 		tuple_update_execute(region_aligned_alloc_cb, &fiber()->gc,
 				     request->tuple, request->tuple_end,
@@ -378,6 +440,8 @@ MemtxSpace::prepareUpsert(struct txn_stmt *stmt, struct space *space,
 		uint32_t new_size = 0, bsize;
 		const char *old_data = tuple_data_range(stmt->old_tuple,
 							&bsize);
+		if (old_data == NULL)
+			diag_raise();
 		/*
 		 * Update the tuple.
 		 * tuple_upsert_execute() fails on totally wrong
@@ -469,6 +533,8 @@ MemtxSpace::createIndex(struct space *space, struct index_def *index_def_arg)
 	switch (index_def_arg->type) {
 	case HASH:
 		return new MemtxHash(index_def_arg);
+	case FHASH:
+		return new MemtxFHash(index_def_arg);
 	case TREE:
 		return new MemtxTree(index_def_arg);
 	case RTREE:
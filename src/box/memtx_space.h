@@ -48,6 +48,17 @@ void
 memtx_replace_all_keys(struct txn_stmt *, struct space *space,
 		       enum dup_replace_mode /* mode */);
 
+/**
+ * Re-store the compressed tuples of a space whose fields
+ * indexed in @a format are compressed, so that an index
+ * over these fields can be built, @sa tuple_format::zformat.
+ * Only the first @a index_count indexes, which are built,
+ * are updated.
+ */
+void
+memtx_space_restore_tuples(struct space *space, uint32_t index_count,
+			   struct tuple_format *format);
+
 struct MemtxSpace: public Handler {
 	MemtxSpace(Engine *e);
 	virtual ~MemtxSpace()
@@ -188,7 +188,7 @@ tree_iterator_bwd_skip_one_check_next_equality(struct iterator *iterator)
 
 MemtxTree::MemtxTree(struct index_def *index_def_arg)
 	: MemtxIndex(index_def_arg), build_array(0), build_array_size(0),
-	  build_array_alloc_size(0)
+	  build_array_alloc_size(0), build_array_is_sorted(false)
 {
 	memtx_index_arena_init();
 	memtx_tree_create(&tree, index_def,
@@ -221,6 +221,36 @@ MemtxTree::random(uint32_t rnd) const
 	return res ? *res : 0;
 }
 
+size_t
+MemtxTree::approximateCount(enum iterator_type type, const char *key,
+			    uint32_t part_count) const
+{
+	size_t size = memtx_tree_size(&tree);
+	if (type == ITER_ALL || part_count == 0)
+		return size;
+
+	struct key_data key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		return memtx_tree_approximate_count(&tree, &key_data);
+	case ITER_GE:
+		return size - memtx_tree_approximate_rank(&tree, &key_data,
+							  false);
+	case ITER_GT:
+		return size - memtx_tree_approximate_rank(&tree, &key_data,
+							  true);
+	case ITER_LT:
+		return memtx_tree_approximate_rank(&tree, &key_data, false);
+	case ITER_LE:
+		return memtx_tree_approximate_rank(&tree, &key_data, true);
+	default:
+		return count(type, key, part_count);
+	}
+}
+
 struct tuple *
 MemtxTree::findByKey(const char *key, uint32_t part_count) const
 {
@@ -392,15 +422,25 @@ MemtxTree::buildNext(struct tuple *tuple)
 }
 
 void
-MemtxTree::endBuild()
+MemtxTree::sortBuild()
 {
+	if (build_array_is_sorted)
+		return;
 	qsort_arg(build_array, build_array_size, sizeof(struct tuple *), memtx_tree_qcompare, index_def);
+	build_array_is_sorted = true;
+}
+
+void
+MemtxTree::endBuild()
+{
+	sortBuild();
 	memtx_tree_build(&tree, build_array, build_array_size);
 
 	free(build_array);
 	build_array = 0;
 	build_array_size = 0;
 	build_array_alloc_size = 0;
+	build_array_is_sorted = false;
 }
 
 /**
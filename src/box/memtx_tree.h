@@ -62,9 +62,13 @@ public:
 	virtual void beginBuild() override;
 	virtual void reserve(uint32_t size_hint) override;
 	virtual void buildNext(struct tuple *tuple) override;
+	virtual void sortBuild() override;
 	virtual void endBuild() override;
 	virtual size_t size() const override;
 	virtual struct tuple *random(uint32_t rnd) const override;
+	virtual size_t approximateCount(enum iterator_type type,
+					const char *key,
+					uint32_t part_count) const override;
 	virtual struct tuple *findByKey(const char *key,
 					uint32_t part_count) const override;
 	virtual struct tuple *replace(struct tuple *old_tuple,
@@ -93,6 +97,8 @@ public:
 	struct memtx_tree tree;
 	struct tuple **build_array;
 	size_t build_array_size, build_array_alloc_size;
+	/** Set by sortBuild(), so that endBuild() doesn't sort twice. */
+	bool build_array_is_sorted;
 };
 
 #endif /* TARANTOOL_BOX_MEMTX_TREE_H_INCLUDED */
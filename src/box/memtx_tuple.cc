@@ -31,10 +31,13 @@
 
 #include "memtx_tuple.h"
 
+#include <zdict.h>
+
 #include "small/small.h"
 #include "small/region.h"
 #include "small/quota.h"
 #include "fiber.h"
+#include "coeio.h"
 #include "box.h"
 
 struct memtx_tuple {
@@ -60,6 +63,43 @@ struct small_alloc memtx_alloc; /* used box box.slab.info() */
 
 uint32_t snapshot_version;
 
+/** Context to compress tuples, used in the tx thread only. */
+static ZSTD_CCtx *memtx_tuple_zctx;
+/** Size of compressed tuples, used by box.slab.info(). */
+uint64_t memtx_tuple_zsize;
+/** Size of compressed tuples when decompressed. */
+uint64_t memtx_tuple_zsize_raw;
+
+enum {
+	/** Don't compress less than this many bytes. */
+	MEMTX_TUPLE_COMPRESS_MIN = 256,
+	/** Zstd compression level of tuples. */
+	MEMTX_TUPLE_COMPRESS_LEVEL = 3,
+	/** Size of the header of the compressed fields. */
+	MEMTX_TUPLE_ZHEADER_SIZE = 5,
+	/** Max size of a trained zstd dictionary. */
+	MEMTX_ZDICT_SIZE = 16 * 1024,
+	/** Max size of data sampled to train a zstd dictionary. */
+	MEMTX_ZDICT_SAMPLE_SIZE = 256 * 1024,
+	/** Number of tuples sampled to train a dictionary. */
+	MEMTX_ZDICT_SAMPLES = 512,
+};
+
+/**
+ * The first tuples of a space, sampled to train a zstd
+ * dictionary for the space, see tuple_zdict.
+ */
+struct memtx_zdict_sampler {
+	/** Sizes of sampled tuples. */
+	size_t sizes[MEMTX_ZDICT_SAMPLES];
+	/** Number of sampled tuples. */
+	unsigned count;
+	/** Size of sampled data. */
+	size_t used;
+	/** Sampled tuples, concatenated. */
+	char data[MEMTX_ZDICT_SAMPLE_SIZE];
+};
+
 enum {
 	/** Lowest allowed slab_alloc_minimal */
 	OBJSIZE_MIN = 16,
@@ -109,11 +149,182 @@ memtx_tuple_init(uint64_t tuple_arena_max_size, uint32_t objsize_min,
 	slab_cache_create(&memtx_slab_cache, &memtx_arena);
 	small_alloc_create(&memtx_alloc, &memtx_slab_cache,
 			   objsize_min, alloc_factor);
+	memtx_tuple_zctx = ZSTD_createCCtx();
+	if (memtx_tuple_zctx == NULL)
+		panic("failed to create zstd compression context");
 }
 
 void
 memtx_tuple_free(void)
 {
+	ZSTD_freeCCtx(memtx_tuple_zctx);
+}
+
+/**
+ * Train a zstd dictionary on the sampled tuples. Called in
+ * a coio thread, since training takes a while.
+ */
+static ssize_t
+memtx_zdict_train_f(va_list ap)
+{
+	struct memtx_zdict_sampler *sampler =
+		va_arg(ap, struct memtx_zdict_sampler *);
+	ZSTD_CDict **cdict = va_arg(ap, ZSTD_CDict **);
+	ZSTD_DDict **ddict = va_arg(ap, ZSTD_DDict **);
+	char *buf = (char *) malloc(MEMTX_ZDICT_SIZE);
+	if (buf == NULL)
+		return -1;
+	size_t size = ZDICT_trainFromBuffer(buf, MEMTX_ZDICT_SIZE,
+					    sampler->data, sampler->sizes,
+					    sampler->count);
+	if (ZDICT_isError(size)) {
+		say_warn("failed to train zstd dictionary: %s",
+			 ZDICT_getErrorName(size));
+		free(buf);
+		return -1;
+	}
+	/* Both digested dictionaries copy the content. */
+	*cdict = ZSTD_createCDict(buf, size, MEMTX_TUPLE_COMPRESS_LEVEL);
+	*ddict = ZSTD_createDDict(buf, size);
+	free(buf);
+	if (*cdict == NULL || *ddict == NULL) {
+		say_warn("failed to create zstd dictionary");
+		ZSTD_freeCDict(*cdict);
+		ZSTD_freeDDict(*ddict);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Train the dictionary of a format of compressed tuples in
+ * background. Tuples are compressed without a dictionary
+ * until it is trained, and forever if training fails.
+ */
+static int
+memtx_zdict_train_fiber_f(va_list ap)
+{
+	struct tuple_format *zformat = va_arg(ap, struct tuple_format *);
+	struct memtx_zdict_sampler *sampler =
+		va_arg(ap, struct memtx_zdict_sampler *);
+	ZSTD_CDict *cdict = NULL;
+	ZSTD_DDict *ddict = NULL;
+	if (coio_call(memtx_zdict_train_f, sampler, &cdict, &ddict) == 0) {
+		/* Tuples compressed with cdict need ddict. */
+		zformat->zdict.ddict = ddict;
+		zformat->zdict.cdict = cdict;
+	}
+	free(sampler);
+	tuple_format_ref(zformat, -1);
+	return 0;
+}
+
+/**
+ * Start training the dictionary of a format of compressed
+ * tuples on the sampled tuples. The format is referenced
+ * until training is over.
+ */
+static void
+memtx_zdict_train(struct tuple_format *zformat)
+{
+	struct tuple_zdict *zdict = &zformat->zdict;
+	struct memtx_zdict_sampler *sampler =
+		(struct memtx_zdict_sampler *) zdict->sampler;
+	zdict->sampler = NULL;
+	zdict->is_sampled = true;
+	struct fiber *f = fiber_new("memtx.zdict", memtx_zdict_train_fiber_f);
+	if (f == NULL) {
+		/* The dictionary is optional, ignore the error. */
+		diag_clear(diag_get());
+		free(sampler);
+		return;
+	}
+	tuple_format_ref(zformat, 1);
+	fiber_start(f, zformat, sampler);
+}
+
+/**
+ * Sample the compressed part of a tuple to train the
+ * dictionary of its format. Start training once there are
+ * enough samples.
+ */
+static void
+memtx_zdict_sample(struct tuple_format *zformat, const char *data,
+		   size_t size)
+{
+	struct tuple_zdict *zdict = &zformat->zdict;
+	if (zdict->is_sampled)
+		return;
+	if (zdict->sampler == NULL) {
+		zdict->sampler = malloc(sizeof(struct memtx_zdict_sampler));
+		if (zdict->sampler == NULL)
+			return; /* The dictionary is optional. */
+		((struct memtx_zdict_sampler *) zdict->sampler)->count = 0;
+		((struct memtx_zdict_sampler *) zdict->sampler)->used = 0;
+	}
+	struct memtx_zdict_sampler *sampler =
+		(struct memtx_zdict_sampler *) zdict->sampler;
+	if (sampler->used + size <= sizeof(sampler->data)) {
+		memcpy(sampler->data + sampler->used, data, size);
+		sampler->used += size;
+		sampler->sizes[sampler->count++] = size;
+	}
+	if (sampler->count == MEMTX_ZDICT_SAMPLES ||
+	    sampler->used + MEMTX_TUPLE_COMPRESS_MIN > sizeof(sampler->data))
+		memtx_zdict_train(zformat);
+}
+
+/**
+ * Compress tuple data for a format of compressed tuples,
+ * @sa tuple_format::is_compressed. The result is allocated
+ * on the fiber region.
+ * @retval NULL if compression doesn't pay off or failed,
+ *         then the tuple is to be stored as is.
+ */
+static const char *
+memtx_tuple_compress(struct tuple_format *zformat, const char *data,
+		     const char *end, const char **zend)
+{
+	assert(zformat->is_compressed);
+	const char *tail = data;
+	uint32_t field_count = mp_decode_array(&tail);
+	if (zformat->field_count == 0 || field_count <= zformat->field_count)
+		return NULL;
+	for (uint32_t i = 0; i < zformat->field_count; i++)
+		mp_next(&tail);
+	size_t prefix_size = tail - data;
+	size_t tail_size = end - tail;
+	if (tail_size < MEMTX_TUPLE_COMPRESS_MIN)
+		return NULL;
+
+	memtx_zdict_sample(zformat, tail, tail_size);
+	struct tuple_zdict *zdict = &zformat->zdict;
+
+	size_t zmax_size = ZSTD_compressBound(tail_size);
+	char *buf = (char *) region_alloc(&fiber()->gc, prefix_size +
+					  MEMTX_TUPLE_ZHEADER_SIZE + zmax_size);
+	if (buf == NULL)
+		return NULL;
+	memcpy(buf, data, prefix_size);
+	char *pos = buf + prefix_size;
+	*pos = 0xce; /* MP_UINT32 */
+	mp_store_u32(pos + 1, tail_size);
+	pos += MEMTX_TUPLE_ZHEADER_SIZE;
+	size_t zsize;
+	if (zdict->cdict != NULL) {
+		zsize = ZSTD_compress_usingCDict(memtx_tuple_zctx, pos,
+						 zmax_size, tail, tail_size,
+						 zdict->cdict);
+	} else {
+		zsize = ZSTD_compressCCtx(memtx_tuple_zctx, pos, zmax_size,
+					  tail, tail_size,
+					  MEMTX_TUPLE_COMPRESS_LEVEL);
+	}
+	if (ZSTD_isError(zsize) ||
+	    MEMTX_TUPLE_ZHEADER_SIZE + zsize >= tail_size)
+		return NULL;
+	*zend = pos + zsize;
+	return buf;
 }
 
 struct tuple_format_vtab memtx_tuple_format_vtab = {
@@ -124,6 +335,21 @@ struct tuple *
 memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 {
 	assert(mp_typeof(*data) == MP_ARRAY);
+	assert(!format->is_compressed);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t raw_len = end - data;
+	if (format->zformat != NULL &&
+	    raw_len >= MEMTX_TUPLE_COMPRESS_MIN) {
+		const char *zend;
+		const char *zdata = memtx_tuple_compress(format->zformat,
+							 data, end, &zend);
+		if (zdata != NULL) {
+			format = format->zformat;
+			data = zdata;
+			end = zend;
+		}
+	}
 	size_t tuple_len = end - data;
 	size_t meta_size = tuple_format_meta_size(format);
 	size_t total = sizeof(struct memtx_tuple) + meta_size + tuple_len;
@@ -143,6 +369,7 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 	 * of disaster recovery.
 	 */
 	if (memtx_tuple == NULL) {
+		region_truncate(region, region_svp);
 		if (total > memtx_alloc.objsize_max) {
 			diag_set(ClientError, ER_SLAB_ALLOC_MAX,
 				 (unsigned) total);
@@ -169,6 +396,11 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 	char *raw = (char *) tuple + tuple->data_offset;
 	uint32_t *field_map = (uint32_t *) raw;
 	memcpy(raw, data, tuple_len);
+	region_truncate(region, region_svp);
+	if (format->is_compressed) {
+		memtx_tuple_zsize += tuple_len;
+		memtx_tuple_zsize_raw += raw_len;
+	}
 	if (tuple_init_field_map(format, field_map, raw)) {
 		memtx_tuple_delete(format, tuple);
 		return NULL;
@@ -184,6 +416,11 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 	assert(tuple->refs == 0);
 	size_t total = sizeof(struct memtx_tuple) +
 		       tuple_format_meta_size(format) + tuple->bsize;
+	if (format->is_compressed) {
+		memtx_tuple_zsize -= tuple->bsize;
+		memtx_tuple_zsize_raw -= tuple_data_size(tuple);
+		tuple_zcache_drop(tuple);
+	}
 	tuple_format_ref(format, -1);
 	struct memtx_tuple *memtx_tuple =
 		container_of(tuple, struct memtx_tuple, base);
@@ -212,9 +449,11 @@ box_tuple_update(const box_tuple_t *tuple, const char *expr,
 		 const char *expr_end)
 {
 	uint32_t new_size = 0, bsize;
-	const char *old_data = tuple_data_range(tuple, &bsize);
 	struct region *region = &fiber()->gc;
 	size_t used = region_used(region);
+	const char *old_data = tuple_data_range(tuple, &bsize);
+	if (old_data == NULL)
+		return NULL;
 	const char *new_data =
 		tuple_update_execute(region_aligned_alloc_cb, region, expr,
 				     expr_end, old_data, old_data + bsize,
@@ -237,9 +476,11 @@ box_tuple_upsert(const box_tuple_t *tuple, const char *expr,
 		 const char *expr_end)
 {
 	uint32_t new_size = 0, bsize;
-	const char *old_data = tuple_data_range(tuple, &bsize);
 	struct region *region = &fiber()->gc;
 	size_t used = region_used(region);
+	const char *old_data = tuple_data_range(tuple, &bsize);
+	if (old_data == NULL)
+		return NULL;
 	const char *new_data =
 		tuple_upsert_execute(region_aligned_alloc_cb, region, expr,
 				     expr_end, old_data, old_data + bsize,
@@ -467,6 +467,35 @@ public:
 	}
 };
 
+/**
+ * Read all new rows from the in-memory WAL tail.
+ *
+ * @retval 0 the tail has been read up
+ * @retval -1 some of the rows following the recovery
+ *            position have been evicted from the tail and
+ *            must be read from disk
+ */
+static int
+recover_wal_tail(struct recovery *r, struct xstream *stream,
+		 struct wal_tail_cursor *cursor)
+{
+	enum { WAL_TAIL_READ_ROWS = 64 };
+	struct xrow_header rows[WAL_TAIL_READ_ROWS];
+	ssize_t count;
+	while ((count = wal_tail_read(cursor, rows, lengthof(rows))) > 0) {
+		for (ssize_t i = 0; i < count; i++) {
+			struct xrow_header *row = &rows[i];
+			int64_t current_lsn = vclock_get(&r->vclock,
+							 row->replica_id);
+			if (row->lsn <= current_lsn)
+				continue; /* already sent, skip */
+			vclock_follow(&r->vclock, row->replica_id, row->lsn);
+			xstream_write_xc(stream, row);
+		}
+	}
+	return count < 0 ? -1 : 0;
+}
+
 static int
 recovery_follow_f(va_list ap)
 {
@@ -475,8 +504,31 @@ recovery_follow_f(va_list ap)
 	ev_tstamp wal_dir_rescan_delay = va_arg(ap, ev_tstamp);
 
 	WalSubscription subscription(r->wal_dir.dirname);
+	/*
+	 * When following the WAL of this instance, which is
+	 * the case of a replication relay, read new rows from
+	 * the in-memory WAL tail once the xlog files have been
+	 * read up. Fall back on the files only if the relay
+	 * lags behind the tail.
+	 */
+	struct wal_tail_cursor tail;
+	bool use_tail = false;
+	auto tail_guard = make_scoped_guard([&]{
+		if (use_tail)
+			wal_tail_close(&tail);
+	});
 
 	while (! fiber_is_cancelled()) {
+		if (use_tail) {
+			if (recover_wal_tail(r, stream, &tail) != 0) {
+				say_info("fell behind the in-memory WAL tail, "
+					 "reading xlog files");
+				wal_tail_close(&tail);
+				use_tail = false;
+				continue;
+			}
+			goto wait;
+		}
 
 		/*
 		 * Recover until there is no new stuff which appeared in
@@ -515,6 +567,17 @@ recovery_follow_f(va_list ap)
 		subscription.set_log_path(r->cursor.state != XLOG_CURSOR_CLOSED ?
 					  r->cursor.name: NULL);
 
+		if (subscription.watcher.loop != NULL) {
+			use_tail = wal_tail_open(&tail, &r->vclock) == 0;
+			if (use_tail) {
+				say_info("reading the in-memory WAL tail");
+				continue;
+			}
+			wal_tail_close(&tail);
+		}
+wait:
+		/* No new rows until the next wakeup. */
+		xstream_flush_xc(stream);
 		if (subscription.signaled == false) {
 			/**
 			 * Allow an immediate wakeup/break loop
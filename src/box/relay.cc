@@ -44,11 +44,27 @@
 #include "trigger.h"
 #include "errinj.h"
 #include "xrow_io.h"
+#include "msgpuck/msgpuck.h"
+
+enum {
+	/** Write the batch out once it grows beyond this size. */
+	RELAY_BATCH_SIZE = 64 * 1024,
+	/** Size of the length prefix of a compressed batch. */
+	RELAY_FRAME_HEADER_SIZE = 5,
+};
+
+/**
+ * Write the batch out if its first row has been waiting for
+ * longer than this, in seconds.
+ */
+static const ev_tstamp RELAY_BATCH_DELAY = 0.01;
 
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
 static void
 relay_send_row(struct xstream *stream, struct xrow_header *row);
+static void
+relay_flush_stream(struct xstream *stream);
 
 static inline void
 relay_create(struct relay *relay, int fd, uint64_t sync,
@@ -63,7 +79,99 @@ relay_create(struct relay *relay, int fd, uint64_t sync,
 static inline void
 relay_destroy(struct relay *relay)
 {
-	(void) relay;
+	if (relay->zctx != NULL)
+		ZSTD_freeCCtx(relay->zctx);
+}
+
+/**
+ * Create the output batch. The buffers use the slab cache
+ * of the current cord, so this must be called in the cord
+ * which is going to send the rows.
+ */
+static void
+relay_batch_create(struct relay *relay)
+{
+	ibuf_create(&relay->batch, &cord()->slabc, RELAY_BATCH_SIZE);
+	ibuf_create(&relay->zbatch, &cord()->slabc, RELAY_BATCH_SIZE);
+	relay->stream.flush = relay_flush_stream;
+	relay->stat.throughput_time = ev_monotonic_now(loop());
+}
+
+static void
+relay_batch_destroy(struct relay *relay)
+{
+	ibuf_destroy(&relay->zbatch);
+	ibuf_destroy(&relay->batch);
+}
+
+static void
+relay_update_stat(struct relay *relay, size_t size, size_t sent)
+{
+	struct relay_stat *stat = &relay->stat;
+	stat->bytes += size;
+	stat->bytes_sent += sent;
+	stat->throughput_bytes += sent;
+	ev_tstamp now = ev_monotonic_now(loop());
+	if (now - stat->throughput_time >= 1.0) {
+		stat->throughput = stat->throughput_bytes /
+				   (now - stat->throughput_time);
+		stat->throughput_bytes = 0;
+		stat->throughput_time = now;
+	}
+}
+
+/**
+ * Compress the batch into a single zstd frame, prefixed with
+ * its length encoded as MP_UINT32.
+ */
+static size_t
+relay_compress_batch(struct relay *relay)
+{
+	size_t size = ibuf_used(&relay->batch);
+	size_t zmax_size = ZSTD_compressBound(size);
+	ibuf_reset(&relay->zbatch);
+	char *data = (char *) ibuf_reserve_xc(&relay->zbatch,
+					      RELAY_FRAME_HEADER_SIZE +
+					      zmax_size);
+	size_t zsize = ZSTD_compressCCtx(relay->zctx,
+					 data + RELAY_FRAME_HEADER_SIZE,
+					 zmax_size, relay->batch.rpos, size,
+					 relay->compression);
+	if (ZSTD_isError(zsize)) {
+		tnt_raise(ClientError, ER_COMPRESSION,
+			  ZSTD_getErrorName(zsize));
+	}
+	*data = 0xce; /* MP_UINT32 */
+	mp_store_u32(data + 1, zsize);
+	relay->zbatch.wpos += RELAY_FRAME_HEADER_SIZE + zsize;
+	return RELAY_FRAME_HEADER_SIZE + zsize;
+}
+
+/** Write out all rows accumulated in the batch. */
+static void
+relay_flush(struct relay *relay)
+{
+	size_t size = ibuf_used(&relay->batch);
+	if (size == 0)
+		return;
+	struct iovec iov;
+	if (relay->compression == 0) {
+		iov.iov_base = relay->batch.rpos;
+		iov.iov_len = size;
+	} else {
+		iov.iov_len = relay_compress_batch(relay);
+		iov.iov_base = relay->zbatch.rpos;
+	}
+	coio_writev(&relay->io, &iov, 1, iov.iov_len);
+	ibuf_reset(&relay->batch);
+	relay_update_stat(relay, size, iov.iov_len);
+}
+
+static void
+relay_flush_stream(struct xstream *stream)
+{
+	struct relay *relay = container_of(stream, struct relay, stream);
+	relay_flush(relay);
 }
 
 static inline void
@@ -90,8 +198,14 @@ relay_initial_join(int fd, uint64_t sync)
 		relay_destroy(&relay);
 	});
 
+	relay_batch_create(&relay);
+	auto batch_guard = make_scoped_guard([&]{
+		relay_batch_destroy(&relay);
+	});
+
 	assert(relay.stream.write != NULL);
 	engine_join(&relay.stream);
+	relay_flush(&relay);
 }
 
 int
@@ -100,12 +214,17 @@ relay_final_join_f(va_list ap)
 	struct relay *relay = va_arg(ap, struct relay *);
 	coeio_enable();
 	relay_set_cord_name(relay->io.fd);
+	relay_batch_create(relay);
+	auto batch_guard = make_scoped_guard([=]{
+		relay_batch_destroy(relay);
+	});
 
 	/* Send all WALs until stop_vclock */
 	assert(relay->stream.write != NULL);
 	xdir_scan_xc(&relay->r->wal_dir);
 	recover_remaining_wals(relay->r, &relay->stream, &relay->stop_vclock);
 	assert(vclock_compare(&relay->r->vclock, &relay->stop_vclock) == 0);
+	relay_flush(relay);
 	return 0;
 }
 
@@ -152,6 +271,14 @@ relay_subscribe_f(va_list ap)
 	coeio_enable();
 	relay->stream.write = relay_send_row;
 	relay_set_cord_name(relay->io.fd);
+	/*
+	 * The follower fiber flushes the batch whenever it
+	 * runs out of rows to send, see recovery_follow_f().
+	 */
+	relay_batch_create(relay);
+	auto batch_guard = make_scoped_guard([=]{
+		relay_batch_destroy(relay);
+	});
 	recovery_follow_local(r, &relay->stream, fiber_name(fiber()),
 			      relay->wal_dir_rescan_delay);
 
@@ -210,7 +337,7 @@ relay_subscribe_f(va_list ap)
 /** Replication acceptor fiber handler. */
 void
 relay_subscribe(int fd, uint64_t sync, struct replica *replica,
-		struct vclock *replica_clock)
+		struct vclock *replica_clock, uint32_t compression)
 {
 	assert(replica->id != REPLICA_ID_NIL);
 	/* Don't allow multiple relays for the same replica */
@@ -226,13 +353,22 @@ relay_subscribe(int fd, uint64_t sync, struct replica *replica,
 			       replica_clock);
 	relay.replica_id = replica->id;
 	relay.wal_dir_rescan_delay = cfg_getd("wal_dir_rescan_delay");
-	replica_set_relay(replica, &relay);
-
 	auto scope_guard = make_scoped_guard([&]{
-		replica_clear_relay(replica);
 		recovery_delete(relay.r);
 		relay_destroy(&relay);
 	});
+	if (compression != 0) {
+		relay.zctx = ZSTD_createCCtx();
+		if (relay.zctx == NULL) {
+			tnt_raise(ClientError, ER_COMPRESSION,
+				  "failed to create context");
+		}
+		relay.compression = compression;
+	}
+	replica_set_relay(replica, &relay);
+	auto relay_guard = make_scoped_guard([=]{
+		replica_clear_relay(replica);
+	});
 
 	struct cord cord;
 	cord_costart(&cord, "subscribe", relay_subscribe_f, &relay);
@@ -240,12 +376,31 @@ relay_subscribe(int fd, uint64_t sync, struct replica *replica,
 		diag_raise();
 }
 
+/**
+ * Add a row to the output batch. The batch is written out
+ * when it is large or old enough, or when the row source has
+ * nothing more to send for now.
+ */
 static void
 relay_send(struct relay *relay, struct xrow_header *packet)
 {
 	packet->sync = relay->sync;
-	coio_write_xrow(&relay->io, packet);
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_to_iovec(packet, iov);
+	ev_tstamp now = ev_monotonic_now(loop());
+	if (ibuf_used(&relay->batch) == 0)
+		relay->batch_time = now;
+	for (int i = 0; i < iovcnt; i++) {
+		char *data = (char *) ibuf_reserve_xc(&relay->batch,
+						      iov[i].iov_len);
+		memcpy(data, iov[i].iov_base, iov[i].iov_len);
+		relay->batch.wpos += iov[i].iov_len;
+	}
+	relay->stat.rows++;
 	fiber_gc();
+	if (ibuf_used(&relay->batch) >= RELAY_BATCH_SIZE ||
+	    now - relay->batch_time >= RELAY_BATCH_DELAY)
+		relay_flush(relay);
 }
 
 static void
@@ -255,6 +410,7 @@ relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 	relay_send(relay, row);
 	ERROR_INJECT(ERRINJ_RELAY,
 	{
+		relay_flush(relay);
 		fiber_sleep(1000.0);
 	});
 }
@@ -274,7 +430,14 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 		relay_send(relay, packet);
 		ERROR_INJECT(ERRINJ_RELAY,
 		{
+			relay_flush(relay);
 			fiber_sleep(1000.0);
 		});
+		ERROR_INJECT(ERRINJ_RELAY_SEND_DELAY,
+		{
+			relay_flush(relay);
+			while (errinj_getb(ERRINJ_RELAY_SEND_DELAY))
+				fiber_sleep(0.01);
+		});
 	}
 }
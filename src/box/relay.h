@@ -30,14 +30,32 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <small/ibuf.h>
 #include "evio.h"
 #include "fiber.h"
 #include "vclock.h"
 #include "xstream.h"
+#include "zstd.h"
 
 struct replica;
 struct tt_uuid;
 
+/** Replication stream statistics of a relay. */
+struct relay_stat {
+	/** Rows sent to the replica. */
+	uint64_t rows;
+	/** Size of the sent rows before compression. */
+	uint64_t bytes;
+	/** Bytes written to the socket. */
+	uint64_t bytes_sent;
+	/** Bytes written per second, updated once a second. */
+	double throughput;
+	/** Start of the current throughput period. */
+	ev_tstamp throughput_time;
+	/** Bytes written in the current throughput period. */
+	uint64_t throughput_bytes;
+};
+
 /** State of a replication relay. */
 struct relay {
 	/** The thread in which we relay data to the replica. */
@@ -51,6 +69,25 @@ struct relay {
 	struct vclock stop_vclock;
 	ev_tstamp wal_dir_rescan_delay;
 	uint32_t replica_id;
+	/**
+	 * Encoded rows not yet written to the socket. Rows
+	 * are sent in batches to save on syscalls, see
+	 * relay_flush().
+	 */
+	struct ibuf batch;
+	/** When the first row of the current batch was added. */
+	ev_tstamp batch_time;
+	/**
+	 * Zstd compression level of the stream as negotiated
+	 * in SUBSCRIBE, 0 if the stream is not compressed.
+	 */
+	uint32_t compression;
+	/** Compression context, used if compression is on. */
+	ZSTD_CCtx *zctx;
+	/** Buffer for a compressed batch. */
+	struct ibuf zbatch;
+	/** Statistics, shown in box.info.replication. */
+	struct relay_stat stat;
 };
 
 /**
@@ -75,10 +112,12 @@ relay_final_join(int fd, uint64_t sync, struct vclock *start_vclock,
 /**
  * Subscribe a replica to updates.
  *
+ * @param compression  zstd level of the stream, 0 for none
+ *
  * @return none.
  */
 void
 relay_subscribe(int fd, uint64_t sync, struct replica *replica,
-		struct vclock *replica_vclock);
+		struct vclock *replica_vclock, uint32_t compression);
 
 #endif /* TARANTOOL_REPLICATION_RELAY_H_INCLUDED */
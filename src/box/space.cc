@@ -132,6 +132,12 @@ space_new(struct space_def *def, struct rlist *key_list)
 	space->has_unique_secondary_key = has_unique_secondary_key;
 	tuple_format_ref(space->format, 1);
 	space->format->exact_field_count = def->exact_field_count;
+	if (def->opts.fixed_layout &&
+	    tuple_format_enable_native_fields(space->format) != 0)
+		diag_raise();
+	if (def->opts.compression &&
+	    tuple_format_enable_compression(space->format) != 0)
+		diag_raise();
 	space->index_id_max = index_id_max;
 	/* init space engine instance */
 	space->handler = engine->open();
@@ -171,6 +177,12 @@ space_size(struct space *space)
 	return space_index(space, 0)->size();
 }
 
+bool
+space_is_empty(struct space *space)
+{
+	return space_index(space, 0)->isEmpty();
+}
+
 void
 space_dump_def(const struct space *space, struct rlist *key_list)
 {
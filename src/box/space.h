@@ -167,6 +167,10 @@ void space_noop(struct space *space);
 uint32_t
 space_size(struct space *space);
 
+/** Return true if the space has no tuples. Exact for all engines. */
+bool
+space_is_empty(struct space *space);
+
 /**
  * Allocate and initialize a space. The space
  * needs to be loaded before it can be used
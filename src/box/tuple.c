@@ -33,6 +33,8 @@
 #include "trivia/util.h"
 #include "fiber.h"
 #include "tt_uuid.h"
+#include "tt_pthread.h"
+#include "assoc.h"
 #include "third_party/PMurHash.h"
 
 enum {
@@ -41,6 +43,13 @@ enum {
 
 static struct mempool tuple_iterator_pool;
 
+/**
+ * Key of the thread-local context to decompress tuples.
+ * Each thread that reads compressed tuples, e.g. the
+ * checkpoint thread, creates one on demand.
+ */
+static pthread_key_t tuple_zdctx_key;
+
 /**
  * Last tuple returned by public C API
  * \sa tuple_bless()
@@ -89,9 +98,258 @@ tuple_validate_raw(struct tuple_format *format, const char *tuple)
  * to the snapshot file).
  */
 
+/**
+ * Find the compressed fields of a compressed tuple.
+ * @param tuple tuple
+ * @param[out] prefix_size size of the indexed fields, which
+ *             are stored uncompressed
+ * @param[out] tail_size   size of the rest of the fields
+ *             when decompressed
+ * @return zstd frame with the rest of the fields
+ */
+static const char *
+tuple_zframe(const struct tuple *tuple, uint32_t *prefix_size,
+	     uint32_t *tail_size)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	assert(format->is_compressed && format->field_count > 0);
+	const char *data = tuple_data(tuple);
+	const char *pos = tuple_field_raw(format, data, tuple_field_map(tuple),
+					  format->field_count - 1);
+	mp_next(&pos);
+	*prefix_size = pos - data;
+	assert((uint8_t) *pos == 0xce); /* MP_UINT32 */
+	pos++;
+	*tail_size = mp_load_u32(&pos);
+	return pos;
+}
+
+uint32_t
+tuple_data_size(const struct tuple *tuple)
+{
+	if (likely(!tuple_is_compressed(tuple)))
+		return tuple->bsize;
+	uint32_t prefix_size, tail_size;
+	tuple_zframe(tuple, &prefix_size, &tail_size);
+	return prefix_size + tail_size;
+}
+
+/**
+ * Decompress the fields of a compressed tuple into @a buf,
+ * which must have room for the whole tuple.
+ * @param[out] p_size size of the tuple data
+ * @retval  0 success
+ * @retval -1 the frame is corrupt or out of memory, diag is set
+ */
+static int
+tuple_decompress(const struct tuple *tuple, char *buf, uint32_t *p_size)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	uint32_t prefix_size, tail_size;
+	const char *frame = tuple_zframe(tuple, &prefix_size, &tail_size);
+	size_t frame_size = tuple_data(tuple) + tuple->bsize - frame;
+	memcpy(buf, tuple_data(tuple), prefix_size);
+
+	ZSTD_DCtx *zdctx = tt_pthread_getspecific(tuple_zdctx_key);
+	if (zdctx == NULL) {
+		zdctx = ZSTD_createDCtx();
+		if (zdctx == NULL) {
+			diag_set(OutOfMemory, sizeof(zdctx), "ZSTD_createDCtx",
+				 "zstd context");
+			return -1;
+		}
+		tt_pthread_setspecific(tuple_zdctx_key, zdctx);
+	}
+	size_t rc;
+	/* Tuples compressed before the dictionary was trained. */
+	if (ZSTD_getDictID_fromFrame(frame, frame_size) == 0) {
+		rc = ZSTD_decompressDCtx(zdctx, buf + prefix_size, tail_size,
+					 frame, frame_size);
+	} else if (format->zdict.ddict != NULL) {
+		rc = ZSTD_decompress_usingDDict(zdctx, buf + prefix_size,
+						tail_size, frame, frame_size,
+						format->zdict.ddict);
+	} else {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "unknown tuple dictionary");
+		return -1;
+	}
+	if (ZSTD_isError(rc) || rc != tail_size) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 ZSTD_isError(rc) ? ZSTD_getErrorName(rc) :
+			 "unexpected tuple size");
+		return -1;
+	}
+	*p_size = prefix_size + tail_size;
+	return 0;
+}
+
+const char *
+tuple_data_decompress(const struct tuple *tuple, uint32_t *p_size)
+{
+	uint32_t size = tuple_data_size(tuple);
+	char *buf = (char *) region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region", "decompressed tuple");
+		return NULL;
+	}
+	if (tuple_decompress(tuple, buf, p_size) != 0)
+		return NULL;
+	return buf;
+}
+
+/* {{{ Decompressed tuple cache */
+
+enum {
+	/**
+	 * Size of decompressed copies of tuples above which
+	 * copies of tuples not referenced outside their space
+	 * are evicted.
+	 */
+	TUPLE_ZCACHE_SIZE = 16 * 1024 * 1024,
+};
+
+/**
+ * A decompressed copy of a compressed tuple, which is used
+ * to access its non-indexed fields, @sa tuple_field().
+ */
+struct tuple_zcopy {
+	/** The compressed tuple. */
+	const struct tuple *tuple;
+	/** Link in tuple_zcache::lru. */
+	struct rlist in_lru;
+	/** Size of the decompressed data. */
+	uint32_t size;
+	/** Decompressed data. */
+	char data[0];
+};
+
+/**
+ * Decompressed copies of tuples, used in the tx thread only.
+ * A copy lives until its tuple is deleted, so that fields
+ * returned by box_tuple_field() are valid as long as the tuple
+ * is referenced. Copies of tuples referenced only by their
+ * space (refs <= 1) are evicted in LRU order if the cache is
+ * over TUPLE_ZCACHE_SIZE.
+ */
+static struct tuple_zcache {
+	/** struct tuple * -> struct tuple_zcopy *. */
+	struct mh_i64ptr_t *copies;
+	/** All copies, the most recently used first. */
+	struct rlist lru;
+	/** Total size of the copies. */
+	size_t used;
+} tuple_zcache;
+
+static void
+tuple_zcopy_delete(struct tuple_zcopy *copy, mh_int_t k)
+{
+	mh_i64ptr_del(tuple_zcache.copies, k, NULL);
+	rlist_del_entry(copy, in_lru);
+	tuple_zcache.used -= copy->size;
+	free(copy);
+}
+
+/** Evict copies of tuples not referenced outside their space. */
+static void
+tuple_zcache_evict(const struct tuple_zcopy *keep)
+{
+	struct rlist *lru = &tuple_zcache.lru;
+	struct tuple_zcopy *copy = rlist_empty(lru) ? NULL :
+		rlist_last_entry(lru, struct tuple_zcopy, in_lru);
+	while (copy != NULL && tuple_zcache.used > TUPLE_ZCACHE_SIZE) {
+		struct tuple_zcopy *prev =
+			rlist_prev_entry_safe(copy, lru, in_lru);
+		if (copy != keep && copy->tuple->refs <= 1) {
+			mh_int_t k = mh_i64ptr_find(tuple_zcache.copies,
+						    (uintptr_t) copy->tuple,
+						    NULL);
+			assert(k != mh_end(tuple_zcache.copies));
+			tuple_zcopy_delete(copy, k);
+		}
+		copy = prev;
+	}
+}
+
+const char *
+tuple_data_zcopy(const struct tuple *tuple)
+{
+	if (!cord_is_main()) {
+		/* The cache isn't thread-safe. */
+		uint32_t size;
+		return tuple_data_decompress(tuple, &size);
+	}
+	struct mh_i64ptr_t *h = tuple_zcache.copies;
+	mh_int_t k = mh_i64ptr_find(h, (uintptr_t) tuple, NULL);
+	if (k != mh_end(h)) {
+		struct tuple_zcopy *copy = mh_i64ptr_node(h, k)->val;
+		rlist_move_entry(&tuple_zcache.lru, copy, in_lru);
+		return copy->data;
+	}
+	uint32_t size = tuple_data_size(tuple);
+	struct tuple_zcopy *copy = malloc(sizeof(*copy) + size);
+	if (copy == NULL) {
+		diag_set(OutOfMemory, sizeof(*copy) + size, "malloc",
+			 "decompressed tuple");
+		return NULL;
+	}
+	if (tuple_decompress(tuple, copy->data, &copy->size) != 0) {
+		free(copy);
+		return NULL;
+	}
+	copy->tuple = tuple;
+	struct mh_i64ptr_node_t node = { (uintptr_t) tuple, copy };
+	if (mh_i64ptr_put(h, &node, NULL, NULL) == mh_end(h)) {
+		diag_set(OutOfMemory, 0, "mh_i64ptr_put", "tuple_zcopy");
+		free(copy);
+		return NULL;
+	}
+	rlist_add_entry(&tuple_zcache.lru, copy, in_lru);
+	tuple_zcache.used += copy->size;
+	tuple_zcache_evict(copy);
+	return copy->data;
+}
+
+void
+tuple_zcache_drop(const struct tuple *tuple)
+{
+	struct mh_i64ptr_t *h = tuple_zcache.copies;
+	if (h == NULL || !cord_is_main())
+		return;
+	mh_int_t k = mh_i64ptr_find(h, (uintptr_t) tuple, NULL);
+	if (k != mh_end(h))
+		tuple_zcopy_delete(mh_i64ptr_node(h, k)->val, k);
+}
+
+/* }}} Decompressed tuple cache */
+
+/**
+ * Rewind an iterator over the decompressed copy of a tuple
+ * owned by the iterator.
+ */
+static inline void
+tuple_rewind_buf(struct tuple_iterator *it)
+{
+	assert(it->buf != NULL);
+	it->pos = it->buf;
+	(void) mp_decode_array(&it->pos); /* Skip array header */
+	it->fieldno = 0;
+}
+
 const char *
 tuple_seek(struct tuple_iterator *it, uint32_t fieldno)
 {
+	if (unlikely(tuple_is_compressed(it->tuple))) {
+		/*
+		 * Don't mix pointers to the tuple and to the
+		 * decompressed copy the iterator walks over.
+		 */
+		if ((int) fieldno < it->fieldno)
+			tuple_rewind_buf(it);
+		while (it->fieldno < (int) fieldno && tuple_next(it) != NULL)
+			;
+		return tuple_next(it);
+	}
 	const char *field = tuple_field(it->tuple, fieldno);
 	if (likely(field != NULL)) {
 		it->pos = field;
@@ -199,10 +457,24 @@ tuple_extract_key_raw(const char *data, const char *data_end,
 	return key;
 }
 
+/** Destructor of the thread-local tuple_zdctx_key. */
+static void
+tuple_free_zdctx(void *arg)
+{
+	assert(arg != NULL);
+	ZSTD_freeDCtx(arg);
+}
+
 void
 tuple_init(void)
 {
 	tuple_format_init();
+	tt_pthread_key_create(&tuple_zdctx_key, tuple_free_zdctx);
+	tuple_zcache.copies = mh_i64ptr_new();
+	if (tuple_zcache.copies == NULL)
+		panic("failed to allocate decompressed tuple cache");
+	rlist_create(&tuple_zcache.lru);
+	tuple_zcache.used = 0;
 
 	mempool_create(&tuple_iterator_pool, &cord()->slabc,
 		       sizeof(struct tuple_iterator));
@@ -221,6 +493,18 @@ tuple_free(void)
 
 	mempool_destroy(&tuple_iterator_pool);
 
+	struct tuple_zcopy *copy, *next;
+	rlist_foreach_entry_safe(copy, &tuple_zcache.lru, in_lru, next)
+		free(copy);
+	mh_i64ptr_delete(tuple_zcache.copies);
+	tuple_zcache.copies = NULL;
+
+	/* Key destructors aren't called for the main thread. */
+	ZSTD_DCtx *zdctx = tt_pthread_getspecific(tuple_zdctx_key);
+	if (zdctx != NULL)
+		ZSTD_freeDCtx(zdctx);
+	tt_pthread_key_delete(tuple_zdctx_key);
+
 	tuple_format_free();
 }
 
@@ -255,7 +539,7 @@ size_t
 box_tuple_bsize(const box_tuple_t *tuple)
 {
 	assert(tuple != NULL);
-	return tuple->bsize;
+	return tuple_data_size(tuple);
 }
 
 ssize_t
@@ -296,7 +580,31 @@ box_tuple_iterator(box_tuple_t *tuple)
 		mempool_free(&tuple_iterator_pool, it);
 		return NULL;
 	}
-	tuple_rewind(it, tuple);
+	if (likely(!tuple_is_compressed(tuple))) {
+		tuple_rewind(it, tuple);
+		return it;
+	}
+	/*
+	 * The iterator may outlive the fiber region, keep the
+	 * decompressed tuple with it.
+	 */
+	uint32_t size = tuple_data_size(tuple);
+	it->buf = (char *) malloc(size);
+	if (it->buf == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "tuple iterator");
+		tuple_unref(tuple);
+		mempool_free(&tuple_iterator_pool, it);
+		return NULL;
+	}
+	it->tuple = tuple;
+	if (tuple_decompress(tuple, it->buf, &size) != 0) {
+		free(it->buf);
+		tuple_unref(tuple);
+		mempool_free(&tuple_iterator_pool, it);
+		return NULL;
+	}
+	it->end = it->buf + size;
+	tuple_rewind_buf(it);
 	return it;
 }
 
@@ -304,6 +612,7 @@ void
 box_tuple_iterator_free(box_tuple_iterator_t *it)
 {
 	tuple_unref(it->tuple);
+	free(it->buf);
 	mempool_free(&tuple_iterator_pool, it);
 }
 
@@ -316,7 +625,10 @@ box_tuple_position(box_tuple_iterator_t *it)
 void
 box_tuple_rewind(box_tuple_iterator_t *it)
 {
-	tuple_rewind(it, it->tuple);
+	if (unlikely(it->buf != NULL))
+		tuple_rewind_buf(it);
+	else
+		tuple_rewind(it, it->tuple);
 }
 
 const char *
@@ -385,6 +697,40 @@ tuple_hash_slow_path(const struct tuple *tuple, const struct index_def *index_de
 	return PMurHash32_Result(h, carry, total_size);
 }
 
+void
+tuple_hash_prefixes(const struct tuple *tuple,
+		    const struct index_def *index_def, uint32_t *hashes)
+{
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+
+	for (uint32_t i = 0; i < index_def->key_def.part_count; i++) {
+		const struct key_part *part = &index_def->key_def.parts[i];
+		const char *field = tuple_field(tuple, part->fieldno);
+		total_size += tuple_hash_field(&h, &carry, &field, part->type);
+		hashes[i] = PMurHash32_Result(h, carry, total_size);
+	}
+}
+
+uint32_t
+key_hash_prefix(const char *key, const struct index_def *index_def,
+		uint32_t part_count)
+{
+	assert(part_count <= index_def->key_def.part_count);
+
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+
+	for (uint32_t i = 0; i < part_count; i++) {
+		const struct key_part *part = &index_def->key_def.parts[i];
+		total_size += tuple_hash_field(&h, &carry, &key, part->type);
+	}
+
+	return PMurHash32_Result(h, carry, total_size);
+}
+
 uint32_t
 key_hash_slow_path(const char *key, const struct index_def *index_def)
 {
@@ -139,6 +139,8 @@ box_tuple_format(const box_tuple_t *tuple);
  * \param tuple a tuple
  * \param fieldno zero-based index in MsgPack array.
  * \retval NULL if i >= box_tuple_field_count(tuple)
+ * \retval NULL if failed to decompress a compressed tuple
+ *         (check box_error_last())
  * \retval msgpack otherwise
  */
 const char *
@@ -293,6 +295,8 @@ tuple_size(const struct tuple *tuple)
 
 /**
  * Get pointer to MessagePack data of the tuple.
+ * Only the indexed fields can be accessed this way if the
+ * tuple is compressed, @sa tuple_format::is_compressed.
  * @param tuple tuple.
  * @return MessagePack array.
  */
@@ -302,19 +306,65 @@ tuple_data(const struct tuple *tuple)
 	return (const char *) tuple + tuple->data_offset;
 }
 
+/**
+ * Check if the tuple is stored compressed.
+ * @sa tuple_format::is_compressed
+ */
+static inline bool
+tuple_is_compressed(const struct tuple *tuple)
+{
+	return tuple_format_by_id(tuple->format_id)->is_compressed;
+}
+
+/**
+ * Decompress the data of a compressed tuple into the fiber
+ * region. Support function of tuple_data_range().
+ * @retval NULL on error, diag is set
+ */
+const char *
+tuple_data_decompress(const struct tuple *tuple, uint32_t *p_size);
+
+/**
+ * Get the cached decompressed copy of a compressed tuple,
+ * which is valid while the tuple is referenced. Support
+ * function of tuple_field().
+ * @retval NULL on error, diag is set
+ */
+const char *
+tuple_data_zcopy(const struct tuple *tuple);
+
+/**
+ * Drop the decompressed copy of a compressed tuple being
+ * deleted, @sa tuple_data_zcopy().
+ */
+void
+tuple_zcache_drop(const struct tuple *tuple);
+
 /**
  * Get pointer to MessagePack data of the tuple.
+ * A compressed tuple is decompressed into the fiber region,
+ * the data is valid until the region is truncated.
  * @param tuple tuple.
  * @param[out] size Size in bytes of the MessagePack array.
  * @return MessagePack array.
+ * @retval NULL if failed to decompress the tuple, diag is set
  */
 static inline const char *
 tuple_data_range(const struct tuple *tuple, uint32_t *p_size)
 {
+	if (unlikely(tuple_is_compressed(tuple)))
+		return tuple_data_decompress(tuple, p_size);
 	*p_size = tuple->bsize;
 	return (const char *) tuple + tuple->data_offset;
 }
 
+/**
+ * Size of MessagePack data of the tuple, which is
+ * larger than tuple->bsize if the tuple is compressed.
+ */
+uint32_t
+tuple_data_size(const struct tuple *tuple);
+
 /**
  * Extract key from tuple by given key definition and return
  * buffer allocated on box_txn_alloc with this key. This function
@@ -407,7 +457,11 @@ tuple_validate_raw(struct tuple_format *format, const char *data);
 static inline int
 tuple_validate(struct tuple_format *format, struct tuple *tuple)
 {
-	return tuple_validate_raw(format, tuple_data(tuple));
+	uint32_t bsize;
+	const char *data = tuple_data_range(tuple, &bsize);
+	if (data == NULL)
+		return -1;
+	return tuple_validate_raw(format, data);
 }
 
 /*
@@ -440,13 +494,22 @@ tuple_field_count(const struct tuple *tuple)
  * @param fieldno the index of field to return
  * @param len pointer where the len of the field will be stored
  * @retval pointer to MessagePack data
- * @retval NULL when fieldno is out of range
+ * @retval NULL when fieldno is out of range or failed to
+ *         decompress a compressed tuple, in which case diag
+ *         is set
  */
 static inline const char *
 tuple_field(const struct tuple *tuple, uint32_t fieldno)
 {
-	return tuple_field_raw(tuple_format(tuple), tuple_data(tuple),
-			       tuple_field_map(tuple), fieldno);
+	struct tuple_format *format = tuple_format(tuple);
+	const char *data = tuple_data(tuple);
+	if (unlikely(format->is_compressed && fieldno >= format->field_count)) {
+		/* Not an indexed field, use the decompressed copy. */
+		data = tuple_data_zcopy(tuple);
+		if (data == NULL)
+			return NULL;
+	}
+	return tuple_field_raw(format, data, tuple_field_map(tuple), fieldno);
 }
 
 /**
@@ -460,6 +523,11 @@ struct tuple_iterator {
 	const char *pos;
 	/** End of the tuple. */
 	const char *end;
+	/**
+	 * Decompressed data of a compressed tuple, owned by
+	 * the iterator, or NULL, @sa box_tuple_iterator().
+	 */
+	char *buf;
 	/** @endcond **/
 	/** field no of the next field. */
 	int fieldno;
@@ -485,13 +553,15 @@ struct tuple_iterator {
 static inline void
 tuple_rewind(struct tuple_iterator *it, struct tuple *tuple)
 {
+	/* Compressed tuples are iterated by box_tuple_iterator(). */
+	assert(!tuple_is_compressed(tuple));
 	it->tuple = tuple;
-	uint32_t bsize;
-	const char *data = tuple_data_range(tuple, &bsize);
+	it->buf = NULL;
+	const char *data = tuple_data(tuple);
 	it->pos = data;
 	(void) mp_decode_array(&it->pos); /* Skip array header */
 	it->fieldno = 0;
-	it->end = data + bsize;
+	it->end = data + tuple->bsize;
 }
 
 /**
@@ -623,8 +693,17 @@ tuple_hash(const struct tuple *tuple, const struct index_def *index_def)
 	 * single-part hash_table over an integer field.
 	 */
 	if (index_def->key_def.part_count == 1 && part->type == FIELD_TYPE_UNSIGNED) {
-		const char *field = tuple_field(tuple, part->fieldno);
-		uint64_t val = mp_decode_uint(&field);
+		struct tuple_format *format = tuple_format(tuple);
+		uint64_t val;
+		if (format->has_native_fields &&
+		    tuple_format_field_is_native(format, part->fieldno,
+						 FIELD_TYPE_UNSIGNED)) {
+			val = tuple_native_load_uint(tuple_field_native_raw(
+				format, tuple_field_map(tuple), part->fieldno));
+		} else {
+			const char *field = tuple_field(tuple, part->fieldno);
+			val = mp_decode_uint(&field);
+		}
 		if (likely(val <= UINT32_MAX))
 			return val;
 		return ((uint32_t)((val)>>33^(val)^(val)<<11));
@@ -661,6 +740,31 @@ key_hash(const char *key, const struct index_def *index_def)
 	return key_hash_slow_path(key, index_def);
 }
 
+/**
+ * Calculate hash values of all key prefixes of a tuple
+ * in one pass.
+ * @param tuple - a tuple
+ * @param index_def - index_def for field description
+ * @param[out] hashes - array of part_count values, hashes[i]
+ *                      is the hash of the first i + 1 key parts
+ */
+void
+tuple_hash_prefixes(const struct tuple *tuple,
+		    const struct index_def *index_def, uint32_t *hashes);
+
+/**
+ * Calculate a hash value of a partial key. The value matches
+ * the one calculated by tuple_hash_prefixes() for the same
+ * number of parts.
+ * @param key - partial key (msgpack fields w/o array marker)
+ * @param index_def - index_def for field description
+ * @param part_count - number of parts in the key
+ * @return - hash value
+ */
+uint32_t
+key_hash_prefix(const char *key, const struct index_def *index_def,
+		uint32_t part_count);
+
 /** These functions are implemented in tuple_convert.cc. */
 
 struct obuf;
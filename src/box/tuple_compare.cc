@@ -283,7 +283,7 @@ mp_compare_scalar(const char *field_a, const char *field_b)
  * @retval <0 if field_a < field_b
  * @retval >0 if field_a > field_b
  */
-static int
+static inline int
 tuple_compare_field(const char *field_a, const char *field_b,
 		    int8_t type)
 {
@@ -335,10 +335,18 @@ tuple_compare_slowpath_raw(const struct tuple_format *format_a,
 	return r;
 }
 
+static int
+tuple_compare_slowpath_native(const struct tuple *tuple_a,
+			      const struct tuple *tuple_b,
+			      const struct key_def *key_def);
+
 static int
 tuple_compare_slowpath(const struct tuple *tuple_a, const struct tuple *tuple_b,
 		       const struct key_def *key_def)
 {
+	if (unlikely(tuple_format(tuple_a)->has_native_fields &&
+		     tuple_format(tuple_b)->has_native_fields))
+		return tuple_compare_slowpath_native(tuple_a, tuple_b, key_def);
 	return tuple_compare_slowpath_raw(tuple_format(tuple_a),
 					  tuple_data(tuple_a),
 					  tuple_field_map(tuple_a),
@@ -453,9 +461,18 @@ tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
 						   part_count, key_def);
 }
 
+/*
+ * Generic field comparators: TYPE is a compile-time constant,
+ * so the type switch in tuple_compare_field() is folded and
+ * the comparator is called directly. Hot types have explicit
+ * specializations below.
+ */
 template <int TYPE>
 static inline int
-field_compare(const char **field_a, const char **field_b);
+field_compare(const char **field_a, const char **field_b)
+{
+	return tuple_compare_field(*field_a, *field_b, TYPE);
+}
 
 template <>
 inline int
@@ -479,7 +496,13 @@ field_compare<FIELD_TYPE_STRING>(const char **field_a, const char **field_b)
 
 template <int TYPE>
 static inline int
-field_compare_and_next(const char **field_a, const char **field_b);
+field_compare_and_next(const char **field_a, const char **field_b)
+{
+	int r = tuple_compare_field(*field_a, *field_b, TYPE);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
 
 template <>
 inline int
@@ -508,9 +531,247 @@ field_compare_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+/*
+ * Native field comparators: compare copies of numeric fields
+ * stored in the field map, @sa tuple_field_format::native_slot.
+ * A copy may lose precision, then equal copies are resolved by
+ * comparing MessagePack.
+ */
+template <int TYPE>
+static inline int
+field_compare_native(const struct tuple *tuple_a, const struct tuple *tuple_b,
+		     const struct tuple_format *format_a,
+		     const struct tuple_format *format_b, uint32_t fieldno);
+
+template <>
+inline int
+field_compare_native<FIELD_TYPE_UNSIGNED>(const struct tuple *tuple_a,
+					  const struct tuple *tuple_b,
+					  const struct tuple_format *format_a,
+					  const struct tuple_format *format_b,
+					  uint32_t fieldno)
+{
+	uint64_t a = tuple_native_load_uint(tuple_field_native_raw(format_a,
+				tuple_field_map(tuple_a), fieldno));
+	uint64_t b = tuple_native_load_uint(tuple_field_native_raw(format_b,
+				tuple_field_map(tuple_b), fieldno));
+	return a < b ? -1 : a > b;
+}
+
+template <>
+inline int
+field_compare_native<FIELD_TYPE_INTEGER>(const struct tuple *tuple_a,
+					 const struct tuple *tuple_b,
+					 const struct tuple_format *format_a,
+					 const struct tuple_format *format_b,
+					 uint32_t fieldno)
+{
+	int64_t a = tuple_native_load_int(tuple_field_native_raw(format_a,
+				tuple_field_map(tuple_a), fieldno));
+	int64_t b = tuple_native_load_int(tuple_field_native_raw(format_b,
+				tuple_field_map(tuple_b), fieldno));
+	if (likely(a != b || a != INT64_MAX))
+		return a < b ? -1 : a > b;
+	/* Both values are INT64_MAX or greater. */
+	return mp_compare_integer(tuple_field_raw(format_a, tuple_data(tuple_a),
+						  tuple_field_map(tuple_a),
+						  fieldno),
+				  tuple_field_raw(format_b, tuple_data(tuple_b),
+						  tuple_field_map(tuple_b),
+						  fieldno));
+}
+
+template <>
+inline int
+field_compare_native<FIELD_TYPE_NUMBER>(const struct tuple *tuple_a,
+					const struct tuple *tuple_b,
+					const struct tuple_format *format_a,
+					const struct tuple_format *format_b,
+					uint32_t fieldno)
+{
+	double a = tuple_native_load_double(tuple_field_native_raw(format_a,
+				tuple_field_map(tuple_a), fieldno));
+	double b = tuple_native_load_double(tuple_field_native_raw(format_b,
+				tuple_field_map(tuple_b), fieldno));
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	/* Integers may be rounded, NaN is unordered. */
+	return mp_compare_number(tuple_field_raw(format_a, tuple_data(tuple_a),
+						 tuple_field_map(tuple_a),
+						 fieldno),
+				 tuple_field_raw(format_b, tuple_data(tuple_b),
+						 tuple_field_map(tuple_b),
+						 fieldno));
+}
+
+/**
+ * Compare tuples using native copies of fields where both
+ * tuples have them, @sa tuple_compare_slowpath().
+ */
+static int
+tuple_compare_slowpath_native(const struct tuple *tuple_a,
+			      const struct tuple *tuple_b,
+			      const struct key_def *key_def)
+{
+	const struct tuple_format *format_a = tuple_format(tuple_a);
+	const struct tuple_format *format_b = tuple_format(tuple_b);
+	const struct key_part *part = key_def->parts;
+	const struct key_part *end = part + key_def->part_count;
+	int r = 0;
+	for (; part < end; part++) {
+		if (tuple_format_field_is_native(format_a, part->fieldno,
+						 part->type) &&
+		    tuple_format_field_is_native(format_b, part->fieldno,
+						 part->type)) {
+			switch (part->type) {
+			case FIELD_TYPE_UNSIGNED:
+				r = field_compare_native<FIELD_TYPE_UNSIGNED>(
+					tuple_a, tuple_b, format_a, format_b,
+					part->fieldno);
+				break;
+			case FIELD_TYPE_INTEGER:
+				r = field_compare_native<FIELD_TYPE_INTEGER>(
+					tuple_a, tuple_b, format_a, format_b,
+					part->fieldno);
+				break;
+			case FIELD_TYPE_NUMBER:
+				r = field_compare_native<FIELD_TYPE_NUMBER>(
+					tuple_a, tuple_b, format_a, format_b,
+					part->fieldno);
+				break;
+			default:
+				unreachable();
+			}
+		} else {
+			const char *field_a, *field_b;
+			field_a = tuple_field_raw(format_a, tuple_data(tuple_a),
+						  tuple_field_map(tuple_a),
+						  part->fieldno);
+			field_b = tuple_field_raw(format_b, tuple_data(tuple_b),
+						  tuple_field_map(tuple_b),
+						  part->fieldno);
+			assert(field_a != NULL && field_b != NULL);
+			r = tuple_compare_field(field_a, field_b, part->type);
+		}
+		if (r != 0)
+			break;
+	}
+	return r;
+}
+
 /* Tuple comparator */
 namespace /* local symbols */ {
 
+/**
+ * Check at compile time if all key parts can be stored
+ * natively, @sa field_type_is_native().
+ */
+template <int IDX, int TYPE, int ...MORE_TYPES>
+struct FieldIsNative
+{
+	enum {
+		value = FieldIsNative<IDX, TYPE>::value &&
+			FieldIsNative<MORE_TYPES...>::value
+	};
+};
+
+template <int IDX, int TYPE>
+struct FieldIsNative<IDX, TYPE>
+{
+	enum {
+		value = TYPE == FIELD_TYPE_UNSIGNED ||
+			TYPE == FIELD_TYPE_INTEGER ||
+			TYPE == FIELD_TYPE_NUMBER
+	};
+};
+
+template <int IDX, int TYPE, int ...MORE_TYPES> struct FieldCompareNative { };
+
+template <int IDX, int TYPE, int IDX2, int TYPE2, int ...MORE_TYPES>
+struct FieldCompareNative<IDX, TYPE, IDX2, TYPE2, MORE_TYPES...>
+{
+	inline static bool
+	is_native(const struct tuple_format *format)
+	{
+		return tuple_format_field_is_native(format, IDX,
+						    (enum field_type) TYPE) &&
+		       FieldCompareNative<IDX2, TYPE2, MORE_TYPES...>::
+				is_native(format);
+	}
+
+	inline static int compare(const struct tuple *tuple_a,
+				  const struct tuple *tuple_b,
+				  const struct tuple_format *format_a,
+				  const struct tuple_format *format_b)
+	{
+		int r = field_compare_native<TYPE>(tuple_a, tuple_b,
+						   format_a, format_b, IDX);
+		if (r != 0)
+			return r;
+		return FieldCompareNative<IDX2, TYPE2, MORE_TYPES...>::
+			compare(tuple_a, tuple_b, format_a, format_b);
+	}
+};
+
+template <int IDX, int TYPE>
+struct FieldCompareNative<IDX, TYPE>
+{
+	inline static bool
+	is_native(const struct tuple_format *format)
+	{
+		return tuple_format_field_is_native(format, IDX,
+						    (enum field_type) TYPE);
+	}
+
+	inline static int compare(const struct tuple *tuple_a,
+				  const struct tuple *tuple_b,
+				  const struct tuple_format *format_a,
+				  const struct tuple_format *format_b)
+	{
+		return field_compare_native<TYPE>(tuple_a, tuple_b,
+						  format_a, format_b, IDX);
+	}
+};
+
+/**
+ * Compare tuples by native copies of fields if both tuples
+ * have them. Only instantiated for numeric keys.
+ */
+template <bool IS_NATIVE, int ...MORE_TYPES>
+struct TupleCompareNative
+{
+	inline static bool compare(const struct tuple *,
+				   const struct tuple *,
+				   const struct tuple_format *,
+				   const struct tuple_format *, int *)
+	{
+		return false;
+	}
+};
+
+template <int ...MORE_TYPES>
+struct TupleCompareNative<true, MORE_TYPES...>
+{
+	inline static bool compare(const struct tuple *tuple_a,
+				   const struct tuple *tuple_b,
+				   const struct tuple_format *format_a,
+				   const struct tuple_format *format_b, int *r)
+	{
+		/* Skip per-part checks for tuples without native fields. */
+		if (likely(!format_a->has_native_fields ||
+			   !format_b->has_native_fields))
+			return false;
+		if (!FieldCompareNative<MORE_TYPES...>::is_native(format_a) ||
+		    !FieldCompareNative<MORE_TYPES...>::is_native(format_b))
+			return false;
+		*r = FieldCompareNative<MORE_TYPES...>::
+			compare(tuple_a, tuple_b, format_a, format_b);
+		return true;
+	}
+};
+
 template <int IDX, int TYPE, int ...MORE_TYPES> struct FieldCompare { };
 
 /**
@@ -574,6 +835,11 @@ struct TupleCompare
 	{
 		struct tuple_format *format_a = tuple_format(tuple_a);
 		struct tuple_format *format_b = tuple_format(tuple_b);
+		int r;
+		if (TupleCompareNative<FieldIsNative<IDX, TYPE, MORE_TYPES...>::
+				       value, IDX, TYPE, MORE_TYPES...>::
+		    compare(tuple_a, tuple_b, format_a, format_b, &r))
+			return r;
 		const char *field_a, *field_b;
 		field_a = tuple_field_raw(format_a, tuple_data(tuple_a),
 					  tuple_field_map(tuple_a), IDX);
@@ -593,6 +859,11 @@ struct TupleCompare<0, TYPE, MORE_TYPES...> {
 	{
 		struct tuple_format *format_a = tuple_format(tuple_a);
 		struct tuple_format *format_b = tuple_format(tuple_b);
+		int r;
+		if (TupleCompareNative<FieldIsNative<0, TYPE, MORE_TYPES...>::
+				       value, 0, TYPE, MORE_TYPES...>::
+		    compare(tuple_a, tuple_b, format_a, format_b, &r))
+			return r;
 		const char *field_a = tuple_data(tuple_a);
 		const char *field_b = tuple_data(tuple_b);
 		mp_decode_array(&field_a);
@@ -610,26 +881,47 @@ struct comparator_signature {
 #define COMPARATOR(...) \
 	{ TupleCompare<__VA_ARGS__>::compare, { __VA_ARGS__, UINT32_MAX } },
 
+/*
+ * Specialized comparators are generated for every sequence
+ * of up to three key part types over fields 0, 1, 2.
+ */
+#define COMPARATOR_3(t1, t2) \
+	COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_UNSIGNED) \
+	COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_STRING) \
+	COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_INTEGER) \
+	COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_NUMBER) \
+	COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_SCALAR)
+
+#define COMPARATOR_2(t1) \
+	COMPARATOR(0, t1, 1, FIELD_TYPE_UNSIGNED) \
+	COMPARATOR(0, t1, 1, FIELD_TYPE_STRING) \
+	COMPARATOR(0, t1, 1, FIELD_TYPE_INTEGER) \
+	COMPARATOR(0, t1, 1, FIELD_TYPE_NUMBER) \
+	COMPARATOR(0, t1, 1, FIELD_TYPE_SCALAR) \
+	COMPARATOR_3(t1, FIELD_TYPE_UNSIGNED) \
+	COMPARATOR_3(t1, FIELD_TYPE_STRING) \
+	COMPARATOR_3(t1, FIELD_TYPE_INTEGER) \
+	COMPARATOR_3(t1, FIELD_TYPE_NUMBER) \
+	COMPARATOR_3(t1, FIELD_TYPE_SCALAR)
+
+#define COMPARATOR_1(t1) \
+	COMPARATOR(0, t1) \
+	COMPARATOR_2(t1)
+
 /**
  * field1 no, field1 type, field2 no, field2 type, ...
  */
 static const comparator_signature cmp_arr[] = {
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_STRING)
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING)
-	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING)
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
-	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
-	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
-	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR_1(FIELD_TYPE_UNSIGNED)
+	COMPARATOR_1(FIELD_TYPE_STRING)
+	COMPARATOR_1(FIELD_TYPE_INTEGER)
+	COMPARATOR_1(FIELD_TYPE_NUMBER)
+	COMPARATOR_1(FIELD_TYPE_SCALAR)
 };
 
+#undef COMPARATOR_1
+#undef COMPARATOR_2
+#undef COMPARATOR_3
 #undef COMPARATOR
 
 tuple_compare_t
@@ -653,7 +945,11 @@ tuple_compare_create(const struct key_def *def) {
 /* {{{ tuple_compare_with_key */
 
 template <int TYPE>
-static inline int field_compare_with_key(const char **field, const char **key);
+static inline int
+field_compare_with_key(const char **field, const char **key)
+{
+	return tuple_compare_field(*field, *key, TYPE);
+}
 
 template <>
 inline int
@@ -677,7 +973,13 @@ field_compare_with_key<FIELD_TYPE_STRING>(const char **field, const char **key)
 
 template <int TYPE>
 static inline int
-field_compare_with_key_and_next(const char **field_a, const char **field_b);
+field_compare_with_key_and_next(const char **field_a, const char **field_b)
+{
+	int r = tuple_compare_field(*field_a, *field_b, TYPE);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
 
 template <>
 inline int
@@ -809,22 +1111,40 @@ struct comparator_with_key_signature
 #define KEY_COMPARATOR(...) \
 	{ TupleCompareWithKey<0, __VA_ARGS__>::compare, { __VA_ARGS__ } },
 
+/*
+ * A comparator matches any key definition which is a prefix
+ * of its signature, so three-part comparators over fields
+ * 0, 1, 2 also serve one- and two-part keys.
+ */
+#define KEY_COMPARATOR_3(t1, t2) \
+	KEY_COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_UNSIGNED) \
+	KEY_COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_STRING) \
+	KEY_COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_INTEGER) \
+	KEY_COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_NUMBER) \
+	KEY_COMPARATOR(0, t1, 1, t2, 2, FIELD_TYPE_SCALAR)
+
+#define KEY_COMPARATOR_2(t1) \
+	KEY_COMPARATOR_3(t1, FIELD_TYPE_UNSIGNED) \
+	KEY_COMPARATOR_3(t1, FIELD_TYPE_STRING) \
+	KEY_COMPARATOR_3(t1, FIELD_TYPE_INTEGER) \
+	KEY_COMPARATOR_3(t1, FIELD_TYPE_NUMBER) \
+	KEY_COMPARATOR_3(t1, FIELD_TYPE_SCALAR) \
+	KEY_COMPARATOR(1, t1, 2, FIELD_TYPE_UNSIGNED) \
+	KEY_COMPARATOR(1, t1, 2, FIELD_TYPE_STRING) \
+	KEY_COMPARATOR(1, t1, 2, FIELD_TYPE_INTEGER) \
+	KEY_COMPARATOR(1, t1, 2, FIELD_TYPE_NUMBER) \
+	KEY_COMPARATOR(1, t1, 2, FIELD_TYPE_SCALAR)
+
 static const comparator_with_key_signature cmp_wk_arr[] = {
-	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
-	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
-	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
-	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
-	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
-	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
-	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
-	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
-
-	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
-	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
-	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
-	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR_2(FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR_2(FIELD_TYPE_STRING)
+	KEY_COMPARATOR_2(FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR_2(FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR_2(FIELD_TYPE_SCALAR)
 };
 
+#undef KEY_COMPARATOR_2
+#undef KEY_COMPARATOR_3
 #undef KEY_COMPARATOR
 
 tuple_compare_with_key_t
@@ -36,6 +36,8 @@ tuple_to_obuf(struct tuple *tuple, struct obuf *buf)
 {
 	uint32_t bsize;
 	const char *data = tuple_data_range(tuple, &bsize);
+	if (data == NULL)
+		return -1;
 	if (obuf_dup(buf, data, bsize) != bsize) {
 		diag_set(OutOfMemory, bsize, "tuple_to_obuf", "dup");
 		return -1;
@@ -48,6 +50,8 @@ tuple_to_buf(const struct tuple *tuple, char *buf, size_t size)
 {
 	uint32_t bsize;
 	const char *data = tuple_data_range(tuple, &bsize);
+	if (data == NULL)
+		return -1;
 	if (likely(bsize <= size)) {
 		memcpy(buf, data, bsize);
 	}
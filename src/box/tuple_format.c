@@ -51,6 +51,7 @@ tuple_format_create(struct tuple_format *format, struct key_def **keys,
 	for (uint32_t i = 0; i < format->field_count; i++) {
 		format->fields[i].type = FIELD_TYPE_ANY;
 		format->fields[i].offset_slot = TUPLE_OFFSET_SLOT_NIL;
+		format->fields[i].native_slot = TUPLE_OFFSET_SLOT_NIL;
 	}
 
 	int current_slot = 0;
@@ -182,12 +183,29 @@ tuple_format_alloc(struct key_def **keys, uint16_t key_count)
 	format->id = FORMAT_ID_NIL;
 	format->field_count = field_count;
 	format->exact_field_count = 0;
+	format->is_compressed = false;
+	format->zformat = NULL;
+	memset(&format->zdict, 0, sizeof(format->zdict));
+	format->has_native_fields = false;
 	return format;
 }
 
+static void
+tuple_zdict_destroy(struct tuple_zdict *zdict)
+{
+	if (zdict->cdict != NULL)
+		ZSTD_freeCDict(zdict->cdict);
+	if (zdict->ddict != NULL)
+		ZSTD_freeDDict(zdict->ddict);
+	free(zdict->sampler);
+}
+
 void
 tuple_format_delete(struct tuple_format *format)
 {
+	if (format->zformat != NULL)
+		tuple_format_ref(format->zformat, -1);
+	tuple_zdict_destroy(&format->zdict);
 	tuple_format_deregister(format);
 	free(format);
 }
@@ -226,6 +244,9 @@ tuple_format_dup(const struct tuple_format *src)
 	}
 	memcpy(format, src, total);
 	format->id = FORMAT_ID_NIL;
+	format->is_compressed = false;
+	format->zformat = NULL;
+	memset(&format->zdict, 0, sizeof(format->zdict));
 	if (tuple_format_register(format) != 0) {
 		free(format);
 		return NULL;
@@ -233,6 +254,97 @@ tuple_format_dup(const struct tuple_format *src)
 	return format;
 }
 
+int
+tuple_format_enable_compression(struct tuple_format *format)
+{
+	assert(format->zformat == NULL && !format->is_compressed);
+	struct tuple_format *zformat = tuple_format_dup(format);
+	if (zformat == NULL)
+		return -1;
+	zformat->is_compressed = true;
+	zformat->refs = 0;
+	tuple_format_ref(zformat, 1);
+	format->zformat = zformat;
+	return 0;
+}
+
+int
+tuple_format_enable_native_fields(struct tuple_format *format)
+{
+	int current_slot = -(int) (format->field_map_size / sizeof(uint32_t));
+	for (uint32_t i = 0; i < format->field_count; i++) {
+		struct tuple_field_format *field = &format->fields[i];
+		if (!field_type_is_native(field->type))
+			continue;
+		assert(field->native_slot == TUPLE_OFFSET_SLOT_NIL);
+		current_slot -= sizeof(uint64_t) / sizeof(uint32_t);
+		field->native_slot = current_slot;
+		format->has_native_fields = true;
+	}
+	size_t field_map_size = -current_slot * sizeof(uint32_t);
+	if (field_map_size + format->extra_size > UINT16_MAX) {
+		/** tuple->data_offset is 16 bits */
+		diag_set(ClientError, ER_INDEX_FIELD_COUNT_LIMIT,
+			 -current_slot);
+		return -1;
+	}
+	format->field_map_size = field_map_size;
+	return 0;
+}
+
+/**
+ * Store a native copy of a field of a validated tuple,
+ * @sa tuple_field_format::native_slot.
+ */
+static void
+tuple_field_store_native(const struct tuple_field_format *field,
+			 uint32_t *field_map, const char *pos)
+{
+	char *native = (char *) &field_map[field->native_slot];
+	switch (field->type) {
+	case FIELD_TYPE_UNSIGNED: {
+		uint64_t val = mp_decode_uint(&pos);
+		memcpy(native, &val, sizeof(val));
+		break;
+	}
+	case FIELD_TYPE_INTEGER: {
+		int64_t val;
+		if (mp_typeof(*pos) == MP_UINT) {
+			uint64_t uval = mp_decode_uint(&pos);
+			val = uval > INT64_MAX ? INT64_MAX : (int64_t) uval;
+		} else {
+			val = mp_decode_int(&pos);
+		}
+		memcpy(native, &val, sizeof(val));
+		break;
+	}
+	case FIELD_TYPE_NUMBER: {
+		double val;
+		switch (mp_typeof(*pos)) {
+		case MP_UINT:
+			val = mp_decode_uint(&pos);
+			break;
+		case MP_INT:
+			val = mp_decode_int(&pos);
+			break;
+		case MP_FLOAT:
+			val = mp_decode_float(&pos);
+			break;
+		case MP_DOUBLE:
+			val = mp_decode_double(&pos);
+			break;
+		default:
+			unreachable();
+			val = 0;
+		}
+		memcpy(native, &val, sizeof(val));
+		break;
+	}
+	default:
+		unreachable();
+	}
+}
+
 /** @sa declaration for details. */
 int
 tuple_init_field_map(const struct tuple_format *format, uint32_t *field_map,
@@ -264,6 +376,8 @@ tuple_init_field_map(const struct tuple_format *format, uint32_t *field_map,
 	if (key_mp_type_validate(format->fields[0].type, mp_type, ER_FIELD_TYPE,
 				 TUPLE_INDEX_BASE))
 		return -1;
+	if (format->fields[0].native_slot != TUPLE_OFFSET_SLOT_NIL)
+		tuple_field_store_native(&format->fields[0], field_map, pos);
 	mp_next(&pos);
 	/* other fields...*/
 	for (uint32_t i = 1; i < format->field_count; i++) {
@@ -274,6 +388,9 @@ tuple_init_field_map(const struct tuple_format *format, uint32_t *field_map,
 		if (format->fields[i].offset_slot != TUPLE_OFFSET_SLOT_NIL)
 			field_map[format->fields[i].offset_slot] =
 				(uint32_t) (pos - tuple);
+		if (format->fields[i].native_slot != TUPLE_OFFSET_SLOT_NIL)
+			tuple_field_store_native(&format->fields[i], field_map,
+						 pos);
 		mp_next(&pos);
 	}
 	return 0;
@@ -303,7 +420,11 @@ tuple_format_free()
 	}
 	for (struct tuple_format **format = tuple_formats;
 	     format < tuple_formats + formats_size;
-	     format++)
-		free(*format); /* ignore the reference count. */
+	     format++) {
+		/* ignore the reference count. */
+		if (*format != NULL)
+			tuple_zdict_destroy(&(*format)->zdict);
+		free(*format);
+	}
 	free(tuple_formats);
 }
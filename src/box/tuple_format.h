@@ -33,6 +33,10 @@
 
 #include "key_def.h" /* for enum field_type */
 #include "errinj.h"
+#ifndef ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_STATIC_LINKING_ONLY /* ZSTD_getDictID_fromFrame() */
+#endif
+#include "zstd.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -96,11 +100,50 @@ struct tuple_field_format {
 	 * gives the start of the field
 	 */
 	int32_t offset_slot;
+	/**
+	 * Position in field map of tuple of a native copy of
+	 * the field: uint64_t for unsigned, int64_t for integer
+	 * and double for number fields. The copy takes two
+	 * slots, native_slot and native_slot + 1. It is stored
+	 * along with MessagePack so that comparators can read
+	 * the field with a single load.
+	 * If the format doesn't store a native copy of the field
+	 * then INT_MAX is stored in this member.
+	 * @sa tuple_format_enable_native_fields()
+	 */
+	int32_t native_slot;
 };
 
 struct tuple;
 struct tuple_format;
 
+/**
+ * Zstd dictionary of a format of compressed tuples. It is
+ * trained on the first tuples of the format and then never
+ * changes, so that all tuples compressed with it can be
+ * decompressed as long as the format exists.
+ */
+struct tuple_zdict {
+	/** Digested dictionary for compression. */
+	ZSTD_CDict *cdict;
+	/**
+	 * Digested dictionary for decompression. It is
+	 * read-only and so can be shared by all threads.
+	 */
+	ZSTD_DDict *ddict;
+	/**
+	 * Engine-specific data used to train the dictionary,
+	 * allocated with malloc(). NULL unless tuples are being
+	 * sampled.
+	 */
+	void *sampler;
+	/**
+	 * Set once enough tuples are sampled. Tuples aren't
+	 * sampled any more then, even if training fails.
+	 */
+	bool is_sampled;
+};
+
 /** Engine-specific tuple format methods. */
 struct tuple_format_vtab {
 	/** Free allocated tuple using engine-specific memory allocator. */
@@ -141,6 +184,29 @@ struct tuple_format {
 	 * fields. If set, each tuple must have exactly this number of fields.
 	 */
 	uint32_t exact_field_count;
+	/**
+	 * Set in the format of compressed tuples. Such a tuple
+	 * stores its indexed fields, 0 .. field_count - 1, as is,
+	 * followed by the size of the rest of the fields (MP_UINT32)
+	 * and the rest of the fields compressed into a zstd frame.
+	 * So comparators and hash functions, which only look at
+	 * indexed fields, work as usual, while the whole tuple is
+	 * decompressed by tuple_data_range().
+	 */
+	bool is_compressed;
+	/**
+	 * Format to use for compressed tuples of this format,
+	 * NULL if tuples of this format are never compressed.
+	 * @sa tuple_format_enable_compression()
+	 */
+	struct tuple_format *zformat;
+	/** Dictionary of a format of compressed tuples. */
+	struct tuple_zdict zdict;
+	/**
+	 * True if tuples store native copies of numeric fields,
+	 * @sa tuple_field_format::native_slot.
+	 */
+	bool has_native_fields;
 	/* Length of 'fields' array. */
 	uint32_t field_count;
 	/* Formats of the fields */
@@ -208,6 +274,28 @@ tuple_format_new(struct tuple_format_vtab *vtab, struct key_def **keys,
 struct tuple_format *
 tuple_format_dup(const struct tuple_format *src);
 
+/**
+ * Create the format of compressed tuples for this format.
+ * An engine compresses a tuple by storing it with
+ * format->zformat.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory or format register error.
+ */
+int
+tuple_format_enable_compression(struct tuple_format *format);
+
+/**
+ * Store native copies of indexed numeric fields in tuples
+ * of this format, @sa tuple_field_format::native_slot. Must
+ * be called before any tuple of the format is created.
+ *
+ * @retval  0 Success.
+ * @retval -1 Field map is too big.
+ */
+int
+tuple_format_enable_native_fields(struct tuple_format *format);
+
 /**
  * Returns the total size of tuple metadata of this format.
  * See @link struct tuple @endlink for explanation of tuple layout.
@@ -277,6 +365,83 @@ tuple_field_raw(const struct tuple_format *format, const char *tuple,
 	return tuple;
 }
 
+/**
+ * Check if fields of this type can be stored natively,
+ * @sa tuple_field_format::native_slot.
+ */
+static inline bool
+field_type_is_native(enum field_type type)
+{
+	return type == FIELD_TYPE_UNSIGNED || type == FIELD_TYPE_INTEGER ||
+	       type == FIELD_TYPE_NUMBER;
+}
+
+/**
+ * Check if tuples of the format store a native copy of a
+ * field of the given type.
+ */
+static inline bool
+tuple_format_field_is_native(const struct tuple_format *format,
+			     uint32_t field_no, enum field_type type)
+{
+	return field_no < format->field_count &&
+	       format->fields[field_no].native_slot != TUPLE_OFFSET_SLOT_NIL &&
+	       format->fields[field_no].type == type;
+}
+
+/**
+ * Get a native copy of a field, which must exist.
+ * @param format tuple format
+ * @param field_map a pointer to the LAST element of field map
+ * @param field_no the index of field to return
+ *
+ * @returns a pointer to uint64_t, int64_t or double, which
+ *          may be unaligned
+ * @sa tuple_format_field_is_native()
+ */
+static inline const char *
+tuple_field_native_raw(const struct tuple_format *format,
+		       const uint32_t *field_map, uint32_t field_no)
+{
+	assert(field_no < format->field_count);
+	int32_t native_slot = format->fields[field_no].native_slot;
+	assert(native_slot != TUPLE_OFFSET_SLOT_NIL);
+	return (const char *) &field_map[native_slot];
+}
+
+/** Load a native copy of an unsigned field. */
+static inline uint64_t
+tuple_native_load_uint(const char *native)
+{
+	uint64_t val;
+	memcpy(&val, native, sizeof(val));
+	return val;
+}
+
+/**
+ * Load a native copy of an integer field. Values greater
+ * than INT64_MAX are stored as INT64_MAX.
+ */
+static inline int64_t
+tuple_native_load_int(const char *native)
+{
+	int64_t val;
+	memcpy(&val, native, sizeof(val));
+	return val;
+}
+
+/**
+ * Load a native copy of a number field. Integers not
+ * representable as double are stored rounded.
+ */
+static inline double
+tuple_native_load_double(const char *native)
+{
+	double val;
+	memcpy(&val, native, sizeof(val));
+	return val;
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -135,6 +135,19 @@ vclock_inc(struct vclock *vclock, uint32_t replica_id)
 	return ++vclock->lsn[replica_id];
 }
 
+/**
+ * Move the component of @a replica_id back to @a lsn, for
+ * example, if the rows it was promoted for failed to commit.
+ */
+static inline void
+vclock_rollback(struct vclock *vclock, uint32_t replica_id, int64_t lsn)
+{
+	assert(replica_id < VCLOCK_MAX);
+	assert(lsn >= 0 && lsn <= vclock->lsn[replica_id]);
+	vclock->signature -= vclock->lsn[replica_id] - lsn;
+	vclock->lsn[replica_id] = lsn;
+}
+
 static inline void
 vclock_copy(struct vclock *dst, const struct vclock *src)
 {
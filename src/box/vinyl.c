@@ -35,8 +35,10 @@
 #include "vy_stmt_iterator.h"
 #include "vy_mem.h"
 #include "vy_cache.h"
+#include "vy_read_set.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 
 #include <bit/bit.h>
 #include <small/rlist.h>
@@ -46,6 +48,7 @@
 #include <small/region.h>
 #include <small/lsregion.h>
 #include <msgpuck/msgpuck.h>
+#include <zdict.h>
 #include <coeio_file.h>
 
 #include "trivia/util.h"
@@ -93,6 +96,7 @@ struct vy_scheduler;
 struct vy_task;
 struct vy_stat;
 struct vy_squash_queue;
+struct vy_page_cache;
 
 enum vy_status {
 	VINYL_OFFLINE,
@@ -113,6 +117,12 @@ struct vy_conf {
 	uint64_t memory_limit;
 	/* read cache quota */
 	uint64_t cache;
+	/* page cache quota */
+	uint64_t page_cache;
+	/* number of pages to read ahead on a sequential scan */
+	uint32_t read_ahead;
+	/* read run files bypassing the OS page cache */
+	bool direct_io;
 	/* bloom filter false positive rate */
 	double bloom_fpr;
 };
@@ -148,6 +158,8 @@ struct vy_env {
 	ev_timer            quota_timer;
 	/** Enviroment for cache subsystem */
 	struct vy_cache_env cache_env;
+	/** Cache of decompressed run pages shared by all iterators */
+	struct vy_page_cache *page_cache;
 };
 
 #define vy_crcs(p, size, crc) \
@@ -217,6 +229,8 @@ struct vy_stat {
 	struct vy_latency get_latency;
 	struct vy_latency tx_latency;
 	struct vy_latency cursor_latency;
+	/** Time spent looking for conflicts on commit. */
+	struct vy_latency conflict_latency;
 	/**
 	 * Dump bandwidth is needed for calculating the quota watermark.
 	 * The higher the bandwidth, the later we can start dumping w/o
@@ -368,6 +382,185 @@ vy_apply_upsert(const struct tuple *upsert, const struct tuple *object,
 		struct tuple_format *upsert_format, bool suppress_error,
 		struct vy_stat *stat);
 
+/** Max size of a trained zstd dictionary. */
+enum { VY_ZDICT_SIZE = 16 * 1024 };
+/** Max size of data sampled to train a zstd dictionary. */
+enum { VY_ZDICT_SAMPLE_SIZE = 1024 * 1024 };
+/** Min and max number of pages sampled to train a dictionary. */
+enum { VY_ZDICT_MIN_SAMPLES = 8, VY_ZDICT_MAX_SAMPLES = 1024 };
+
+/**
+ * Zstd dictionary used to compress pages of a run,
+ * see key_opts::zstd_dict.
+ */
+struct vy_zdict {
+	/**
+	 * Reference counter. A dictionary is referenced by
+	 * the index it was trained for and by all runs
+	 * compressed with it.
+	 */
+	int refs;
+	/**
+	 * Digested dictionary used for decompression. It is
+	 * read-only and so can be shared by all threads.
+	 */
+	ZSTD_DDict *ddict;
+	/**
+	 * Digested dictionary used for compression, so that
+	 * it isn't loaded anew for each page. Like @a ddict,
+	 * it is read-only. Only created for dictionaries
+	 * trained for an index: dictionaries loaded from run
+	 * files are only used for reading.
+	 */
+	ZSTD_CDict *cdict;
+	/** Size of the dictionary. */
+	size_t size;
+	/** Dictionary content. */
+	char data[0];
+};
+
+static struct vy_zdict *
+vy_zdict_new(const char *data, size_t size)
+{
+	struct vy_zdict *zdict = malloc(sizeof(*zdict) + size);
+	if (zdict == NULL) {
+		diag_set(OutOfMemory, sizeof(*zdict) + size,
+			 "malloc", "struct vy_zdict");
+		return NULL;
+	}
+	memcpy(zdict->data, data, size);
+	zdict->size = size;
+	zdict->ddict = ZSTD_createDDict(zdict->data, size);
+	if (zdict->ddict == NULL) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "failed to create dictionary");
+		free(zdict);
+		return NULL;
+	}
+	zdict->cdict = NULL;
+	zdict->refs = 1;
+	return zdict;
+}
+
+static struct vy_zdict *
+vy_zdict_ref(struct vy_zdict *zdict)
+{
+	assert(zdict->refs > 0);
+	zdict->refs++;
+	return zdict;
+}
+
+static void
+vy_zdict_unref(struct vy_zdict *zdict)
+{
+	assert(zdict->refs > 0);
+	if (--zdict->refs > 0)
+		return;
+	ZSTD_freeDDict(zdict->ddict);
+	if (zdict->cdict != NULL)
+		ZSTD_freeCDict(zdict->cdict);
+	TRASH(zdict);
+	free(zdict);
+}
+
+/**
+ * Pages of a run collected to train a zstd dictionary on.
+ * Each page is a separate sample.
+ */
+struct vy_zdict_sampler {
+	/** Sampled pages, concatenated. */
+	struct ibuf data;
+	/** Sizes of sampled pages. */
+	size_t sizes[VY_ZDICT_MAX_SAMPLES];
+	/** Number of sampled pages. */
+	unsigned count;
+};
+
+static void
+vy_zdict_sampler_create(struct vy_zdict_sampler *sampler)
+{
+	ibuf_create(&sampler->data, &cord()->slabc, VY_ZDICT_SAMPLE_SIZE);
+	sampler->count = 0;
+}
+
+static void
+vy_zdict_sampler_destroy(struct vy_zdict_sampler *sampler)
+{
+	ibuf_destroy(&sampler->data);
+}
+
+/**
+ * Add a page to the sample, unless the sample is already
+ * large enough. @a page is the uncompressed page data as
+ * accumulated by xlog before commit. It starts with space
+ * reserved for the xlog fixheader, which is not sampled.
+ */
+static void
+vy_zdict_sampler_add(struct vy_zdict_sampler *sampler,
+		     struct obuf *page)
+{
+	assert(obuf_size(page) >= XLOG_FIXHEADER_SIZE);
+	size_t size = obuf_size(page) - XLOG_FIXHEADER_SIZE;
+	if (sampler->count >= VY_ZDICT_MAX_SAMPLES || size == 0 ||
+	    ibuf_used(&sampler->data) + size > VY_ZDICT_SAMPLE_SIZE)
+		return;
+	char *pos = ibuf_alloc(&sampler->data, size);
+	if (pos == NULL)
+		return; /* The sample is optional. */
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	for (const struct iovec *iov = page->iov; iov->iov_len; ++iov) {
+		assert(iov->iov_len >= offset);
+		memcpy(pos, (char *)iov->iov_base + offset,
+		       iov->iov_len - offset);
+		pos += iov->iov_len - offset;
+		offset = 0;
+	}
+	sampler->sizes[sampler->count++] = size;
+}
+
+/**
+ * Train a zstd dictionary on the sampled pages.
+ * Returns NULL if there are too few samples or training
+ * failed: in this case new runs are compressed with the
+ * old dictionary.
+ */
+static struct vy_zdict *
+vy_zdict_sampler_train(struct vy_zdict_sampler *sampler)
+{
+	if (sampler->count < VY_ZDICT_MIN_SAMPLES)
+		return NULL;
+	char *buf = malloc(VY_ZDICT_SIZE);
+	if (buf == NULL)
+		return NULL;
+	struct vy_zdict *zdict = NULL;
+	size_t size = ZDICT_trainFromBuffer(buf, VY_ZDICT_SIZE,
+					    sampler->data.rpos,
+					    sampler->sizes, sampler->count);
+	if (ZDICT_isError(size)) {
+		say_warn("failed to train zstd dictionary: %s",
+			 ZDICT_getErrorName(size));
+		goto out;
+	}
+	zdict = vy_zdict_new(buf, size);
+	if (zdict == NULL) {
+		say_warn("failed to create zstd dictionary: %s",
+			 diag_last_error(diag_get())->errmsg);
+		diag_clear(diag_get());
+		goto out;
+	}
+	/* 3 is compression level, see xlog_tx_write_zstd(). */
+	zdict->cdict = ZSTD_createCDict(zdict->data, size, 3);
+	if (zdict->cdict == NULL) {
+		say_warn("failed to create zstd dictionary: "
+			 "out of memory");
+		vy_zdict_unref(zdict);
+		zdict = NULL;
+	}
+out:
+	free(buf);
+	return zdict;
+}
+
 /**
  * Run metadata. A run is a written to a file as a single
  * chunk.
@@ -377,14 +570,36 @@ struct vy_run_info {
 	uint32_t  count;
 	/** Number of keys. */
 	uint32_t  keys;
+	/**
+	 * Number of DELETE statements among the keys, used to
+	 * estimate the number of tuples without reading pages.
+	 */
+	uint32_t deletes;
 	/* Min and max lsn over all statements in the run. */
 	int64_t  min_lsn;
 	int64_t  max_lsn;
 	/** Size of run on disk. */
 	uint64_t size;
+	/**
+	 * Time when the newest statements of the run were dumped,
+	 * in seconds since the Epoch. Used by the time window
+	 * compaction strategy. 0 for runs written by older versions.
+	 */
+	uint64_t time;
 	/** Bloom filter of all tuples in run */
 	bool has_bloom;
 	struct bloom bloom;
+	/**
+	 * Bloom filters of key prefixes, see key_opts::prefix_bloom.
+	 * prefix_blooms[i] holds hashes of the first i + 1 key parts.
+	 */
+	uint32_t prefix_bloom_count;
+	struct bloom *prefix_blooms;
+	/**
+	 * Zstd dictionary the run pages are compressed with
+	 * or NULL if pages are compressed without a dictionary.
+	 */
+	struct vy_zdict *zdict;
 	/** Pages meta. */
 	struct vy_page_info *page_infos;
 };
@@ -408,6 +623,8 @@ struct vy_page_info {
 	char *min_key;
 	/* row index offset in page */
 	uint32_t row_index_offset;
+	/* key index offset in page, 0 if the page has no key index */
+	uint32_t key_index_offset;
 };
 
 static int
@@ -417,10 +634,24 @@ vy_page_info_create(struct vy_page_info *page_info, uint64_t offset,
 static void
 vy_page_info_destroy(struct vy_page_info *page_info);
 
+/** Alignment of file offsets and buffers for O_DIRECT reads. */
+enum { VY_DIRECT_IO_ALIGN = 4096 };
+/**
+ * Interval, in bytes, at which a run file being written is
+ * synced and evicted from the OS page cache if direct I/O
+ * is on.
+ */
+enum { VY_RUN_SYNC_INTERVAL = 1024 * 1024 };
+
 struct vy_run {
 	struct vy_run_info info;
 	/** Run data file. */
 	int fd;
+	/**
+	 * Set if the data file is opened with O_DIRECT. Reads
+	 * must be aligned to VY_DIRECT_IO_ALIGN then.
+	 */
+	bool is_direct;
 	/**
 	 * Reference counter. The run file is closed and the run
 	 * in-memory structure is freed only when it reaches 0.
@@ -430,6 +661,12 @@ struct vy_run {
 	int refs;
 	/** Link in range->runs list. */
 	struct rlist in_range;
+	/**
+	 * List of pages of this run stored in the page cache,
+	 * linked by vy_page->in_run. Needed to purge the pages
+	 * from the cache when the run is deleted.
+	 */
+	struct rlist cached_pages;
 	/** Unique ID of this run. */
 	int64_t id;
 };
@@ -522,8 +759,8 @@ struct vy_range {
 typedef rb_tree(struct vy_range) vy_range_tree_t;
 
 /**
- * A single operation made by a transaction:
- * a single read or write in a vy_index.
+ * A single write made by a transaction in a vy_index.
+ * Reads are tracked as intervals, see struct vy_read_interval.
  */
 struct txv {
 	struct vy_index *index;
@@ -531,17 +768,10 @@ struct txv {
 	struct vy_tx *tx;
 	/** Next in the transaction log. */
 	struct stailq_entry next_in_log;
-	/** Member of either read or write set. */
+	/** Member of the write set. */
 	rb_node(struct txv) in_set;
-	/** true for read tx, false for write tx */
-	bool is_read;
-	/** true if that is a read statement,
-	 * and there was no value found for that key */
-	bool is_gap;
 };
 
-typedef rb_tree(struct txv) read_set_t;
-
 /**
  * A struct for primary and secondary Vinyl indexes.
  *
@@ -585,18 +815,19 @@ struct vy_index {
 	 */
 	struct vy_cache *cache;
 	/**
-	 * Conflict manager index. Contains all changes
-	 * made by transaction before they commit. Is used
-	 * to implement read committed isolation level, i.e.
-	 * the changes made by a transaction are only present
-	 * in this tree, and thus not seen by other transactions.
+	 * Conflict manager index. Contains all key intervals
+	 * read from the index by active transactions. A write
+	 * committed to the index sends all transactions that
+	 * read the written key to a read view.
 	 */
-	read_set_t read_set;
+	struct vy_read_set read_set;
 	vy_range_tree_t tree;
 	/** Number of ranges in this index. */
 	int range_count;
 	/** Number of runs in all ranges. */
 	int run_count;
+	/** Number of runs compressed with a zstd dictionary. */
+	int zdict_run_count;
 	/** Number of pages in all runs. */
 	int page_count;
 	/**
@@ -608,8 +839,41 @@ struct vy_index {
 	uint64_t size;
 	/** Amount of memory used by in-memory indexes. */
 	uint64_t used;
+	/** Number of bytes written to disk by dumps. */
+	uint64_t dump_size;
+	/**
+	 * Number of bytes written to disk by compaction, including
+	 * range splits. Write amplification of the index is
+	 * 1 + compact_size / dump_size.
+	 */
+	uint64_t compact_size;
 	/** Histogram of number of runs in range. */
 	struct histogram *run_hist;
+	/** Number of completed range splits. */
+	uint64_t split_count;
+	/**
+	 * Number of worker tasks the range splits were divided
+	 * into, including the parent tasks, see vy_task_split_new().
+	 */
+	uint64_t split_task_count;
+	/**
+	 * Number of statements delayed by write throttling,
+	 * accounted to the primary index of the space written to.
+	 */
+	uint64_t stall_count;
+	/** Histogram of write throttling delays, in milliseconds. */
+	struct histogram *stall_hist;
+	/**
+	 * Number of stale entries purged from this secondary
+	 * index, see vy_index_purge_stale().
+	 */
+	uint64_t purge_count;
+	/**
+	 * Zstd dictionary to compress new runs with, trained on
+	 * pages of the last written run, or NULL. Only used if
+	 * key_opts::zstd_dict is set.
+	 */
+	struct vy_zdict *zdict;
 	/**
 	 * Reference counter. Used to postpone index drop
 	 * until all pending operations have completed.
@@ -738,17 +1002,11 @@ enum tx_state {
 	VINYL_TX_ROLLBACK
 };
 
-struct read_set_key {
-	struct tuple *stmt;
-	struct vy_tx *tx;
-};
-
 typedef rb_tree(struct txv) write_set_t;
 
 struct vy_tx {
 	/**
-	 * In memory transaction log. Contains both reads
-	 * and writes.
+	 * In memory transaction log of writes.
 	 */
 	struct stailq log;
 	/**
@@ -756,6 +1014,11 @@ struct vy_tx {
 	 * vy_index object.
 	 */
 	write_set_t write_set;
+	/**
+	 * Key intervals read by the transaction, linked by
+	 * vy_read_interval->in_tx.
+	 */
+	struct rlist read_set;
 	/**
 	 * Version of write_set state; if the state changes (insert/remove),
 	 * the version increments.
@@ -990,6 +1253,12 @@ struct vy_cursor {
 	struct vy_read_iterator iterator;
 	/** Set to true, if need to check statements to match the cursor key. */
 	bool need_check_eq;
+	/**
+	 * Key interval read by the cursor so far, tracked in
+	 * the conflict manager index. NULL if the cursor hasn't
+	 * read anything yet.
+	 */
+	struct vy_read_interval *interval;
 };
 
 /**
@@ -1033,50 +1302,6 @@ txv_delete(struct txv *v)
 	free(v);
 }
 
-static int
-read_set_cmp(struct txv *a, struct txv *b);
-
-static int
-read_set_key_cmp(struct read_set_key *a, struct txv *b);
-
-rb_gen_ext_key(MAYBE_UNUSED static inline, read_set_, read_set_t, struct txv,
-	       in_set, read_set_cmp, struct read_set_key *, read_set_key_cmp);
-
-static struct txv *
-read_set_search_key(read_set_t *rbtree, struct tuple *stmt, struct vy_tx *tx)
-{
-	struct read_set_key key;
-	key.stmt = stmt;
-	key.tx = tx;
-	return read_set_search(rbtree, &key);
-}
-
-static int
-read_set_cmp(struct txv *a, struct txv *b)
-{
-	assert(a->index == b->index);
-	int rc = vy_stmt_compare(a->stmt, b->stmt, &a->index->index_def->key_def);
-	/**
-	 * While in svindex older value are "bigger" than newer
-	 * ones, i.e. the newest value comes first, in
-	 * transactional index (read_set), we want to look
-	 * at data in chronological order.
-	 * @sa vy_mem_tree_cmp
-	 */
-	if (rc == 0)
-		rc = a->tx < b->tx ? -1 : a->tx > b->tx;
-	return rc;
-}
-
-static int
-read_set_key_cmp(struct read_set_key *a, struct txv *b)
-{
-	int rc = vy_stmt_compare(a->stmt, b->stmt, &b->index->index_def->key_def);
-	if (rc == 0)
-		return a->tx < b->tx ? -1 : a->tx > b->tx;
-	return rc;
-}
-
 typedef rb_tree(struct vy_tx) tx_tree_t;
 
 static int
@@ -1106,6 +1331,43 @@ struct tx_manager {
 	struct vy_env *env;
 };
 
+struct vy_send_to_read_view_arg {
+	struct vy_env *env;
+	/** The committing transaction. */
+	struct vy_tx *tx;
+	/** The statement written by the transaction. */
+	struct txv *v;
+};
+
+static void
+vy_send_to_read_view_cb(struct vy_read_interval *interval, void *arg)
+{
+	struct vy_send_to_read_view_arg *a = arg;
+	struct vy_env *env = a->env;
+	struct vy_tx *abort = interval->tx;
+	/* Don't abort self. */
+	if (abort == a->tx)
+		return;
+	/* Delete of nothing does not cause a conflict */
+	if (interval->is_gap && vy_stmt_type(a->v->stmt) == IPROTO_DELETE)
+		return;
+
+	/* the found tx can only be commited as read-only */
+	abort->is_in_read_view = true;
+	/* Set the read view of the found (now read-only) tx */
+	if (abort->vlsn == INT64_MAX) {
+		abort->vlsn = env->xm->lsn;
+		tx_tree_insert(&env->xm->tree, abort);
+		if (env->xm->vlsn == INT64_MAX)
+			env->xm->vlsn = abort->vlsn;
+		else
+			assert(env->xm->vlsn <= env->xm->lsn);
+	} else {
+		assert(abort->vlsn <= env->xm->lsn);
+		assert(abort->vlsn >= env->xm->vlsn);
+	}
+}
+
 /**
  * Send to a read view all transaction which are reading the stmt v
  *  written by tx.
@@ -1113,39 +1375,9 @@ struct tx_manager {
 static void
 vy_send_to_read_view(struct vy_env *env, struct vy_tx *tx, struct txv *v)
 {
-	read_set_t *tree = &v->index->read_set;
-	struct index_def *index_def = v->index->index_def;
-	struct read_set_key key;
-	key.stmt = v->stmt;
-	key.tx = NULL;
-	/** Find the first value equal to or greater than key */
-	for (struct txv *abort = read_set_nsearch(tree, &key);
-	     abort != NULL; abort = read_set_next(tree, abort)) {
-		/* Check if we're still looking at the matching key. */
-		if (vy_stmt_compare(key.stmt, abort->stmt, &index_def->key_def))
-			break;
-		/* Don't abort self. */
-		if (abort->tx == tx)
-			continue;
-		/* Delete of nothing does not cause a conflict */
-		if (abort->is_gap && vy_stmt_type(v->stmt) == IPROTO_DELETE)
-			continue;
-
-		/* the found tx can only be commited as read-only */
-		abort->tx->is_in_read_view = true;
-		/* Set the read view of the found (now read-only) tx */
-		if (abort->tx->vlsn == INT64_MAX) {
-			abort->tx->vlsn = env->xm->lsn;
-			tx_tree_insert(&env->xm->tree, abort->tx);
-			if (env->xm->vlsn == INT64_MAX)
-				env->xm->vlsn = abort->tx->vlsn;
-			else
-				assert(env->xm->vlsn <= env->xm->lsn);
-		} else {
-			assert(abort->tx->vlsn <= env->xm->lsn);
-			assert(abort->tx->vlsn >= env->xm->vlsn);
-		}
-	}
+	struct vy_send_to_read_view_arg arg = { env, tx, v };
+	vy_read_set_walk_key(&v->index->read_set, v->stmt,
+			     vy_send_to_read_view_cb, &arg);
 }
 
 static int
@@ -1243,15 +1475,6 @@ tx_manager_vlsn(struct tx_manager *m)
 	return vlsn;
 }
 
-static struct txv *
-read_set_delete_cb(read_set_t *t, struct txv *v, void *arg)
-{
-	(void) t;
-	(void) arg;
-	txv_delete(v);
-	return NULL;
-}
-
 static void
 vy_tx_begin(struct tx_manager *m, struct vy_tx *tx)
 {
@@ -1263,6 +1486,7 @@ vy_tx_begin(struct tx_manager *m, struct vy_tx *tx)
 	tx->state = VINYL_TX_READY;
 	tx->is_in_read_view = false;
 	rlist_create(&tx->cursors);
+	rlist_create(&tx->read_set);
 
 	/* possible read-write tx reads latest changes */
 	tx->vlsn = INT64_MAX;
@@ -1270,7 +1494,8 @@ vy_tx_begin(struct tx_manager *m, struct vy_tx *tx)
 }
 
 /**
- * Remember the read in the conflict manager index.
+ * Remember a point read in the conflict manager index.
+ * @param is_gap Set if nothing was found by the key.
  */
 static int
 vy_tx_track(struct vy_tx *tx, struct vy_index *index,
@@ -1288,15 +1513,20 @@ vy_tx_track(struct vy_tx *tx, struct vy_index *index,
 			return 0;
 		}
 	}
-	struct txv *v = read_set_search_key(&index->read_set, key, tx);
-	if (v == NULL) {
-		if ((v = txv_new(index, key, tx)) == NULL)
-			return -1;
-		v->is_read = true;
-		v->is_gap = is_gap;
-		stailq_add_tail_entry(&tx->log, v, next_in_log);
-		read_set_insert(&index->read_set, v);
+	struct vy_read_interval *interval;
+	interval = vy_read_set_search(&index->read_set, tx,
+				      key, true, key, true);
+	if (interval != NULL) {
+		if (!is_gap)
+			interval->is_gap = false;
+		return 0;
 	}
+	interval = vy_read_interval_new(tx, index, key, true, key, true);
+	if (interval == NULL)
+		return -1;
+	interval->is_gap = is_gap;
+	rlist_add_tail_entry(&tx->read_set, interval, in_tx);
+	vy_read_set_insert(&index->read_set, interval);
 	return 0;
 }
 
@@ -1313,14 +1543,18 @@ vy_tx_destroy(struct tx_manager *m, struct vy_tx *tx)
 
 	/** Abort all open cursors. */
 	struct vy_cursor *c;
-	rlist_foreach_entry(c, &tx->cursors, next_in_tx)
+	rlist_foreach_entry(c, &tx->cursors, next_in_tx) {
 		c->tx = NULL;
+		c->interval = NULL;
+	}
 
 	/* Remove from the conflict manager index */
-	struct txv *v;
-	stailq_foreach_entry(v, &tx->log, next_in_log)
-		if (v->is_read)
-			read_set_remove(&v->index->read_set, v);
+	struct vy_read_interval *interval, *tmp;
+	rlist_foreach_entry_safe(interval, &tx->read_set, in_tx, tmp) {
+		vy_read_set_remove(&interval->index->read_set, interval);
+		vy_read_interval_delete(interval);
+	}
+	rlist_create(&tx->read_set);
 
 	m->count_tx--;
 }
@@ -1369,16 +1603,33 @@ vy_run_new(int64_t id)
 	memset(&run->info, 0, sizeof(run->info));
 	run->id = id;
 	run->fd = -1;
+	run->is_direct = false;
 	run->refs = 1;
 	rlist_create(&run->in_range);
+	rlist_create(&run->cached_pages);
 	TRASH(&run->info.bloom);
 	run->info.has_bloom = false;
 	return run;
 }
 
+static void
+vy_page_cache_drop_run(struct vy_run *run);
+
+/** Free bloom filters of key prefixes of a run. */
+static void
+vy_run_prefix_blooms_destroy(struct vy_run_info *run_info)
+{
+	for (uint32_t i = 0; i < run_info->prefix_bloom_count; i++)
+		bloom_destroy(&run_info->prefix_blooms[i], runtime.quota);
+	free(run_info->prefix_blooms);
+	run_info->prefix_blooms = NULL;
+	run_info->prefix_bloom_count = 0;
+}
+
 static void
 vy_run_delete(struct vy_run *run)
 {
+	vy_page_cache_drop_run(run);
 	if (run->fd >= 0 && close(run->fd) < 0)
 		say_syserror("close failed");
 	if (run->info.page_infos != NULL) {
@@ -1389,6 +1640,9 @@ vy_run_delete(struct vy_run *run)
 	}
 	if (run->info.has_bloom)
 		bloom_destroy(&run->info.bloom, runtime.quota);
+	vy_run_prefix_blooms_destroy(&run->info);
+	if (run->info.zdict != NULL)
+		vy_zdict_unref(run->info.zdict);
 	TRASH(run);
 	free(run);
 }
@@ -1467,6 +1721,8 @@ static void
 vy_index_acct_run(struct vy_index *index, struct vy_run *run)
 {
 	index->run_count++;
+	if (run->info.zdict != NULL)
+		index->zdict_run_count++;
 	index->page_count += run->info.count;
 	index->stmt_count += run->info.keys;
 	index->size += vy_run_size(run);
@@ -1476,6 +1732,8 @@ static void
 vy_index_unacct_run(struct vy_index *index, struct vy_run *run)
 {
 	index->run_count--;
+	if (run->info.zdict != NULL)
+		index->zdict_run_count--;
 	index->page_count -= run->info.count;
 	index->stmt_count -= run->info.keys;
 	index->size -= vy_run_size(run);
@@ -1580,6 +1838,8 @@ vy_range_prepare_new_run(struct vy_range *range)
 		vy_run_delete(run);
 		return -1;
 	}
+	if (index->zdict != NULL)
+		run->info.zdict = vy_zdict_ref(index->zdict);
 	range->new_run = run;
 	return 0;
 }
@@ -1989,7 +2249,7 @@ struct vy_write_iterator;
 
 static struct vy_write_iterator *
 vy_write_iterator_new(struct vy_index *index, bool is_last_level,
-		      int64_t oldest_vlsn);
+		      int64_t oldest_vlsn, const char *start_key);
 static NODISCARD int
 vy_write_iterator_add_run(struct vy_write_iterator *wi, struct vy_run *run);
 static NODISCARD int
@@ -2081,6 +2341,180 @@ vy_row_index_encode(const uint32_t *row_index, uint32_t count,
 	return xrow->bodycnt >= 0 ? 0 : -1;
 }
 
+/**
+ * Number of keys between two restart points of a page key
+ * index, see vy_page::keys.
+ */
+enum { VY_PAGE_KEY_RESTART_INTERVAL = 16 };
+
+/**
+ * Page key index being written, see vy_page::keys.
+ */
+struct vy_key_index_writer {
+	/** Prefix-compressed keys. */
+	struct ibuf keys;
+	/** Offsets of restart points in keys. */
+	struct ibuf restarts;
+	/** The last added key. */
+	struct ibuf last_key;
+	/** Number of added keys. */
+	uint32_t count;
+};
+
+static void
+vy_key_index_writer_create(struct vy_key_index_writer *writer)
+{
+	ibuf_create(&writer->keys, &cord()->slabc, 4096);
+	ibuf_create(&writer->restarts, &cord()->slabc,
+		    sizeof(uint32_t) * 256);
+	ibuf_create(&writer->last_key, &cord()->slabc, 256);
+	writer->count = 0;
+}
+
+static void
+vy_key_index_writer_destroy(struct vy_key_index_writer *writer)
+{
+	ibuf_destroy(&writer->keys);
+	ibuf_destroy(&writer->restarts);
+	ibuf_destroy(&writer->last_key);
+}
+
+/**
+ * Append the key of a statement to a page key index.
+ * Each key is stored as the length of the prefix it shares
+ * with the previous key, the length of the rest of the key,
+ * and the rest of the key. Every VY_PAGE_KEY_RESTART_INTERVAL
+ * keys a restart point is stored: a key that shares nothing
+ * with the previous one.
+ *
+ * @retval 0 for success
+ * @retval -1 for error
+ */
+static int
+vy_key_index_writer_add(struct vy_key_index_writer *writer,
+			const struct tuple *stmt,
+			const struct index_def *index_def)
+{
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	uint32_t size;
+	const char *key = tuple_extract_key(stmt, index_def, &size);
+	if (key == NULL)
+		return -1;
+
+	uint32_t shared = 0;
+	if (writer->count % VY_PAGE_KEY_RESTART_INTERVAL == 0) {
+		uint32_t *offset = ibuf_alloc(&writer->restarts,
+					      sizeof(uint32_t));
+		if (offset == NULL)
+			goto oom;
+		*offset = ibuf_used(&writer->keys);
+	} else {
+		const char *last_key = writer->last_key.rpos;
+		uint32_t last_size = ibuf_used(&writer->last_key);
+		while (shared < size && shared < last_size &&
+		       key[shared] == last_key[shared])
+			shared++;
+	}
+	uint32_t unshared = size - shared;
+	size_t entry_size = mp_sizeof_uint(shared) +
+			    mp_sizeof_uint(unshared) + unshared;
+	char *pos = ibuf_alloc(&writer->keys, entry_size);
+	if (pos == NULL)
+		goto oom;
+	pos = mp_encode_uint(pos, shared);
+	pos = mp_encode_uint(pos, unshared);
+	memcpy(pos, key + shared, unshared);
+
+	ibuf_reset(&writer->last_key);
+	char *last_key = ibuf_alloc(&writer->last_key, size);
+	if (last_key == NULL)
+		goto oom;
+	memcpy(last_key, key, size);
+	writer->count++;
+	region_truncate(region, used);
+	return 0;
+oom:
+	diag_set(OutOfMemory, size, "ibuf", "key index");
+	region_truncate(region, used);
+	return -1;
+}
+
+/**
+ * Encode a page key index as xrow: an array of the
+ * prefix-compressed keys and the restart point offsets.
+ *
+ * @param writer key index
+ * @param[out] xrow xrow to fill.
+ * @retval 0 for success
+ * @retval -1 for error
+ */
+static int
+vy_key_index_encode(struct vy_key_index_writer *writer,
+		    struct xrow_header *xrow)
+{
+	memset(xrow, 0, sizeof(*xrow));
+	xrow->type = IPROTO_REPLACE;
+
+	struct request request;
+	request_create(&request, IPROTO_REPLACE);
+	uint32_t keys_size = ibuf_used(&writer->keys);
+	uint32_t restart_count = ibuf_used(&writer->restarts) /
+				 sizeof(uint32_t);
+	size_t tuple_size = mp_sizeof_array(2) + mp_sizeof_bin(keys_size) +
+			    mp_sizeof_bin(sizeof(uint32_t) * restart_count);
+	char *tuple = region_alloc(&fiber()->gc, tuple_size);
+	if (tuple == NULL) {
+		diag_set(OutOfMemory, tuple_size, "region", "key index");
+		return -1;
+	}
+	request.tuple = tuple;
+	tuple = mp_encode_array(tuple, 2);
+	tuple = mp_encode_bin(tuple, writer->keys.rpos, keys_size);
+	tuple = mp_encode_binl(tuple, sizeof(uint32_t) * restart_count);
+	const uint32_t *restarts = (const uint32_t *)writer->restarts.rpos;
+	for (uint32_t i = 0; i < restart_count; ++i)
+		tuple = mp_store_u32(tuple, restarts[i]);
+	request.tuple_end = tuple;
+	assert(request.tuple_end == request.tuple + tuple_size);
+	xrow->bodycnt = request_encode(&request, xrow->body);
+	return xrow->bodycnt >= 0 ? 0 : -1;
+}
+
+/**
+ * Return the number of bloom filters of key prefixes
+ * a run of an index has, see key_opts::prefix_bloom.
+ */
+static inline uint32_t
+vy_index_prefix_bloom_count(const struct index_def *user_index_def)
+{
+	if (!user_index_def->opts.prefix_bloom)
+		return 0;
+	return user_index_def->key_def.part_count - 1;
+}
+
+/**
+ * Add a statement to the bloom filters of a run being written.
+ * @param bs - bloom spectrum of full keys
+ * @param prefix_bs - bloom spectrums of key prefixes or NULL
+ */
+static void
+vy_run_bloom_add(struct bloom_spectrum *bs, struct bloom_spectrum *prefix_bs,
+		 const struct tuple *stmt,
+		 const struct index_def *user_index_def)
+{
+	uint32_t prefix_count = vy_index_prefix_bloom_count(user_index_def);
+	if (prefix_count == 0) {
+		bloom_spectrum_add(bs, tuple_hash(stmt, user_index_def));
+		return;
+	}
+	uint32_t hashes[BOX_INDEX_PART_MAX];
+	tuple_hash_prefixes(stmt, user_index_def, hashes);
+	for (uint32_t i = 0; i < prefix_count; i++)
+		bloom_spectrum_add(&prefix_bs[i], hashes[i]);
+	bloom_spectrum_add(bs, tuple_hash(stmt, user_index_def));
+}
+
 /**
  * Write statements from the iterator to a new page in the run,
  * update page and run statistics.
@@ -2093,8 +2527,10 @@ static int
 vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 		  struct vy_write_iterator *wi, const char *split_key,
 		  uint32_t *page_info_capacity, struct bloom_spectrum *bs,
-		  struct tuple **curr_stmt, const struct index_def *index_def,
-		  const struct index_def *user_index_def)
+		  struct bloom_spectrum *prefix_bs, struct tuple **curr_stmt,
+		  const struct index_def *index_def,
+		  const struct index_def *user_index_def,
+		  struct vy_zdict_sampler *sampler)
 {
 	assert(curr_stmt != NULL);
 	assert(*curr_stmt != NULL);
@@ -2102,6 +2538,9 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 	/* row offsets accumulator */
 	struct ibuf row_index_buf;
 	ibuf_create(&row_index_buf, &cord()->slabc, sizeof(uint32_t) * 4096);
+	/* page keys accumulator */
+	struct vy_key_index_writer key_index;
+	vy_key_index_writer_create(&key_index);
 
 	if (run_info->count >= *page_info_capacity) {
 		uint32_t cap = *page_info_capacity > 0 ?
@@ -2120,6 +2559,7 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 
 	struct vy_page_info *page = run_info->page_infos + run_info->count;
 	vy_page_info_create(page, data_xlog->offset, index_def, *curr_stmt);
+	uint32_t deletes = 0;
 	bool end_of_run = false;
 	xlog_tx_begin(data_xlog);
 
@@ -2136,7 +2576,11 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 		struct tuple *stmt = *curr_stmt;
 		if (vy_run_dump_stmt(stmt, data_xlog, page, index_def) != 0)
 			goto error_rollback;
-		bloom_spectrum_add(bs, tuple_hash(stmt, user_index_def));
+		if (vy_key_index_writer_add(&key_index, stmt, index_def) != 0)
+			goto error_rollback;
+		vy_run_bloom_add(bs, prefix_bs, stmt, user_index_def);
+		if (vy_stmt_type(stmt) == IPROTO_DELETE)
+			deletes++;
 
 		if (vy_write_iterator_next(wi, curr_stmt))
 			goto error_rollback;
@@ -2150,22 +2594,34 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 	} while (end_of_run == false &&
 		 obuf_size(&data_xlog->obuf) < (uint64_t)index_def->opts.page_size);
 
+	/* Write key index */
+	struct xrow_header xrow;
+	assert(key_index.count == page->count);
+	if (vy_key_index_encode(&key_index, &xrow) < 0)
+		goto error_rollback;
+	ssize_t written = xlog_write_row(data_xlog, &xrow);
+	if (written < 0)
+		goto error_rollback;
+	page->key_index_offset = page->unpacked_size;
+	page->unpacked_size += written;
+
 	/* Save offset to row index  */
 	page->row_index_offset = page->unpacked_size;
 
 	/* Write row index */
-	struct xrow_header xrow;
 	const uint32_t *row_index = (const uint32_t *) row_index_buf.rpos;
 	assert(ibuf_used(&row_index_buf) == sizeof(uint32_t) * page->count);
 	if (vy_row_index_encode(row_index, page->count, &xrow) < 0)
 		goto error_rollback;
 
-	ssize_t written = xlog_write_row(data_xlog, &xrow);
+	written = xlog_write_row(data_xlog, &xrow);
 	if (written < 0)
 		goto error_rollback;
 
 	page->unpacked_size += written;
 
+	if (sampler != NULL)
+		vy_zdict_sampler_add(sampler, &data_xlog->obuf);
 	written = xlog_tx_commit(data_xlog);
 	if (written == 0)
 		written = xlog_flush(data_xlog);
@@ -2183,19 +2639,63 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 		run_info->max_lsn = page->max_lsn;
 	run_info->size += page->size;
 	run_info->keys += page->count;
+	run_info->deletes += deletes;
 
+	vy_key_index_writer_destroy(&key_index);
 	ibuf_destroy(&row_index_buf);
 	return !end_of_run ? 0: 1;
 
 error_rollback:
 	xlog_tx_rollback(data_xlog);
 error_row_index:
+	vy_key_index_writer_destroy(&key_index);
 	ibuf_destroy(&row_index_buf);
 	return -1;
 }
 
+/**
+ * Reopen the data file of a run with O_DIRECT, so that reads
+ * bypass the OS page cache and run pages are cached only in
+ * the vinyl page cache. Falls back on buffered I/O if the file
+ * system does not support O_DIRECT.
+ */
+static int
+vy_run_open_direct(struct vy_run *run, const char *path)
+{
+#ifdef O_DIRECT
+	int fd = open(path, O_RDONLY | O_DIRECT);
+	/* Pretend the file system doesn't support O_DIRECT. */
+	ERROR_INJECT(ERRINJ_VY_RUN_DIRECT_IO, {
+		if (fd >= 0)
+			close(fd);
+		fd = -1;
+		errno = EINVAL;
+	});
+	if (fd < 0) {
+		if (errno == EINVAL) {
+			say_warn("%s: O_DIRECT is not supported, "
+				 "using buffered I/O", path);
+			return 0;
+		}
+		diag_set(SystemError, "failed to open file '%s'", path);
+		return -1;
+	}
+	if (run->fd >= 0 && close(run->fd) < 0)
+		say_syserror("close failed");
+	run->fd = fd;
+	run->is_direct = true;
+#else
+	(void)run;
+	(void)path;
+#endif /* O_DIRECT */
+	return 0;
+}
+
 /**
  * Write statements from the iterator to a new run file.
+ * If @a sampler is not NULL, written pages are added to it.
+ * If @a direct_io is set, the file is reopened with O_DIRECT
+ * after it has been written.
  *
  *  @retval 0, curr_stmt != NULL: all is ok, the iterator is not finished
  *  @retval 0, curr_stmt == NULL: all is ok, the iterator finished
@@ -2205,8 +2705,10 @@ static int
 vy_run_write_data(struct vy_run *run, const char *dirpath,
 		  struct vy_write_iterator *wi, struct tuple **curr_stmt,
 		  const char *end_key, struct bloom_spectrum *bs,
+		  struct bloom_spectrum *prefix_bs,
 		  const struct index_def *index_def,
-		  const struct index_def *user_index_def)
+		  const struct index_def *user_index_def,
+		  struct vy_zdict_sampler *sampler, bool direct_io)
 {
 	assert(curr_stmt != NULL);
 	assert(*curr_stmt != NULL);
@@ -2223,6 +2725,18 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	};
 	if (xlog_create(&data_xlog, path, &meta) < 0)
 		return -1;
+	if (direct_io) {
+		/*
+		 * Evict written data from the OS page cache as
+		 * we go, the run will be read with O_DIRECT.
+		 */
+		data_xlog.sync_interval = VY_RUN_SYNC_INTERVAL;
+		data_xlog.free_cache = true;
+	}
+	if (run_info->zdict != NULL) {
+		assert(run_info->zdict->cdict != NULL);
+		data_xlog.zcdict = run_info->zdict->cdict;
+	}
 
 	/*
 	 * Read from the iterator until it's exhausted or
@@ -2235,7 +2749,8 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	do {
 		rc = vy_run_write_page(run_info, &data_xlog, wi,
 				       end_key, &page_infos_capacity, bs,
-				       curr_stmt, index_def, user_index_def);
+				       prefix_bs, curr_stmt, index_def,
+				       user_index_def, sampler);
 		if (rc < 0)
 			goto err;
 		fiber_gc();
@@ -2250,6 +2765,8 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	xlog_close(&data_xlog, true);
 	fiber_gc();
 
+	if (direct_io)
+		return vy_run_open_direct(run, path);
 	return 0;
 err:
 	xlog_close(&data_xlog, false);
@@ -2263,14 +2780,16 @@ enum vy_request_page_key {
 	VY_PAGE_REQUEST_COUNT = 1,
 	VY_PAGE_MIN_KEY = 2,
 	VY_PAGE_DATA_SIZE = 3,
-	VY_PAGE_ROW_INDEX_OFFSET = 4
+	VY_PAGE_ROW_INDEX_OFFSET = 4,
+	VY_PAGE_KEY_INDEX_OFFSET = 5,
 };
 
 const char *vy_page_info_key_strs[] = {
 	"count",
 	"min",
 	"data size",
-	"row index"
+	"row index",
+	"key index",
 };
 
 const uint64_t vy_page_info_key_map = (1 << VY_PAGE_REQUEST_COUNT) |
@@ -2303,14 +2822,16 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	mp_next(&tmp);
 	min_key_size = tmp - page_info->min_key;
 
+	/* page map contains 4 items and optional key index offset */
+	uint32_t map_size = page_info->key_index_offset != 0 ? 5 : 4;
+
 	/* calc tuple size */
 	uint32_t size;
 	/* 3 items: page offset, size, and map */
 	size = mp_sizeof_array(3) +
 	       mp_sizeof_uint(page_info->offset) +
 	       mp_sizeof_uint(page_info->size) +
-	       /* page map contains 4 items */
-	       mp_sizeof_map(4) +
+	       mp_sizeof_map(map_size) +
 	       mp_sizeof_uint(VY_PAGE_REQUEST_COUNT) +
 	       mp_sizeof_uint(page_info->count) +
 	       mp_sizeof_uint(VY_PAGE_MIN_KEY) +
@@ -2319,6 +2840,10 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	       mp_sizeof_uint(page_info->unpacked_size) +
 	       mp_sizeof_uint(VY_PAGE_ROW_INDEX_OFFSET) +
 	       mp_sizeof_uint(page_info->row_index_offset);
+	if (page_info->key_index_offset != 0) {
+		size += mp_sizeof_uint(VY_PAGE_KEY_INDEX_OFFSET) +
+			mp_sizeof_uint(page_info->key_index_offset);
+	}
 
 	char *pos = region_alloc(region, size);
 	if (pos == NULL) {
@@ -2330,7 +2855,7 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	pos = mp_encode_array(pos, 3);
 	pos = mp_encode_uint(pos, page_info->offset);
 	pos = mp_encode_uint(pos, page_info->size);
-	pos = mp_encode_map(pos, 4);
+	pos = mp_encode_map(pos, map_size);
 	pos = mp_encode_uint(pos, VY_PAGE_REQUEST_COUNT);
 	pos = mp_encode_uint(pos, page_info->count);
 	pos = mp_encode_uint(pos, VY_PAGE_MIN_KEY);
@@ -2340,6 +2865,10 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	pos = mp_encode_uint(pos, page_info->unpacked_size);
 	pos = mp_encode_uint(pos, VY_PAGE_ROW_INDEX_OFFSET);
 	pos = mp_encode_uint(pos, page_info->row_index_offset);
+	if (page_info->key_index_offset != 0) {
+		pos = mp_encode_uint(pos, VY_PAGE_KEY_INDEX_OFFSET);
+		pos = mp_encode_uint(pos, page_info->key_index_offset);
+	}
 	request.tuple_end = pos;
 
 	memset(xrow, 0, sizeof(*xrow));
@@ -2402,6 +2931,9 @@ vy_page_info_decode(struct vy_page_info *page, const struct xrow_header *xrow)
 		case VY_PAGE_ROW_INDEX_OFFSET:
 			page->row_index_offset = mp_decode_uint(&pos);
 			break;
+		case VY_PAGE_KEY_INDEX_OFFSET:
+			page->key_index_offset = mp_decode_uint(&pos);
+			break;
 		default:
 			diag_set(ClientError, ER_VINYL, "Can't decode page meta "
 				 "unknown page meta key %d", key);
@@ -2429,13 +2961,21 @@ enum vy_request_run_key {
 	VY_RUN_MAX_LSN = 2,
 	VY_RUN_PAGE_COUNT = 3,
 	VY_RUN_BLOOM = 4,
+	VY_RUN_PREFIX_BLOOM = 5,
+	VY_RUN_TIME = 6,
+	VY_RUN_ZDICT = 7,
+	VY_RUN_DELETE_COUNT = 8,
 };
 
 const char *vy_run_info_key_strs[] = {
 	"min lsn",
 	"max lsn",
 	"page count",
-	"bloom filter"
+	"bloom filter",
+	"prefix bloom filters",
+	"time",
+	"zstd dictionary",
+	"delete count",
 };
 
 const uint64_t vy_run_info_key_map = (1 << VY_RUN_MIN_LSN) |
@@ -2493,12 +3033,53 @@ vy_run_bloom_decode(const char **buffer, struct bloom *bloom)
 			"wrong size of a table");
 		return -1;
 	}
-	if (bloom_load_table(bloom, *pos, runtime.quota) != 0) {
-		diag_set(ClientError, ER_VINYL, "Can't decode bloom meta: "
-			"alloc failed");
-		return -1;
+	if (bloom_load_table(bloom, *pos, runtime.quota) != 0) {
+		diag_set(ClientError, ER_VINYL, "Can't decode bloom meta: "
+			"alloc failed");
+		return -1;
+	}
+	*pos += table_size;
+	return 0;
+}
+
+static size_t
+vy_run_prefix_blooms_encode_size(const struct vy_run_info *run_info)
+{
+	size_t size = mp_sizeof_array(run_info->prefix_bloom_count);
+	for (uint32_t i = 0; i < run_info->prefix_bloom_count; i++)
+		size += vy_run_bloom_encode_size(&run_info->prefix_blooms[i]);
+	return size;
+}
+
+static char *
+vy_run_prefix_blooms_encode(char *buffer, const struct vy_run_info *run_info)
+{
+	char *pos = mp_encode_array(buffer, run_info->prefix_bloom_count);
+	for (uint32_t i = 0; i < run_info->prefix_bloom_count; i++)
+		pos = vy_run_bloom_encode(pos, &run_info->prefix_blooms[i]);
+	return pos;
+}
+
+static int
+vy_run_prefix_blooms_decode(const char **buffer, struct vy_run_info *run_info)
+{
+	uint32_t count = mp_decode_array(buffer);
+	if (count == 0)
+		return 0;
+	struct bloom *blooms = calloc(count, sizeof(*blooms));
+	if (blooms == NULL) {
+		diag_set(OutOfMemory, count * sizeof(*blooms),
+			 "calloc", "struct bloom");
+		return -1;
+	}
+	run_info->prefix_blooms = blooms;
+	for (uint32_t i = 0; i < count; i++) {
+		if (vy_run_bloom_decode(buffer, &blooms[i]) != 0) {
+			vy_run_prefix_blooms_destroy(run_info);
+			return -1;
+		}
+		run_info->prefix_bloom_count++;
 	}
-	*pos += table_size;
 	return 0;
 }
 
@@ -2519,9 +3100,18 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	assert(run_info->has_bloom);
 	size_t size = mp_sizeof_array(1);
 	/*
-	 * run map size: min lsn, max lsn, page count
-	 */
-	size += mp_sizeof_map(4);
+	 * run map size: min lsn, max lsn, page count, bloom, time
+	 * and optional prefix blooms, zstd dictionary and delete
+	 * count
+	 */
+	uint32_t map_size = 5;
+	if (run_info->prefix_bloom_count > 0)
+		map_size++;
+	if (run_info->zdict != NULL)
+		map_size++;
+	if (run_info->deletes > 0)
+		map_size++;
+	size += mp_sizeof_map(map_size);
 	size += mp_sizeof_uint(VY_RUN_MIN_LSN) +
 		mp_sizeof_uint(run_info->min_lsn);
 	size += mp_sizeof_uint(VY_RUN_MAX_LSN) +
@@ -2530,6 +3120,20 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 		mp_sizeof_uint(run_info->count);
 	size += mp_sizeof_uint(VY_RUN_BLOOM) +
 		vy_run_bloom_encode_size(&run_info->bloom);
+	size += mp_sizeof_uint(VY_RUN_TIME) +
+		mp_sizeof_uint(run_info->time);
+	if (run_info->prefix_bloom_count > 0) {
+		size += mp_sizeof_uint(VY_RUN_PREFIX_BLOOM) +
+			vy_run_prefix_blooms_encode_size(run_info);
+	}
+	if (run_info->zdict != NULL) {
+		size += mp_sizeof_uint(VY_RUN_ZDICT) +
+			mp_sizeof_bin(run_info->zdict->size);
+	}
+	if (run_info->deletes > 0) {
+		size += mp_sizeof_uint(VY_RUN_DELETE_COUNT) +
+			mp_sizeof_uint(run_info->deletes);
+	}
 
 	char *tuple = region_alloc(&fiber()->gc, size);
 	if (tuple == NULL) {
@@ -2539,7 +3143,7 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	char *pos = tuple;
 	/* encode values */
 	pos = mp_encode_array(pos, 1);
-	pos = mp_encode_map(pos, 4);
+	pos = mp_encode_map(pos, map_size);
 	pos = mp_encode_uint(pos, VY_RUN_MIN_LSN);
 	pos = mp_encode_uint(pos, run_info->min_lsn);
 	pos = mp_encode_uint(pos, VY_RUN_MAX_LSN);
@@ -2548,6 +3152,21 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, run_info->count);
 	pos = mp_encode_uint(pos, VY_RUN_BLOOM);
 	pos = vy_run_bloom_encode(pos, &run_info->bloom);
+	pos = mp_encode_uint(pos, VY_RUN_TIME);
+	pos = mp_encode_uint(pos, run_info->time);
+	if (run_info->prefix_bloom_count > 0) {
+		pos = mp_encode_uint(pos, VY_RUN_PREFIX_BLOOM);
+		pos = vy_run_prefix_blooms_encode(pos, run_info);
+	}
+	if (run_info->zdict != NULL) {
+		pos = mp_encode_uint(pos, VY_RUN_ZDICT);
+		pos = mp_encode_bin(pos, run_info->zdict->data,
+				    run_info->zdict->size);
+	}
+	if (run_info->deletes > 0) {
+		pos = mp_encode_uint(pos, VY_RUN_DELETE_COUNT);
+		pos = mp_encode_uint(pos, run_info->deletes);
+	}
 
 	/* put tuple in a replace request to run's space */
 	struct request request;
@@ -2614,6 +3233,24 @@ vy_run_info_decode(struct vy_run_info *run_info,
 			else
 				return -1;
 			break;
+		case VY_RUN_PREFIX_BLOOM:
+			if (vy_run_prefix_blooms_decode(&pos, run_info) != 0)
+				return -1;
+			break;
+		case VY_RUN_TIME:
+			run_info->time = mp_decode_uint(&pos);
+			break;
+		case VY_RUN_ZDICT: {
+			uint32_t size;
+			const char *data = mp_decode_bin(&pos, &size);
+			run_info->zdict = vy_zdict_new(data, size);
+			if (run_info->zdict == NULL)
+				return -1;
+			break;
+		}
+		case VY_RUN_DELETE_COUNT:
+			run_info->deletes = mp_decode_uint(&pos);
+			break;
 		default:
 			diag_set(ClientError, ER_VINYL,
 				 "Unknown run meta key %d", key);
@@ -2738,7 +3375,7 @@ fail:
 }
 
 static int
-vy_run_recover(struct vy_run *run, const char *dir)
+vy_run_recover(struct vy_run *run, const char *dir, bool direct_io)
 {
 	char path[PATH_MAX];
 	vy_run_snprint_path(path, sizeof(path), dir, run->id, VY_FILE_INDEX);
@@ -2815,6 +3452,8 @@ vy_run_recover(struct vy_run *run, const char *dir)
 	}
 	run->fd = cursor.fd;
 	xlog_cursor_close(&cursor, true);
+	if (direct_io)
+		return vy_run_open_direct(run, path);
 	return 0;
 
 fail_close:
@@ -2948,6 +3587,9 @@ vy_range_delete(struct vy_range *range)
  * 0 < .. < @range->run_count for minor compaction, or 0 for
  * dump.
  *
+ * If @start_key is not NULL, the iterator starts from the given
+ * key rather than from the beginning of the range.
+ *
  * The maximum possible number of output tuples of the
  * iterator is returned in @p_max_output_count
  *
@@ -2955,6 +3597,7 @@ vy_range_delete(struct vy_range *range)
 static struct vy_write_iterator *
 vy_range_get_write_iterator(struct vy_range *range, int run_count,
 			    int64_t vlsn, int64_t dump_lsn,
+			    const char *start_key,
 			    size_t *p_max_output_count)
 {
 	struct vy_write_iterator *wi;
@@ -2963,7 +3606,8 @@ vy_range_get_write_iterator(struct vy_range *range, int run_count,
 	*p_max_output_count = 0;
 
 	wi = vy_write_iterator_new(range->index,
-				   run_count == range->run_count, vlsn);
+				   run_count == range->run_count, vlsn,
+				   start_key);
 	if (wi == NULL)
 		goto err_wi;
 	/*
@@ -2993,15 +3637,51 @@ err_wi:
 	return NULL;
 }
 
+/**
+ * Return the time to assign to a run containing statements
+ * dumped right now, see vy_run_info::time.
+ */
+static uint64_t
+vy_run_time_now(void)
+{
+	ERROR_INJECT_U64(ERRINJ_VY_RUN_TIME,
+		errinj_getu64(ERRINJ_VY_RUN_TIME) > 0,
+		return errinj_getu64(ERRINJ_VY_RUN_TIME));
+	return ev_now(loop());
+}
+
+/**
+ * Return the time of a run merged from the @run_count newest
+ * runs of a range and its frozen in-memory trees, see
+ * vy_run_info::time.
+ */
+static uint64_t
+vy_range_new_run_time(struct vy_range *range, int run_count)
+{
+	if (!rlist_empty(&range->frozen))
+		return vy_run_time_now();
+	uint64_t time = 0;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &range->runs, in_range) {
+		if (run_count-- == 0)
+			break;
+		time = MAX(time, run->info.time);
+	}
+	return time;
+}
+
 /*
  * Create a new run for a range and write statements returned by a write
  * iterator to the run file until the end of the range is encountered.
+ * If @a new_zdict is not NULL and the index compresses runs with zstd
+ * dictionaries, a new dictionary is trained on the written pages and
+ * returned in @a new_zdict (or NULL if training failed).
  */
 static int
 vy_range_write_run(struct vy_range *range, struct vy_write_iterator *wi,
 		   struct tuple **stmt, size_t *written,
 		   size_t max_output_count, double bloom_fpr,
-		   uint64_t *dumped_statements)
+		   uint64_t *dumped_statements, struct vy_zdict **new_zdict)
 {
 	assert(stmt != NULL);
 
@@ -3021,15 +3701,63 @@ vy_range_write_run(struct vy_range *range, struct vy_write_iterator *wi,
 			       "vinyl range dump"); return -1;});
 
 	struct bloom_spectrum bs;
-	bloom_spectrum_create(&bs, max_output_count, bloom_fpr, runtime.quota);
-
-	if (vy_run_write_data(run, index->path, wi, stmt, range->end, &bs,
-			      index_def, user_index_def) != 0)
+	if (bloom_spectrum_create(&bs, max_output_count, bloom_fpr,
+				  runtime.quota) != 0) {
+		diag_set(OutOfMemory, 0, "bloom_spectrum_create", "bloom");
 		return -1;
+	}
+
+	uint32_t prefix_count = vy_index_prefix_bloom_count(user_index_def);
+	struct bloom_spectrum *prefix_bs = NULL;
+	uint32_t prefix_bs_count = 0;
+	if (prefix_count > 0) {
+		prefix_bs = calloc(prefix_count, sizeof(*prefix_bs));
+		run->info.prefix_blooms = calloc(prefix_count,
+						 sizeof(struct bloom));
+		if (prefix_bs == NULL || run->info.prefix_blooms == NULL) {
+			diag_set(OutOfMemory, prefix_count * sizeof(*prefix_bs),
+				 "calloc", "struct bloom_spectrum");
+			goto err;
+		}
+		for (; prefix_bs_count < prefix_count; prefix_bs_count++) {
+			if (bloom_spectrum_create(&prefix_bs[prefix_bs_count],
+						  max_output_count, bloom_fpr,
+						  runtime.quota) != 0) {
+				diag_set(OutOfMemory, 0, "bloom_spectrum_create",
+					 "prefix bloom");
+				goto err;
+			}
+		}
+	}
+
+	struct vy_zdict_sampler *sampler = NULL;
+	if (new_zdict != NULL && index_def->opts.zstd_dict) {
+		sampler = malloc(sizeof(*sampler));
+		if (sampler != NULL)
+			vy_zdict_sampler_create(sampler);
+	}
+	int rc = vy_run_write_data(run, index->path, wi, stmt, range->end,
+				   &bs, prefix_bs, index_def, user_index_def,
+				   sampler, index->env->conf->direct_io);
+	if (sampler != NULL) {
+		if (rc == 0)
+			*new_zdict = vy_zdict_sampler_train(sampler);
+		vy_zdict_sampler_destroy(sampler);
+		free(sampler);
+	}
+	if (rc != 0)
+		goto err;
 
 	bloom_spectrum_choose(&bs, &run->info.bloom);
 	run->info.has_bloom = true;
 	bloom_spectrum_destroy(&bs, runtime.quota);
+	for (uint32_t i = 0; i < prefix_count; i++) {
+		bloom_spectrum_choose(&prefix_bs[i],
+				      &run->info.prefix_blooms[i]);
+		bloom_spectrum_destroy(&prefix_bs[i], runtime.quota);
+		run->info.prefix_bloom_count++;
+	}
+	free(prefix_bs);
 
 	if (vy_run_write_index(run, index->path) != 0)
 		return -1;
@@ -3038,23 +3766,44 @@ vy_range_write_run(struct vy_range *range, struct vy_write_iterator *wi,
 	*written += vy_run_size(run);
 	*dumped_statements += run->info.keys;
 	return 0;
+err:
+	bloom_spectrum_destroy(&bs, runtime.quota);
+	for (uint32_t i = 0; i < prefix_bs_count; i++)
+		bloom_spectrum_destroy(&prefix_bs[i], runtime.quota);
+	free(prefix_bs);
+	free(run->info.prefix_blooms);
+	run->info.prefix_blooms = NULL;
+	return -1;
 }
 
 /**
- * Return true and set split_key accordingly if the range needs to be
- * split in two.
+ * Max number of ranges a range can be split into at once.
+ * Must be a power of two, see vy_range_needs_split().
+ */
+enum { VY_RANGE_SPLIT_MAX_PARTS = 16 };
+
+/**
+ * Return the number of parts the range needs to be split into and
+ * store the keys separating them in @split_keys, or return 0 if
+ * the range doesn't need to be split.
  *
  * - We should never split a range until it was merged at least once
  *   (actually, it should be a function of run_count_per_level/number
  *   of runs used for the merge: with low run_count_per_level it's more
  *   than once, with high run_count_per_level it's once).
  * - We should use the last run size as the size of the range.
- * - We should split around the last run middle key.
  * - We should only split if the last run size is greater than
  *   4/3 * range_size.
+ * - We should split around the last run middle key.
+ * - If the halves are still too big, we should split them too,
+ *   as consecutive splits would do, but in one go, so that
+ *   a range that has grown much larger than range_size can be
+ *   split by several workers in parallel (see vy_task_split_new()).
+ *   Parts are separated by min keys of the last run pages.
  */
-static bool
-vy_range_needs_split(struct vy_range *range, const char **p_split_key)
+static int
+vy_range_needs_split(struct vy_range *range,
+		     const char *split_keys[VY_RANGE_SPLIT_MAX_PARTS - 1])
 {
 	struct vy_index *index = range->index;
 	struct index_def *index_def = index->index_def;
@@ -3062,28 +3811,39 @@ vy_range_needs_split(struct vy_range *range, const char **p_split_key)
 
 	/* The range hasn't been merged yet - too early to split it. */
 	if (range->n_compactions < 1)
-		return false;
+		return 0;
 
 	/* Find the oldest run. */
 	assert(!rlist_empty(&range->runs));
 	run = rlist_last_entry(&range->runs, struct vy_run, in_range);
 
 	/* The range is too small to be split. */
-	if (vy_run_size(run) < (uint64_t)index_def->opts.range_size * 4 / 3)
-		return false;
-
-	/* Find the median key in the oldest run (approximately). */
-	struct vy_page_info *mid_page;
-	mid_page = vy_run_page_info(run, run->info.count / 2);
+	uint64_t range_size = index_def->opts.range_size;
+	uint64_t run_size = vy_run_size(run);
+	if (run_size < range_size * 4 / 3)
+		return 0;
 
-	struct vy_page_info *first_page = vy_run_page_info(run, 0);
+	uint32_t n_parts = 2;
+	while (n_parts < VY_RANGE_SPLIT_MAX_PARTS &&
+	       run_size / n_parts >= range_size * 4 / 3)
+		n_parts *= 2;
 
-	/* No point in splitting if a new range is going to be empty. */
-	if (key_compare(first_page->min_key, mid_page->min_key,
-			&index_def->key_def) == 0)
-		return false;
-	*p_split_key = mid_page->min_key;
-	return true;
+	/*
+	 * Split the oldest run into parts of (approximately)
+	 * equal size. Skip a boundary if it equals the previous
+	 * one - there's no point in creating an empty range.
+	 */
+	const char *prev_key = vy_run_page_info(run, 0)->min_key;
+	int n_keys = 0;
+	for (uint32_t i = 1; i < n_parts; i++) {
+		struct vy_page_info *page;
+		page = vy_run_page_info(run, run->info.count * i / n_parts);
+		if (key_compare(prev_key, page->min_key,
+				&index_def->key_def) == 0)
+			continue;
+		prev_key = split_keys[n_keys++] = page->min_key;
+	}
+	return n_keys > 0 ? n_keys + 1 : 0;
 }
 
 /**
@@ -3099,26 +3859,27 @@ vy_range_needs_split(struct vy_range *range, const char **p_split_key)
  * where L_N is the total number of runs, N is the total number of
  * levels, older runs have greater numbers. Runs at each subsequent
  * are run_size_ratio times larger than on the previous one. When
- * the number of runs at a level exceeds run_count_per_level, we
+ * the number of runs at a level exceeds @run_count_per_level, we
  * compact all its runs along with all runs from the upper levels
  * and in-memory indexes.  Including  previous levels into
  * compaction is relatively cheap, because of the level size
  * ratio.
  *
  * Given a range, this function computes the maximal level that needs
- * to be compacted and sets @compact_priority to the number of runs in
- * this level and all preceding levels.
+ * to be compacted among the @run_count newest runs and returns the
+ * number of runs in this level and all preceding levels.
  */
-static void
-vy_range_update_compact_priority(struct vy_range *range)
+static int
+vy_range_compact_priority_by_level(struct vy_range *range, int run_count,
+				   int64_t run_count_per_level)
 {
 	struct key_opts *opts = &range->index->index_def->opts;
 
-	assert(opts->run_count_per_level > 0);
+	assert(run_count_per_level > 0);
 	assert(opts->run_size_ratio > 1);
 	assert(range->max_dump_size > 0);
 
-	range->compact_priority = 0;
+	int compact_priority = 0;
 
 	/* Total number of checked runs. */
 	uint32_t total_run_count = 0;
@@ -3138,6 +3899,8 @@ vy_range_update_compact_priority(struct vy_range *range)
 
 	struct vy_run *run;
 	rlist_foreach_entry(run, &range->runs, in_range) {
+		if (run_count-- == 0)
+			break;
 		uint64_t run_size = vy_run_size(run);
 		total_size += run_size;
 		level_run_count++;
@@ -3171,17 +3934,95 @@ vy_range_update_compact_priority(struct vy_range *range)
 			 * we find an appropriate level for it.
 			 */
 		}
-		if (level_run_count > opts->run_count_per_level) {
+		if (level_run_count > run_count_per_level) {
 			/*
 			 * The number of runs at the current level
 			 * exceeds the configured maximum. Arrange
 			 * for compaction. We compact all runs at
 			 * this level and upper levels.
 			 */
-			range->compact_priority = total_run_count;
+			compact_priority = total_run_count;
 			est_new_run_size = total_size;
 		}
 	}
+	return compact_priority;
+}
+
+/**
+ * Size-tiered compaction: up to run_count_per_level runs are
+ * allowed at each level, so a statement is rewritten about once
+ * per level, at the cost of reading several runs per level.
+ */
+static int
+vy_range_compact_priority_tiered(struct vy_range *range)
+{
+	struct key_opts *opts = &range->index->index_def->opts;
+	return vy_range_compact_priority_by_level(range, range->run_count,
+						  opts->run_count_per_level);
+}
+
+/**
+ * Leveled compaction: a level is compacted as soon as it has
+ * two runs, so that a lookup reads at most one run per level,
+ * at the cost of rewriting a statement several times per level.
+ */
+static int
+vy_range_compact_priority_leveled(struct vy_range *range)
+{
+	return vy_range_compact_priority_by_level(range, range->run_count, 1);
+}
+
+/**
+ * Time window compaction: runs are compacted as with the tiered
+ * strategy, but only with runs dumped in the same time window of
+ * compaction_window seconds (see vy_run_info::time). Once a time
+ * window is over, its runs are never rewritten again, which suits
+ * time series data, which is appended in time order and is rarely
+ * updated.
+ */
+static int
+vy_range_compact_priority_time_window(struct vy_range *range)
+{
+	struct key_opts *opts = &range->index->index_def->opts;
+	assert(opts->compaction_window > 0);
+
+	int run_count = 0;
+	uint64_t window = 0;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &range->runs, in_range) {
+		uint64_t run_window = run->info.time / opts->compaction_window;
+		if (run_count > 0 && run_window != window)
+			break;
+		window = run_window;
+		run_count++;
+	}
+	return vy_range_compact_priority_by_level(range, run_count,
+						  opts->run_count_per_level);
+}
+
+/**
+ * Compaction strategies, see key_opts::compaction. Given a range,
+ * a strategy returns the number of the newest runs of the range
+ * that need to be compacted, or 0 if compaction is not needed.
+ */
+static int
+(*vy_compaction_strategies[])(struct vy_range *) = {
+	/* [COMPACTION_TIERED]      = */ vy_range_compact_priority_tiered,
+	/* [COMPACTION_LEVELED]     = */ vy_range_compact_priority_leveled,
+	/* [COMPACTION_TIME_WINDOW] = */ vy_range_compact_priority_time_window,
+};
+
+/**
+ * Set @compact_priority of a range to the number of runs to be
+ * compacted as dictated by the compaction strategy of the index.
+ */
+static void
+vy_range_update_compact_priority(struct vy_range *range)
+{
+	struct key_opts *opts = &range->index->index_def->opts;
+	assert(opts->compaction < compaction_type_MAX);
+	range->compact_priority =
+		vy_compaction_strategies[opts->compaction](range);
 }
 
 /**
@@ -3462,7 +4303,8 @@ vy_index_recovery_cb(const struct xctl_record *record, void *cb_arg)
 		run = vy_run_new(record->vy_run_id);
 		if (run == NULL)
 			return -1;
-		if (vy_run_recover(run, index->path) != 0) {
+		if (vy_run_recover(run, index->path,
+				   index->env->conf->direct_io) != 0) {
 			vy_run_delete(run);
 			return -1;
 		}
@@ -3822,6 +4664,32 @@ struct vy_task {
 	size_t max_output_count;
 	/** For run-writing tasks: bloom filter false-positive-rate setting */
 	double bloom_fpr;
+	/**
+	 * For split tasks: the first of the new ranges written by
+	 * this task and the number of ranges to write.
+	 */
+	struct vy_range *split_part;
+	int split_part_count;
+	/**
+	 * A task may be divided into subtasks executed by worker
+	 * threads in parallel with the task itself, see
+	 * vy_task_split_new(). Subtasks are not completed on their
+	 * own: the scheduler completes the parent task once it and
+	 * all its subtasks have been executed, see vy_task_join().
+	 */
+	struct stailq subtasks;
+	/** Link in the parent task's list of subtasks. */
+	struct stailq_entry in_parent;
+	/** The task this one is a subtask of or NULL. */
+	struct vy_task *parent;
+	/** Number of the task and its subtasks not executed yet. */
+	int unfinished_count;
+	/**
+	 * Zstd dictionary trained on the pages written by this
+	 * task, see key_opts::zstd_dict. On completion, it
+	 * replaces the index dictionary.
+	 */
+	struct vy_zdict *new_zdict;
 };
 
 /**
@@ -3845,19 +4713,71 @@ vy_task_new(struct mempool *pool, struct vy_index *index,
 	task->index = index;
 	vy_index_ref(index);
 	diag_create(&task->diag);
+	stailq_create(&task->subtasks);
+	task->unfinished_count = 1;
+	return task;
+}
+
+/**
+ * Allocate a subtask of @parent. The subtask is queued along
+ * with the parent task, see vy_scheduler_f().
+ */
+static struct vy_task *
+vy_task_add_subtask(struct mempool *pool, struct vy_task *parent,
+		    const struct vy_task_ops *ops)
+{
+	struct vy_task *task = vy_task_new(pool, parent->index, ops);
+	if (task == NULL)
+		return NULL;
+	task->parent = parent;
+	stailq_add_tail_entry(&parent->subtasks, task, in_parent);
+	parent->unfinished_count++;
 	return task;
 }
 
-/** Free a task allocated with vy_task_new(). */
+/** Free a task allocated with vy_task_new() and its subtasks. */
 static void
 vy_task_delete(struct mempool *pool, struct vy_task *task)
 {
+	struct vy_task *subtask, *next;
+	stailq_foreach_entry_safe(subtask, next, &task->subtasks, in_parent)
+		vy_task_delete(pool, subtask);
+	if (task->new_zdict != NULL)
+		vy_zdict_unref(task->new_zdict);
 	vy_index_unref(task->index);
 	diag_destroy(&task->diag);
 	TRASH(task);
 	mempool_free(pool, task);
 }
 
+/**
+ * Account a task returned by a worker thread. If the task has
+ * subtasks or is a subtask itself, return NULL until the parent
+ * task and all its subtasks have been executed, then return the
+ * parent task with statistics and the first error of subtasks
+ * merged into it. Otherwise return the task itself.
+ */
+static struct vy_task *
+vy_task_join(struct vy_task *task)
+{
+	if (task->parent != NULL)
+		task = task->parent;
+	assert(task->unfinished_count > 0);
+	if (--task->unfinished_count > 0)
+		return NULL;
+	struct vy_task *subtask;
+	stailq_foreach_entry(subtask, &task->subtasks, in_parent) {
+		task->exec_time = MAX(task->exec_time, subtask->exec_time);
+		task->dump_size += subtask->dump_size;
+		task->dumped_statements += subtask->dumped_statements;
+		if (subtask->status != 0 && task->status == 0) {
+			task->status = subtask->status;
+			diag_move(&subtask->diag, &task->diag);
+		}
+	}
+	return task;
+}
+
 static int
 vy_task_dump_execute(struct vy_task *task)
 {
@@ -3873,7 +4793,8 @@ vy_task_dump_execute(struct vy_task *task)
 	if (vy_write_iterator_next(wi, &stmt) != 0 ||
 	    vy_range_write_run(range, wi, &stmt, &task->dump_size,
 			       task->max_output_count, task->bloom_fpr,
-			       &task->dumped_statements) != 0) {
+			       &task->dumped_statements,
+			       &task->new_zdict) != 0) {
 		vy_write_iterator_cleanup(wi);
 		return -1;
 	}
@@ -3906,6 +4827,7 @@ vy_task_dump_complete(struct vy_task *task)
 	/* The iterator has been cleaned up in a worker thread. */
 	vy_write_iterator_delete(task->wi);
 
+	index->dump_size += task->dump_size;
 	vy_index_unacct_range(index, range);
 	vy_range_dump_mems(range, scheduler, task->dump_lsn);
 	if (range->new_run != NULL) {
@@ -3982,10 +4904,13 @@ vy_task_dump_new(struct mempool *pool, struct vy_range *range,
 
 	struct vy_write_iterator *wi;
 	wi = vy_range_get_write_iterator(range, 0, tx_manager_vlsn(xm),
-					 dump_lsn, &task->max_output_count);
+					 dump_lsn, NULL,
+					 &task->max_output_count);
 	if (wi == NULL)
 		goto err_wi;
 
+	range->new_run->info.time = vy_run_time_now();
+
 	task->range = range;
 	task->wi = wi;
 	task->dump_lsn = MIN(xm->lsn, dump_lsn);
@@ -4015,7 +4940,7 @@ vy_task_split_execute(struct vy_task *task)
 	struct vy_range *range = task->range;
 	struct vy_write_iterator *wi = task->wi;
 	struct tuple *stmt;
-	struct vy_range *r;
+	struct vy_range *r = task->split_part;
 	uint64_t unused;
 
 	/* The range has been deleted from the scheduler queues. */
@@ -4025,8 +4950,8 @@ vy_task_split_execute(struct vy_task *task)
 	/* Start iteration. */
 	if (vy_write_iterator_next(wi, &stmt) != 0)
 		goto error;
-	assert(!rlist_empty(&range->split_list));
-	rlist_foreach_entry(r, &range->split_list, split_list) {
+	assert(task->split_part_count > 0);
+	for (int i = 0; i < task->split_part_count; i++) {
 		assert(r->shadow == range);
 		if (&r->split_list != rlist_first(&range->split_list)) {
 			ERROR_INJECT(ERRINJ_VY_RANGE_SPLIT,
@@ -4034,10 +4959,17 @@ vy_task_split_execute(struct vy_task *task)
 					       "vinyl range split");
 				      goto error;});
 		}
+		/*
+		 * Train a dictionary on the first part written by
+		 * the parent task only.
+		 */
+		struct vy_zdict **new_zdict = task->parent == NULL && i == 0 ?
+					      &task->new_zdict : NULL;
 		if (vy_range_write_run(r, wi, &stmt, &task->dump_size,
 				       task->max_output_count, task->bloom_fpr,
-				       &unused) != 0)
+				       &unused, new_zdict) != 0)
 			goto error;
+		r = rlist_next_entry(r, split_list);
 	}
 	vy_write_iterator_cleanup(wi);
 	return 0;
@@ -4046,6 +4978,19 @@ error:
 	return -1;
 }
 
+/**
+ * Delete write iterators of a split task and its subtasks.
+ * The iterators have been cleaned up in worker threads.
+ */
+static void
+vy_task_split_delete_wi(struct vy_task *task)
+{
+	struct vy_task *subtask;
+	vy_write_iterator_delete(task->wi);
+	stailq_foreach_entry(subtask, &task->subtasks, in_parent)
+		vy_write_iterator_delete(subtask->wi);
+}
+
 static int
 vy_task_split_complete(struct vy_task *task)
 {
@@ -4077,8 +5022,14 @@ vy_task_split_complete(struct vy_task *task)
 	say_info("%s: completed splitting range %s",
 		 index->name, vy_range_str(range));
 
-	/* The iterator has been cleaned up in a worker thread. */
-	vy_write_iterator_delete(task->wi);
+	vy_task_split_delete_wi(task);
+
+	index->compact_size += task->dump_size;
+	index->split_count++;
+	index->split_task_count++;
+	struct vy_task *subtask;
+	stailq_foreach_entry(subtask, &task->subtasks, in_parent)
+		index->split_task_count++;
 
 	/*
 	 * If range split completed successfully, all runs and mems of
@@ -4122,8 +5073,7 @@ vy_task_split_abort(struct vy_task *task, bool in_shutdown)
 	struct vy_range *range = task->range;
 	struct vy_range *r, *tmp;
 
-	/* The iterator has been cleaned up in a worker thread. */
-	vy_write_iterator_delete(task->wi);
+	vy_task_split_delete_wi(task);
 
 	if (!in_shutdown && !index->is_dropped) {
 		say_error("%s: failed to split range %s: %s",
@@ -4163,9 +5113,19 @@ vy_task_split_abort(struct vy_task *task, bool in_shutdown)
 	index->version++;
 }
 
+/**
+ * Create a task for splitting a range into @n_parts ranges
+ * separated by @split_keys. All statements of the range are
+ * rewritten to the new ranges. The new ranges are distributed
+ * among the task and up to @max_tasks - 1 subtasks so that
+ * key-disjoint parts of the range are merged in parallel.
+ * The new ranges are logged atomically on completion of the
+ * parent task, see vy_task_split_complete().
+ */
 static int
 vy_task_split_new(struct mempool *pool, struct vy_range *range,
-		  const char *split_key, struct vy_task **p_task)
+		  const char **split_keys, int n_parts, int max_tasks,
+		  struct vy_task **p_task)
 {
 	struct vy_index *index = range->index;
 	struct tx_manager *xm = index->env->xm;
@@ -4178,19 +5138,35 @@ vy_task_split_new(struct mempool *pool, struct vy_range *range,
 		.complete = vy_task_split_complete,
 		.abort = vy_task_split_abort,
 	};
+	/* Subtasks are completed along with the parent task. */
+	static struct vy_task_ops split_part_ops = {
+		.execute = vy_task_split_execute,
+	};
 
-	const char *keys[3];
-	struct vy_range *parts[2] = {NULL, };
-	const int n_parts = 2;
+	const char *keys[VY_RANGE_SPLIT_MAX_PARTS + 1];
+	struct vy_range *parts[VY_RANGE_SPLIT_MAX_PARTS] = {NULL, };
+	struct vy_task *tasks[VY_RANGE_SPLIT_MAX_PARTS] = {NULL, };
+	assert(n_parts >= 2 && n_parts <= VY_RANGE_SPLIT_MAX_PARTS);
+
+	/* Use a worker thread per new range if possible. */
+	int n_tasks = MIN(n_parts, max_tasks);
+	n_tasks = MAX(n_tasks, 1);
 
 	struct vy_task *task = vy_task_new(pool, index, &split_ops);
 	if (task == NULL)
 		goto err_task;
+	tasks[0] = task;
+	for (int i = 1; i < n_tasks; i++) {
+		tasks[i] = vy_task_add_subtask(pool, task, &split_part_ops);
+		if (tasks[i] == NULL)
+			goto err_parts;
+	}
 
 	/* Determine new ranges' boundaries. */
 	keys[0] = range->begin;
-	keys[1] = split_key;
-	keys[2] = range->end;
+	for (int i = 1; i < n_parts; i++)
+		keys[i] = split_keys[i - 1];
+	keys[n_parts] = range->end;
 
 	/* Allocate new ranges. */
 	for (int i = 0; i < n_parts; i++) {
@@ -4205,12 +5181,32 @@ vy_task_split_new(struct mempool *pool, struct vy_range *range,
 
 	vy_range_freeze_mem(range);
 
-	struct vy_write_iterator *wi;
-	wi = vy_range_get_write_iterator(range, range->run_count,
-					 tx_manager_vlsn(xm), INT64_MAX,
-					 &task->max_output_count);
-	if (wi == NULL)
-		goto err_wi;
+	uint64_t time = vy_range_new_run_time(range, range->run_count);
+	for (int i = 0; i < n_parts; i++)
+		parts[i]->new_run->info.time = time;
+
+	/*
+	 * Distribute new ranges evenly among the tasks. Each task
+	 * gets its own write iterator positioned at the beginning
+	 * of the first range it is supposed to write.
+	 */
+	int64_t vlsn = tx_manager_vlsn(xm);
+	for (int i = 0, first = 0; i < n_tasks; i++) {
+		struct vy_task *t = tasks[i];
+		int last = (i + 1) * n_parts / n_tasks;
+		t->wi = vy_range_get_write_iterator(range, range->run_count,
+						    vlsn, INT64_MAX,
+						    i > 0 ? keys[first] : NULL,
+						    &t->max_output_count);
+		if (t->wi == NULL)
+			goto err_wi;
+		t->range = range;
+		t->split_part = parts[first];
+		t->split_part_count = last - first;
+		t->dump_lsn = xm->lsn;
+		t->bloom_fpr = index->env->conf->bloom_fpr;
+		first = last;
+	}
 
 	/* Replace the old range with the new ones. */
 	vy_index_remove_range(index, range);
@@ -4232,18 +5228,20 @@ vy_task_split_new(struct mempool *pool, struct vy_range *range,
 	range->version++;
 	index->version++;
 
-	task->range = range;
-	task->wi = wi;
-	task->dump_lsn = xm->lsn;
-	task->bloom_fpr = index->env->conf->bloom_fpr;
-
 	vy_scheduler_remove_range(scheduler, range);
 
-	say_info("%s: started splitting range %s by key %s",
-		 index->name, vy_range_str(range), vy_key_str(split_key));
+	say_info("%s: started splitting range %s in %d parts by %d workers",
+		 index->name, vy_range_str(range), n_parts, n_tasks);
 	*p_task = task;
 	return 0;
 err_wi:
+	for (int i = 0; i < n_tasks; i++) {
+		struct vy_write_iterator *wi = tasks[i]->wi;
+		if (wi == NULL)
+			continue;
+		vy_write_iterator_cleanup(wi);
+		vy_write_iterator_delete(wi);
+	}
 	vy_range_unfreeze_mem(range);
 err_parts:
 	for (int i = 0; i < n_parts; i++) {
@@ -4277,7 +5275,7 @@ vy_task_compact_execute(struct vy_task *task)
 	if (vy_write_iterator_next(wi, &stmt) != 0 ||
 	    vy_range_write_run(range, wi, &stmt, &task->dump_size,
 			       task->max_output_count, task->bloom_fpr,
-			       &unused) != 0) {
+			       &unused, &task->new_zdict) != 0) {
 		vy_write_iterator_cleanup(wi);
 		return -1;
 	}
@@ -4286,6 +5284,31 @@ vy_task_compact_execute(struct vy_task *task)
 	return 0;
 }
 
+static int
+vy_index_purge_stale(struct vy_index *index, const struct tuple *stmt);
+
+/**
+ * Purge the secondary index entries of the tuples overwritten by
+ * DELETEs found by compaction of a primary index, see
+ * vy_write_iterator::collect_deleted.
+ */
+static int
+vy_index_purge_deleted(struct vy_index *pk, struct vy_write_iterator *wi)
+{
+	assert(pk->index_def->iid == 0);
+	for (uint32_t i = 0; i < wi->deleted_count; i++) {
+		/* The space may be altered while we are reading. */
+		for (uint32_t iid = 1; !pk->is_dropped &&
+		     iid < pk->space->index_count; iid++) {
+			struct vy_index *index =
+				vy_index(pk->space->index[iid]);
+			if (vy_index_purge_stale(index, wi->deleted[i]) != 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
 static int
 vy_task_compact_complete(struct vy_task *task)
 {
@@ -4317,8 +5340,7 @@ vy_task_compact_complete(struct vy_task *task)
 	say_info("%s: completed compacting range %s",
 		 index->name, vy_range_str(range));
 
-	/* The iterator has been cleaned up in worker. */
-	vy_write_iterator_delete(task->wi);
+	index->compact_size += task->dump_size;
 
 	/*
 	 * Replace compacted mems and runs with the resulting run.
@@ -4343,6 +5365,19 @@ vy_task_compact_complete(struct vy_task *task)
 	range->version++;
 	vy_index_acct_range(index, range);
 	vy_scheduler_add_range(scheduler, range);
+
+	/*
+	 * The range is consistent again, it is safe to yield.
+	 * Failing to purge is not a compaction failure: stale
+	 * entries left are purged on read.
+	 */
+	if (vy_index_purge_deleted(index, task->wi) != 0) {
+		say_warn("%s: failed to purge deleted tuples: %s",
+			 index->name, diag_last_error(diag_get())->errmsg);
+		diag_clear(diag_get());
+	}
+	/* The iterator has been cleaned up in worker. */
+	vy_write_iterator_delete(task->wi);
 	return 0;
 }
 
@@ -4371,7 +5406,7 @@ vy_task_compact_abort(struct vy_task *task, bool in_shutdown)
 
 static int
 vy_task_compact_new(struct mempool *pool, struct vy_range *range,
-		    struct vy_task **p_task)
+		    int max_tasks, struct vy_task **p_task)
 {
 	assert(range->compact_priority > 0);
 
@@ -4391,9 +5426,11 @@ vy_task_compact_new(struct mempool *pool, struct vy_range *range,
 	}
 
 	/* Consider splitting the range if it's too big. */
-	const char *split_key;
-	if (vy_range_needs_split(range, &split_key))
-		return vy_task_split_new(pool, range, split_key, p_task);
+	const char *split_keys[VY_RANGE_SPLIT_MAX_PARTS - 1];
+	int n_parts = vy_range_needs_split(range, split_keys);
+	if (n_parts > 0)
+		return vy_task_split_new(pool, range, split_keys, n_parts,
+					 max_tasks, p_task);
 
 	struct vy_task *task = vy_task_new(pool, index, &compact_ops);
 	if (task == NULL)
@@ -4409,11 +5446,23 @@ vy_task_compact_new(struct mempool *pool, struct vy_range *range,
 
 	struct vy_write_iterator *wi;
 	wi = vy_range_get_write_iterator(range, range->compact_priority,
-					 tx_manager_vlsn(xm), INT64_MAX,
+					 tx_manager_vlsn(xm), INT64_MAX, NULL,
 					 &task->max_output_count);
 	if (wi == NULL)
 		goto err_wi;
 
+	range->new_run->info.time = vy_range_new_run_time(range,
+						range->compact_priority);
+
+	/*
+	 * Secondary index entries of tuples deleted from a space
+	 * that defers deletes are stale, see vy_index_purge_stale().
+	 */
+	struct space *space = index->space;
+	wi->collect_deleted = index->index_def->iid == 0 &&
+			      space->def.opts.defer_deletes &&
+			      space->index_count > 1;
+
 	task->range = range;
 	task->wi = wi;
 	task->dump_lsn = xm->lsn;
@@ -4751,7 +5800,9 @@ retry:
 	struct vy_range *range = container_of(pn, struct vy_range, in_compact);
 	if (range->compact_priority == 0)
 		return 0; /* nothing to do */
-	if (vy_task_compact_new(&scheduler->task_pool, range, ptask) != 0)
+	/* One worker thread is reserved for dumps, see vy_schedule(). */
+	if (vy_task_compact_new(&scheduler->task_pool, range,
+				scheduler->workers_available - 1, ptask) != 0)
 		return -1;
 	if (*ptask == NULL)
 		goto retry; /* index dropped */
@@ -4822,6 +5873,14 @@ vy_scheduler_complete_task(struct vy_scheduler *scheduler,
 		diag_move(diag_get(), diag);
 		goto fail;
 	}
+	if (task->new_zdict != NULL) {
+		/* Compress subsequent runs with the new dictionary. */
+		struct vy_index *index = task->index;
+		if (index->zdict != NULL)
+			vy_zdict_unref(index->zdict);
+		index->zdict = task->new_zdict;
+		task->new_zdict = NULL;
+	}
 	return 0;
 fail:
 	if (task->ops->abort)
@@ -4879,18 +5938,21 @@ vy_scheduler_f(va_list va)
 
 		/* Complete and delete all processed tasks. */
 		stailq_foreach_entry_safe(task, next, &output_queue, link) {
-			if (vy_scheduler_complete_task(scheduler, task) != 0)
-				tasks_failed++;
-			else
-				tasks_done++;
-			if (task->dump_size > 0)
-				vy_stat_dump(env->stat, task->exec_time,
-					     task->dump_size,
-					     task->dumped_statements);
-			vy_task_delete(&scheduler->task_pool, task);
 			scheduler->workers_available++;
 			assert(scheduler->workers_available <=
 			       scheduler->worker_pool_size);
+			struct vy_task *done = vy_task_join(task);
+			if (done == NULL)
+				continue; /* subtasks are in progress */
+			if (vy_scheduler_complete_task(scheduler, done) != 0)
+				tasks_failed++;
+			else
+				tasks_done++;
+			if (done->dump_size > 0)
+				vy_stat_dump(env->stat, done->exec_time,
+					     done->dump_size,
+					     done->dumped_statements);
+			vy_task_delete(&scheduler->task_pool, done);
 		}
 		/*
 		 * Reset the timeout if we managed to successfully
@@ -4921,15 +5983,26 @@ vy_scheduler_f(va_list va)
 		if (task == NULL)
 			goto wait;
 
-		/* Queue the task and notify workers if necessary. */
+		/*
+		 * Queue the task along with its subtasks and notify
+		 * workers if necessary.
+		 */
+		int task_count = task->unfinished_count;
+		struct vy_task *subtask;
 		tt_pthread_mutex_lock(&scheduler->mutex);
 		was_empty = stailq_empty(&scheduler->input_queue);
 		stailq_add_tail_entry(&scheduler->input_queue, task, link);
-		if (was_empty)
+		stailq_foreach_entry(subtask, &task->subtasks, in_parent)
+			stailq_add_tail_entry(&scheduler->input_queue,
+					      subtask, link);
+		if (was_empty && task_count > 1)
+			tt_pthread_cond_broadcast(&scheduler->worker_cond);
+		else if (was_empty)
 			tt_pthread_cond_signal(&scheduler->worker_cond);
 		tt_pthread_mutex_unlock(&scheduler->mutex);
 
-		scheduler->workers_available--;
+		scheduler->workers_available -= task_count;
+		assert(scheduler->workers_available >= 0);
 		fiber_reschedule();
 		continue;
 error:
@@ -5056,9 +6129,12 @@ vy_scheduler_stop_workers(struct vy_scheduler *scheduler)
 	struct vy_task *task, *next;
 	stailq_concat(&task_queue, &scheduler->output_queue);
 	stailq_foreach_entry_safe(task, next, &task_queue, link) {
-		if (task->ops->abort != NULL)
-			task->ops->abort(task, true);
-		vy_task_delete(&scheduler->task_pool, task);
+		struct vy_task *done = vy_task_join(task);
+		if (done == NULL)
+			continue; /* aborted along with the parent */
+		if (done->ops->abort != NULL)
+			done->ops->abort(done, true);
+		vy_task_delete(&scheduler->task_pool, done);
 	}
 }
 
@@ -5197,6 +6273,9 @@ vy_conf_new()
 	}
 	conf->memory_limit = cfg_getd("vinyl_memory");
 	conf->cache = cfg_getd("vinyl_cache");
+	conf->page_cache = cfg_getd("vinyl_page_cache");
+	conf->read_ahead = cfg_geti("vinyl_read_ahead");
+	conf->direct_io = cfg_geti("vinyl_direct_io");
 	conf->bloom_fpr = cfg_getd("vinyl_bloom_fpr");
 
 	conf->path = strdup(cfg_gets("vinyl_dir"));
@@ -5334,9 +6413,15 @@ vy_info_append_iterator_stat(struct vy_info_handler *h, const char *name,
 	vy_info_append_u64(h, "lookup_count", stat->lookup_count);
 	vy_info_append_u64(h, "step_count", stat->step_count);
 	vy_info_append_u64(h, "bloom_reflect_count", stat->bloom_reflections);
+	vy_info_append_u64(h, "bloom_false_positive_count",
+			   stat->bloom_false_positives);
 	vy_info_table_end(h);
 }
 
+static void
+vy_info_append_page_cache(struct vy_page_cache *cache,
+			  struct vy_info_handler *h);
+
 static void
 vy_info_append_performance(struct vy_env *env, struct vy_info_handler *h)
 {
@@ -5351,6 +6436,8 @@ vy_info_append_performance(struct vy_env *env, struct vy_info_handler *h)
 	vy_info_append_stat_latency(h, "tx_latency", &stat->tx_latency);
 	vy_info_append_stat_latency(h, "get_latency", &stat->get_latency);
 	vy_info_append_stat_latency(h, "cursor_latency", &stat->cursor_latency);
+	vy_info_append_stat_latency(h, "conflict_latency",
+				    &stat->conflict_latency);
 
 	vy_info_append_u64(h, "tx_rollback", stat->tx_rlb);
 	vy_info_append_u64(h, "tx_conflict", stat->tx_conflict);
@@ -5366,6 +6453,8 @@ vy_info_append_performance(struct vy_env *env, struct vy_info_handler *h)
 	vy_info_append_u64(h, "used", ce->quota.used);
 	vy_info_table_end(h);
 
+	vy_info_append_page_cache(env->page_cache, h);
+
 	vy_info_table_begin(h, "iterator");
 	vy_info_append_iterator_stat(h, "txw", &stat->txw_stat);
 	vy_info_append_iterator_stat(h, "cache", &stat->cache_stat);
@@ -5402,8 +6491,20 @@ vy_info_append_indices(struct vy_env *env, struct vy_info_handler *h)
 		vy_info_append_u32(h, "range_count", i->range_count);
 		vy_info_append_u32(h, "run_count", i->run_count);
 		vy_info_append_u32(h, "run_avg", i->run_count / i->range_count);
+		vy_info_append_u64(h, "dump_size", i->dump_size);
+		vy_info_append_u64(h, "compact_size", i->compact_size);
 		histogram_snprint(buf, sizeof(buf), i->run_hist);
 		vy_info_append_str(h, "run_histogram", buf);
+		vy_info_append_u32(h, "zdict_run_count", i->zdict_run_count);
+		vy_info_append_u64(h, "zdict_size",
+				   i->zdict != NULL ? i->zdict->size : 0);
+		vy_info_append_u64(h, "split_count", i->split_count);
+		vy_info_append_u64(h, "split_task_count", i->split_task_count);
+		vy_info_append_u64(h, "stall_count", i->stall_count);
+		buf[0] = '\0';
+		histogram_snprint(buf, sizeof(buf), i->stall_hist);
+		vy_info_append_str(h, "stall_histogram", buf);
+		vy_info_append_u64(h, "purge_count", i->purge_count);
 		vy_info_table_end(h);
 	}
 	vy_info_table_end(h);
@@ -5605,6 +6706,10 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	static int64_t run_buckets[] = {
 		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 25, 50, 100,
 	};
+	static int64_t stall_buckets[] = {
+		1, 2, 5, 10, 20, 50, 100, 200, 500,
+		1000, 2000, 5000, 10000, 60000, 3600000,
+	};
 
 	assert(user_index_def->key_def.part_count > 0);
 	struct vy_index *pk = NULL;
@@ -5671,6 +6776,11 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	if (index->run_hist == NULL)
 		goto fail_run_hist;
 
+	index->stall_hist = histogram_new(stall_buckets,
+					  lengthof(stall_buckets));
+	if (index->stall_hist == NULL)
+		goto fail_stall_hist;
+
 	if (user_index_def->iid > 0) {
 		/**
 		 * Calculate the bitmask of columns used in this
@@ -5693,7 +6803,7 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	vy_range_tree_new(&index->tree);
 	index->version = 1;
 	rlist_create(&index->link);
-	read_set_new(&index->read_set);
+	vy_read_set_create(&index->read_set, &index->index_def->key_def);
 	index->space = space;
 	index->user_index_def = user_index_def;
 	index->space_format = space->format;
@@ -5703,6 +6813,8 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	return index;
 
 fail_cache_init:
+	histogram_delete(index->stall_hist);
+fail_stall_hist:
 	histogram_delete(index->run_hist);
 fail_run_hist:
 	free(index->name);
@@ -5789,7 +6901,12 @@ vy_commit_alter_space(struct space *old_space, struct space *new_space)
 static void
 vy_index_delete(struct vy_index *index)
 {
-	read_set_iter(&index->read_set, NULL, read_set_delete_cb, NULL);
+	while (index->read_set.root != NULL) {
+		struct vy_read_interval *interval = index->read_set.root;
+		vy_read_set_remove(&index->read_set, interval);
+		rlist_del_entry(interval, in_tx);
+		vy_read_interval_delete(interval);
+	}
 	vy_range_tree_iter(&index->tree, NULL, vy_range_tree_free_cb, index);
 	free(index->name);
 	free(index->path);
@@ -5800,16 +6917,212 @@ vy_index_delete(struct vy_index *index)
 		index_def_delete(index->index_def);
 	index_def_delete(index->user_index_def);
 	histogram_delete(index->run_hist);
+	histogram_delete(index->stall_hist);
+	if (index->zdict != NULL)
+		vy_zdict_unref(index->zdict);
 	vy_cache_delete(index->cache);
 	tuple_format_ref(index->space_format, -1);
 	TRASH(index);
 	free(index);
 }
 
-size_t
-vy_index_bsize(struct vy_index *index)
+size_t
+vy_index_bsize(struct vy_index *index)
+{
+	return index->used;
+}
+
+/**
+ * Estimated numbers of statements in a run or an in-memory
+ * tree relative to a search key.
+ */
+struct vy_count_estimate {
+	/** Number of statements less than the key. */
+	double lt;
+	/** Number of statements less than or equal to the key. */
+	double le;
+	/** Total number of statements. */
+	double total;
+};
+
+/**
+ * Estimate the number of statements of a run preceding the key
+ * by looking it up among the page min keys. If @a after is set,
+ * statements equal to the key are counted too.
+ */
+static double
+vy_run_approximate_rank(struct vy_run *run, const struct tuple *key,
+			const struct key_def *key_def, bool after)
+{
+	uint32_t begin = 0, end = run->info.count;
+	while (begin != end) {
+		uint32_t mid = begin + (end - begin) / 2;
+		struct vy_page_info *page = vy_run_page_info(run, mid);
+		int cmp = vy_stmt_compare_with_raw_key(key, page->min_key,
+						       key_def);
+		if (cmp > 0 || (after && cmp == 0))
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	if (begin == 0)
+		return 0;
+	/* The key is assumed to be in the middle of its page. */
+	return (begin - 0.5) * run->info.keys / run->info.count;
+}
+
+/**
+ * Check the bloom filters of a run for a key.
+ * @retval true if the run has a bloom filter for the key and
+ *         the filter says the key may be in the run.
+ */
+static bool
+vy_run_bloom_has_key(struct vy_run *run, const struct tuple *key,
+		     const struct index_def *user_index_def)
+{
+	const struct vy_run_info *run_info = &run->info;
+	uint32_t key_field_count = tuple_field_count(key);
+	const char *data = tuple_data(key);
+	mp_decode_array(&data);
+	if (run_info->has_bloom &&
+	    key_field_count >= user_index_def->key_def.part_count) {
+		return bloom_possible_has(&run_info->bloom,
+					  key_hash(data, user_index_def));
+	}
+	if (key_field_count > 0 &&
+	    key_field_count <= run_info->prefix_bloom_count) {
+		uint32_t hash = key_hash_prefix(data, user_index_def,
+						key_field_count);
+		return bloom_possible_has(
+			&run_info->prefix_blooms[key_field_count - 1], hash);
+	}
+	return false;
+}
+
+/**
+ * Add the estimate of statements matching the key in a run to
+ * @a est. DELETE statements don't count as tuples and each of
+ * them is assumed to cancel one statement in an older run.
+ */
+static void
+vy_run_count_estimate(struct vy_run *run, const struct tuple *key,
+		      const struct index_def *index_def,
+		      const struct index_def *user_index_def,
+		      struct vy_count_estimate *est)
+{
+	if (run->info.count == 0 || run->info.keys == 0)
+		return;
+	double scale = 1 - 2.0 * run->info.deletes / run->info.keys;
+	double lt = vy_run_approximate_rank(run, key, &index_def->key_def,
+					    false);
+	double le = vy_run_approximate_rank(run, key, &index_def->key_def,
+					    true);
+	/*
+	 * A key falling in the middle of a page gets no share
+	 * of it, so ask the bloom filter whether there is at
+	 * least one matching statement.
+	 */
+	if (le == lt && vy_run_bloom_has_key(run, key, user_index_def))
+		le += 1;
+	est->lt += lt * scale;
+	est->le += le * scale;
+	est->total += run->info.keys * scale;
+}
+
+/**
+ * Add the estimate of statements matching the key in an
+ * in-memory tree to @a est.
+ */
+static void
+vy_mem_count_estimate(struct vy_mem *mem, const struct tuple *key,
+		      struct vy_count_estimate *est)
 {
-	return index->used;
+	struct tree_mem_key tree_key;
+	tree_key.stmt = key;
+	/* Any LSN matches the key. */
+	tree_key.lsn = INT64_MAX - 1;
+	est->lt += vy_mem_tree_approximate_rank(&mem->tree, &tree_key, false);
+	est->le += vy_mem_tree_approximate_rank(&mem->tree, &tree_key, true);
+	est->total += vy_mem_tree_size(&mem->tree);
+}
+
+int
+vy_index_count_approximate(struct vy_index *index, enum iterator_type type,
+			   const char *key, uint32_t part_count,
+			   size_t *result)
+{
+	struct vy_env *e = index->env;
+	struct index_def *def = index->index_def;
+	struct tuple *vykey = vy_stmt_new_select(e->key_format, key,
+						 part_count);
+	if (vykey == NULL)
+		return -1;
+	struct vy_count_estimate est = { 0, 0, 0 };
+	/*
+	 * Ranges partition the key space, so the estimates of
+	 * all of them add up. While a range is being split, its
+	 * runs and older in-memory trees stay linked to the
+	 * original range, pointed to by ->shadow of the new ones.
+	 */
+	struct vy_range *shadow = NULL;
+	for (struct vy_range *range = vy_range_tree_first(&index->tree);
+	     range != NULL; range = vy_range_tree_next(&index->tree, range)) {
+		struct vy_range *src = range;
+		if (range->shadow != NULL) {
+			vy_mem_count_estimate(range->mem, vykey, &est);
+			if (range->shadow == shadow)
+				continue;
+			src = shadow = range->shadow;
+		}
+		vy_mem_count_estimate(src->mem, vykey, &est);
+		struct vy_mem *mem;
+		rlist_foreach_entry(mem, &src->frozen, in_frozen)
+			vy_mem_count_estimate(mem, vykey, &est);
+		struct vy_run *run;
+		rlist_foreach_entry(run, &src->runs, in_range) {
+			vy_run_count_estimate(run, vykey, def,
+					      index->user_index_def, &est);
+		}
+	}
+	tuple_unref(vykey);
+
+	double count;
+	if (part_count == 0) {
+		count = est.total;
+	} else {
+		switch (type) {
+		case ITER_ALL:
+			count = est.total;
+			break;
+		case ITER_EQ:
+		case ITER_REQ:
+			count = est.le - est.lt;
+			break;
+		case ITER_GE:
+			count = est.total - est.lt;
+			break;
+		case ITER_GT:
+			count = est.total - est.le;
+			break;
+		case ITER_LT:
+			count = est.lt;
+			break;
+		case ITER_LE:
+			count = est.le;
+			break;
+		default:
+			unreachable();
+			count = 0;
+		}
+	}
+	if ((type == ITER_EQ || type == ITER_REQ) &&
+	    def->opts.is_unique && part_count >= def->key_def.part_count &&
+	    count > 1) {
+		/* At most one tuple matches a full unique key. */
+		count = 1;
+	}
+	*result = count > 0 ? (size_t) (count + 0.5) : 0;
+	return 0;
 }
 
 /** {{{ Upsert */
@@ -6080,8 +7393,6 @@ vy_tx_set(struct vy_tx *tx, struct vy_index *index, struct tuple *stmt)
 	} else {
 		/* Allocate a MVCC container. */
 		struct txv *v = txv_new(index, stmt, tx);
-		v->is_read = false;
-		v->is_gap = false;
 		write_set_insert(&tx->write_set, v);
 		tx->write_set_version++;
 		stailq_add_tail_entry(&tx->log, v, next_in_log);
@@ -6462,6 +7773,115 @@ vy_index_full_by_stmt(struct vy_tx *tx, struct vy_index *index,
 	return vy_index_get(tx, pk, pkey, part_count, full);
 }
 
+/**
+ * Purge a stale secondary index entry: write a DELETE for it, so
+ * that it is not looked up in the primary index by every read
+ * and is eventually discarded by compaction. The entry is only
+ * purged if it is stale in the latest committed state, not just
+ * in the read view of the transaction that came across it.
+ *
+ * The DELETE is not written to WAL. It gets the LSN of the last
+ * committed transaction, which is not less than the LSN of any
+ * statement in the index and less than the LSN of any statement
+ * to be committed. If it is lost on restart, the entry will be
+ * found stale and purged again.
+ *
+ * @param index Secondary index.
+ * @param stmt  Secondary index entry or any statement of the
+ *              space containing the key of the entry.
+ *
+ * @retval  0 Success, the entry is purged or it isn't stale.
+ * @retval -1 Memory or read error.
+ */
+static int
+vy_index_purge_stale(struct vy_index *index, const struct tuple *stmt)
+{
+	assert(index->index_def->iid > 0);
+	struct vy_env *e = index->env;
+	/*
+	 * Statements of a checkpoint in progress must not be
+	 * mixed with newer ones, see vy_tx_write().
+	 */
+	if (e->status != VINYL_ONLINE || e->scheduler->checkpoint_lsn != -1)
+		return 0;
+	int64_t lsn = e->xm->lsn;
+	struct region *gc = &fiber()->gc;
+	size_t region_svp = region_used(gc);
+	/*
+	 * Copy the entry key, because the entry may be freed
+	 * while we are reading the primary index.
+	 */
+	struct tuple *delete =
+		vy_stmt_new_surrogate_delete(index->space->format, stmt);
+	region_truncate(gc, region_svp);
+	if (delete == NULL)
+		return -1;
+	struct tuple *full;
+	int rc = vy_index_full_by_stmt(NULL, index, delete, &full);
+	region_truncate(gc, region_svp);
+	if (rc != 0) {
+		tuple_unref(delete);
+		return -1;
+	}
+	bool is_stale = full == NULL ||
+		vy_tuple_compare(full, delete, &index->index_def->key_def) != 0;
+	if (full != NULL)
+		tuple_unref(full);
+	/*
+	 * A transaction committed while we were reading the
+	 * primary index could have written the entry anew.
+	 */
+	if (!is_stale || e->xm->lsn != lsn || index->is_dropped ||
+	    e->status != VINYL_ONLINE || e->scheduler->checkpoint_lsn != -1) {
+		tuple_unref(delete);
+		return 0;
+	}
+	vy_stmt_set_lsn(delete, lsn);
+	size_t mem_used_before = lsregion_used(&e->allocator);
+	const struct tuple *region_stmt = NULL;
+	rc = vy_tx_write(index, delete, &region_stmt, e->status, -1);
+	tuple_unref(delete);
+	if (rc != 0)
+		return -1;
+	vy_quota_force_use(&e->quota,
+			   lsregion_used(&e->allocator) - mem_used_before);
+	index->purge_count++;
+	return 0;
+}
+
+/**
+ * Get a tuple from the primary index by the partial tuple from
+ * the secondary index and check that the secondary index entry
+ * is not stale. An entry is stale if the tuple it was created
+ * for was deleted or replaced without the old tuple lookup,
+ * see space_opts::defer_deletes. A stale entry is purged, see
+ * vy_index_purge_stale().
+ * @param tx        Current transaction.
+ * @param index     Secondary index.
+ * @param partial   Partial tuple from the secondary \p index.
+ * @param[out] full The full tuple or NULL if the entry is stale.
+ *                  Must be unreferenced after usage.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory or read error.
+ */
+static inline int
+vy_index_full_by_stmt_checked(struct vy_tx *tx, struct vy_index *index,
+			      const struct tuple *partial, struct tuple **full)
+{
+	if (vy_index_full_by_stmt(tx, index, partial, full) != 0)
+		return -1;
+	if (*full != NULL &&
+	    vy_tuple_compare(*full, partial, &index->index_def->key_def) != 0) {
+		/* The tuple was deleted and inserted with another key. */
+		tuple_unref(*full);
+		*full = NULL;
+	}
+	if (*full == NULL)
+		return vy_index_purge_stale(index, partial);
+	return 0;
+}
+
 /**
  * Find a tuple in the primary index by the key of the specified
  * index.
@@ -6488,7 +7908,7 @@ vy_index_full_by_key(struct vy_tx *tx, struct vy_index *index, const char *key,
 		*result = found;
 		return 0;
 	}
-	int rc = vy_index_full_by_stmt(tx, index, found, result);
+	int rc = vy_index_full_by_stmt_checked(tx, index, found, result);
 	tuple_unref(found);
 	return rc;
 }
@@ -6529,6 +7949,29 @@ error:
 	return -1;
 }
 
+/**
+ * Check if DELETE from a space by the key of an index can skip
+ * the old tuple lookup and leave the secondary index entries of
+ * the deleted tuple in place, see space_opts::defer_deletes.
+ * A stale entry in a unique index would make the key look
+ * taken, so the lookup is skipped only if all secondary
+ * indexes are non-unique.
+ */
+static bool
+vy_delete_can_defer(struct space *space, struct vy_index *index)
+{
+	if (!space->def.opts.defer_deletes ||
+	    index->index_def->iid != 0 ||
+	    !rlist_empty(&space->on_replace))
+		return false;
+	for (uint32_t i = 1; i < space->index_count; ++i) {
+		struct vy_index *secondary = vy_index(space->index[i]);
+		if (secondary->user_index_def->opts.is_unique)
+			return false;
+	}
+	return true;
+}
+
 int
 vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	  struct request *request)
@@ -6539,7 +7982,8 @@ vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	struct vy_index *index = vy_index_find_unique(space, request->index_id);
 	if (index == NULL)
 		return -1;
-	bool has_secondary = space->index_count > 1;
+	bool has_secondary = space->index_count > 1 &&
+			     !vy_delete_can_defer(space, index);
 	const char *key = request->key;
 	uint32_t part_count = mp_decode_array(&key);
 	if (vy_unique_key_validate(index, key, part_count))
@@ -6552,7 +7996,8 @@ vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	 *
 	 * - if the space has one or more secondary indexes, then
 	 *   we need to extract secondary keys from the old tuple
-	 *   and pass them to indexes for deletion.
+	 *   and pass them to indexes for deletion, unless the
+	 *   deletion is deferred (see vy_delete_can_defer()).
 	 */
 	if (has_secondary || !rlist_empty(&space->on_replace)) {
 		if (vy_index_full_by_key(tx, index, key, part_count,
@@ -6564,7 +8009,11 @@ vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	if (has_secondary) {
 		assert(stmt->old_tuple != NULL);
 		return vy_delete_impl(tx, space, stmt->old_tuple);
-	} else { /* Primary is the single index in the space. */
+	} else {
+		/*
+		 * Primary is the single index in the space or
+		 * secondary index entries are left stale.
+		 */
 		assert(index->index_def->iid == 0);
 		struct tuple *delete =
 			vy_stmt_new_surrogate_delete_from_key(space->format,
@@ -7030,9 +8479,12 @@ vy_prepare(struct vy_env *e, struct vy_tx *tx)
 	} else {
 		tx->state = VINYL_TX_COMMIT;
 		/** Abort read/write intersection */
+		double start = clock_monotonic();
 		struct txv *v = write_set_first(&tx->write_set);
 		for (; v != NULL; v = write_set_next(&tx->write_set, v))
 			vy_send_to_read_view(e, tx, v);
+		vy_latency_update(&e->stat->conflict_latency,
+				  clock_monotonic() - start);
 	}
 
 	vy_tx_destroy(tx->manager, tx);
@@ -7047,6 +8499,25 @@ vy_prepare(struct vy_env *e, struct vy_tx *tx)
 	return rc;
 }
 
+void
+vy_throttle(struct vy_env *e, struct space *space)
+{
+	if (e->status != VINYL_ONLINE || space->index_count == 0)
+		return;
+	double start = ev_now(loop());
+	double delay = vy_quota_delay(&e->quota, start);
+	if (delay <= 0)
+		return;
+	struct vy_index *pk = vy_index(space->index[0]);
+	/* The space may be dropped while we are sleeping. */
+	vy_index_ref(pk);
+	fiber_sleep(delay);
+	double stall = ev_now(loop()) - start;
+	histogram_collect(pk->stall_hist, stall * 1000);
+	pk->stall_count++;
+	vy_index_unref(pk);
+}
+
 int
 vy_commit(struct vy_env *e, struct vy_tx *tx, int64_t lsn)
 {
@@ -7068,12 +8539,6 @@ vy_commit(struct vy_env *e, struct vy_tx *tx, int64_t lsn)
 	int64_t checkpoint_lsn = e->scheduler->checkpoint_lsn;
 	MAYBE_UNUSED uint32_t current_space_id = 0;
 	stailq_foreach_entry(v, &tx->log, next_in_log) {
-		/*
-		 * The tx log contains both reads and writes, but
-		 * we must save only writes.
-		 */
-		if (v->is_read)
-			continue;
 		struct vy_index *index = v->index;
 		struct tuple *stmt = v->stmt;
 		vy_stmt_set_lsn(stmt, lsn);
@@ -7113,6 +8578,7 @@ vy_commit(struct vy_env *e, struct vy_tx *tx, int64_t lsn)
 	free(tx);
 
 	vy_quota_use(quota, write_size);
+	vy_quota_charge(quota, write_size, ev_now(loop()));
 	return 0;
 }
 
@@ -7149,16 +8615,15 @@ vy_rollback_to_savepoint(struct vy_tx *tx, void *svp)
 	struct stailq tail;
 	stailq_create(&tail);
 	stailq_splice(&tx->log, last, &tail);
+	/*
+	 * Reads stay tracked: an interval read by a cursor
+	 * may have started before the savepoint.
+	 */
 	struct txv *v, *tmp;
 	stailq_foreach_entry_safe(v, tmp, &tail, next_in_log) {
-		/* Remove from the conflict manager index */
-		if (v->is_read)
-			read_set_remove(&v->index->read_set, v);
 		/* Remove from the transaction write log. */
-		if (!v->is_read) {
-			write_set_remove(&tx->write_set, v);
-			tx->write_set_version++;
-		}
+		write_set_remove(&tx->write_set, v);
+		tx->write_set_version++;
 		txv_delete(v);
 	}
 }
@@ -7206,6 +8671,20 @@ vy_env_quota_timer_cb(ev_loop *loop, ev_timer *timer, int events)
 
 	vy_quota_update_watermark(&e->quota, max_range_size,
 				  tx_write_rate, dump_bandwidth);
+	/*
+	 * Once the watermark is exceeded, admit new writes at
+	 * the rate memory is reclaimed by dumps, so that the
+	 * hard limit is not hit and transactions are not stalled
+	 * until a dump completes.
+	 */
+	vy_quota_set_rate(&e->quota, dump_bandwidth);
+	/* Pretend dumps can't keep up with writes. */
+	ERROR_INJECT_U64(ERRINJ_VY_QUOTA_RATE,
+		errinj_getu64(ERRINJ_VY_QUOTA_RATE) > 0, {
+		e->quota.watermark = 0;
+		vy_quota_set_rate(&e->quota,
+				  errinj_getu64(ERRINJ_VY_QUOTA_RATE));
+	});
 }
 
 /** Destructor for env->zdctx_key thread-local variable */
@@ -7221,6 +8700,11 @@ vy_squash_queue_new(void);
 static void
 vy_squash_queue_delete(struct vy_squash_queue *q);
 
+static struct vy_page_cache *
+vy_page_cache_new(uint64_t limit);
+static void
+vy_page_cache_delete(struct vy_page_cache *cache);
+
 struct vy_env *
 vy_env_new(void)
 {
@@ -7252,6 +8736,9 @@ vy_env_new(void)
 	if (e->key_format == NULL)
 		goto error_key_format;
 	tuple_format_ref(e->key_format, 1);
+	e->page_cache = vy_page_cache_new(e->conf->page_cache);
+	if (e->page_cache == NULL)
+		goto error_page_cache;
 
 	struct slab_cache *slab_cache = cord_slab_cache();
 	mempool_create(&e->cursor_pool, slab_cache,
@@ -7268,6 +8755,8 @@ vy_env_new(void)
 	vy_cache_env_create(&e->cache_env, slab_cache,
 			    e->conf->cache);
 	return e;
+error_page_cache:
+	tuple_format_ref(e->key_format, -1);
 error_key_format:
 	vy_squash_queue_delete(e->squash_queue);
 error_squash_queue:
@@ -7301,6 +8790,7 @@ vy_env_delete(struct vy_env *e)
 	lsregion_destroy(&e->allocator);
 	tt_pthread_key_delete(e->zdctx_key);
 	vy_cache_env_destroy(&e->cache_env);
+	vy_page_cache_delete(e->page_cache);
 	TRASH(e);
 	free(e);
 }
@@ -7455,7 +8945,9 @@ vy_run_iterator_open(struct vy_run_iterator *itr, struct vy_iterator_stat *stat,
  * Page
  */
 struct vy_page {
-	/** Page position in the run file (used by run_iterator->page_cache */
+	/** ID of the run this page was read from. */
+	int64_t run_id;
+	/** Page position in the run file */
 	uint32_t page_no;
 	/** The number of statements */
 	uint32_t count;
@@ -7465,10 +8957,37 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Page data */
 	char *data;
+	/**
+	 * Prefix-compressed keys of the page statements, stored
+	 * in page data, or NULL if the page has no key index (was
+	 * written by an older version). Used to search the page
+	 * without decoding statements, see vy_page_search_keys().
+	 */
+	const char *keys;
+	/**
+	 * Restart point offsets in keys, stored in page data
+	 * as big-endian uint32_t, see vy_key_index_writer_add().
+	 */
+	const char *restarts;
+	/** Number of restart points. */
+	uint32_t restart_count;
+	/**
+	 * Reference counter. A page is shared between the page
+	 * cache and run iterators and is freed when the last
+	 * reference is dropped.
+	 */
+	int refs;
+	/** The page cache this page is stored in or NULL. */
+	struct vy_page_cache *cache;
+	/** Link in vy_page_cache->lru. */
+	struct rlist in_lru;
+	/** Link in vy_run->cached_pages. */
+	struct rlist in_run;
 };
 
 static struct vy_page *
-vy_page_new(const struct vy_page_info *page_info)
+vy_page_new(int64_t run_id, uint32_t page_no,
+	    const struct vy_page_info *page_info)
 {
 	struct vy_page *page = malloc(sizeof(*page));
 	if (page == NULL) {
@@ -7476,8 +8995,17 @@ vy_page_new(const struct vy_page_info *page_info)
 			"load_page", "page cache");
 		return NULL;
 	}
+	page->run_id = run_id;
+	page->page_no = page_no;
 	page->count = page_info->count;
 	page->unpacked_size = page_info->unpacked_size;
+	page->keys = NULL;
+	page->restarts = NULL;
+	page->restart_count = 0;
+	page->refs = 1;
+	page->cache = NULL;
+	rlist_create(&page->in_lru);
+	rlist_create(&page->in_run);
 	page->row_index = calloc(page_info->count, sizeof(uint32_t));
 	if (page->row_index == NULL) {
 		diag_set(OutOfMemory, page_info->count * sizeof(uint32_t),
@@ -7500,6 +9028,7 @@ vy_page_new(const struct vy_page_info *page_info)
 static void
 vy_page_delete(struct vy_page *page)
 {
+	assert(page->cache == NULL);
 	uint32_t *row_index = page->row_index;
 	char *data = page->data;
 #if !defined(NDEBUG)
@@ -7524,6 +9053,294 @@ vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	return xrow_header_decode(xrow, &data, data_end);
 }
 
+/** Increment a page's reference counter. */
+static void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+/**
+ * Decrement a page's reference counter and free the page
+ * when it reaches 0.
+ */
+static void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/**
+ * Return the amount of memory occupied by a page. Used for
+ * accounting the page in the page cache quota.
+ */
+static size_t
+vy_page_size(struct vy_page *page)
+{
+	return sizeof(*page) + page->unpacked_size +
+	       page->count * sizeof(uint32_t);
+}
+
+/* {{{ Page cache */
+
+/**
+ * Key of a page in the page cache: a page is uniquely
+ * identified by the id of the run it belongs to and its
+ * ordinal number in the run.
+ */
+struct vy_page_key {
+	int64_t run_id;
+	uint32_t page_no;
+};
+
+static inline uint32_t
+vy_page_key_hash(int64_t run_id, uint32_t page_no)
+{
+	uint64_t h = (uint64_t)run_id * 0x9E3779B97F4A7C15ULL + page_no;
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+#define mh_name _vy_page
+#define mh_key_t const struct vy_page_key *
+#define mh_node_t struct vy_page *
+#define mh_arg_t void *
+#define mh_hash(a, arg) vy_page_key_hash((*(a))->run_id, (*(a))->page_no)
+#define mh_hash_key(a, arg) vy_page_key_hash((a)->run_id, (a)->page_no)
+#define mh_cmp(a, b, arg) ((*(a))->run_id != (*(b))->run_id || \
+			   (*(a))->page_no != (*(b))->page_no)
+#define mh_cmp_key(a, b, arg) ((a)->run_id != (*(b))->run_id || \
+			       (a)->page_no != (*(b))->page_no)
+#define MH_SOURCE 1
+#include "salad/mhash.h"
+
+/**
+ * Cache of decompressed run pages shared by all run iterators
+ * of the TX thread. Without it every new iterator would have
+ * to read and decompress hot pages from disk over and over
+ * again. Pages are evicted in LRU order once the total size of
+ * cached pages exceeds the configured limit (vinyl_page_cache).
+ *
+ * The cache is not thread-safe and must only be accessed from
+ * the TX thread. Worker threads read pages bypassing it.
+ */
+struct vy_page_cache {
+	/** (run id, page no) => struct vy_page. */
+	struct mh_vy_page_t *hash;
+	/** LRU list of cached pages. The first element is the newest. */
+	struct rlist lru;
+	/** Memory quota of the cache. */
+	struct vy_quota quota;
+	/** Number of pages in the cache. */
+	size_t count;
+	/** Number of lookups that found a page in the cache. */
+	uint64_t hit;
+	/** Number of lookups that did not find a page in the cache. */
+	uint64_t miss;
+	/** Pages being read ahead, see struct vy_page_read_ahead. */
+	struct rlist read_ahead;
+	/** Number of entries in the read_ahead list. */
+	uint32_t read_ahead_count;
+	/** Number of pages read ahead and put in the cache. */
+	uint64_t read_ahead_pages;
+};
+
+static struct vy_page_cache *
+vy_page_cache_new(uint64_t limit)
+{
+	struct vy_page_cache *cache = malloc(sizeof(*cache));
+	if (cache == NULL) {
+		diag_set(OutOfMemory, sizeof(*cache), "malloc",
+			 "struct vy_page_cache");
+		return NULL;
+	}
+	cache->hash = mh_vy_page_new();
+	if (cache->hash == NULL) {
+		diag_set(OutOfMemory, sizeof(*cache->hash), "malloc",
+			 "page cache hash");
+		free(cache);
+		return NULL;
+	}
+	rlist_create(&cache->lru);
+	vy_quota_init(&cache->quota, NULL, NULL);
+	vy_quota_set_limit(&cache->quota, limit);
+	cache->count = 0;
+	cache->hit = 0;
+	cache->miss = 0;
+	rlist_create(&cache->read_ahead);
+	cache->read_ahead_count = 0;
+	cache->read_ahead_pages = 0;
+	return cache;
+}
+
+/** Remove a page from the cache and drop the cache's reference. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache, struct vy_page *page)
+{
+	assert(page->cache == cache);
+	struct vy_page_key key = {
+		.run_id = page->run_id,
+		.page_no = page->page_no,
+	};
+	mh_int_t pos = mh_vy_page_find(cache->hash, &key, NULL);
+	assert(pos != mh_end(cache->hash));
+	mh_vy_page_del(cache->hash, pos, NULL);
+	rlist_del(&page->in_lru);
+	rlist_del(&page->in_run);
+	vy_quota_release(&cache->quota, vy_page_size(page));
+	cache->count--;
+	page->cache = NULL;
+	vy_page_unref(page);
+}
+
+static void
+vy_page_cache_delete(struct vy_page_cache *cache)
+{
+	while (!rlist_empty(&cache->lru)) {
+		struct vy_page *page = rlist_first_entry(&cache->lru,
+						struct vy_page, in_lru);
+		vy_page_cache_evict(cache, page);
+	}
+	mh_vy_page_delete(cache->hash);
+	TRASH(cache);
+	free(cache);
+}
+
+/**
+ * Evict the least recently used pages until the cache
+ * fits in its quota.
+ */
+static void
+vy_page_cache_gc(struct vy_page_cache *cache)
+{
+	while (vy_quota_is_exceeded(&cache->quota) &&
+	       !rlist_empty(&cache->lru)) {
+		struct vy_page *page = rlist_last_entry(&cache->lru,
+						struct vy_page, in_lru);
+		vy_page_cache_evict(cache, page);
+	}
+}
+
+/**
+ * Find a page in the cache without updating the LRU list
+ * and hit/miss statistics.
+ */
+static struct vy_page *
+vy_page_cache_find(struct vy_page_cache *cache, int64_t run_id,
+		   uint32_t page_no)
+{
+	struct vy_page_key key = {
+		.run_id = run_id,
+		.page_no = page_no,
+	};
+	mh_int_t pos = mh_vy_page_find(cache->hash, &key, NULL);
+	if (pos == mh_end(cache->hash))
+		return NULL;
+	return *mh_vy_page_node(cache->hash, pos);
+}
+
+/**
+ * Look up a page in the cache.
+ * @retval not NULL The page. The caller must reference it
+ *                  if it is going to be used after a yield.
+ * @retval     NULL The page is not cached.
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_page_cache *cache, int64_t run_id,
+		  uint32_t page_no)
+{
+	struct vy_page *page = vy_page_cache_find(cache, run_id, page_no);
+	if (page == NULL) {
+		cache->miss++;
+		return NULL;
+	}
+	cache->hit++;
+	rlist_move_entry(&cache->lru, page, in_lru);
+	return page;
+}
+
+/**
+ * Add a page just read from disk to the cache.
+ *
+ * Since reading a page yields, the same page may have been
+ * loaded and cached by another fiber meanwhile. In this case
+ * the given page is released and the cached one is returned.
+ *
+ * @param cache The page cache.
+ * @param run   The run the page was read from.
+ * @param page  The page. The reference to it is taken over.
+ *
+ * @return The page to use instead of @page, referenced on
+ *         behalf of the caller.
+ */
+static struct vy_page *
+vy_page_cache_add(struct vy_page_cache *cache, struct vy_run *run,
+		  struct vy_page *page)
+{
+	assert(page->run_id == run->id);
+	assert(page->cache == NULL);
+	struct vy_page *cached = vy_page_cache_find(cache, page->run_id,
+						    page->page_no);
+	if (cached != NULL) {
+		rlist_move_entry(&cache->lru, cached, in_lru);
+		vy_page_unref(page);
+		vy_page_ref(cached);
+		return cached;
+	}
+	size_t size = vy_page_size(page);
+	if (size > cache->quota.limit) {
+		/* The page won't fit anyway, don't bother. */
+		return page;
+	}
+	mh_int_t pos = mh_vy_page_put(cache->hash,
+				      (const struct vy_page **)&page,
+				      NULL, NULL);
+	if (pos == mh_end(cache->hash)) {
+		/* Not critical, the page is still usable. */
+		return page;
+	}
+	vy_page_ref(page);
+	page->cache = cache;
+	rlist_add_entry(&cache->lru, page, in_lru);
+	rlist_add_entry(&run->cached_pages, page, in_run);
+	vy_quota_force_use(&cache->quota, size);
+	cache->count++;
+	vy_page_cache_gc(cache);
+	return page;
+}
+
+/**
+ * Remove all pages of a run from the page cache.
+ * Called when the run is deleted.
+ */
+static void
+vy_page_cache_drop_run(struct vy_run *run)
+{
+	while (!rlist_empty(&run->cached_pages)) {
+		struct vy_page *page = rlist_first_entry(&run->cached_pages,
+						struct vy_page, in_run);
+		vy_page_cache_evict(page->cache, page);
+	}
+}
+
+static void
+vy_info_append_page_cache(struct vy_page_cache *cache,
+			  struct vy_info_handler *h)
+{
+	vy_info_table_begin(h, "page_cache");
+	vy_info_append_u64(h, "count", cache->count);
+	vy_info_append_u64(h, "used", cache->quota.used);
+	vy_info_append_u64(h, "limit", cache->quota.limit);
+	vy_info_append_u64(h, "hit", cache->hit);
+	vy_info_append_u64(h, "miss", cache->miss);
+	vy_info_append_u64(h, "read_ahead", cache->read_ahead_pages);
+	vy_info_table_end(h);
+}
+
+/* }}} Page cache */
+
 /**
  * Read raw stmt data from the page
  * @param page          Page.
@@ -7585,17 +9402,16 @@ vy_run_iterator_cache_touch(struct vy_run_iterator *itr, uint32_t page_no)
 }
 
 /**
- * Put page to LRU cache
+ * Put page to LRU cache. The iterator takes over the caller's
+ * reference to the page.
  */
 static void
-vy_run_iterator_cache_put(struct vy_run_iterator *itr, struct vy_page *page,
-			  uint32_t page_no)
+vy_run_iterator_cache_put(struct vy_run_iterator *itr, struct vy_page *page)
 {
 	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
+		vy_page_unref(itr->prev_page);
 	itr->prev_page = itr->curr_page;
 	itr->curr_page = page;
-	page->page_no = page_no;
 }
 
 /**
@@ -7610,16 +9426,47 @@ vy_run_iterator_cache_clean(struct vy_run_iterator *itr)
 		itr->curr_stmt_pos.page_no = UINT32_MAX;
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
 
 static int
-vy_row_index_decode(uint32_t *row_index, uint32_t count,
-		    struct xrow_header *xrow)
+vy_row_index_decode(uint32_t *row_index, uint32_t count,
+		    struct xrow_header *xrow)
+{
+	struct request request;
+	request_create(&request, xrow->type);
+	if (request_decode(&request, xrow->body->iov_base,
+			   xrow->body->iov_len) == -1) {
+		return -1;
+	}
+	if (request.tuple == NULL) {
+error:
+		diag_set(ClientError, ER_VINYL, "Can't decode row index");
+		return -1;
+	}
+	const char *pos = request.tuple;
+	if (mp_decode_array(&pos) != 1)
+		goto error;
+	uint32_t size = mp_decode_binl(&pos);
+	if (size != sizeof(uint32_t) * count)
+		goto error;
+	for (uint32_t i = 0; i < count; ++i)
+		row_index[i] = mp_load_u32(&pos);
+	assert(pos == request.tuple_end);
+	return 0;
+}
+
+/**
+ * Decode the key index of a page, see vy_key_index_encode().
+ * The key index is not copied: page->keys and page->restarts
+ * point to the page data.
+ */
+static int
+vy_key_index_decode(struct vy_page *page, struct xrow_header *xrow)
 {
 	struct request request;
 	request_create(&request, xrow->type);
@@ -7629,17 +9476,23 @@ vy_row_index_decode(uint32_t *row_index, uint32_t count,
 	}
 	if (request.tuple == NULL) {
 error:
-		diag_set(ClientError, ER_VINYL, "Can't decode row index");
+		diag_set(ClientError, ER_VINYL, "Can't decode key index");
 		return -1;
 	}
 	const char *pos = request.tuple;
-	if (mp_decode_array(&pos) != 1)
+	if (mp_decode_array(&pos) != 2 || mp_typeof(*pos) != MP_BIN)
 		goto error;
-	uint32_t size = mp_decode_binl(&pos);
-	if (size != sizeof(uint32_t) * count)
+	uint32_t size;
+	page->keys = mp_decode_bin(&pos, &size);
+	if (mp_typeof(*pos) != MP_BIN)
+		goto error;
+	page->restarts = mp_decode_bin(&pos, &size);
+	page->restart_count = size / sizeof(uint32_t);
+	if (size % sizeof(uint32_t) != 0 ||
+	    page->restart_count != (page->count +
+				    VY_PAGE_KEY_RESTART_INTERVAL - 1) /
+				   VY_PAGE_KEY_RESTART_INTERVAL)
 		goto error;
-	for (uint32_t i = 0; i < count; ++i)
-		row_index[i] = mp_load_u32(&pos);
 	assert(pos == request.tuple_end);
 	return 0;
 }
@@ -7650,23 +9503,42 @@ error:
  * @retval -1 on error, check diag
  */
 static int
-vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
-	     ZSTD_DStream *zdctx)
+vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
+	     const struct vy_run *run, ZSTD_DStream *zdctx)
 {
 	/* read xlog tx from xlog file */
 	size_t region_svp = region_used(&fiber()->gc);
-	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	off_t offset = page_info->offset;
+	size_t size = page_info->size;
+	size_t skip = 0;
+	if (run->is_direct) {
+		/*
+		 * Pages are not aligned in the file, so read
+		 * the smallest aligned block containing the page.
+		 */
+		skip = offset % VY_DIRECT_IO_ALIGN;
+		offset -= skip;
+		size = (skip + size + VY_DIRECT_IO_ALIGN - 1) /
+		       VY_DIRECT_IO_ALIGN * VY_DIRECT_IO_ALIGN;
+	}
+	char *data = (char *)region_aligned_alloc(&fiber()->gc, size,
+						  run->is_direct ?
+						  VY_DIRECT_IO_ALIGN : 1);
 	if (data == NULL) {
-		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		diag_set(OutOfMemory, size, "region gc", "page");
 		return -1;
 	}
-	ssize_t readen = fio_pread(fd, data, page_info->size,
-				   page_info->offset);
+	ssize_t readen = fio_pread(run->fd, data, size, offset);
 	if (readen < 0) {
 		/* TODO: report filename */
 		diag_set(SystemError, "failed to read from file");
 		goto error;
 	}
+	/* A direct read may stop at the end of file. */
+	readen -= skip;
+	data += skip;
+	if (readen > (ssize_t)page_info->size)
+		readen = page_info->size;
 	if (readen != (ssize_t)page_info->size) {
 		/* TODO: replace with XlogError, report filename */
 		diag_set(ClientError, ER_VINYL, "Unexpected end of file");
@@ -7679,7 +9551,9 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
 	const char *data_end = data + readen;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
-	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
+	const ZSTD_DDict *ddict = run->info.zdict != NULL ?
+				  run->info.zdict->ddict : NULL;
+	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx, ddict) != 0)
 		goto error;
 
 	struct xrow_header xrow;
@@ -7689,6 +9563,13 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
 		goto error;
 	if (vy_row_index_decode(page->row_index, page->count, &xrow) != 0)
 		goto error;
+	if (page_info->key_index_offset != 0) {
+		data_pos = page->data + page_info->key_index_offset;
+		data_end = page->data + page_info->row_index_offset;
+		if (xrow_header_decode(&xrow, &data_pos, data_end) == -1 ||
+		    vy_key_index_decode(page, &xrow) != 0)
+			goto error;
+	}
 	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
 		diag_set(ClientError, ER_VINYL, "page read injection");
@@ -7729,7 +9610,7 @@ vy_page_read_cb(struct coio_task *base)
 	if (zdctx == NULL)
 		return -1;
 	task->rc = vy_page_read(task->page, &task->page_info,
-				task->run->fd, zdctx);
+				task->run, zdctx);
 	return task->rc;
 }
 
@@ -7747,6 +9628,214 @@ vy_page_read_cb_free(struct coio_task *base)
 	return 0;
 }
 
+/**
+ * Read a page from a run file in a coeio thread.
+ *
+ * The run is referenced for the time of the read so that its
+ * file descriptor isn't closed (even worse, reopened) while a
+ * coeio thread is reading it.
+ *
+ * @retval  0 success
+ * @retval -1 read error or the fiber was cancelled, the page
+ *            is freed
+ * @retval -2 the run was deleted while the page was being read,
+ *            the page is freed
+ */
+static int
+vy_page_read_async(struct vy_env *env, struct vy_run *run,
+		   const struct vy_page_info *page_info, struct vy_page *page)
+{
+	/* Allocate a coio task */
+	struct vy_page_read_task *task =
+		(struct vy_page_read_task *)mempool_alloc(&env->read_task_pool);
+	if (task == NULL) {
+		diag_set(OutOfMemory, sizeof(*task), "malloc",
+			 "vy_page_read_task");
+		vy_page_delete(page);
+		return -1;
+	}
+	coio_task_create(&task->base, vy_page_read_cb,
+			  vy_page_read_cb_free);
+
+	task->run = run;
+	vy_run_ref(task->run);
+	task->page_info = *page_info;
+	task->env = env;
+	task->page = page;
+
+	/* Post task to coeio */
+	if (coio_task_post(&task->base, TIMEOUT_INFINITY) != 0)
+		return -1; /* timed out or cancelled */
+
+	if (task->rc != 0) {
+		/* posted, but failed */
+		diag_move(&task->base.diag, &fiber()->diag);
+		vy_page_read_cb_free(&task->base);
+		return -1;
+	}
+
+	coio_task_destroy(&task->base);
+	mempool_free(&env->read_task_pool, task);
+
+	if (vy_run_unref(run)) {
+		vy_page_delete(page);
+		return -2;
+	}
+	return 0;
+}
+
+/**
+ * A page being read ahead of run iterators.
+ *
+ * When a run iterator moves sequentially, the next pages of
+ * the run are read in background fibers, each waiting for its
+ * own coeio task, so that reads of several pages are issued to
+ * the disk in parallel rather than one after another. A page
+ * read ahead is put in the page cache, where the iterator
+ * finds it when it gets there. An iterator that needs a page
+ * which is still being read waits for the read to complete
+ * instead of reading the page once again.
+ */
+struct vy_page_read_ahead {
+	/** Link in vy_page_cache->read_ahead. */
+	struct rlist in_cache;
+	/** The run the page is read from, referenced. */
+	struct vy_run *run;
+	/** Page number in the run. */
+	uint32_t page_no;
+	/** Broadcast when the read is complete. */
+	struct ipc_cond done;
+};
+
+/**
+ * Max number of pages that may be read ahead at the same time.
+ * Bounds the number of coeio tasks occupied by read-ahead and
+ * the length of the list of pages being read.
+ */
+enum { VY_READ_AHEAD_MAX = 64 };
+
+static struct vy_page_read_ahead *
+vy_page_cache_find_read_ahead(struct vy_page_cache *cache, int64_t run_id,
+			      uint32_t page_no)
+{
+	struct vy_page_read_ahead *ra;
+	rlist_foreach_entry(ra, &cache->read_ahead, in_cache) {
+		if (ra->run->id == run_id && ra->page_no == page_no)
+			return ra;
+	}
+	return NULL;
+}
+
+static int
+vy_page_read_ahead_f(va_list ap)
+{
+	struct vy_env *env = va_arg(ap, struct vy_env *);
+	struct vy_page_read_ahead *ra = va_arg(ap, struct vy_page_read_ahead *);
+	struct vy_page_cache *cache = env->page_cache;
+	struct vy_run *run = ra->run;
+
+	/*
+	 * A failed read isn't reported: the page will be read
+	 * again by the iterator that needs it, and the error
+	 * will be returned to the user then.
+	 */
+	struct vy_page_info *page_info = vy_run_page_info(run, ra->page_no);
+	struct vy_page *page = vy_page_new(run->id, ra->page_no, page_info);
+	if (page != NULL &&
+	    vy_page_read_async(env, run, page_info, page) == 0) {
+		page = vy_page_cache_add(cache, run, page);
+		vy_page_unref(page);
+		cache->read_ahead_pages++;
+	}
+
+	rlist_del_entry(ra, in_cache);
+	cache->read_ahead_count--;
+	ipc_cond_broadcast(&ra->done);
+	ipc_cond_destroy(&ra->done);
+	vy_run_unref(run);
+	TRASH(ra);
+	free(ra);
+	return 0;
+}
+
+/**
+ * Start reading a page of a run in background unless it is
+ * already cached or being read.
+ *
+ * @retval true  the page is cached, being read or the read
+ *               has been started
+ * @retval false too many pages are being read ahead already
+ */
+static bool
+vy_page_cache_read_ahead(struct vy_env *env, struct vy_run *run,
+			 uint32_t page_no)
+{
+	struct vy_page_cache *cache = env->page_cache;
+	if (vy_page_cache_find(cache, run->id, page_no) != NULL ||
+	    vy_page_cache_find_read_ahead(cache, run->id, page_no) != NULL)
+		return true;
+	if (cache->read_ahead_count >= VY_READ_AHEAD_MAX)
+		return false;
+	struct vy_page_read_ahead *ra = malloc(sizeof(*ra));
+	if (ra == NULL)
+		return false;
+	struct fiber *f = fiber_new("vinyl.read_ahead", vy_page_read_ahead_f);
+	if (f == NULL) {
+		/* Read-ahead is an optimization, ignore the error. */
+		diag_clear(diag_get());
+		free(ra);
+		return false;
+	}
+	ra->run = run;
+	vy_run_ref(run);
+	ra->page_no = page_no;
+	ipc_cond_create(&ra->done);
+	rlist_add_tail_entry(&cache->read_ahead, ra, in_cache);
+	cache->read_ahead_count++;
+	fiber_start(f, env, ra);
+	return true;
+}
+
+/**
+ * Return true if read-ahead may be used by the iterator.
+ * Pages read ahead are stored in the page cache, which is only
+ * accessible from the TX thread, and are read by coeio, which
+ * is only used after recovery.
+ */
+static bool
+vy_run_iterator_can_read_ahead(struct vy_run_iterator *itr)
+{
+	struct vy_env *env = itr->index->env;
+	return env->conf->read_ahead > 0 && env->page_cache != NULL &&
+	       cord_is_main() && env->status == VINYL_ONLINE;
+}
+
+/**
+ * Read ahead the pages following the given one in the
+ * iteration order.
+ */
+static void
+vy_run_iterator_read_ahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_env *env = itr->index->env;
+	struct vy_run *run = itr->run;
+	bool backward = itr->iterator_type == ITER_LE ||
+			itr->iterator_type == ITER_LT;
+	for (uint32_t i = 0; i < env->conf->read_ahead; i++) {
+		if (backward) {
+			if (page_no == 0)
+				break;
+			page_no--;
+		} else {
+			if (page_no + 1 >= run->info.count)
+				break;
+			page_no++;
+		}
+		if (!vy_page_cache_read_ahead(env, run, page_no))
+			break;
+	}
+}
+
 /**
  * Get a page by the given number the cache or load it from the disk.
  *
@@ -7759,76 +9848,91 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 			  struct vy_page **result)
 {
 	struct vy_index *index = itr->index;
-	const struct vy_env *env = index->env;
+	struct vy_env *env = index->env;
 
 	/* Check cache */
 	*result = vy_run_iterator_cache_get(itr, page_no);
 	if (*result != NULL)
 		return 0;
 
+	/*
+	 * Read ahead if the iterator has moved to the page
+	 * following the current one.
+	 */
+	bool read_ahead = false;
+	if (itr->curr_page != NULL && vy_run_iterator_can_read_ahead(itr)) {
+		uint32_t curr_page_no = itr->curr_page->page_no;
+		if (itr->iterator_type == ITER_LE ||
+		    itr->iterator_type == ITER_LT)
+			read_ahead = page_no + 1 == curr_page_no;
+		else
+			read_ahead = page_no == curr_page_no + 1;
+	}
+
+	/*
+	 * Check the shared page cache. It is only accessible
+	 * from the TX thread.
+	 */
+	struct vy_page_cache *page_cache = NULL;
+	if (cord_is_main())
+		page_cache = env->page_cache;
+	struct vy_page *page;
+	if (page_cache != NULL) {
+		/*
+		 * If the page is being read ahead, wait for the
+		 * read to complete and take it from the cache.
+		 * Please note that vy_run can go away while we
+		 * are waiting.
+		 */
+		struct vy_page_read_ahead *ra;
+		ra = vy_page_cache_find_read_ahead(page_cache,
+						   itr->run->id, page_no);
+		if (ra != NULL) {
+			vy_run_ref(itr->run);
+			ipc_cond_wait(&ra->done);
+			if (vy_run_unref(itr->run)) {
+				itr->index = NULL;
+				itr->run = NULL;
+				return -2;
+			}
+		}
+		page = vy_page_cache_get(page_cache, itr->run->id, page_no);
+		if (page != NULL) {
+			vy_page_ref(page);
+			vy_run_iterator_cache_put(itr, page);
+			if (read_ahead)
+				vy_run_iterator_read_ahead(itr, page_no);
+			*result = page;
+			return 0;
+		}
+	}
+
 	/* Allocate buffers */
 	struct vy_page_info *page_info = vy_run_page_info(itr->run, page_no);
-	struct vy_page *page = vy_page_new(page_info);
+	page = vy_page_new(itr->run->id, page_no, page_info);
 	if (page == NULL)
 		return -1;
 
 	/* Read page data from the disk */
-	int rc;
 	if (cord_is_main() && env->status == VINYL_ONLINE) {
 		/*
 		 * Use coeio for TX thread **after recovery**.
-		 * Please note that vy_run can go away after yield.
-		 * In this case vy_run_iterator is no more valid and
-		 * rc = -2 is returned to the caller.
-		 */
-
-		/* Allocate a coio task */
-		struct vy_page_read_task *task =
-			(struct vy_page_read_task *)mempool_alloc(&itr->index->env->read_task_pool);
-		if (task == NULL) {
-			diag_set(OutOfMemory, sizeof(*task), "malloc",
-				 "vy_page_read_task");
-			return -1;
-		}
-		coio_task_create(&task->base, vy_page_read_cb,
-				  vy_page_read_cb_free);
-
-		/*
-		 * Make sure the run file descriptor won't be closed
-		 * (even worse, reopened) while a coeio thread is
-		 * reading it.
+		 * Start reading the next pages before waiting for
+		 * this one so that the reads go in parallel.
 		 */
-		task->run = itr->run;
-		vy_run_ref(task->run);
-		task->page_info = *page_info;
-		task->env = index->env;
-		task->page = page;
-
-		/* Post task to coeio */
-		rc = coio_task_post(&task->base, TIMEOUT_INFINITY);
-		if (rc < 0)
-			return -1; /* timed out or cancelled */
-
-		if (task->rc != 0) {
-			/* posted, but failed */
-			diag_move(&task->base.diag, &fiber()->diag);
-			vy_page_read_cb_free(&task->base);
-			return -1;
-		}
-
-		coio_task_destroy(&task->base);
-		mempool_free(&task->env->read_task_pool, task);
-
-		if (vy_run_unref(itr->run)) {
+		if (read_ahead)
+			vy_run_iterator_read_ahead(itr, page_no);
+		int rc = vy_page_read_async(env, itr->run, page_info, page);
+		if (rc == -2) {
 			/*
 			 * The run's gone so the iterator isn't
 			 * valid anymore.
 			 */
 			itr->index = NULL;
 			itr->run = NULL;
-			vy_page_delete(page);
-			return -2;
 		}
+		if (rc != 0)
+			return rc;
 	} else {
 		/*
 		 * Optimization: use blocked I/O for non-TX threads or
@@ -7839,7 +9943,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 			vy_page_delete(page);
 			return -1;
 		}
-		if (vy_page_read(page, page_info, itr->run->fd, zdctx) != 0) {
+		if (vy_page_read(page, page_info, itr->run, zdctx) != 0) {
 			vy_page_delete(page);
 			return -1;
 		}
@@ -7849,7 +9953,9 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	assert(vy_run_iterator_cache_get(itr, page_no) == NULL);
 
 	/* Update cache */
-	vy_run_iterator_cache_put(itr, page, page_no);
+	if (page_cache != NULL)
+		page = vy_page_cache_add(page_cache, itr->run, page);
+	vy_run_iterator_cache_put(itr, page);
 
 	*result = page;
 	return 0;
@@ -7914,6 +10020,119 @@ vy_run_iterator_search_page(struct vy_run_iterator *itr,
 	return end;
 }
 
+/**
+ * Start reading the page the iterator is going to start the
+ * search from, so that the first pages of all runs of a range
+ * are read in parallel. The page is found by a binary search
+ * in the page index, which doesn't need disk access. Point
+ * lookups are skipped, because they may be filtered out by
+ * the bloom filter.
+ */
+static void
+vy_run_iterator_read_ahead_start(struct vy_run_iterator *itr)
+{
+	if (itr->iterator_type == ITER_EQ || itr->run->info.count == 0 ||
+	    !vy_run_iterator_can_read_ahead(itr))
+		return;
+	uint32_t page_no;
+	if (tuple_field_count(itr->key) > 0) {
+		bool unused = false;
+		page_no = vy_run_iterator_search_page(itr, itr->key, &unused);
+		if (page_no > 0)
+			page_no--;
+	} else if (itr->iterator_type == ITER_LE) {
+		page_no = itr->run->info.count - 1;
+	} else {
+		page_no = 0;
+	}
+	vy_page_cache_read_ahead(itr->index->env, itr->run, page_no);
+}
+
+/** Return the offset of a restart point of a page key index. */
+static inline uint32_t
+vy_page_restart(const struct vy_page *page, uint32_t restart_no)
+{
+	assert(restart_no < page->restart_count);
+	const char *pos = page->restarts + restart_no * sizeof(uint32_t);
+	return mp_load_u32(&pos);
+}
+
+/**
+ * Binary search in page key index, see vy_page::keys.
+ * Finds the restart point block the key falls into by a binary
+ * search over restart point keys, which are stored as is, then
+ * scans the block restoring prefix-compressed keys. Statements
+ * are not decoded.
+ * @sa vy_run_iterator_search_in_page()
+ *
+ * @retval  0 success, the position is stored in *pos
+ * @retval -1 memory error
+ */
+static int
+vy_page_search_keys(struct vy_page *page, const struct tuple *key,
+		    const struct key_def *key_def, int zero_cmp,
+		    bool *equal_key, uint32_t *pos)
+{
+	assert(page->keys != NULL);
+	/* Find the first restart point with a key >= the given key. */
+	uint32_t beg = 0;
+	uint32_t end = page->restart_count;
+	while (beg != end) {
+		uint32_t mid = beg + (end - beg) / 2;
+		const char *data = page->keys + vy_page_restart(page, mid);
+		uint32_t shared = mp_decode_uint(&data);
+		assert(shared == 0);
+		(void) shared;
+		mp_decode_uint(&data); /* key size */
+		int cmp = -vy_stmt_compare_with_raw_key(key, data, key_def);
+		cmp = cmp ? cmp : zero_cmp;
+		*equal_key = *equal_key || cmp == 0;
+		if (cmp < 0)
+			beg = mid + 1;
+		else
+			end = mid;
+	}
+	if (end == 0) {
+		*pos = 0;
+		return 0;
+	}
+	/* Scan the block preceding the restart point found. */
+	uint32_t block = end - 1;
+	uint32_t stmt_no = block * VY_PAGE_KEY_RESTART_INTERVAL;
+	uint32_t stmt_end = MIN(stmt_no + VY_PAGE_KEY_RESTART_INTERVAL,
+				page->count);
+	const char *data = page->keys + vy_page_restart(page, block);
+	/*
+	 * A restored key consists of bytes stored in the block,
+	 * so the block size is enough to store any of its keys.
+	 */
+	const char *data_end = block + 1 < page->restart_count ?
+		page->keys + vy_page_restart(page, block + 1) :
+		page->restarts;
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	char *buf = region_alloc(region, data_end - data);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, data_end - data, "region", "key");
+		return -1;
+	}
+	for (; stmt_no < stmt_end; stmt_no++) {
+		uint32_t shared = mp_decode_uint(&data);
+		uint32_t unshared = mp_decode_uint(&data);
+		assert(data + unshared <= data_end);
+		memcpy(buf + shared, data, unshared);
+		data += unshared;
+		int cmp = -vy_stmt_compare_with_raw_key(key, buf, key_def);
+		cmp = cmp ? cmp : zero_cmp;
+		*equal_key = *equal_key || cmp == 0;
+		if (cmp >= 0)
+			break;
+	}
+	region_truncate(region, used);
+	*pos = stmt_no;
+	return 0;
+}
+
 /**
  * Binary search in page
  * In terms of STL, makes lower_bound for EQ,GE,LT and upper_bound for GT,LE
@@ -7932,6 +10151,11 @@ vy_run_iterator_search_in_page(struct vy_run_iterator *itr,
 	int zero_cmp = itr->iterator_type == ITER_GT ||
 		       itr->iterator_type == ITER_LE ? -1 : 0;
 	struct vy_index *idx = itr->index;
+	uint32_t pos;
+	if (page->keys != NULL &&
+	    vy_page_search_keys(page, key, &idx->index_def->key_def,
+				zero_cmp, equal_key, &pos) == 0)
+		return pos;
 	while (beg != end) {
 		uint32_t mid = beg + (end - beg) / 2;
 		struct tuple *fnd_key = vy_page_stmt(page, mid, itr->format,
@@ -8148,8 +10372,11 @@ vy_run_iterator_start(struct vy_run_iterator *itr, struct tuple **ret)
 	*ret = NULL;
 
 	struct index_def *user_index_def = itr->index->user_index_def;
-	if (itr->run->info.has_bloom && itr->iterator_type == ITER_EQ &&
-	    tuple_field_count(itr->key) >= user_index_def->key_def.part_count) {
+	struct vy_run_info *run_info = &itr->run->info;
+	uint32_t key_field_count = tuple_field_count(itr->key);
+	bool bloom_checked = false;
+	if (run_info->has_bloom && itr->iterator_type == ITER_EQ &&
+	    key_field_count >= user_index_def->key_def.part_count) {
 		uint32_t hash;
 		if (vy_stmt_type(itr->key) == IPROTO_SELECT) {
 			const char *data = tuple_data(itr->key);
@@ -8158,11 +10385,28 @@ vy_run_iterator_start(struct vy_run_iterator *itr, struct tuple **ret)
 		} else {
 			hash = tuple_hash(itr->key, user_index_def);
 		}
-		if (!bloom_possible_has(&itr->run->info.bloom, hash)) {
+		if (!bloom_possible_has(&run_info->bloom, hash)) {
+			itr->search_ended = true;
+			itr->stat->bloom_reflections++;
+			return 0;
+		}
+		bloom_checked = true;
+	} else if (itr->iterator_type == ITER_EQ && key_field_count > 0 &&
+		   key_field_count <= run_info->prefix_bloom_count &&
+		   vy_stmt_type(itr->key) == IPROTO_SELECT) {
+		/* Partial key: check the bloom filter of the prefix. */
+		const char *data = tuple_data(itr->key);
+		mp_decode_array(&data);
+		uint32_t hash = key_hash_prefix(data, user_index_def,
+						key_field_count);
+		struct bloom *bloom =
+			&run_info->prefix_blooms[key_field_count - 1];
+		if (!bloom_possible_has(bloom, hash)) {
 			itr->search_ended = true;
 			itr->stat->bloom_reflections++;
 			return 0;
 		}
+		bloom_checked = true;
 	}
 
 	itr->stat->lookup_count++;
@@ -8202,6 +10446,8 @@ vy_run_iterator_start(struct vy_run_iterator *itr, struct tuple **ret)
 		itr->curr_pos.pos_in_page = 0;
 	}
 	if (itr->iterator_type == ITER_EQ && !equal_found) {
+		if (bloom_checked)
+			itr->stat->bloom_false_positives++;
 		vy_run_iterator_cache_clean(itr);
 		itr->search_ended = true;
 		return 0;
@@ -9468,6 +11714,19 @@ struct vy_write_iterator {
 	struct tuple *key;
 	struct tuple *tmp_stmt;
 	struct vy_merge_iterator mi;
+	/**
+	 * If set, collect the tuples overwritten by DELETEs, so
+	 * that their entries can be purged from secondary indexes
+	 * of a space that defers deletes, see
+	 * vy_index_purge_stale().
+	 */
+	bool collect_deleted;
+	/** Collected tuples overwritten by DELETEs. */
+	struct tuple **deleted;
+	/** Number of collected tuples. */
+	uint32_t deleted_count;
+	/** Size of the deleted array. */
+	uint32_t deleted_capacity;
 	/* Usage statistics of mem iterators */
 	struct vy_iterator_stat mem_iterator_stat;
 	/* Usage statistics of run iterators */
@@ -9476,11 +11735,13 @@ struct vy_write_iterator {
 
 /*
  * Open an empty write iterator. To add sources to the iterator
- * use vy_write_iterator_add_* functions
+ * use vy_write_iterator_add_* functions. If @start_key is not
+ * NULL, the iterator skips statements less than the key.
  */
 static int
 vy_write_iterator_open(struct vy_write_iterator *wi, struct vy_index *index,
-		       bool is_last_level, int64_t oldest_vlsn)
+		       bool is_last_level, int64_t oldest_vlsn,
+		       const char *start_key)
 {
 	struct vy_env *env = index->env;
 	wi->index = index;
@@ -9488,7 +11749,10 @@ vy_write_iterator_open(struct vy_write_iterator *wi, struct vy_index *index,
 	wi->is_last_level = is_last_level;
 	wi->goto_next_key = false;
 
-	wi->key = vy_stmt_new_select(env->key_format, NULL, 0);
+	uint32_t part_count = 0;
+	if (start_key != NULL)
+		part_count = mp_decode_array(&start_key);
+	wi->key = vy_stmt_new_select(env->key_format, start_key, part_count);
 	if (wi->key == NULL)
 		return -1;
 	wi->surrogate_format = index->surrogate_format;
@@ -9500,9 +11764,51 @@ vy_write_iterator_open(struct vy_write_iterator *wi, struct vy_index *index,
 	return 0;
 }
 
+/**
+ * Max number of deleted tuples collected by a write iterator, see
+ * vy_write_iterator::collect_deleted. The rest of the stale
+ * entries are purged on read.
+ */
+enum { VY_WRITE_ITERATOR_DELETED_MAX = 65536 };
+
+/**
+ * Remember the tuple overwritten by the DELETE the write
+ * iterator is positioned at, see
+ * vy_write_iterator::collect_deleted.
+ */
+static NODISCARD int
+vy_write_iterator_collect_deleted(struct vy_write_iterator *wi)
+{
+	if (wi->deleted_count >= VY_WRITE_ITERATOR_DELETED_MAX)
+		return 0;
+	struct tuple *older;
+	if (vy_merge_iterator_next_lsn(&wi->mi, &older) != 0)
+		return -1;
+	if (older == NULL || vy_stmt_type(older) != IPROTO_REPLACE)
+		return 0;
+	if (wi->deleted_count == wi->deleted_capacity) {
+		uint32_t capacity = wi->deleted_capacity > 0 ?
+				    wi->deleted_capacity * 2 : 64;
+		size_t size = capacity * sizeof(*wi->deleted);
+		struct tuple **deleted = realloc(wi->deleted, size);
+		if (deleted == NULL) {
+			diag_set(OutOfMemory, size, "realloc", "deleted");
+			return -1;
+		}
+		wi->deleted = deleted;
+		wi->deleted_capacity = capacity;
+	}
+	/* The statement may be allocated on lsregion, copy it. */
+	older = vy_stmt_dup(older, tuple_format_by_id(older->format_id));
+	if (older == NULL)
+		return -1;
+	wi->deleted[wi->deleted_count++] = older;
+	return 0;
+}
+
 static struct vy_write_iterator *
 vy_write_iterator_new(struct vy_index *index, bool is_last_level,
-		      int64_t oldest_vlsn)
+		      int64_t oldest_vlsn, const char *start_key)
 {
 	struct vy_write_iterator *wi = calloc(1, sizeof(*wi));
 	if (wi == NULL) {
@@ -9510,7 +11816,7 @@ vy_write_iterator_new(struct vy_index *index, bool is_last_level,
 		return NULL;
 	}
 	if (vy_write_iterator_open(wi, index, is_last_level,
-				   oldest_vlsn) != 0) {
+				   oldest_vlsn, start_key) != 0) {
 		free(wi);
 		return NULL;
 	}
@@ -9594,6 +11900,23 @@ vy_write_iterator_next(struct vy_write_iterator *wi, struct tuple **ret)
 		if (vy_stmt_lsn(stmt) > wi->oldest_vlsn)
 			break; /* Save the current stmt as the result. */
 		wi->goto_next_key = true;
+		if (vy_stmt_type(stmt) == IPROTO_DELETE &&
+		    wi->collect_deleted) {
+			/*
+			 * Moving to the overwritten statement
+			 * may free the current one.
+			 */
+			tuple_ref(stmt);
+			int rc = vy_write_iterator_collect_deleted(wi);
+			if (rc != 0 || wi->is_last_level) {
+				tuple_unref(stmt);
+				if (rc != 0)
+					return -1;
+				continue; /* Skip unnecessary DELETE */
+			}
+			wi->tmp_stmt = stmt;
+			break;
+		}
 		if (vy_stmt_type(stmt) == IPROTO_DELETE && wi->is_last_level)
 			continue; /* Skip unnecessary DELETE */
 		if (vy_stmt_type(stmt) == IPROTO_REPLACE ||
@@ -9657,6 +11980,9 @@ vy_write_iterator_delete(struct vy_write_iterator *wi)
 
 	assert(wi->tmp_stmt == NULL);
 	assert(wi->key == NULL);
+	for (uint32_t i = 0; i < wi->deleted_count; i++)
+		tuple_unref(wi->deleted[i]);
+	free(wi->deleted);
 	tuple_format_ref(wi->surrogate_format, -1);
 	tuple_format_ref(wi->upsert_format, -1);
 	vy_merge_iterator_close(&wi->mi);
@@ -9762,6 +12088,7 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 				     itr->index, run, itr->iterator_type,
 				     itr->key, itr->vlsn, format,
 				     itr->index->upsert_format);
+		vy_run_iterator_read_ahead_start(&sub_src->run_iterator);
 	}
 }
 
@@ -10096,7 +12423,8 @@ vy_join_cb(const struct xctl_record *record, void *cb_arg)
 	struct vy_run *run = vy_run_new(record->vy_run_id);
 	if (run == NULL)
 		goto out;
-	if (vy_run_recover(run, arg->index_path) != 0)
+	if (vy_run_recover(run, arg->index_path,
+			   arg->env->conf->direct_io) != 0)
 		goto out_free_run;
 
 	ZSTD_DStream *zdctx = vy_env_get_zdctx(arg->env);
@@ -10106,10 +12434,10 @@ vy_join_cb(const struct xctl_record *record, void *cb_arg)
 	/* Send the run's statements to the replica. */
 	for (uint32_t page_no = 0; page_no < run->info.count; page_no++) {
 		struct vy_page_info *pi = vy_run_page_info(run, page_no);
-		struct vy_page *page = vy_page_new(pi);
+		struct vy_page *page = vy_page_new(run->id, page_no, pi);
 		if (page == NULL)
 			goto out_free_run;
-		if (vy_page_read(page, pi, run->fd, zdctx) != 0)
+		if (vy_page_read(page, pi, run, zdctx) != 0)
 			goto out_free_page;
 		for (uint32_t stmt_no = 0; stmt_no < pi->count; stmt_no++) {
 			struct xrow_header xrow;
@@ -10401,6 +12729,7 @@ vy_cursor_new(struct vy_tx *tx, struct vy_index *index, const char *key,
 	c->tx = tx;
 	c->start = tx->start;
 	c->need_check_eq = false;
+	c->interval = NULL;
 	enum iterator_type iterator_type;
 	switch (type) {
 	case ITER_ALL:
@@ -10433,6 +12762,52 @@ vy_cursor_new(struct vy_tx *tx, struct vy_index *index, const char *key,
 	return c;
 }
 
+/**
+ * Remember the read made by a cursor in the conflict manager
+ * index: extend the interval read by the cursor to the statement
+ * it has just returned or, if @a stmt is NULL, to the end of the
+ * cursor key range.
+ */
+static int
+vy_cursor_track(struct vy_cursor *c, struct tuple *stmt)
+{
+	struct vy_tx *tx = c->tx;
+	if (tx->is_in_read_view)
+		return 0; /* no reason to track reads */
+	struct vy_index *index = c->index;
+	enum iterator_type type = c->iterator_type;
+	bool is_forward = type == ITER_EQ || type == ITER_GE ||
+			  type == ITER_GT;
+	struct vy_read_interval *interval = c->interval;
+	if (interval == NULL) {
+		/* Nothing has been read yet, start from the key. */
+		bool belongs = type != ITER_GT && type != ITER_LT;
+		interval = vy_read_interval_new(tx, index, c->key, belongs,
+						c->key, belongs);
+		if (interval == NULL)
+			return -1;
+		interval->is_gap = true;
+		rlist_add_tail_entry(&tx->read_set, interval, in_tx);
+		c->interval = interval;
+	} else {
+		vy_read_set_remove(&index->read_set, interval);
+	}
+	if (stmt != NULL)
+		interval->is_gap = false;
+	/*
+	 * An EQ interval is [key, key] from the start, a partial
+	 * key covers all statements starting with it.
+	 */
+	if (type != ITER_EQ) {
+		if (is_forward)
+			vy_read_interval_set_right(interval, stmt, true);
+		else
+			vy_read_interval_set_left(interval, stmt, true);
+	}
+	vy_read_set_insert(&index->read_set, interval);
+	return 0;
+}
+
 int
 vy_cursor_next(struct vy_cursor *c, struct tuple **result)
 {
@@ -10448,31 +12823,80 @@ vy_cursor_next(struct vy_cursor *c, struct tuple **result)
 	}
 
 	assert(c->key != NULL);
-	int rc = vy_read_iterator_next(&c->iterator, &vyresult);
-	if (rc)
+next:
+	if (vy_read_iterator_next(&c->iterator, &vyresult) != 0)
 		return -1;
 	c->n_reads++;
-	if (vy_tx_track(c->tx, index, vyresult ? vyresult : c->key,
-			vyresult == NULL))
+	if (vy_cursor_track(c, vyresult) != 0)
 		return -1;
 	if (vyresult == NULL)
 		return 0;
 	if (c->need_check_eq &&
 	    vy_tuple_compare_with_key(vyresult, c->key, &def->key_def) != 0)
 		return 0;
-	if (def->iid > 0 && vy_index_full_by_stmt(c->tx, index, vyresult,
-						  &vyresult))
-		return -1;
-	*result = vyresult;
+	if (def->iid == 0) {
+		tuple_ref(vyresult);
+		*result = vyresult;
+		return 0;
+	}
 	/**
-	 * If the index is not primary (def->iid != 0) then no
-	 * need to reference the tuple, because it is returned
-	 * from vy_index_full_by_stmt() as new statement with 1
-	 * reference.
+	 * The tuple is returned from vy_index_full_by_stmt_checked()
+	 * as new statement with 1 reference, no need to reference it.
 	 */
-	if (def->iid == 0)
-		tuple_ref(vyresult);
-	return *result != NULL ? 0 : -1;
+	if (vy_index_full_by_stmt_checked(c->tx, index, vyresult, result))
+		return -1;
+	if (*result == NULL) {
+		/* Skip a stale entry left by a deferred DELETE. */
+		goto next;
+	}
+	return 0;
+}
+
+int
+vy_cursor_count(struct vy_cursor *c, size_t *count)
+{
+	struct vy_index *index = c->index;
+	struct index_def *def = index->index_def;
+	assert(index->space_index_count > 0);
+	*count = 0;
+
+	if (c->tx == NULL) {
+		diag_set(ClientError, ER_NO_ACTIVE_TRANSACTION);
+		return -1;
+	}
+	/*
+	 * A secondary index entry can only be stale if the space
+	 * defers deletes, otherwise there is no need to look up
+	 * the full tuple in the primary index just to count it.
+	 * The option can't be switched off while the space has
+	 * secondary indexes, so stale entries can't outlive it.
+	 */
+	bool check_stale = def->iid > 0 && index->space->def.opts.defer_deletes;
+	assert(c->key != NULL);
+	while (true) {
+		struct tuple *vyresult = NULL;
+		if (vy_read_iterator_next(&c->iterator, &vyresult) != 0)
+			return -1;
+		c->n_reads++;
+		if (vy_cursor_track(c, vyresult) != 0)
+			return -1;
+		if (vyresult == NULL)
+			return 0;
+		if (c->need_check_eq &&
+		    vy_tuple_compare_with_key(vyresult, c->key,
+					      &def->key_def) != 0)
+			return 0;
+		if (check_stale) {
+			struct tuple *full;
+			if (vy_index_full_by_stmt_checked(c->tx, index,
+							  vyresult, &full))
+				return -1;
+			if (full == NULL)
+				continue;
+			tuple_unref(full);
+		}
+		++*count;
+	}
 }
 
 void
@@ -208,6 +208,15 @@ int
 vy_upsert(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	  struct request *request);
 
+/**
+ * Delay the current fiber before it executes a statement on
+ * @space if memory is consumed faster than it can be reclaimed,
+ * see vy_quota_delay(). The delay is accounted to the primary
+ * index of the space.
+ */
+void
+vy_throttle(struct vy_env *e, struct space *space);
+
 int
 vy_prepare(struct vy_env *e, struct vy_tx *tx);
 
@@ -275,6 +284,19 @@ vy_index_drop(struct vy_index *index);
 size_t
 vy_index_bsize(struct vy_index *db);
 
+/**
+ * Estimate the number of tuples matching a key without reading
+ * anything from disk: run page metadata and in-memory tree ranks
+ * are used instead.
+ *
+ * @retval  0 Success, the estimate is stored in @a result.
+ * @retval -1 Memory error.
+ */
+int
+vy_index_count_approximate(struct vy_index *index, enum iterator_type type,
+			   const char *key, uint32_t part_count,
+			   size_t *result);
+
 /*
  * Index Cursor
  */
@@ -294,6 +316,13 @@ vy_cursor_delete(struct vy_cursor *cursor);
 int
 vy_cursor_next(struct vy_cursor *cursor, struct tuple **result);
 
+/**
+ * Count the statements left in the cursor without returning
+ * them, the cursor is exhausted after the call.
+ */
+int
+vy_cursor_count(struct vy_cursor *cursor, size_t *count);
+
 /*
  * Replication
  */
@@ -117,17 +117,41 @@ VinylIndex::max(const char *key, uint32_t part_count) const
 	return it->next(it);
 }
 
+bool
+VinylIndex::isEmpty() const
+{
+	return min(NULL, 0) == NULL;
+}
+
 size_t
 VinylIndex::count(enum iterator_type type, const char *key,
 		  uint32_t part_count) const
 {
-	struct iterator *it = allocIterator();
-	auto guard = make_scoped_guard([=]{it->free(it);});
-	initIterator(it, type, key, part_count);
-	size_t count = 0;
-	struct tuple *tuple = NULL;
-	while ((tuple = it->next(it)) != NULL)
-		++count;
+	if (type > ITER_GT || type < 0)
+		return Index::count(type, key, part_count);
+	struct vy_tx *tx =
+		in_txn() ? (struct vy_tx *) in_txn()->engine_tx : NULL;
+	struct vy_cursor *cursor = vy_cursor_new(tx, db, key, part_count,
+						 type);
+	if (cursor == NULL)
+		diag_raise();
+	auto guard = make_scoped_guard([=]{vy_cursor_delete(cursor);});
+	size_t count;
+	if (vy_cursor_count(cursor, &count) != 0)
+		diag_raise();
+	return count;
+}
+
+size_t
+VinylIndex::approximateCount(enum iterator_type type, const char *key,
+			     uint32_t part_count) const
+{
+	if (type > ITER_GT || type < 0)
+		return Index::approximateCount(type, key, part_count);
+	size_t count;
+	if (vy_index_count_approximate(db, type, key, part_count,
+				       &count) != 0)
+		diag_raise();
 	return count;
 }
 
@@ -63,10 +63,17 @@ public:
 	virtual struct tuple *
 	max(const char *key, uint32_t part_count) const override;
 
+	virtual bool
+	isEmpty() const override;
+
 	virtual size_t
 	count(enum iterator_type type, const char *key, uint32_t part_count)
 		const override;
 
+	virtual size_t
+	approximateCount(enum iterator_type type, const char *key,
+			 uint32_t part_count) const override;
+
 public:
 	struct vy_env *env;
 	struct vy_index *db;
@@ -104,6 +104,7 @@ VinylSpace::executeReplace(struct txn *txn, struct space *space,
 	struct vy_tx *tx = (struct vy_tx *)txn->engine_tx;
 	struct txn_stmt *stmt = txn_current_stmt(txn);
 
+	vy_throttle(((VinylEngine *)engine)->env, space);
 	if (vy_replace(tx, stmt, space, request))
 		diag_raise();
 
@@ -117,6 +118,7 @@ VinylSpace::executeDelete(struct txn *txn, struct space *space,
 {
 	struct txn_stmt *stmt = txn_current_stmt(txn);
 	struct vy_tx *tx = (struct vy_tx *) txn->engine_tx;
+	vy_throttle(((VinylEngine *)engine)->env, space);
 	if (vy_delete(tx, stmt, space, request))
 		diag_raise();
 	/*
@@ -132,6 +134,7 @@ VinylSpace::executeUpdate(struct txn *txn, struct space *space,
 {
 	struct vy_tx *tx = (struct vy_tx *)txn->engine_tx;
 	struct txn_stmt *stmt = txn_current_stmt(txn);
+	vy_throttle(((VinylEngine *)engine)->env, space);
 	if (vy_update(tx, stmt, space, request) != 0)
 		diag_raise();
 	return stmt->new_tuple;
@@ -143,6 +146,7 @@ VinylSpace::executeUpsert(struct txn *txn, struct space *space,
 {
 	struct vy_tx *tx = (struct vy_tx *)txn->engine_tx;
 	struct txn_stmt *stmt = txn_current_stmt(txn);
+	vy_throttle(((VinylEngine *)engine)->env, space);
 	if (vy_upsert(tx, stmt, space, request) != 0)
 		diag_raise();
 }
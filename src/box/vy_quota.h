@@ -67,6 +67,22 @@ struct vy_quota {
 	size_t watermark;
 	/** Current memory consumption. */
 	size_t used;
+	/**
+	 * Rate, in bytes per second, at which new transactions
+	 * are admitted while the watermark is exceeded. Set to
+	 * the expected memory reclaim rate, so that writers are
+	 * slowed down gradually instead of being stalled at the
+	 * hard limit. SIZE_MAX means no rate limit.
+	 */
+	size_t rate;
+	/**
+	 * Token bucket used for rate limiting: number of bytes
+	 * that may be consumed without a delay. Goes negative
+	 * when writers are ahead of the rate.
+	 */
+	double tokens;
+	/** Time when the token bucket was last refilled. */
+	double refill_time;
 	/** Quota callback. */
 	vy_quota_cb cb;
 	/** Argument passed to cb. */
@@ -79,6 +95,9 @@ vy_quota_init(struct vy_quota *q, vy_quota_cb cb, void *cb_arg)
 	q->limit = SIZE_MAX;
 	q->watermark = SIZE_MAX;
 	q->used = 0;
+	q->rate = SIZE_MAX;
+	q->tokens = 0;
+	q->refill_time = 0;
 	q->cb = cb;
 	q->cb_arg = cb_arg;
 }
@@ -100,7 +119,7 @@ static inline void
 vy_quota_set_limit(struct vy_quota *q, size_t limit)
 {
 	q->limit = q->watermark = limit;
-	if (q->used >= limit)
+	if (q->cb != NULL && q->used >= limit)
 		q->cb(VY_QUOTA_EXCEEDED, q->cb_arg);
 }
 
@@ -128,6 +147,66 @@ vy_quota_update_watermark(struct vy_quota *q, size_t chunk_size,
 		q->watermark = 0;
 }
 
+/**
+ * Set the rate at which transactions are admitted once
+ * the watermark is exceeded, in bytes per second.
+ */
+static inline void
+vy_quota_set_rate(struct vy_quota *q, size_t rate)
+{
+	q->rate = rate > 0 ? rate : 1;
+}
+
+/**
+ * Maximal amount of memory that may be consumed in one go
+ * without a delay once the watermark is exceeded, expressed
+ * in milliseconds worth of the admission rate.
+ */
+enum { VY_QUOTA_BURST_MS = 100 };
+
+/** Refill the admission rate token bucket at time @now. */
+static inline void
+vy_quota_refill(struct vy_quota *q, double now)
+{
+	double burst = (double)q->rate * VY_QUOTA_BURST_MS / 1000;
+	q->tokens += (now - q->refill_time) * q->rate;
+	q->refill_time = now;
+	if (q->tokens > burst)
+		q->tokens = burst;
+}
+
+/**
+ * Account @size bytes of memory consumed at time @now against
+ * the admission rate. Never blocks: writers that got ahead of
+ * the rate are delayed by vy_quota_delay() before their next
+ * statement.
+ */
+static inline void
+vy_quota_charge(struct vy_quota *q, size_t size, double now)
+{
+	if (q->rate == SIZE_MAX)
+		return;
+	vy_quota_refill(q, now);
+	if (q->used >= q->watermark)
+		q->tokens -= size;
+}
+
+/**
+ * Return the time, in seconds, a writer should sleep at time
+ * @now before consuming more memory to keep memory consumption
+ * within the admission rate, or 0 if it may proceed.
+ */
+static inline double
+vy_quota_delay(struct vy_quota *q, double now)
+{
+	if (q->rate == SIZE_MAX || q->used < q->watermark)
+		return 0;
+	vy_quota_refill(q, now);
+	if (q->tokens >= 0)
+		return 0;
+	return -q->tokens / q->rate;
+}
+
 /**
  * Consume @size bytes of memory. Throttle the caller if
  * the limit is exceeded.
@@ -0,0 +1,396 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "vy_read_set.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "trivia/util.h"
+#include "diag.h"
+#include "tuple.h"
+#include "vy_stmt.h"
+
+struct vy_read_interval *
+vy_read_interval_new(struct vy_tx *tx, struct vy_index *index,
+		     struct tuple *left, bool left_belongs,
+		     struct tuple *right, bool right_belongs)
+{
+	struct vy_read_interval *interval = malloc(sizeof(*interval));
+	if (interval == NULL) {
+		diag_set(OutOfMemory, sizeof(*interval),
+			 "malloc", "struct vy_read_interval");
+		return NULL;
+	}
+	interval->tx = tx;
+	interval->index = index;
+	interval->left = left;
+	interval->left_belongs = left_belongs;
+	if (left != NULL)
+		tuple_ref(left);
+	interval->right = right;
+	interval->right_belongs = right_belongs;
+	if (right != NULL)
+		tuple_ref(right);
+	interval->is_gap = false;
+	rlist_create(&interval->in_tx);
+	interval->tree_left = interval->tree_right = NULL;
+	interval->priority = rand();
+	interval->subtree_last = interval;
+	return interval;
+}
+
+void
+vy_read_interval_delete(struct vy_read_interval *interval)
+{
+	if (interval->left != NULL)
+		tuple_unref(interval->left);
+	if (interval->right != NULL)
+		tuple_unref(interval->right);
+	TRASH(interval);
+	free(interval);
+}
+
+void
+vy_read_interval_set_left(struct vy_read_interval *interval,
+			  struct tuple *left, bool left_belongs)
+{
+	if (left != NULL)
+		tuple_ref(left);
+	if (interval->left != NULL)
+		tuple_unref(interval->left);
+	interval->left = left;
+	interval->left_belongs = left_belongs;
+}
+
+void
+vy_read_interval_set_right(struct vy_read_interval *interval,
+			   struct tuple *right, bool right_belongs)
+{
+	if (right != NULL)
+		tuple_ref(right);
+	if (interval->right != NULL)
+		tuple_unref(interval->right);
+	interval->right = right;
+	interval->right_belongs = right_belongs;
+}
+
+/**
+ * Number of key parts in a boundary: a key may be partial,
+ * a statement always has all of them.
+ */
+static inline uint32_t
+vy_read_set_part_count(const struct tuple *stmt, const struct key_def *key_def)
+{
+	if (vy_stmt_type(stmt) != IPROTO_SELECT)
+		return key_def->part_count;
+	uint32_t part_count = tuple_field_count(stmt);
+	return MIN(part_count, key_def->part_count);
+}
+
+/**
+ * Compare left boundaries of two intervals. A partial key
+ * boundary that belongs to the interval is less than any key
+ * it is a prefix of, a boundary that doesn't belong to it is
+ * greater than any such key.
+ */
+static int
+vy_read_interval_cmpl(const struct key_def *key_def,
+		      const struct vy_read_interval *a,
+		      const struct vy_read_interval *b)
+{
+	if (a->left == NULL || b->left == NULL)
+		return (a->left != NULL) - (b->left != NULL);
+	int cmp = vy_stmt_compare(a->left, b->left, key_def);
+	if (cmp != 0)
+		return cmp;
+	if (a->left_belongs != b->left_belongs)
+		return a->left_belongs ? -1 : 1;
+	uint32_t a_parts = vy_read_set_part_count(a->left, key_def);
+	uint32_t b_parts = vy_read_set_part_count(b->left, key_def);
+	if (a->left_belongs)
+		return a_parts < b_parts ? -1 : a_parts > b_parts;
+	else
+		return a_parts > b_parts ? -1 : a_parts < b_parts;
+}
+
+/**
+ * Compare right boundaries of two intervals, see
+ * vy_read_interval_cmpl().
+ */
+static int
+vy_read_interval_cmpr(const struct key_def *key_def,
+		      const struct vy_read_interval *a,
+		      const struct vy_read_interval *b)
+{
+	if (a->right == NULL || b->right == NULL)
+		return (a->right == NULL) - (b->right == NULL);
+	int cmp = vy_stmt_compare(a->right, b->right, key_def);
+	if (cmp != 0)
+		return cmp;
+	if (a->right_belongs != b->right_belongs)
+		return a->right_belongs ? 1 : -1;
+	uint32_t a_parts = vy_read_set_part_count(a->right, key_def);
+	uint32_t b_parts = vy_read_set_part_count(b->right, key_def);
+	if (a->right_belongs)
+		return a_parts < b_parts ? 1 : -(a_parts > b_parts);
+	else
+		return a_parts > b_parts ? 1 : -(a_parts < b_parts);
+}
+
+/**
+ * Order of intervals in the tree: by the left boundary, then
+ * by the transaction, then by the right boundary.
+ */
+static int
+vy_read_interval_cmp(const struct key_def *key_def,
+		     const struct vy_read_interval *a,
+		     const struct vy_read_interval *b)
+{
+	int cmp = vy_read_interval_cmpl(key_def, a, b);
+	if (cmp != 0)
+		return cmp;
+	if (a->tx != b->tx)
+		return a->tx < b->tx ? -1 : 1;
+	return vy_read_interval_cmpr(key_def, a, b);
+}
+
+/** Total order of tree nodes, equal intervals are told apart. */
+static inline int
+vy_read_set_node_cmp(const struct key_def *key_def,
+		     const struct vy_read_interval *a,
+		     const struct vy_read_interval *b)
+{
+	int cmp = vy_read_interval_cmp(key_def, a, b);
+	if (cmp != 0)
+		return cmp;
+	return a < b ? -1 : a > b;
+}
+
+/** Is the key less than the left boundary of the interval? */
+static inline bool
+vy_read_interval_key_is_before(const struct key_def *key_def,
+			       const struct tuple *stmt,
+			       const struct vy_read_interval *interval)
+{
+	if (interval->left == NULL)
+		return false;
+	int cmp = vy_stmt_compare(stmt, interval->left, key_def);
+	return cmp < 0 || (cmp == 0 && !interval->left_belongs);
+}
+
+/** Is the key greater than the right boundary of the interval? */
+static inline bool
+vy_read_interval_key_is_after(const struct key_def *key_def,
+			      const struct tuple *stmt,
+			      const struct vy_read_interval *interval)
+{
+	if (interval->right == NULL)
+		return false;
+	int cmp = vy_stmt_compare(stmt, interval->right, key_def);
+	return cmp > 0 || (cmp == 0 && !interval->right_belongs);
+}
+
+/** Recalculate the subtree augmentation of a node. */
+static inline void
+vy_read_set_update(const struct key_def *key_def,
+		   struct vy_read_interval *node)
+{
+	struct vy_read_interval *last = node;
+	struct vy_read_interval *child = node->tree_left;
+	if (child != NULL &&
+	    vy_read_interval_cmpr(key_def, child->subtree_last, last) > 0)
+		last = child->subtree_last;
+	child = node->tree_right;
+	if (child != NULL &&
+	    vy_read_interval_cmpr(key_def, child->subtree_last, last) > 0)
+		last = child->subtree_last;
+	node->subtree_last = last;
+}
+
+static struct vy_read_interval *
+vy_read_set_rotate_right(const struct key_def *key_def,
+			 struct vy_read_interval *node)
+{
+	struct vy_read_interval *top = node->tree_left;
+	node->tree_left = top->tree_right;
+	top->tree_right = node;
+	vy_read_set_update(key_def, node);
+	vy_read_set_update(key_def, top);
+	return top;
+}
+
+static struct vy_read_interval *
+vy_read_set_rotate_left(const struct key_def *key_def,
+			struct vy_read_interval *node)
+{
+	struct vy_read_interval *top = node->tree_right;
+	node->tree_right = top->tree_left;
+	top->tree_left = node;
+	vy_read_set_update(key_def, node);
+	vy_read_set_update(key_def, top);
+	return top;
+}
+
+static struct vy_read_interval *
+vy_read_set_insert_r(const struct key_def *key_def,
+		     struct vy_read_interval *node,
+		     struct vy_read_interval *interval)
+{
+	if (node == NULL)
+		return interval;
+	if (vy_read_set_node_cmp(key_def, interval, node) < 0) {
+		node->tree_left = vy_read_set_insert_r(key_def,
+						       node->tree_left,
+						       interval);
+		if (node->tree_left->priority > node->priority)
+			return vy_read_set_rotate_right(key_def, node);
+	} else {
+		node->tree_right = vy_read_set_insert_r(key_def,
+							node->tree_right,
+							interval);
+		if (node->tree_right->priority > node->priority)
+			return vy_read_set_rotate_left(key_def, node);
+	}
+	vy_read_set_update(key_def, node);
+	return node;
+}
+
+void
+vy_read_set_insert(struct vy_read_set *set, struct vy_read_interval *interval)
+{
+	interval->tree_left = interval->tree_right = NULL;
+	interval->subtree_last = interval;
+	set->root = vy_read_set_insert_r(set->key_def, set->root, interval);
+	set->count++;
+}
+
+/** Merge two subtrees, all nodes of @a a are less than of @a b. */
+static struct vy_read_interval *
+vy_read_set_merge(const struct key_def *key_def,
+		  struct vy_read_interval *a, struct vy_read_interval *b)
+{
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (a->priority > b->priority) {
+		a->tree_right = vy_read_set_merge(key_def, a->tree_right, b);
+		vy_read_set_update(key_def, a);
+		return a;
+	} else {
+		b->tree_left = vy_read_set_merge(key_def, a, b->tree_left);
+		vy_read_set_update(key_def, b);
+		return b;
+	}
+}
+
+static struct vy_read_interval *
+vy_read_set_remove_r(const struct key_def *key_def,
+		     struct vy_read_interval *node,
+		     struct vy_read_interval *interval)
+{
+	assert(node != NULL);
+	if (node == interval)
+		return vy_read_set_merge(key_def, node->tree_left,
+					 node->tree_right);
+	if (vy_read_set_node_cmp(key_def, interval, node) < 0) {
+		node->tree_left = vy_read_set_remove_r(key_def,
+						       node->tree_left,
+						       interval);
+	} else {
+		node->tree_right = vy_read_set_remove_r(key_def,
+							node->tree_right,
+							interval);
+	}
+	vy_read_set_update(key_def, node);
+	return node;
+}
+
+void
+vy_read_set_remove(struct vy_read_set *set, struct vy_read_interval *interval)
+{
+	assert(set->count > 0);
+	set->root = vy_read_set_remove_r(set->key_def, set->root, interval);
+	interval->tree_left = interval->tree_right = NULL;
+	interval->subtree_last = interval;
+	set->count--;
+}
+
+struct vy_read_interval *
+vy_read_set_search(struct vy_read_set *set, struct vy_tx *tx,
+		   struct tuple *left, bool left_belongs,
+		   struct tuple *right, bool right_belongs)
+{
+	struct vy_read_interval key;
+	key.tx = tx;
+	key.left = left;
+	key.left_belongs = left_belongs;
+	key.right = right;
+	key.right_belongs = right_belongs;
+	struct vy_read_interval *node = set->root;
+	while (node != NULL) {
+		int cmp = vy_read_interval_cmp(set->key_def, &key, node);
+		if (cmp == 0)
+			return node;
+		node = cmp < 0 ? node->tree_left : node->tree_right;
+	}
+	return NULL;
+}
+
+static void
+vy_read_set_walk_key_r(const struct key_def *key_def,
+		       struct vy_read_interval *node, const struct tuple *stmt,
+		       vy_read_set_walk_f cb, void *arg)
+{
+	while (node != NULL) {
+		/* All intervals of the subtree end before the key. */
+		if (vy_read_interval_key_is_after(key_def, stmt,
+						  node->subtree_last))
+			return;
+		vy_read_set_walk_key_r(key_def, node->tree_left, stmt, cb, arg);
+		/*
+		 * The node and its right subtree begin after
+		 * the key.
+		 */
+		if (vy_read_interval_key_is_before(key_def, stmt, node))
+			return;
+		if (!vy_read_interval_key_is_after(key_def, stmt, node))
+			cb(node, arg);
+		node = node->tree_right;
+	}
+}
+
+void
+vy_read_set_walk_key(struct vy_read_set *set, const struct tuple *stmt,
+		     vy_read_set_walk_f cb, void *arg)
+{
+	vy_read_set_walk_key_r(set->key_def, set->root, stmt, cb, arg);
+}
@@ -0,0 +1,175 @@
+#ifndef INCLUDES_TARANTOOL_BOX_VY_READ_SET_H
+#define INCLUDES_TARANTOOL_BOX_VY_READ_SET_H
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <small/rlist.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct tuple;
+struct key_def;
+struct vy_tx;
+struct vy_index;
+
+/**
+ * A key interval read by a transaction.
+ *
+ * A point lookup is tracked as an interval whose boundaries
+ * are both equal to the looked up key. A cursor tracks one
+ * interval from the search key to the last statement it
+ * returned, which grows as the cursor advances, instead of
+ * a record per returned statement.
+ */
+struct vy_read_interval {
+	/** Transaction that made the read. */
+	struct vy_tx *tx;
+	/** Index the interval was read from. */
+	struct vy_index *index;
+	/** Left boundary of the interval, NULL for -inf. */
+	struct tuple *left;
+	/** Set if the left boundary belongs to the interval. */
+	bool left_belongs;
+	/** Right boundary of the interval, NULL for +inf. */
+	struct tuple *right;
+	/** Set if the right boundary belongs to the interval. */
+	bool right_belongs;
+	/**
+	 * Set if the read found nothing in the interval, so that
+	 * a DELETE in it deletes nothing and is not a conflict.
+	 */
+	bool is_gap;
+	/** Link in the list of reads of the transaction. */
+	struct rlist in_tx;
+	/** Children in the read set tree. */
+	struct vy_read_interval *tree_left;
+	struct vy_read_interval *tree_right;
+	/** Heap priority of the node in the read set tree. */
+	uint32_t priority;
+	/**
+	 * The interval with the greatest right boundary in the
+	 * subtree rooted at this node.
+	 */
+	struct vy_read_interval *subtree_last;
+};
+
+/**
+ * Intervals read by all active transactions from an index.
+ *
+ * It is a treap ordered by the left boundary and augmented with
+ * the greatest right boundary of each subtree. This allows to
+ * find all intervals containing a key in O(log N + K) rather
+ * than to look at every read made in the index.
+ */
+struct vy_read_set {
+	/** Root of the tree, NULL if the set is empty. */
+	struct vy_read_interval *root;
+	/** Key definition of the index. */
+	const struct key_def *key_def;
+	/** Number of intervals in the set. */
+	size_t count;
+};
+
+/**
+ * Allocate a read interval. The boundaries are referenced.
+ * @retval NULL Memory error.
+ */
+struct vy_read_interval *
+vy_read_interval_new(struct vy_tx *tx, struct vy_index *index,
+		     struct tuple *left, bool left_belongs,
+		     struct tuple *right, bool right_belongs);
+
+/** Free a read interval that is not in a read set. */
+void
+vy_read_interval_delete(struct vy_read_interval *interval);
+
+/**
+ * Replace the left boundary of an interval that is not in
+ * a read set.
+ */
+void
+vy_read_interval_set_left(struct vy_read_interval *interval,
+			  struct tuple *left, bool left_belongs);
+
+/**
+ * Replace the right boundary of an interval that is not in
+ * a read set.
+ */
+void
+vy_read_interval_set_right(struct vy_read_interval *interval,
+			   struct tuple *right, bool right_belongs);
+
+static inline void
+vy_read_set_create(struct vy_read_set *set, const struct key_def *key_def)
+{
+	set->root = NULL;
+	set->key_def = key_def;
+	set->count = 0;
+}
+
+void
+vy_read_set_insert(struct vy_read_set *set, struct vy_read_interval *interval);
+
+void
+vy_read_set_remove(struct vy_read_set *set, struct vy_read_interval *interval);
+
+/**
+ * Find an interval read by the transaction with exactly the
+ * given boundaries.
+ */
+struct vy_read_interval *
+vy_read_set_search(struct vy_read_set *set, struct vy_tx *tx,
+		   struct tuple *left, bool left_belongs,
+		   struct tuple *right, bool right_belongs);
+
+/** Callback for vy_read_set_walk_key(). */
+typedef void
+(*vy_read_set_walk_f)(struct vy_read_interval *interval, void *arg);
+
+/**
+ * Invoke @a cb for each interval of the set containing
+ * the full key of @a stmt.
+ */
+void
+vy_read_set_walk_key(struct vy_read_set *set, const struct tuple *stmt,
+		     vy_read_set_walk_f cb, void *arg);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_BOX_VY_READ_SET_H */
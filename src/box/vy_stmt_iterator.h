@@ -122,6 +122,8 @@ struct vy_iterator_stat {
 	size_t step_count;
 	/* Number of searches avoided using bloom filter */
 	size_t bloom_reflections;
+	/* Number of searches bloom filter failed to avoid */
+	size_t bloom_false_positives;
 };
 
 #if defined(__cplusplus)
@@ -41,18 +41,88 @@
 #include "cbus.h"
 #include "coeio.h"
 #include "replication.h"
+#include "rmean.h"
 
 
 const char *wal_mode_STRS[] = { "none", "write", "fsync", NULL };
 
 int wal_dir_lock = -1;
 
+/** Group commit statistics, box.stat.wal(). */
+enum {
+	/** The number of WAL syncs. */
+	WAL_STAT_SYNC,
+	/** The number of rows made durable by the syncs. */
+	WAL_STAT_SYNC_ROWS,
+	/** Time spent in syncs, in microseconds. */
+	WAL_STAT_SYNC_TIME,
+	WAL_STAT_LAST,
+};
+
+static const char *wal_stat_strings[WAL_STAT_LAST] = {
+	"SYNC", "SYNC_ROWS", "SYNC_TIME"
+};
+
+/** Maintained by the WAL thread. */
+struct rmean *rmean_wal;
+
 static int64_t
 wal_write(struct journal *, struct journal_entry *);
 
 static int64_t
 wal_write_in_wal_mode_none(struct journal *, struct journal_entry *);
 
+/**
+ * Max size of the in-memory WAL tail, see struct wal_tail.
+ */
+enum { WAL_TAIL_SIZE_MAX = 32 * 1024 * 1024 };
+
+/** A row of the in-memory WAL tail. */
+struct wal_tail_row {
+	/** Link in wal_tail::rows. */
+	struct stailq_entry in_tail;
+	int64_t lsn;
+	uint32_t replica_id;
+	/** Size of the encoded row in data. */
+	uint32_t size;
+	/** The row encoded as in an xlog file, without fixheader. */
+	char data[0];
+};
+
+/**
+ * A copy of the rows most recently written to the WAL, kept
+ * in memory so that replication relays following the master
+ * closely can stream them without re-reading and decoding
+ * xlog files. Appended by the WAL thread, read by relays.
+ * When the size limit is exceeded, the oldest rows are
+ * evicted, and relays which haven't read them yet fall back
+ * on reading xlog files.
+ *
+ * Rows are only copied to the tail after the first relay has
+ * asked for it, so an instance without replicas doesn't pay
+ * for it in memory or CPU.
+ */
+struct wal_tail {
+	/**
+	 * Set when the first reader opens the tail. Until
+	 * then, rows are not copied and only the vclock is
+	 * advanced.
+	 */
+	bool is_active;
+	/** Rows, oldest first. */
+	struct stailq rows;
+	/** Sequence number of the first row in the list. */
+	int64_t first_seq;
+	/** Sequence number to assign to the next appended row. */
+	int64_t next_seq;
+	/** Total size of rows in the list. */
+	size_t used;
+	/** WAL vclock before the first row in the list. */
+	struct vclock vclock;
+	/** The lock protecting the tail. */
+	pthread_mutex_t mutex;
+};
+
 /* WAL thread. */
 struct wal_thread {
 	/** 'wal' thread doing the writes. */
@@ -119,6 +189,31 @@ struct wal_writer
 	struct rlist watchers;
 	/** The lock protecting the watchers list. */
 	pthread_mutex_t watchers_mutex;
+	/** Recently written rows, for replication relays. */
+	struct wal_tail tail;
+	/**
+	 * Group commit: batches written to the current WAL but
+	 * not synced and not acknowledged to tx yet.
+	 */
+	struct stailq sync_queue;
+	/** The number of bytes written by sync_queue batches. */
+	size_t sync_queue_size;
+	/** WAL file offset at which sync_queue data begins. */
+	off_t sync_offset;
+	/**
+	 * A setting from instance configuration -
+	 * wal_group_commit_delay: how long a written batch may
+	 * wait for other batches to share a sync with.
+	 */
+	double group_commit_delay;
+	/**
+	 * A setting from instance configuration -
+	 * wal_group_commit_size: sync at once when this many
+	 * bytes are waiting for a sync.
+	 */
+	int64_t group_commit_size;
+	/** Expires group_commit_delay after the queue start. */
+	struct ev_timer sync_timer;
 };
 
 struct wal_msg: public cmsg {
@@ -129,6 +224,8 @@ struct wal_msg: public cmsg {
 	 * be rolled back.
 	 */
 	struct stailq rollback;
+	/** Link in wal_writer::sync_queue. */
+	struct stailq_entry in_sync_queue;
 };
 
 /**
@@ -152,11 +249,19 @@ wal_mode()
 static void
 wal_write_to_disk(struct cmsg *msg);
 
+static void
+wal_sync_queue_flush(struct wal_writer *writer);
+
 static void
 tx_schedule_commit(struct cmsg *msg);
 
+/*
+ * The first hop has no pipe: the WAL thread holds a batch
+ * until it is synced, then sends it to tx itself,
+ * @sa wal_sync_queue_flush().
+ */
 static struct cmsg_hop wal_request_route[] = {
-	{wal_write_to_disk, &wal_thread.tx_pipe},
+	{wal_write_to_disk, NULL},
 	{tx_schedule_commit, NULL},
 };
 
@@ -256,16 +361,220 @@ tx_schedule_rollback(struct cmsg *msg)
 	stailq_create(&writer->rollback);
 }
 
+/* {{{ In-memory WAL tail */
+
+static void
+wal_tail_create(struct wal_tail *tail, struct vclock *vclock)
+{
+	tail->is_active = false;
+	stailq_create(&tail->rows);
+	tail->first_seq = 0;
+	tail->next_seq = 0;
+	tail->used = 0;
+	vclock_copy(&tail->vclock, vclock);
+	tt_pthread_mutex_init(&tail->mutex, NULL);
+}
+
+static void
+wal_tail_destroy(struct wal_tail *tail)
+{
+	struct wal_tail_row *row, *next;
+	stailq_foreach_entry_safe(row, next, &tail->rows, in_tail)
+		free(row);
+	tt_pthread_mutex_destroy(&tail->mutex);
+}
+
+/** Max size of the tail, can be reduced in tests. */
+static size_t
+wal_tail_size_max(void)
+{
+	ERROR_INJECT_U64(ERRINJ_WAL_TAIL_SIZE,
+		errinj_getu64(ERRINJ_WAL_TAIL_SIZE) > 0,
+		return errinj_getu64(ERRINJ_WAL_TAIL_SIZE));
+	return WAL_TAIL_SIZE_MAX;
+}
+
+/** Evict the oldest rows until the tail fits in @a size. */
+static void
+wal_tail_trim(struct wal_tail *tail, size_t size)
+{
+	while (tail->used > size) {
+		struct wal_tail_row *row =
+			stailq_shift_entry(&tail->rows, struct wal_tail_row,
+					   in_tail);
+		vclock_follow(&tail->vclock, row->replica_id, row->lsn);
+		tail->used -= sizeof(*row) + row->size;
+		tail->first_seq++;
+		free(row);
+	}
+}
+
+/**
+ * Append rows of a written transaction to the tail.
+ * Called from the WAL thread. Failure to allocate memory
+ * isn't critical: the tail is dropped, and relays fall
+ * back on reading xlog files.
+ */
+static void
+wal_tail_append(struct wal_tail *tail, struct journal_entry *entry)
+{
+	struct xrow_header **row = entry->rows;
+	tt_pthread_mutex_lock(&tail->mutex);
+	bool is_active = tail->is_active;
+	if (!is_active) {
+		/* No one reads the tail yet, just follow the WAL. */
+		for (; row < entry->rows + entry->n_rows; row++)
+			vclock_follow(&tail->vclock, (*row)->replica_id,
+				      (*row)->lsn);
+	}
+	tt_pthread_mutex_unlock(&tail->mutex);
+	if (!is_active)
+		return;
+	size_t size_max = wal_tail_size_max();
+	for (; row < entry->rows + entry->n_rows; row++) {
+		struct iovec iov[XROW_IOVMAX];
+		int iovcnt = xrow_header_encode(*row, iov, 0);
+		size_t size = 0;
+		for (int i = 0; i < iovcnt; i++)
+			size += iov[i].iov_len;
+		size_t total = sizeof(struct wal_tail_row) + size;
+		struct wal_tail_row *tail_row = NULL;
+		if (iovcnt > 0 && total <= size_max)
+			tail_row = (struct wal_tail_row *) malloc(total);
+		if (tail_row == NULL) {
+			/* Drop the tail, it can't have gaps. */
+			diag_clear(diag_get());
+			tt_pthread_mutex_lock(&tail->mutex);
+			wal_tail_trim(tail, 0);
+			vclock_follow(&tail->vclock, (*row)->replica_id,
+				      (*row)->lsn);
+			tail->first_seq = ++tail->next_seq;
+			tt_pthread_mutex_unlock(&tail->mutex);
+			continue;
+		}
+		tail_row->lsn = (*row)->lsn;
+		tail_row->replica_id = (*row)->replica_id;
+		tail_row->size = size;
+		char *pos = tail_row->data;
+		for (int i = 0; i < iovcnt; i++) {
+			memcpy(pos, iov[i].iov_base, iov[i].iov_len);
+			pos += iov[i].iov_len;
+		}
+		tt_pthread_mutex_lock(&tail->mutex);
+		wal_tail_trim(tail, size_max - total);
+		stailq_add_tail_entry(&tail->rows, tail_row, in_tail);
+		tail->used += total;
+		tail->next_seq++;
+		tt_pthread_mutex_unlock(&tail->mutex);
+	}
+}
+
+int
+wal_tail_open(struct wal_tail_cursor *cursor, const struct vclock *vclock)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	cursor->last = NULL;
+	cursor->buf = NULL;
+	cursor->capacity = 0;
+	if (journal_is_initialized(&writer->base) == false ||
+	    writer->wal_mode == WAL_NONE)
+		return -1;
+
+	struct wal_tail *tail = &writer->tail;
+	tt_pthread_mutex_lock(&tail->mutex);
+	tail->is_active = true;
+	int cmp = vclock_compare(&tail->vclock, vclock);
+	cursor->seq = tail->first_seq;
+	tt_pthread_mutex_unlock(&tail->mutex);
+	/*
+	 * The tail can be used only if it has all rows
+	 * following the reader's vclock.
+	 */
+	return cmp == 0 || cmp == -1 ? 0 : -1;
+}
+
+void
+wal_tail_close(struct wal_tail_cursor *cursor)
+{
+	free(cursor->buf);
+	cursor->buf = NULL;
+	cursor->capacity = 0;
+}
+
+ssize_t
+wal_tail_read(struct wal_tail_cursor *cursor, struct xrow_header *rows,
+	      int max_rows)
+{
+	struct wal_tail *tail = &wal_writer_singleton.tail;
+	tt_pthread_mutex_lock(&tail->mutex);
+	if (cursor->seq < tail->first_seq) {
+		/* The rows the reader needs have been evicted. */
+		tt_pthread_mutex_unlock(&tail->mutex);
+		return -1;
+	}
+	/*
+	 * The last row read by the reader is still in the
+	 * tail unless the reader is at the very beginning.
+	 */
+	struct stailq_entry *first = cursor->seq == tail->first_seq ?
+		stailq_first(&tail->rows) : stailq_next(cursor->last);
+	/* Copy the rows to the reader's buffer. */
+	size_t size = 0;
+	int count = 0;
+	struct stailq_entry *item = first;
+	for (; item != NULL && count < max_rows; item = stailq_next(item)) {
+		size += stailq_entry(item, struct wal_tail_row,
+				     in_tail)->size;
+		count++;
+	}
+	if (size > cursor->capacity) {
+		char *buf = (char *) realloc(cursor->buf, size);
+		if (buf == NULL) {
+			tt_pthread_mutex_unlock(&tail->mutex);
+			tnt_raise(OutOfMemory, size, "realloc",
+				  "wal_tail_cursor");
+		}
+		cursor->buf = buf;
+		cursor->capacity = size;
+	}
+	char *pos = cursor->buf;
+	item = first;
+	for (int i = 0; i < count; i++) {
+		struct wal_tail_row *row = stailq_entry(item,
+					struct wal_tail_row, in_tail);
+		memcpy(pos, row->data, row->size);
+		pos += row->size;
+		cursor->last = item;
+		item = stailq_next(item);
+	}
+	cursor->seq += count;
+	tt_pthread_mutex_unlock(&tail->mutex);
+
+	/* Decode the rows outside the lock. */
+	const char *data = cursor->buf;
+	const char *end = cursor->buf + size;
+	for (int i = 0; i < count; i++)
+		xrow_header_decode_xc(&rows[i], &data, end);
+	assert(data == end);
+	return count;
+}
+
+/* }}} */
+
 /**
  * Initialize WAL writer context. Even though it's a singleton,
  * encapsulate the details just in case we may use
  * more writers in the future.
  */
+static void
+wal_sync_timer_cb(ev_loop *loop, ev_timer *timer, int events);
+
 static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, const struct tt_uuid *instance_uuid,
 		  struct vclock *vclock, int64_t wal_max_rows,
-		  int64_t wal_max_size)
+		  int64_t wal_max_size, double group_commit_delay,
+		  int64_t group_commit_size)
 {
 	writer->wal_mode = wal_mode;
 	writer->wal_max_rows = wal_max_rows;
@@ -273,10 +582,21 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 	journal_create(&writer->base, wal_mode == WAL_NONE ?
 		       wal_write_in_wal_mode_none : wal_write, NULL);
 
+	/*
+	 * In fsync mode the WAL is synced explicitly once per
+	 * group of batches, @sa wal_sync_queue_flush(), rather
+	 * than on every write with O_SYNC.
+	 */
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid);
 	xlog_clear(&writer->current_wal);
-	if (wal_mode == WAL_FSYNC)
-		writer->wal_dir.open_wflags |= O_SYNC;
+
+	stailq_create(&writer->sync_queue);
+	writer->sync_queue_size = 0;
+	writer->sync_offset = 0;
+	writer->group_commit_delay = group_commit_delay;
+	writer->group_commit_size = group_commit_size;
+	ev_timer_init(&writer->sync_timer, wal_sync_timer_cb, 0, 0);
+	writer->sync_timer.data = writer;
 
 	stailq_create(&writer->rollback);
 	cmsg_init(&writer->in_rollback, NULL);
@@ -287,6 +607,8 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	tt_pthread_mutex_init(&writer->watchers_mutex, NULL);
 	rlist_create(&writer->watchers);
+
+	wal_tail_create(&writer->tail, vclock);
 }
 
 /** Destroy a WAL writer structure. */
@@ -295,6 +617,7 @@ wal_writer_destroy(struct wal_writer *writer)
 {
 	xdir_destroy(&writer->wal_dir);
 	tt_pthread_mutex_destroy(&writer->watchers_mutex);
+	wal_tail_destroy(&writer->tail);
 }
 
 /** WAL thread routine. */
@@ -323,14 +646,16 @@ wal_thread_start()
 void
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 const struct tt_uuid *instance_uuid, struct vclock *vclock,
-	 int64_t wal_max_rows, int64_t wal_max_size)
+	 int64_t wal_max_rows, int64_t wal_max_size,
+	 double group_commit_delay, int64_t group_commit_size)
 {
 	assert(wal_max_rows > 1);
 
 	struct wal_writer *writer = &wal_writer_singleton;
 
 	wal_writer_create(writer, wal_mode, wal_dirname, instance_uuid,
-			  vclock, wal_max_rows, wal_max_size);
+			  vclock, wal_max_rows, wal_max_size,
+			  group_commit_delay, group_commit_size);
 
 	xdir_scan_xc(&writer->wal_dir);
 
@@ -367,6 +692,8 @@ wal_checkpoint_f(struct cmsg *data)
 {
 	struct wal_checkpoint *msg = (struct wal_checkpoint *) data;
 	struct wal_writer *writer = &wal_writer_singleton;
+	/* Complete the writes waiting for a group commit. */
+	wal_sync_queue_flush(writer);
 	/*
 	 * Avoid closing the current WAL if it has no rows (empty).
 	 */
@@ -465,6 +792,8 @@ wal_opt_rotate(struct wal_writer *writer)
 	if (xlog_is_open(&writer->current_wal) &&
 	    (writer->current_wal.rows >= writer->wal_max_rows ||
 	     writer->current_wal.offset >= writer->wal_max_size)) {
+		/* The queue must not span WAL files. */
+		wal_sync_queue_flush(writer);
 		/*
 		 * We can not handle xlog_close()
 		 * failure in any reasonable way.
@@ -560,6 +889,135 @@ wal_assign_lsn(struct wal_writer *writer, struct xrow_header **row,
 	}
 }
 
+/**
+ * Complete a batch which has been written and synced: advance
+ * the writer state and make the rows available to relays.
+ */
+static void
+wal_msg_complete(struct wal_writer *writer, struct wal_msg *wal_msg)
+{
+	struct xlog *l = &writer->current_wal;
+	struct journal_entry *entry;
+	stailq_foreach_entry(entry, &wal_msg->commit, fifo) {
+		/** All rows in a transaction have the same replica_id */
+		struct xrow_header *last = entry->rows[entry->n_rows - 1];
+		/* Update internal vclock */
+		if (last->replica_id != instance_id) {
+			vclock_follow(&writer->vclock, last->replica_id,
+				      last->lsn);
+		}
+		/* Update row counter for wal_opt_rotate() */
+		l->rows += entry->n_rows;
+		/* Make the rows available to relays. */
+		wal_tail_append(&writer->tail, entry);
+		/* Mark request as successful for tx thread */
+		entry->res = vclock_sum(&writer->vclock);
+	}
+}
+
+/**
+ * Sync the current WAL if necessary, complete all batches
+ * waiting in the group commit queue and send them to tx.
+ * If the sync fails, the unsynced data is truncated and all
+ * queued requests are rolled back.
+ */
+static void
+wal_sync_queue_flush(struct wal_writer *writer)
+{
+	ev_timer_stop(loop(), &writer->sync_timer);
+	if (stailq_empty(&writer->sync_queue))
+		return;
+
+	struct xlog *l = &writer->current_wal;
+	bool sync_failed = false;
+	if (writer->wal_mode == WAL_FSYNC && writer->sync_queue_size > 0) {
+		ev_tstamp start = ev_time();
+		int rc = fdatasync(l->fd);
+		ERROR_INJECT(ERRINJ_WAL_SYNC, { errno = EIO; rc = -1; });
+		if (rc < 0) {
+			say_syserror("%s: fdatasync failed", l->filename);
+			sync_failed = true;
+		}
+		rmean_collect(rmean_wal, WAL_STAT_SYNC, 1);
+		rmean_collect(rmean_wal, WAL_STAT_SYNC_TIME,
+			      (ev_time() - start) * 1000000);
+	}
+	if (sync_failed) {
+		/*
+		 * Same as after a failed write: throw away
+		 * everything past the last good position.
+		 */
+		if (lseek(l->fd, writer->sync_offset, SEEK_SET) < 0 ||
+		    ftruncate(l->fd, writer->sync_offset) != 0)
+			panic_syserror("failed to truncate xlog after sync error");
+		l->offset = writer->sync_offset;
+	}
+
+	int64_t rows = 0;
+	struct wal_msg *wal_msg, *next;
+	stailq_foreach_entry_safe(wal_msg, next, &writer->sync_queue,
+				  in_sync_queue) {
+		if (sync_failed) {
+			/* Committed requests precede failed ones. */
+			stailq_concat(&wal_msg->commit, &wal_msg->rollback);
+			stailq_concat(&wal_msg->rollback, &wal_msg->commit);
+		} else {
+			wal_msg_complete(writer, wal_msg);
+			struct journal_entry *entry;
+			stailq_foreach_entry(entry, &wal_msg->commit, fifo)
+				rows += entry->n_rows;
+		}
+		/* Pass the batch on to tx, @sa cmsg_dispatch(). */
+		wal_msg->hop++;
+		cpipe_push(&wal_thread.tx_pipe, wal_msg);
+	}
+	stailq_create(&writer->sync_queue);
+	writer->sync_queue_size = 0;
+	if (writer->wal_mode == WAL_FSYNC)
+		rmean_collect(rmean_wal, WAL_STAT_SYNC_ROWS, rows);
+
+	if (sync_failed && writer->in_rollback.route == NULL)
+		wal_writer_begin_rollback(writer);
+	wal_notify_watchers(writer);
+}
+
+static void
+wal_sync_timer_cb(ev_loop *loop, ev_timer *timer, int events)
+{
+	(void) loop;
+	(void) events;
+	wal_sync_queue_flush((struct wal_writer *) timer->data);
+}
+
+/**
+ * Queue a written batch for a group commit. The queue is
+ * flushed when it has accumulated group_commit_size bytes or
+ * when its oldest batch has waited for group_commit_delay,
+ * whichever comes first.
+ */
+static void
+wal_sync_queue_add(struct wal_writer *writer, struct wal_msg *wal_msg,
+		   size_t size)
+{
+	if (stailq_empty(&writer->sync_queue))
+		writer->sync_offset = writer->current_wal.offset - size;
+	stailq_add_tail_entry(&writer->sync_queue, wal_msg, in_sync_queue);
+	writer->sync_queue_size += size;
+
+	if (writer->wal_mode != WAL_FSYNC ||
+	    writer->group_commit_delay <= 0 ||
+	    writer->sync_queue_size >= (size_t) writer->group_commit_size ||
+	    !stailq_empty(&wal_msg->rollback)) {
+		wal_sync_queue_flush(writer);
+		return;
+	}
+	if (!ev_is_active(&writer->sync_timer)) {
+		ev_timer_set(&writer->sync_timer,
+			     writer->group_commit_delay, 0);
+		ev_timer_start(loop(), &writer->sync_timer);
+	}
+}
+
 static void
 wal_write_to_disk(struct cmsg *msg)
 {
@@ -571,12 +1029,13 @@ wal_write_to_disk(struct cmsg *msg)
 	if (writer->in_rollback.route != NULL) {
 		/* We're rolling back a failed write. */
 		stailq_concat(&wal_msg->rollback, &wal_msg->commit);
-		return;
+		return wal_sync_queue_add(writer, wal_msg, 0);
 	}
 
 	/* Xlog is only rotated between queue processing  */
 	if (wal_opt_rotate(writer) != 0) {
 		stailq_concat(&wal_msg->rollback, &wal_msg->commit);
+		wal_sync_queue_add(writer, wal_msg, 0);
 		return wal_writer_begin_rollback(writer);
 	}
 
@@ -602,6 +1061,7 @@ wal_write_to_disk(struct cmsg *msg)
 	 */
 
 	struct xlog *l = &writer->current_wal;
+	off_t offset = l->offset;
 
 	/*
 	 * Iterate over requests (transactions)
@@ -640,30 +1100,19 @@ done:
 				   fifo);
 	struct journal_entry *rollback_entry = last_commit_entry ?
 		stailq_next_entry(last_commit_entry, fifo) : entry;
-	/* Update status of the successfully committed requests. */
-	for (; entry != rollback_entry;
-	     entry = stailq_next_entry(entry, fifo)) {
-
-		/** All rows in a transaction have the same replica_id */
-		struct xrow_header *last = entry->rows[entry->n_rows - 1];
-		/* Update internal vclock */
-		if (last->replica_id != instance_id) {
-			vclock_follow(&writer->vclock, last->replica_id,
-				      last->lsn);
-		}
-		/* Update row counter for wal_opt_rotate() */
-		l->rows += entry->n_rows;
-		/* Mark request as successful for tx thread */
-		entry->res = vclock_sum(&writer->vclock);
-	}
 	if (rollback_entry) {
 		/* Rollback unprocessed requests */
-		stailq_splice(&wal_msg->commit, &entry->fifo,
+		stailq_splice(&wal_msg->commit, &rollback_entry->fifo,
 			      &wal_msg->rollback);
-		wal_writer_begin_rollback(writer);
 	}
+	/*
+	 * The committed requests are completed by the group
+	 * commit, once they are on disk.
+	 */
+	wal_sync_queue_add(writer, wal_msg, l->offset - offset);
+	if (rollback_entry)
+		wal_writer_begin_rollback(writer);
 	fiber_gc();
-	wal_notify_watchers(writer);
 }
 
 /** WAL thread main loop.  */
@@ -675,6 +1124,11 @@ wal_thread_f(va_list ap)
 	/** Initialize eio in this thread */
 	coeio_enable();
 
+	/* Init statistics counter */
+	rmean_wal = rmean_new(wal_stat_strings, WAL_STAT_LAST);
+	if (rmean_wal == NULL)
+		panic("failed to allocate WAL statistics");
+
 	struct cbus_endpoint endpoint;
 	cbus_endpoint_create(&endpoint, "wal", fiber_schedule_cb, fiber());
 	/*
@@ -688,6 +1142,8 @@ wal_thread_f(va_list ap)
 
 	struct wal_writer *writer = &wal_writer_singleton;
 
+	if (journal_is_initialized(&writer->base))
+		wal_sync_queue_flush(writer);
 	if (xlog_is_open(&writer->current_wal))
 		xlog_close(&writer->current_wal, false);
 
@@ -695,6 +1151,9 @@ wal_thread_f(va_list ap)
 		xlog_close(&xctl_writer.xlog, false);
 
 	cpipe_destroy(&wal_thread.tx_pipe);
+	struct rmean *rmean = rmean_wal;
+	rmean_wal = NULL;
+	rmean_delete(rmean);
 	return 0;
 }
 
@@ -36,6 +36,8 @@
 #include "journal.h"
 
 struct fiber;
+struct stailq_entry;
+struct xrow_header;
 struct vclock;
 struct wal_writer;
 
@@ -54,7 +56,8 @@ wal_thread_start();
 void
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 const struct tt_uuid *instance_uuid, struct vclock *vclock,
-	 int64_t wal_max_rows, int64_t wal_max_size);
+	 int64_t wal_max_rows, int64_t wal_max_size,
+	 double group_commit_delay, int64_t group_commit_size);
 
 enum wal_mode
 wal_mode();
@@ -83,6 +86,50 @@ wal_clear_watcher(struct wal_watcher *);
 void
 wal_atfork();
 
+/**
+ * A reader of the in-memory copy of the rows most recently
+ * written to the WAL.
+ */
+struct wal_tail_cursor {
+	/** Sequence number of the next row to read. */
+	int64_t seq;
+	/** The last row read, valid while it isn't evicted. */
+	struct stailq_entry *last;
+	/** Buffer the rows are copied to for decoding. */
+	char *buf;
+	size_t capacity;
+};
+
+/**
+ * Open a cursor over the in-memory WAL tail, if it has all
+ * rows following @a vclock. The reader is supposed to skip
+ * the rows it has already seen.
+ *
+ * @retval 0 success, the cursor must be closed with
+ *           wal_tail_close()
+ * @retval -1 the rows are only on disk or there is no WAL
+ *            writer in this process
+ */
+int
+wal_tail_open(struct wal_tail_cursor *cursor, const struct vclock *vclock);
+
+void
+wal_tail_close(struct wal_tail_cursor *cursor);
+
+/**
+ * Read up to @a max_rows rows following the cursor position.
+ * Decoded rows point to the cursor buffer and are valid until
+ * the next call. Throws on error.
+ *
+ * @retval >= 0 the number of rows read, 0 if there are no new
+ *              rows yet
+ * @retval -1 the reader fell behind and the rows it needs
+ *            have been evicted, they must be read from disk
+ */
+ssize_t
+wal_tail_read(struct wal_tail_cursor *cursor, struct xrow_header *rows,
+	      int max_rows);
+
 extern "C" {
 #endif /* defined(__cplusplus) */
 
@@ -885,6 +885,35 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	return 0;
 }
 
+/**
+ * Encode the fixheader of a block of @a len bytes following it.
+ */
+static void
+xlog_fixheader_encode(char *fixheader, log_magic_t magic, size_t len,
+		      uint32_t crc32c)
+{
+	*(log_magic_t *)fixheader = magic;
+	char *data = fixheader + sizeof(log_magic_t);
+
+	data = mp_encode_uint(data, len);
+	/* Encode crc32 for previous row */
+	data = mp_encode_uint(data, 0);
+	/* Encode crc32 for current row */
+	data = mp_encode_uint(data, crc32c);
+	/*
+	 * Encode a padding, to ensure the resulting
+	 * fixheader always has the same size.
+	 */
+	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
+	if (padding > 0) {
+		data = mp_encode_strl(data, padding - 1);
+		if (padding > 1) {
+			memset(data, 0, padding - 1);
+			data += padding - 1;
+		}
+	}
+}
+
 /**
  * Write a sequence of uncompressed xrow objects.
  *
@@ -899,14 +928,6 @@ xlog_tx_write_plain(struct xlog *log)
 	 * now populate it with data.
 	 */
 	char *fixheader = (char *)log->obuf.iov[0].iov_base;
-	*(log_magic_t *)fixheader = row_marker;
-	char *data = fixheader + sizeof(log_magic_t);
-
-	data = mp_encode_uint(data,
-			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
 	uint32_t crc32c = 0;
 	struct iovec *iov;
 	size_t offset = XLOG_FIXHEADER_SIZE;
@@ -916,19 +937,9 @@ xlog_tx_write_plain(struct xlog *log)
 				    iov->iov_len - offset);
 		offset = 0;
 	}
-	data = mp_encode_uint(data, crc32c);
-	/*
-	 * Encode a padding, to ensure the resulting
-	 * fixheader always has the same size.
-	 */
-	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_fixheader_encode(fixheader, row_marker,
+			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -958,7 +969,15 @@ xlog_tx_write_zstd(struct xlog *log)
 	uint32_t crc32c = 0;
 	struct iovec *iov;
 	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
+	if (log->zcdict != NULL)
+#if ZSTD_VERSION_NUMBER >= 10300
+		ZSTD_compressBegin_usingCDict(log->zctx, log->zcdict);
+#else
+		/* 0 is unknown source size. */
+		ZSTD_compressBegin_usingCDict(log->zctx, log->zcdict, 0);
+#endif
+	else
+		ZSTD_compressBegin(log->zctx, 3);
 	size_t offset = XLOG_FIXHEADER_SIZE;
 	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
 		/* Estimate max output buffer size. */
@@ -998,25 +1017,9 @@ xlog_tx_write_zstd(struct xlog *log)
 		offset = 0;
 	}
 
-	*(log_magic_t *)fixheader = zrow_marker;
-	char *data;
-	data = fixheader + sizeof(log_magic_t);
-	data = mp_encode_uint(data,
-			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
-	data = mp_encode_uint(data, crc32c);
-	/* Encode padding */
-	ssize_t padding;
-	padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_fixheader_encode(fixheader, zrow_marker,
+			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -1045,23 +1048,14 @@ error:
 #define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
 
 /**
- * Writes xlog batch to file
+ * Account a transaction block written to the file: advance
+ * the write offset, sync the file and throttle the writer
+ * if necessary. On write failure, truncate the file to the
+ * last good position.
  */
 static ssize_t
-xlog_tx_write(struct xlog *log)
+xlog_tx_complete(struct xlog *log, ssize_t written)
 {
-	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
-		return 0;
-	ssize_t written;
-
-	if (obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
-		written = xlog_tx_write_zstd(log);
-	} else {
-		written = xlog_tx_write_plain(log);
-	}
-	ERROR_INJECT(ERRINJ_WAL_WRITE, written = -1;);
-
-	obuf_reset(&log->obuf);
 	/*
 	 * Simplify recovery after a temporary write failure:
 	 * truncate the file to the best known good write
@@ -1113,6 +1107,73 @@ xlog_tx_write(struct xlog *log)
 	return written;
 }
 
+/**
+ * Writes xlog batch to file
+ */
+static ssize_t
+xlog_tx_write(struct xlog *log)
+{
+	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
+		return 0;
+	ssize_t written;
+
+	if (obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
+		written = xlog_tx_write_zstd(log);
+	} else {
+		written = xlog_tx_write_plain(log);
+	}
+	ERROR_INJECT(ERRINJ_WAL_WRITE, written = -1;);
+
+	obuf_reset(&log->obuf);
+	return xlog_tx_complete(log, written);
+}
+
+size_t
+xlog_tx_encode_bound(size_t size)
+{
+	return XLOG_FIXHEADER_SIZE + MAX(size, ZSTD_compressBound(size));
+}
+
+ssize_t
+xlog_tx_encode(ZSTD_CCtx *zctx, const char *rows, size_t size, char *out)
+{
+	char *data = out + XLOG_FIXHEADER_SIZE;
+	if (size < XLOG_TX_COMPRESS_THRESHOLD) {
+		memcpy(data, rows, size);
+		xlog_fixheader_encode(out, row_marker, size,
+				      crc32_calc(0, data, size));
+		return XLOG_FIXHEADER_SIZE + size;
+	}
+	/* 3 is compression level. */
+	size_t zsize = ZSTD_compressCCtx(zctx, data, ZSTD_compressBound(size),
+					 rows, size, 3);
+	if (ZSTD_isError(zsize)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZSTD_getErrorName(zsize));
+		return -1;
+	}
+	xlog_fixheader_encode(out, zrow_marker, zsize,
+			      crc32_calc(0, data, zsize));
+	return XLOG_FIXHEADER_SIZE + zsize;
+}
+
+ssize_t
+xlog_write_tx(struct xlog *log, const char *data, size_t size)
+{
+	assert(obuf_size(&log->obuf) == 0);
+	ssize_t written = size;
+	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
+	if (written > 0 && fio_writen(log->fd, data, size) != 0) {
+		diag_set(SystemError, "failed to write to '%s' file",
+			 log->filename);
+		written = -1;
+	}
+	return xlog_tx_complete(log, written);
+}
+
 /*
  * Add a row to a log and possibly flush the log.
  *
@@ -1465,7 +1526,8 @@ xlog_fixheader_decode(struct xlog_fixheader *fixheader,
 
 int
 xlog_tx_decode(const char *data, const char *data_end,
-	       char *rows, char *rows_end, ZSTD_DStream *zdctx)
+	       char *rows, char *rows_end, ZSTD_DStream *zdctx,
+	       const ZSTD_DDict *ddict)
 {
 	/* Decode fixheader */
 	struct xlog_fixheader fixheader;
@@ -1500,7 +1562,10 @@ xlog_tx_decode(const char *data, const char *data_end,
 
 	/* Decompress zstd rows */
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	if (ddict != NULL)
+		ZSTD_initDStream_usingDDict(zdctx, ddict);
+	else
+		ZSTD_initDStream(zdctx);
 	int rc = xlog_cursor_decompress(&rows, rows_end, &data, data_end,
 					zdctx);
 	if (rc < 0) {
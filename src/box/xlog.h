@@ -278,6 +278,13 @@ struct xlog {
 	struct obuf obuf;
 	/** The context of zstd compression */
 	ZSTD_CCtx *zctx;
+	/**
+	 * Digested zstd dictionary to compress transactions
+	 * with or NULL. Owned by the caller, must outlive the
+	 * xlog. Readers must use the same dictionary to
+	 * decompress data.
+	 */
+	const ZSTD_CDict *zcdict;
 	/**
 	 * Compressed output buffer
 	 */
@@ -415,6 +422,39 @@ xlog_tx_rollback(struct xlog *log);
 ssize_t
 xlog_flush(struct xlog *log);
 
+/**
+ * Return the maximal size of a transaction block produced
+ * by xlog_tx_encode() from @a size bytes of encoded rows.
+ */
+size_t
+xlog_tx_encode_bound(size_t size);
+
+/**
+ * Encode a sequence of rows into a complete transaction block,
+ * compressing it with @a zctx if it is large enough. Does not
+ * touch any xlog, so can be called from any thread.
+ *
+ * @param zctx compression context
+ * @param rows encoded rows
+ * @param size size of @a rows
+ * @param out output buffer, at least xlog_tx_encode_bound(size)
+ *
+ * @retval >= 0 size of the encoded block
+ * @retval -1 error, diag is set
+ */
+ssize_t
+xlog_tx_encode(ZSTD_CCtx *zctx, const char *rows, size_t size, char *out);
+
+/**
+ * Write a transaction block prepared by xlog_tx_encode()
+ * to the log. The row buffer of the log must be empty.
+ *
+ * @retval count of written bytes
+ * @retval -1 error
+ */
+ssize_t
+xlog_write_tx(struct xlog *log, const char *data, size_t size);
+
 
 /**
  * Sync a log file. The exact action is defined
@@ -490,13 +530,15 @@ xlog_tx_cursor_next_row(struct xlog_tx_cursor *tx_cursor, struct xrow_header *xr
  * @param data_end the end of @a data buffer
  * @param[out] rows a buffer to store decoded rows
  * @param[out] rows_end the end of @a rows buffer
+ * @param zdctx decompression context
+ * @param ddict zstd dictionary the tx was compressed with or NULL
  * @retval  0 success
  * @retval -1 error, check diag
  */
 int
 xlog_tx_decode(const char *data, const char *data_end,
 	       char *rows, char *rows_end,
-	       ZSTD_DStream *zdctx);
+	       ZSTD_DStream *zdctx, const ZSTD_DDict *ddict);
 
 /* }}} */
 
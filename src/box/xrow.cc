@@ -436,7 +436,7 @@ void
 xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
-		      const struct vclock *vclock)
+		      const struct vclock *vclock, uint32_t compression)
 {
 	memset(row, 0, sizeof(*row));
 	uint32_t replicaset_size = vclock_size(vclock);
@@ -444,7 +444,11 @@ xrow_encode_subscribe(struct xrow_header *row,
 		(mp_sizeof_uint(UINT32_MAX) + mp_sizeof_uint(UINT64_MAX));
 	char *buf = (char *) region_alloc_xc(&fiber()->gc, size);
 	char *data = buf;
-	data = mp_encode_map(data, 3);
+	/*
+	 * Don't send the compression key if it is off, so
+	 * that the request is understood by older masters.
+	 */
+	data = mp_encode_map(data, compression != 0 ? 4 : 3);
 	data = mp_encode_uint(data, IPROTO_CLUSTER_UUID);
 	data = xrow_encode_uuid(data, replicaset_uuid);
 	data = mp_encode_uint(data, IPROTO_INSTANCE_UUID);
@@ -457,6 +461,10 @@ xrow_encode_subscribe(struct xrow_header *row,
 		data = mp_encode_uint(data, replica.id);
 		data = mp_encode_uint(data, replica.lsn);
 	}
+	if (compression != 0) {
+		data = mp_encode_uint(data, IPROTO_COMPRESSION);
+		data = mp_encode_uint(data, compression);
+	}
 	assert(data <= buf + size);
 	row->body[0].iov_base = buf;
 	row->body[0].iov_len = (data - buf);
@@ -466,7 +474,8 @@ xrow_encode_subscribe(struct xrow_header *row,
 
 void
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
-		      struct tt_uuid *instance_uuid, struct vclock *vclock)
+		      struct tt_uuid *instance_uuid, struct vclock *vclock,
+		      uint32_t *compression)
 {
 	if (row->bodycnt == 0)
 		tnt_raise(ClientError, ER_INVALID_MSGPACK, "request body");
@@ -508,6 +517,15 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 			lsnmap = d;
 			mp_next(&d);
 			break;
+		case IPROTO_COMPRESSION:
+			if (compression == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_UINT) {
+				tnt_raise(ClientError, ER_INVALID_MSGPACK,
+					  "invalid COMPRESSION");
+			}
+			*compression = mp_decode_uint(&d);
+			break;
 		default: skip:
 			mp_next(&d); /* value */
 		}
@@ -555,16 +573,28 @@ xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid)
 
 void
 xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock)
+{
+	xrow_encode_subscribe_response(row, vclock, 0);
+}
+
+void
+xrow_encode_subscribe_response(struct xrow_header *row,
+			       const struct vclock *vclock,
+			       uint32_t compression)
 {
 	memset(row, 0, sizeof(*row));
 
 	/* Add vclock to response body */
 	uint32_t replicaset_size = vclock_size(vclock);
-	size_t size = 8 + replicaset_size *
+	size_t size = 16 + replicaset_size *
 		(mp_sizeof_uint(UINT32_MAX) + mp_sizeof_uint(UINT64_MAX));
 	char *buf = (char *) region_alloc_xc(&fiber()->gc, size);
 	char *data = buf;
-	data = mp_encode_map(data, 1);
+	data = mp_encode_map(data, compression != 0 ? 2 : 1);
+	if (compression != 0) {
+		data = mp_encode_uint(data, IPROTO_COMPRESSION);
+		data = mp_encode_uint(data, compression);
+	}
 	data = mp_encode_uint(data, IPROTO_VCLOCK);
 	data = mp_encode_map(data, replicaset_size);
 	struct vclock_iterator it;
@@ -285,23 +285,40 @@ xrow_encode_auth(struct xrow_header *row, const char *salt, size_t salt_len,
  * \param replicaset_uuid replica set uuid
  * \param instance_uuid instance uuid
  * \param vclock replication clock
+ * \param compression requested zstd level of the replication
+ *        stream, 0 for no compression
 */
 void
 xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
-		      const struct vclock *vclock);
+		      const struct vclock *vclock, uint32_t compression);
 
 /**
- * \brief Decode SUBSCRIBE command
+ * \brief Decode SUBSCRIBE command or a response to it
  * \param row
  * \param[out] replicaset_uuid
  * \param[out] instance_uuid
  * \param[out] vclock
+ * \param[out] compression zstd level of the replication stream,
+ *             left intact if the row doesn't have it
 */
 void
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
-		      struct tt_uuid *instance_uuid, struct vclock *vclock);
+		      struct tt_uuid *instance_uuid, struct vclock *vclock,
+		      uint32_t *compression);
+
+/**
+ * \brief Encode a response to SUBSCRIBE command
+ * \param row[out]
+ * \param vclock
+ * \param compression zstd level of the replication stream,
+ *        0 if it is not compressed
+*/
+void
+xrow_encode_subscribe_response(struct xrow_header *row,
+			       const struct vclock *vclock,
+			       uint32_t compression);
 
 /**
  * \brief Encode JOIN command
@@ -319,7 +336,7 @@ xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid);
 static inline void
 xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid)
 {
-	return xrow_decode_subscribe(row, NULL, instance_uuid, NULL);
+	return xrow_decode_subscribe(row, NULL, instance_uuid, NULL, NULL);
 }
 
 /**
@@ -338,7 +355,7 @@ xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock);
 static inline void
 xrow_decode_vclock(struct xrow_header *row, struct vclock *vclock)
 {
-	return xrow_decode_subscribe(row, NULL, NULL, vclock);
+	return xrow_decode_subscribe(row, NULL, NULL, vclock, NULL);
 }
 
 #endif
@@ -35,8 +35,8 @@
 #include "error.h"
 #include "msgpuck/msgpuck.h"
 
-void
-coio_read_xrow(struct ev_io *coio, struct ibuf *in, struct xrow_header *row)
+uint32_t
+coio_read_packet(struct ev_io *coio, struct ibuf *in)
 {
 	/* Read fixed header */
 	if (ibuf_used(in) < 1)
@@ -57,10 +57,32 @@ coio_read_xrow(struct ev_io *coio, struct ibuf *in, struct xrow_header *row)
 	to_read = len - ibuf_used(in);
 	if (to_read > 0)
 		coio_breadn(coio, in, to_read);
+	return len;
+}
 
+void
+coio_read_xrow(struct ev_io *coio, struct ibuf *in, struct xrow_header *row)
+{
+	uint32_t len = coio_read_packet(coio, in);
 	xrow_header_decode_xc(row, (const char **) &in->rpos, in->rpos + len);
 }
 
+bool
+xrow_read_buffered(struct ibuf *in, struct xrow_header *row)
+{
+	const char *pos = in->rpos;
+	if (pos == in->wpos || mp_typeof(*pos) != MP_UINT ||
+	    mp_check_uint(pos, in->wpos) > 0)
+		return false;
+	uint32_t len = mp_decode_uint(&pos);
+	if ((size_t) (in->wpos - pos) < len)
+		return false;
+	if (xrow_header_decode(row, &pos, pos + len) != 0)
+		return false;
+	in->rpos = (char *) pos;
+	return true;
+}
+
 void
 coio_write_xrow(struct ev_io *coio, const struct xrow_header *row)
 {
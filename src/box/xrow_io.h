@@ -30,6 +30,9 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stdbool.h>
+#include <stdint.h>
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -38,12 +41,32 @@ struct ev_io;
 struct ibuf;
 struct xrow_header;
 
+/**
+ * Read a packet prefixed with its length (MP_UINT) into
+ * the input buffer. The length is consumed, the packet starts
+ * at in->rpos.
+ * @return packet length
+ */
+uint32_t
+coio_read_packet(struct ev_io *coio, struct ibuf *in);
+
 void
 coio_read_xrow(struct ev_io *coio, struct ibuf *in, struct xrow_header *row);
 
 void
 coio_write_xrow(struct ev_io *coio, const struct xrow_header *row);
 
+/**
+ * Decode the next row from the input buffer, if it has been
+ * read in full, without reading from the socket.
+ * @retval true  the row is decoded and the buffer advanced
+ * @retval false there is no complete row in the buffer, or
+ *               it is malformed - coio_read_xrow() reports
+ *               the error
+ */
+bool
+xrow_read_buffered(struct ibuf *in, struct xrow_header *row);
+
 
 #if defined(__cplusplus)
 } /* extern "C" */
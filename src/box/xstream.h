@@ -42,15 +42,23 @@ struct xrow_header;
 struct xstream;
 
 typedef void (*xstream_write_f)(struct xstream *, struct xrow_header *);
+typedef void (*xstream_flush_f)(struct xstream *);
 
 struct xstream {
 	xstream_write_f write;
+	/**
+	 * Called when no more rows are going to follow soon,
+	 * so that a stream which buffers rows sends them.
+	 * Optional.
+	 */
+	xstream_flush_f flush;
 };
 
 static inline void
 xstream_create(struct xstream *xstream, xstream_write_f write)
 {
 	xstream->write = write;
+	xstream->flush = NULL;
 }
 
 int
@@ -66,6 +74,13 @@ xstream_write_xc(struct xstream *stream, struct xrow_header *row)
 		diag_raise();
 }
 
+static inline void
+xstream_flush_xc(struct xstream *stream)
+{
+	if (stream->flush != NULL)
+		stream->flush(stream);
+}
+
 #endif /* defined(__cplusplus) */
 
 #endif /* TARANTOOL_XSTREAM_H_INCLUDED */
@@ -358,6 +358,7 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_lower_bound _api_name(lower_bound)
 #define bps_tree_upper_bound _api_name(upper_bound)
 #define bps_tree_approximate_count _api_name(approximate_count)
+#define bps_tree_approximate_rank _api_name(approximate_rank)
 #define bps_tree_iterator_get_elem _api_name(iterator_get_elem)
 #define bps_tree_iterator_next _api_name(iterator_next)
 #define bps_tree_iterator_prev _api_name(iterator_prev)
@@ -733,6 +734,21 @@ bps_tree_upper_bound(const struct bps_tree *tree, bps_tree_key_t key,
 static inline size_t
 bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key);
 
+/**
+ * @brief Get approximate number of entries that are less than given key
+ *  (or less than or equal to given key if after is true).
+ * The result is precise if it falls into the first leaf. Otherwise,
+ * since the block occupancy is between 2/3 and 1, the true rank is
+ * between Result * 2 / 3 and Result * 3 / 2, plus or minus one leaf.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param after - count entries equal to the key too
+ * @return - approximate number of entries that are less than given key.
+ */
+static inline size_t
+bps_tree_approximate_rank(const struct bps_tree *tree, bps_tree_key_t key,
+			  bool after);
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -1747,6 +1763,58 @@ bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key)
 	return result;
 }
 
+/**
+ * @brief Get approximate number of entries that are less than given key
+ *  (or less than or equal to given key if after is true).
+ * The result is precise if it falls into the first leaf. Otherwise,
+ * since the block occupancy is between 2/3 and 1, the true rank is
+ * between Result * 2 / 3 and Result * 3 / 2, plus or minus one leaf.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param after - count entries equal to the key too
+ * @return - approximate number of entries that are less than given key.
+ */
+static inline size_t
+bps_tree_approximate_rank(const struct bps_tree *tree, bps_tree_key_t key,
+			  bool after)
+{
+	if (tree->root_id == (bps_tree_block_id_t)(-1))
+		return 0;
+
+	size_t result = 0;
+	bool exact;
+	/*
+	 * Assume all children of a block have subtrees of the
+	 * same size, so that the estimate follows the actual
+	 * occupancy of the tree rather than the average one.
+	 */
+	size_t subtree_size = tree->size;
+	struct bps_block *block = bps_tree_root(tree);
+	for (bps_tree_block_id_t i = 1; i < tree->depth; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos = after ?
+			bps_tree_find_after_ins_point_key(tree, inner->elems,
+							  inner->header.size - 1,
+							  key, &exact) :
+			bps_tree_find_ins_point_key(tree, inner->elems,
+						    inner->header.size - 1,
+						    key, &exact);
+		subtree_size /= inner->header.size;
+		result += pos * subtree_size;
+		block = bps_tree_restore_block(tree, inner->child_ids[pos]);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	result += after ?
+		bps_tree_find_after_ins_point_key(tree, leaf->elems,
+						  leaf->header.size,
+						  key, &exact) :
+		bps_tree_find_ins_point_key(tree, leaf->elems,
+					    leaf->header.size, key, &exact);
+
+	return result < tree->size ? result : tree->size;
+}
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -5723,6 +5791,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_lower_bound
 #undef bps_tree_upper_bound
 #undef bps_tree_approximate_count
+#undef bps_tree_approximate_rank
 #undef bps_tree_iterator_get_elem
 #undef bps_tree_iterator_next
 #undef bps_tree_iterator_prev
@@ -0,0 +1,986 @@
+/*
+ * *No header guard*: the header is allowed to be included twice
+ * with different sets of defines.
+ */
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * fhash - an open addressing hash table with values grouped in
+ * chunks, one chunk per two cache lines.
+ *
+ * A chunk holds up to FHASH(CHUNK_CAPACITY) values together with
+ * their 32-bit hashes. The hashes are stored contiguously at the
+ * beginning of the chunk, so a lookup compares the hash being
+ * searched with all hashes of a chunk at once (with SSE2 if it is
+ * available) and calls the comparison function only for values
+ * with a matching hash. Thus most negative probes don't touch the
+ * memory the values refer to.
+ *
+ * The home chunk of a value is determined by the highest bits of
+ * its hash. If the home chunk is full, the next chunks are probed
+ * (there is no wrap around: the table grows a tail of chunks if
+ * needed). Every chunk counts the values that were placed past it
+ * while probing, so a lookup stops as soon as it reaches a chunk
+ * nobody has overflowed.
+ *
+ * The table is grown by doubling. In order not to stall on a big
+ * table, values are moved to the new table incrementally, a few
+ * chunks per modification. Until the move is complete, lookups
+ * check both tables.
+ *
+ * Chunks are stored in matras, which makes it possible to freeze
+ * an iterator (create a consistent read view of the table).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "small/matras.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Additional user defined name that appended to prefix 'fhash'
+ *  for all names of structs and functions in this header file.
+ * All names use pattern: fhash<FHASH_NAME>_<name of func/struct>
+ * May be empty, but still have to be defined (just #define FHASH_NAME)
+ */
+#ifndef FHASH_NAME
+#error "FHASH_NAME must be defined"
+#endif
+
+/**
+ * Data type that hash table holds. Must be not greater than 8 bytes.
+ */
+#ifndef FHASH_DATA_TYPE
+#error "FHASH_DATA_TYPE must be defined"
+#endif
+
+/**
+ * Data type that used to for finding values.
+ */
+#ifndef FHASH_KEY_TYPE
+#error "FHASH_KEY_TYPE must be defined"
+#endif
+
+/**
+ * Type of optional third parameter of comparing function.
+ * If not needed, simply use #define FHASH_CMP_ARG_TYPE int
+ */
+#ifndef FHASH_CMP_ARG_TYPE
+#error "FHASH_CMP_ARG_TYPE must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value1, value2 and
+ * optional value that stored in hash table struct.
+ */
+#ifndef FHASH_EQUAL
+#error "FHASH_EQUAL must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value, key and
+ * optional value that stored in hash table struct.
+ */
+#ifndef FHASH_EQUAL_KEY
+#error "FHASH_EQUAL_KEY must be defined"
+#endif
+
+/**
+ * Tools for name substitution:
+ */
+#ifndef CONCAT4
+#define CONCAT4_R(a, b, c, d) a##b##c##d
+#define CONCAT4(a, b, c, d) CONCAT4_R(a, b, c, d)
+#endif
+
+#define FHASH(name) CONCAT4(fhash, FHASH_NAME, _, name)
+
+enum {
+	/** Max number of values in a chunk. */
+	FHASH(CHUNK_CAPACITY) = 10,
+	/** Bit mask of a chunk with all slots used. */
+	FHASH(CHUNK_FULL) = (1 << FHASH(CHUNK_CAPACITY)) - 1,
+	/**
+	 * The table is grown when the average number of values
+	 * per home chunk exceeds this number (80% load).
+	 */
+	FHASH(CHUNK_GROW_LOAD) = 8,
+	/** Max log2 of the number of home chunks. */
+	FHASH(MAX_ORDER) = 28,
+	/**
+	 * Number of chunks of the old table moved to the new
+	 * one on each modification while the table is grown.
+	 */
+	FHASH(MOVE_STEP) = 2,
+};
+
+/**
+ * A group of values stored together. Takes exactly 128 bytes.
+ */
+struct FHASH(chunk) {
+	/** Hashes of the values. Must go first to be 16-byte aligned. */
+	uint32_t hash[FHASH(CHUNK_CAPACITY)];
+	/** Bit mask of used slots. */
+	uint16_t used;
+	/**
+	 * Number of values that were placed past this chunk
+	 * because it was full. Saturates at UINT16_MAX.
+	 */
+	uint16_t overflow;
+	uint32_t unused;
+	/** The values. */
+	union {
+		FHASH_DATA_TYPE value;
+		uint64_t uint64_padding;
+	} slot[FHASH(CHUNK_CAPACITY)];
+};
+
+/**
+ * A table of chunks. When the hash is grown, two tables exist
+ * at the same time, see struct FHASH(core).
+ */
+struct FHASH(table) {
+	/** Storage of chunks. */
+	struct matras mtable;
+	/** Number of allocated chunks. */
+	uint32_t chunk_count;
+	/**
+	 * Log2 of the number of home chunks. The home chunk of
+	 * a value is determined by the highest @order bits of its
+	 * hash.
+	 */
+	uint32_t order;
+	/**
+	 * Reference counter. The table is referenced by the hash
+	 * and by every frozen iterator.
+	 */
+	uint32_t refs;
+};
+
+/**
+ * Type of functions for memory allocation and deallocation
+ */
+typedef void *(*FHASH(extent_alloc_t))(void *ctx);
+typedef void (*FHASH(extent_free_t))(void *ctx, void *extent);
+
+/**
+ * Main struct for holding hash table
+ */
+struct FHASH(core) {
+	/** Count of values in the hash table. */
+	uint32_t count;
+	/** The table new values are inserted to or NULL if empty. */
+	struct FHASH(table) *table;
+	/**
+	 * If the hash is being grown, the table the values are
+	 * being moved from, NULL otherwise.
+	 */
+	struct FHASH(table) *old_table;
+	/** Number of chunks of old_table that have been moved. */
+	uint32_t move_pos;
+	/** Memory allocator settings for the tables. */
+	size_t extent_size;
+	FHASH(extent_alloc_t) extent_alloc;
+	FHASH(extent_free_t) extent_free;
+	void *alloc_ctx;
+	/** Additional parameter for data comparison. */
+	FHASH_CMP_ARG_TYPE arg;
+};
+
+/**
+ * Iterator, for iterating all values in hash table.
+ * It also may be used for restoring one value by key.
+ *
+ * Values of the current table are returned first, then
+ * values of the old table, if the hash is being grown.
+ */
+struct FHASH(iterator) {
+	/** 0 - the current table, 1 - the old table, 2 - end. */
+	uint32_t table_no;
+	/** Current chunk in the table. */
+	uint32_t chunk_id;
+	/** Current slot in the chunk. */
+	uint32_t slot;
+	/** True if the iterator is frozen. */
+	bool is_frozen;
+	/** Tables the iterator was frozen with. */
+	struct FHASH(table) *table[2];
+	/** Numbers of chunks at the time of freeze. */
+	uint32_t chunk_count[2];
+	/** Versions of matras memory for MVCC. */
+	struct matras_view view[2];
+};
+
+/* {{{ Tables */
+
+/**
+ * Get the home chunk of a hash in a table.
+ */
+inline uint32_t
+FHASH(table_home)(const struct FHASH(table) *table, uint32_t hash)
+{
+	return table->order == 0 ? 0 : hash >> (32 - table->order);
+}
+
+/**
+ * Get a bit mask of the used slots of a chunk that store values
+ * with the given hash.
+ */
+inline uint32_t
+FHASH(chunk_match)(const struct FHASH(chunk) *chunk, uint32_t hash)
+{
+	uint32_t mask;
+#if defined(__SSE2__)
+	__m128i needle = _mm_set1_epi32((int)hash);
+	__m128i h0 = _mm_load_si128((const __m128i *)&chunk->hash[0]);
+	__m128i h1 = _mm_load_si128((const __m128i *)&chunk->hash[4]);
+	__m128i h2 = _mm_loadl_epi64((const __m128i *)&chunk->hash[8]);
+	mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(h0, needle)));
+	mask |= _mm_movemask_ps(_mm_castsi128_ps(
+			_mm_cmpeq_epi32(h1, needle))) << 4;
+	mask |= (_mm_movemask_ps(_mm_castsi128_ps(
+			_mm_cmpeq_epi32(h2, needle))) & 3) << 8;
+#else
+	mask = 0;
+	for (uint32_t i = 0; i < FHASH(CHUNK_CAPACITY); i++)
+		mask |= (uint32_t)(chunk->hash[i] == hash) << i;
+#endif
+	return mask & chunk->used;
+}
+
+inline struct FHASH(table) *
+FHASH(table_new)(struct FHASH(core) *ht, uint32_t order)
+{
+	struct FHASH(table) *table = (struct FHASH(table) *)
+		malloc(sizeof(*table));
+	if (table == NULL)
+		return NULL;
+	matras_create(&table->mtable, ht->extent_size,
+		      sizeof(struct FHASH(chunk)), ht->extent_alloc,
+		      ht->extent_free, ht->alloc_ctx);
+	table->chunk_count = 0;
+	table->order = order;
+	table->refs = 1;
+	return table;
+}
+
+inline void
+FHASH(table_unref)(struct FHASH(table) *table)
+{
+	assert(table->refs > 0);
+	if (--table->refs == 0) {
+		matras_destroy(&table->mtable);
+		free(table);
+	}
+}
+
+/**
+ * Append an empty chunk to a table.
+ * @retval 0 success, -1 memory error
+ */
+inline int
+FHASH(table_grow)(struct FHASH(table) *table)
+{
+	matras_id_t id;
+	struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+		matras_alloc(&table->mtable, &id);
+	if (chunk == NULL)
+		return -1;
+	assert(id == table->chunk_count);
+	memset(chunk, 0, sizeof(*chunk));
+	table->chunk_count++;
+	return 0;
+}
+
+/**
+ * Find a value in a table.
+ * @param[out] chunk_id, slot - position of the value
+ * @return true if found
+ */
+inline bool
+FHASH(table_find)(const struct FHASH(table) *table, uint32_t hash,
+		  FHASH_DATA_TYPE value, FHASH_CMP_ARG_TYPE arg,
+		  uint32_t *chunk_id, uint32_t *slot)
+{
+	(void)arg;
+	for (uint32_t id = FHASH(table_home)(table, hash);
+	     id < table->chunk_count; id++) {
+		const struct FHASH(chunk) *chunk = (const struct FHASH(chunk) *)
+			matras_get(&table->mtable, id);
+		uint32_t mask = FHASH(chunk_match)(chunk, hash);
+		while (mask != 0) {
+			uint32_t i = __builtin_ctz(mask);
+			if (FHASH_EQUAL((chunk->slot[i].value), (value), (arg))) {
+				*chunk_id = id;
+				*slot = i;
+				return true;
+			}
+			mask &= mask - 1;
+		}
+		if (chunk->overflow == 0)
+			break;
+	}
+	return false;
+}
+
+/**
+ * Find a value by key in a table.
+ * @param[out] chunk_id, slot - position of the value
+ * @return true if found
+ */
+inline bool
+FHASH(table_find_key)(const struct FHASH(table) *table, uint32_t hash,
+		      FHASH_KEY_TYPE key, FHASH_CMP_ARG_TYPE arg,
+		      uint32_t *chunk_id, uint32_t *slot)
+{
+	(void)arg;
+	for (uint32_t id = FHASH(table_home)(table, hash);
+	     id < table->chunk_count; id++) {
+		const struct FHASH(chunk) *chunk = (const struct FHASH(chunk) *)
+			matras_get(&table->mtable, id);
+		uint32_t mask = FHASH(chunk_match)(chunk, hash);
+		while (mask != 0) {
+			uint32_t i = __builtin_ctz(mask);
+			if (FHASH_EQUAL_KEY((chunk->slot[i].value), (key), (arg))) {
+				*chunk_id = id;
+				*slot = i;
+				return true;
+			}
+			mask &= mask - 1;
+		}
+		if (chunk->overflow == 0)
+			break;
+	}
+	return false;
+}
+
+/**
+ * Insert a value to a table. The value must not be present
+ * in the table. The home chunk of the value must be allocated.
+ * @retval 0 success, -1 memory error
+ */
+inline int
+FHASH(table_insert)(struct FHASH(table) *table, uint32_t hash,
+		    FHASH_DATA_TYPE value)
+{
+	uint32_t id = FHASH(table_home)(table, hash);
+	assert(id < table->chunk_count);
+	for (;; id++) {
+		if (id == table->chunk_count &&
+		    FHASH(table_grow)(table) != 0)
+			return -1;
+		struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+			matras_touch(&table->mtable, id);
+		if (chunk == NULL)
+			return -1;
+		if (chunk->used != FHASH(CHUNK_FULL)) {
+			uint32_t i = __builtin_ctz(~(uint32_t)chunk->used);
+			chunk->hash[i] = hash;
+			chunk->slot[i].value = value;
+			chunk->used |= 1 << i;
+			return 0;
+		}
+		/*
+		 * The overflow counter is not rolled back on
+		 * failure: it is only an upper bound.
+		 */
+		if (chunk->overflow != UINT16_MAX)
+			chunk->overflow++;
+	}
+}
+
+/**
+ * Delete a value from a table by position.
+ * @retval 0 success, -1 memory error
+ */
+inline int
+FHASH(table_delete)(struct FHASH(table) *table, uint32_t chunk_id,
+		    uint32_t slot)
+{
+	struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+		matras_touch(&table->mtable, chunk_id);
+	if (chunk == NULL)
+		return -1;
+	assert(chunk->used & (1 << slot));
+	chunk->used &= ~(1 << slot);
+	/*
+	 * Decrement the overflow counters of the chunks that
+	 * were passed by when the value was inserted. If we fail
+	 * to do it, the lookup will just be a bit slower.
+	 */
+	for (uint32_t id = FHASH(table_home)(table, chunk->hash[slot]);
+	     id < chunk_id; id++) {
+		struct FHASH(chunk) *passed = (struct FHASH(chunk) *)
+			matras_touch(&table->mtable, id);
+		if (passed == NULL)
+			break;
+		assert(passed->overflow > 0);
+		if (passed->overflow != UINT16_MAX)
+			passed->overflow--;
+	}
+	return 0;
+}
+
+/* }}} */
+
+/**
+ * @brief Hash table construction. Fills struct fhash members.
+ * @param ht - pointer to a hash table struct
+ * @param extent_size - size of allocating memory blocks
+ * @param extent_alloc_func - memory blocks allocation function
+ * @param extent_free_func - memory blocks allocation function
+ * @param alloc_ctx - argument passed to memory block allocator
+ * @param arg - optional parameter to save for comparing function
+ */
+inline void
+FHASH(create)(struct FHASH(core) *ht, size_t extent_size,
+	      FHASH(extent_alloc_t) extent_alloc_func,
+	      FHASH(extent_free_t) extent_free_func,
+	      void *alloc_ctx, FHASH_CMP_ARG_TYPE arg)
+{
+	ht->count = 0;
+	ht->table = NULL;
+	ht->old_table = NULL;
+	ht->move_pos = 0;
+	ht->extent_size = extent_size;
+	ht->extent_alloc = extent_alloc_func;
+	ht->extent_free = extent_free_func;
+	ht->alloc_ctx = alloc_ctx;
+	ht->arg = arg;
+}
+
+/**
+ * @brief Hash table destruction. Frees all allocated memory,
+ * except tables still used by frozen iterators.
+ * @param ht - pointer to a hash table struct
+ */
+inline void
+FHASH(destroy)(struct FHASH(core) *ht)
+{
+	if (ht->table != NULL)
+		FHASH(table_unref)(ht->table);
+	if (ht->old_table != NULL)
+		FHASH(table_unref)(ht->old_table);
+	ht->table = ht->old_table = NULL;
+	ht->count = 0;
+}
+
+/**
+ * @brief Allocate a table big enough to hold the given number
+ * of values without growing. Does nothing if the hash is not
+ * empty.
+ * @param ht - pointer to a hash table struct
+ * @param size - expected number of values
+ * @return 0 if ok, -1 on memory error
+ */
+inline int
+FHASH(reserve)(struct FHASH(core) *ht, uint32_t size)
+{
+	if (ht->table != NULL)
+		return 0;
+	uint32_t order = 0;
+	while (order < FHASH(MAX_ORDER) &&
+	       ((uint64_t)FHASH(CHUNK_GROW_LOAD) << order) < size)
+		order++;
+	struct FHASH(table) *table = FHASH(table_new)(ht, order);
+	if (table == NULL)
+		return -1;
+	/*
+	 * The table is valid even if we fail to allocate all
+	 * home chunks: missing chunks are allocated on insertion.
+	 */
+	ht->table = table;
+	while (table->chunk_count < ((uint32_t)1 << order)) {
+		if (FHASH(table_grow)(table) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Move a few chunks of the old table to the new one, if the hash
+ * is being grown. Errors are ignored: the move is resumed on the
+ * next modification.
+ */
+inline void
+FHASH(move)(struct FHASH(core) *ht)
+{
+	struct FHASH(table) *old_table = ht->old_table;
+	if (old_table == NULL)
+		return;
+	struct FHASH(table) *table = ht->table;
+	for (uint32_t step = 0; step < FHASH(MOVE_STEP); step++) {
+		if (ht->move_pos == old_table->chunk_count)
+			break;
+		uint32_t id = ht->move_pos;
+		/*
+		 * Values of the old chunk #id have home chunks not
+		 * greater than 2 * id + 1 in the new table.
+		 */
+		while (table->chunk_count < 2 * id + 2) {
+			if (FHASH(table_grow)(table) != 0)
+				return;
+		}
+		const struct FHASH(chunk) *chunk = (const struct FHASH(chunk) *)
+			matras_get(&old_table->mtable, id);
+		if (chunk->used != 0) {
+			struct FHASH(chunk) *old_chunk = (struct FHASH(chunk) *)
+				matras_touch(&old_table->mtable, id);
+			if (old_chunk == NULL)
+				return;
+			while (old_chunk->used != 0) {
+				uint32_t i = __builtin_ctz(old_chunk->used);
+				if (FHASH(table_insert)(table, old_chunk->hash[i],
+						old_chunk->slot[i].value) != 0)
+					return;
+				/*
+				 * Overflow counters of the old table
+				 * are left as is: they are only upper
+				 * bounds and the table is going away.
+				 */
+				old_chunk->used &= ~(1 << i);
+			}
+		}
+		ht->move_pos++;
+	}
+	if (ht->move_pos == old_table->chunk_count) {
+		FHASH(table_unref)(old_table);
+		ht->old_table = NULL;
+		ht->move_pos = 0;
+	}
+}
+
+/**
+ * Find the position of a value.
+ * @param[out] table_no - 0 for the current table, 1 for the old one
+ * @return true if found
+ */
+inline bool
+FHASH(find_pos)(const struct FHASH(core) *ht, uint32_t hash,
+		FHASH_DATA_TYPE value, uint32_t *table_no,
+		uint32_t *chunk_id, uint32_t *slot)
+{
+	if (ht->table != NULL &&
+	    FHASH(table_find)(ht->table, hash, value, ht->arg,
+			      chunk_id, slot)) {
+		*table_no = 0;
+		return true;
+	}
+	if (ht->old_table != NULL &&
+	    FHASH(table_find)(ht->old_table, hash, value, ht->arg,
+			      chunk_id, slot)) {
+		*table_no = 1;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Find the position of a value by key.
+ * @param[out] table_no - 0 for the current table, 1 for the old one
+ * @return true if found
+ */
+inline bool
+FHASH(find_key_pos)(const struct FHASH(core) *ht, uint32_t hash,
+		    FHASH_KEY_TYPE key, uint32_t *table_no,
+		    uint32_t *chunk_id, uint32_t *slot)
+{
+	if (ht->table != NULL &&
+	    FHASH(table_find_key)(ht->table, hash, key, ht->arg,
+				  chunk_id, slot)) {
+		*table_no = 0;
+		return true;
+	}
+	if (ht->old_table != NULL &&
+	    FHASH(table_find_key)(ht->old_table, hash, key, ht->arg,
+				  chunk_id, slot)) {
+		*table_no = 1;
+		return true;
+	}
+	return false;
+}
+
+inline struct FHASH(table) *
+FHASH(table_by_no)(const struct FHASH(core) *ht, uint32_t table_no)
+{
+	return table_no == 0 ? ht->table : ht->old_table;
+}
+
+/**
+ * @brief Find a value by key
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param key - key to find
+ * @return pointer to the value or NULL if nothing found. The
+ * pointer is valid until the next modification of the hash.
+ */
+inline FHASH_DATA_TYPE *
+FHASH(find_key)(const struct FHASH(core) *ht, uint32_t hash,
+		FHASH_KEY_TYPE key)
+{
+	uint32_t table_no, chunk_id, slot;
+	if (!FHASH(find_key_pos)(ht, hash, key, &table_no, &chunk_id, &slot))
+		return NULL;
+	struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+		matras_get(&FHASH(table_by_no)(ht, table_no)->mtable, chunk_id);
+	return &chunk->slot[slot].value;
+}
+
+/**
+ * @brief Insert a value or replace an equal one
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash of the value
+ * @param value - value to insert
+ * @param replaced - set to the replaced value, if any
+ * @return 0 if inserted, 1 if replaced, -1 on memory error
+ */
+inline int
+FHASH(replace)(struct FHASH(core) *ht, uint32_t hash,
+	       FHASH_DATA_TYPE value, FHASH_DATA_TYPE *replaced)
+{
+	uint32_t table_no, chunk_id, slot;
+	if (FHASH(find_pos)(ht, hash, value, &table_no, &chunk_id, &slot)) {
+		struct FHASH(table) *table = FHASH(table_by_no)(ht, table_no);
+		struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+			matras_touch(&table->mtable, chunk_id);
+		if (chunk == NULL)
+			return -1;
+		*replaced = chunk->slot[slot].value;
+		chunk->slot[slot].value = value;
+		return 1;
+	}
+	if (ht->table == NULL && FHASH(reserve)(ht, 1) != 0)
+		return -1;
+	FHASH(move)(ht);
+	struct FHASH(table) *table = ht->table;
+	if (ht->old_table == NULL && table->order < FHASH(MAX_ORDER) &&
+	    ht->count >= ((uint64_t)FHASH(CHUNK_GROW_LOAD) << table->order)) {
+		/*
+		 * Start growing. If there is no memory for that,
+		 * go on with the current table: it works, though
+		 * slower, when overloaded.
+		 */
+		struct FHASH(table) *new_table =
+			FHASH(table_new)(ht, table->order + 1);
+		if (new_table != NULL) {
+			ht->old_table = table;
+			ht->table = table = new_table;
+			ht->move_pos = 0;
+		}
+	}
+	/*
+	 * While the hash is being grown, the chunks of the new
+	 * table are allocated as the old chunks are moved. If
+	 * the home chunk of the value is not allocated yet,
+	 * the value goes to the old table and will be moved
+	 * later.
+	 */
+	uint32_t home = FHASH(table_home)(table, hash);
+	if (home >= table->chunk_count && ht->old_table != NULL) {
+		table = ht->old_table;
+		home = FHASH(table_home)(table, hash);
+		assert(home >= ht->move_pos);
+	}
+	while (home >= table->chunk_count) {
+		if (FHASH(table_grow)(table) != 0)
+			return -1;
+	}
+	if (FHASH(table_insert)(table, hash, value) != 0)
+		return -1;
+	ht->count++;
+	return 0;
+}
+
+/**
+ * @brief Delete a value from a hash table
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash of the value
+ * @param value - value to delete
+ * @return 0 if ok, 1 if not found or -1 on memory error
+ * (only with frozen iterators)
+ */
+inline int
+FHASH(delete_value)(struct FHASH(core) *ht, uint32_t hash,
+		    FHASH_DATA_TYPE value)
+{
+	/*
+	 * Move chunks before deleting: the memory allocator
+	 * may throw and the deletion must not be lost.
+	 */
+	FHASH(move)(ht);
+	uint32_t table_no, chunk_id, slot;
+	if (!FHASH(find_pos)(ht, hash, value, &table_no, &chunk_id, &slot))
+		return 1;
+	if (FHASH(table_delete)(FHASH(table_by_no)(ht, table_no),
+				chunk_id, slot) != 0)
+		return -1;
+	ht->count--;
+	return 0;
+}
+
+/**
+ * @brief Get a value by a random number, to implement
+ * index:random().
+ * @param ht - pointer to a hash table struct
+ * @param rnd - random number
+ * @return pointer to a value or NULL if the hash is empty
+ */
+inline FHASH_DATA_TYPE *
+FHASH(random)(const struct FHASH(core) *ht, uint32_t rnd)
+{
+	if (ht->count == 0)
+		return NULL;
+	for (uint32_t table_no = 0; table_no < 2; table_no++) {
+		struct FHASH(table) *table = FHASH(table_by_no)(ht, table_no);
+		if (table == NULL || table->chunk_count == 0)
+			continue;
+		uint32_t start = rnd % table->chunk_count;
+		uint32_t id = start;
+		do {
+			struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+				matras_get(&table->mtable, id);
+			if (chunk->used != 0) {
+				uint32_t i = __builtin_ctz(chunk->used);
+				return &chunk->slot[i].value;
+			}
+			if (++id == table->chunk_count)
+				id = 0;
+		} while (id != start);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Get the amount of memory used by the hash table.
+ * @param ht - pointer to a hash table struct
+ * @return number of extents
+ */
+inline size_t
+FHASH(extent_count)(const struct FHASH(core) *ht)
+{
+	size_t count = 0;
+	if (ht->table != NULL)
+		count += matras_extent_count(&ht->table->mtable);
+	if (ht->old_table != NULL)
+		count += matras_extent_count(&ht->old_table->mtable);
+	return count;
+}
+
+/* {{{ Iterators */
+
+/**
+ * @brief Set iterator to the beginning of hash table
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ */
+inline void
+FHASH(iterator_begin)(const struct FHASH(core) *ht,
+		      struct FHASH(iterator) *itr)
+{
+	(void)ht;
+	itr->table_no = 0;
+	itr->chunk_id = 0;
+	itr->slot = 0;
+	itr->is_frozen = false;
+}
+
+/**
+ * @brief Set iterator to position determined by key
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @param hash - hash to find
+ * @param key - key to find
+ */
+inline void
+FHASH(iterator_key)(const struct FHASH(core) *ht,
+		    struct FHASH(iterator) *itr,
+		    uint32_t hash, FHASH_KEY_TYPE key)
+{
+	itr->is_frozen = false;
+	if (!FHASH(find_key_pos)(ht, hash, key, &itr->table_no,
+				 &itr->chunk_id, &itr->slot)) {
+		itr->table_no = 2;
+		itr->chunk_id = 0;
+		itr->slot = 0;
+	}
+}
+
+/**
+ * @brief Get the value that iterator currently points to
+ * and advance the iterator.
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @return pointer to the value or NULL if iteration is complete
+ */
+inline FHASH_DATA_TYPE *
+FHASH(iterator_get_and_next)(const struct FHASH(core) *ht,
+			     struct FHASH(iterator) *itr)
+{
+	for (; itr->table_no < 2; itr->table_no++,
+	     itr->chunk_id = 0, itr->slot = 0) {
+		struct FHASH(table) *table;
+		uint32_t chunk_count;
+		if (itr->is_frozen) {
+			table = itr->table[itr->table_no];
+			chunk_count = itr->chunk_count[itr->table_no];
+		} else {
+			table = FHASH(table_by_no)(ht, itr->table_no);
+			chunk_count = table != NULL ? table->chunk_count : 0;
+		}
+		for (; itr->chunk_id < chunk_count;
+		     itr->chunk_id++, itr->slot = 0) {
+			struct FHASH(chunk) *chunk;
+			if (itr->is_frozen) {
+				chunk = (struct FHASH(chunk) *)
+					matras_view_get(&table->mtable,
+							&itr->view[itr->table_no],
+							itr->chunk_id);
+			} else {
+				chunk = (struct FHASH(chunk) *)
+					matras_get(&table->mtable,
+						   itr->chunk_id);
+			}
+			uint32_t mask = chunk->used >> itr->slot << itr->slot;
+			if (mask != 0) {
+				uint32_t i = __builtin_ctz(mask);
+				itr->slot = i + 1;
+				return &chunk->slot[i].value;
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Freezes state for given iterator. All following hash table
+ * modification will not apply to that iterator iteration. That
+ * iterator should be destroyed with a fhash_iterator_destroy call
+ * after usage.
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to freeze
+ */
+inline void
+FHASH(iterator_freeze)(struct FHASH(core) *ht, struct FHASH(iterator) *itr)
+{
+	assert(!itr->is_frozen);
+	for (uint32_t i = 0; i < 2; i++) {
+		struct FHASH(table) *table = FHASH(table_by_no)(ht, i);
+		itr->table[i] = table;
+		itr->chunk_count[i] = 0;
+		if (table == NULL)
+			continue;
+		table->refs++;
+		itr->chunk_count[i] = table->chunk_count;
+		matras_create_read_view(&table->mtable, &itr->view[i]);
+	}
+	itr->is_frozen = true;
+}
+
+/**
+ * @brief Destroy an iterator that was frozen before. Useless for not
+ * frozen iterators.
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to destroy
+ */
+inline void
+FHASH(iterator_destroy)(struct FHASH(core) *ht, struct FHASH(iterator) *itr)
+{
+	(void)ht;
+	if (!itr->is_frozen)
+		return;
+	for (uint32_t i = 0; i < 2; i++) {
+		struct FHASH(table) *table = itr->table[i];
+		if (table == NULL)
+			continue;
+		matras_destroy_read_view(&table->mtable, &itr->view[i]);
+		FHASH(table_unref)(table);
+	}
+	itr->is_frozen = false;
+}
+
+/* }}} */
+
+/*
+ * Selfcheck of the internal state of hash table. Used only for debugging.
+ * That means that you should not use this function.
+ * If return not zero, something went terribly wrong.
+ */
+inline int
+FHASH(selfcheck)(const struct FHASH(core) *ht)
+{
+	int res = 0;
+	uint32_t count = 0;
+	for (uint32_t table_no = 0; table_no < 2; table_no++) {
+		struct FHASH(table) *table = FHASH(table_by_no)(ht, table_no);
+		if (table == NULL)
+			continue;
+		if (table->chunk_count != table->mtable.head.block_count)
+			res |= 1; /* wrong chunk count */
+		for (uint32_t id = 0; id < table->chunk_count; id++) {
+			struct FHASH(chunk) *chunk = (struct FHASH(chunk) *)
+				matras_get(&table->mtable, id);
+			if ((chunk->used & ~FHASH(CHUNK_FULL)) != 0)
+				res |= 2; /* garbage in used mask */
+			if (table_no == 1 && id < ht->move_pos &&
+			    chunk->used != 0)
+				res |= 4; /* not moved */
+			uint32_t used = chunk->used;
+			while (used != 0) {
+				uint32_t i = __builtin_ctz(used);
+				used &= used - 1;
+				count++;
+				uint32_t hash = chunk->hash[i];
+				uint32_t home = FHASH(table_home)(table, hash);
+				if (home > id)
+					res |= 8; /* value before home */
+				for (uint32_t p = home; p < id; p++) {
+					struct FHASH(chunk) *passed =
+						(struct FHASH(chunk) *)
+						matras_get(&table->mtable, p);
+					if (passed->overflow == 0)
+						res |= 16; /* unreachable */
+				}
+				uint32_t c, s, t;
+				if (!FHASH(find_pos)(ht, hash,
+						     chunk->slot[i].value,
+						     &t, &c, &s) ||
+				    t != table_no || c != id || s != i)
+					res |= 32; /* not found */
+			}
+		}
+	}
+	if (count != ht->count)
+		res |= 64; /* wrong count */
+	return res;
+}
@@ -0,0 +1,55 @@
+test_run = require('test_run').new()
+
+-- the option is memtx only
+box.schema.space.create('test', {engine = 'vinyl', compression = true})
+
+s = box.schema.space.create('test', {compression = true})
+pk = s:create_index('pk')
+long = string.rep('abcdefgh', 100)
+-- enough tuples to train a dictionary
+for i = 1, 1000 do s:insert{i, long .. i, i} end
+box.slab.info().items_compressed > 0
+-- small tuples are stored as is
+s:insert{1001, 'a', 1001}
+s:get{1001}
+t = s:get{1}
+t[2] == long .. 1
+t[3]
+#t
+t:bsize()
+t = s:get{1000}
+t[2] == long .. 1000
+t:update({{'=', 3, 0}})[3]
+s:update({1}, {{'=', 3, 100}})[3]
+s:get{1}[2] == long .. 1
+-- non-indexed fields are read from a cached decompressed copy
+fiber = require('fiber')
+function region_used() return fiber.info()[fiber.id()].memory.used end
+box.begin() used = region_used() for _, t in s:pairs() do _ = t[3] end used = region_used() - used box.commit()
+used < 64 * 1024
+s:select({1000}, {iterator = 'GE'})[2][1]
+s:count()
+s2 = box.schema.space.create('test2', {compression = true})
+_ = s2:create_index('pk')
+for i = 1, 100 do s2:insert{i, long .. i, i % 10, long} end
+
+-- the tuples are decompressed in the snapshot
+box.snapshot()
+-- indexing compressed fields re-stores the tuples
+sk = s2:create_index('sk', {parts = {3, 'unsigned'}, unique = false})
+#sk:select{5}
+sk:select{5}[1][2] == long .. 5
+s2:get{5}[4] == long
+test_run:cmd('restart server default')
+s = box.space.test
+long = string.rep('abcdefgh', 100)
+s:get{1}[2] == long .. 1
+s:get{1}[3]
+s:count()
+box.slab.info().items_compressed > 0
+-- the index is built on recovery from the xlog
+s2 = box.space.test2
+#s2.index.sk:select{5}
+s2.index.sk:select{5}[10][1]
+s2:drop()
+s:drop()
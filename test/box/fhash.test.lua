@@ -0,0 +1,23 @@
+-- FHASH index: unique hash index with chunked open addressing
+s = box.schema.space.create('test')
+i = s:create_index('pk', { type = 'fhash' })
+i.type
+i.unique
+for k = 1, 1000 do s:insert{k, tostring(k)} end
+s:count()
+i:get{500}
+i:get{1001} == nil
+s:insert{500, 'dup'}
+s:replace{500, 'new'}
+s:delete{500}
+s:count()
+n = 0
+for _, v in i:pairs() do n = n + 1 end
+n
+#i:select({}, { iterator = 'ALL' })
+#i:select({1}, { iterator = 'GT' }) < 999
+i:random(42) ~= nil
+i:bsize() > 0
+-- FHASH index must be unique
+s:create_index('test', { type = 'fhash', unique = false, parts = { 2, 'string' } })
+s:drop()
@@ -0,0 +1,26 @@
+-- the option is memtx only
+box.schema.space.create('test', {engine = 'vinyl', fixed_layout = true})
+
+s = box.schema.space.create('test', {fixed_layout = true})
+pk = s:create_index('pk')
+i = s:create_index('i', {parts = {2, 'integer'}, unique = false})
+n = s:create_index('n', {parts = {3, 'number'}, unique = false})
+h = s:create_index('h', {type = 'hash', parts = {4, 'unsigned'}})
+s:insert{1, -5, 1.5, 10, 'a'}
+s:insert{2, 18446744073709551615ULL, 2, 20, 'b'}
+s:insert{3, 18446744073709551614ULL, -1, 30, 'c'}
+s:insert{4, 9223372036854775807LL, 9007199254740993ULL, 40, 'd'}
+s:insert{5, -9223372036854775807LL, 9007199254740992ULL, 50, 'e'}
+s:insert{6, 0, 3.5, 60, 'f'}
+pk:select()
+i:select()
+n:select()
+h:get{30}
+i:select({18446744073709551614ULL}, {iterator = 'GE'})
+n:select({9007199254740992ULL}, {iterator = 'GT'})
+s:update({1}, {{'=', 2, 100}})
+i:select({0}, {iterator = 'GT'})
+-- an index added to a non-empty space
+m = s:create_index('m', {parts = {2, 'integer', 4, 'unsigned'}})
+m:select()
+s:drop()
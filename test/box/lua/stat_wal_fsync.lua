@@ -0,0 +1,11 @@
+#!/usr/bin/env tarantool
+os = require('os')
+
+box.cfg{
+    listen                 = os.getenv("LISTEN"),
+    wal_mode               = 'fsync',
+    wal_group_commit_delay = 0.5,
+    wal_group_commit_size  = 10 * 1024 * 1024,
+}
+
+require('console').listen(os.getenv('ADMIN'))
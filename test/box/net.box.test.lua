@@ -664,4 +664,17 @@ nb:close();
 test_run:cmd("setopt delimiter ''");
 srv:close()
 
+-- wide tuples are sent right from the tuple memory
+space = box.schema.space.create('zcopy')
+index = space:create_index('primary')
+for i = 1, 100 do space:insert{i, string.rep('x', 1000)} end
+box.schema.user.grant('guest', 'read', 'space', 'zcopy')
+cn = remote.connect(box.cfg.listen)
+res = cn.space.zcopy:select()
+#res
+res[1][1], res[100][1], #res[100][2]
+cn.space.zcopy:select({50}, {iterator = 'GE', limit = 2})[2][1]
+cn:close()
+space:drop()
+
 test_run:cmd("clear filter")
@@ -0,0 +1,36 @@
+test_run = require('test_run').new()
+net_box = require('net.box')
+
+test_run:cmd('create server net_threads with script = "box/lua/net_threads.lua"')
+test_run:cmd('start server net_threads')
+test_run:cmd('switch net_threads')
+box.cfg.net_threads
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+test_run:cmd('switch default')
+
+uri = test_run:eval('net_threads', 'return box.cfg.listen')[1]
+
+-- connections are spread over the network threads
+conns = {}
+for i = 1, 16 do conns[i] = net_box.connect(uri) end
+ok = true
+for i = 1, 16 do ok = ok and conns[i]:ping() end
+ok
+for i = 1, 16 do conns[i].space.test:insert{i, i * 2} end
+sum = 0
+for i = 1, 16 do sum = sum + conns[i].space.test:get{i}[2] end
+sum
+conns[1].space.test:count()
+
+-- disconnects free connections in their own threads
+for i = 1, 16 do conns[i]:close() end
+for i = 1, 16 do conns[i] = net_box.connect(uri) end
+ok = true
+for i = 1, 16 do ok = ok and conns[i]:ping() end
+ok
+#conns[16].space.test:select()
+for i = 1, 16 do conns[i]:close() end
+
+test_run:cmd('stop server net_threads')
+test_run:cmd('cleanup server net_threads')
@@ -0,0 +1,71 @@
+-- clear statistics
+env = require('test_run')
+test_run = env.new()
+test_run:cmd('restart server default')
+
+box.cfg.wal_mode
+box.cfg.wal_group_commit_delay
+box.cfg.wal_group_commit_size
+
+-- WAL syncs are counted in fsync mode only
+box.stat.wal.SYNC -- zero
+box.stat.wal.SYNC_ROWS -- zero
+box.stat.wal.SYNC_TIME -- zero
+
+space = box.schema.space.create('tweedledum')
+index = space:create_index('primary')
+for i = 1, 10 do space:insert{i} end
+box.stat.wal.SYNC_ROWS.total
+
+t = box.stat.wal()
+t.SYNC ~= nil and t.SYNC_ROWS ~= nil and t.SYNC_TIME ~= nil
+
+box.cfg{wal_group_commit_delay = 0.001}
+
+space:drop()
+
+-- fsync mode: writes issued within wal_group_commit_delay
+-- share one sync
+test_run:cmd('create server stat_wal_fsync with script = "box/lua/stat_wal_fsync.lua"')
+test_run:cmd('start server stat_wal_fsync')
+test_run:cmd('switch stat_wal_fsync')
+box.cfg.wal_mode
+box.cfg.wal_group_commit_delay
+box.cfg.wal_group_commit_size
+fiber = require('fiber')
+space = box.schema.space.create('tweedledum')
+index = space:create_index('primary')
+ch = fiber.channel(5)
+function insert(i) ch:put((pcall(space.insert, space, {i}))) end
+test_run:cmd("setopt delimiter ';'")
+function insert_batch(first)
+    local sync = box.stat.wal.SYNC.total
+    local rows = box.stat.wal.SYNC_ROWS.total
+    for i = first, first + 4 do
+        fiber.create(insert, i)
+        fiber.sleep(0.01)
+    end
+    local res = {}
+    for i = 1, 5 do
+        table.insert(res, ch:get())
+    end
+    return res, box.stat.wal.SYNC.total - sync,
+           box.stat.wal.SYNC_ROWS.total - rows
+end;
+test_run:cmd("setopt delimiter ''");
+insert_batch(1)
+space:count()
+
+-- a failed sync rolls back every transaction in the group
+errinj = box.error.injection
+errinj.set('ERRINJ_WAL_SYNC', true)
+insert_batch(6)
+errinj.set('ERRINJ_WAL_SYNC', false)
+space:count()
+-- wait for the cascading rollback to end
+while not pcall(space.insert, space, {6}) do fiber.sleep(0.01) end
+space:select{}
+space:drop()
+test_run:cmd('switch default')
+test_run:cmd('stop server stat_wal_fsync')
+test_run:cmd('cleanup server stat_wal_fsync')
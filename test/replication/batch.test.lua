@@ -0,0 +1,66 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+-- a space of the other engine
+t = box.schema.space.create('other', {engine = engine == 'memtx' and 'vinyl' or 'memtx'})
+_ = t:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+fiber = require('fiber')
+function relay() local r = box.info.replication[2] return r and r.relay end
+
+--
+-- Rows received in a burst are applied in batches. A batch is
+-- cut at rows of system spaces and of spaces of another engine.
+--
+for i = 1, 1000 do s:insert{i} if i % 100 == 0 then t:insert{i} box.space._schema:replace{'batch', i} end end
+box.begin() for i = 1001, 2000 do s:insert{i} end box.commit()
+
+test_run:cmd("switch replica")
+fiber = require('fiber')
+s = box.space.test
+t = box.space.other
+function batch() local r = box.space._schema:get('batch') return r and r[2] end
+while s:count() < 2000 or t:count() < 10 or batch() ~= 1000 do fiber.sleep(0.01) end
+s:count()
+t:count()
+s:get{1}
+s:get{2000}
+box.info.replication[1].status
+
+--
+-- If a batch fails to commit, its rows are not skipped: they
+-- are applied when replication is resumed.
+--
+lsn = box.info.vclock[1]
+box.error.injection.set('ERRINJ_WAL_IO', true)
+test_run:cmd("switch default")
+for i = 2001, 2100 do s:insert{i} end
+test_run:cmd("switch replica")
+while box.info.replication[1].status ~= 'stopped' do fiber.sleep(0.01) end
+box.info.replication[1].message
+s:count()
+box.info.vclock[1] == lsn
+box.error.injection.set('ERRINJ_WAL_IO', false)
+box.cfg{replication = ''}
+test_run:cmd("switch default")
+while relay() ~= nil do fiber.sleep(0.01) end
+test_run:cmd("switch replica")
+box.cfg{replication = os.getenv('MASTER')}
+while s:count() < 2100 do fiber.sleep(0.01) end
+s:count()
+s:get{2100}
+box.info.vclock[1] > lsn
+box.info.replication[1].status
+
+test_run:cmd("switch default")
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+t:drop()
+box.schema.user.revoke('guest', 'replication')
@@ -0,0 +1,47 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+
+--
+-- The replica asks for a compressed stream when it subscribes.
+--
+fiber = require('fiber')
+function relay() local r = box.info.replication[2] return r and r.relay end
+test_run:cmd("switch replica")
+fiber = require('fiber')
+box.cfg{replication_compression = 3}
+box.cfg{replication = ''}
+test_run:cmd("switch default")
+while relay() ~= nil do fiber.sleep(0.01) end
+test_run:cmd("switch replica")
+box.cfg{replication = os.getenv('MASTER')}
+while box.info.replication[1].status ~= 'follow' do fiber.sleep(0.01) end
+
+test_run:cmd("switch default")
+for i = 1, 1000 do s:insert{i, string.rep('x', 100)} end
+
+test_run:cmd("switch replica")
+s = box.space.test
+while s:count() < 1000 do fiber.sleep(0.01) end
+s:count()
+s:get{1000}[2] == string.rep('x', 100)
+box.info.replication[1].status
+
+test_run:cmd("switch default")
+r = relay()
+r.compression
+r.rows >= 1000
+r.bytes_saved > 0
+r.bytes_saved < r.bytes
+
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
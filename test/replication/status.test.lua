@@ -14,6 +14,9 @@ r.uuid ~= nil
 
 box.space._schema:insert({'dup'})
 test_run:cmd('switch default')
+r = box.info.replication[2].relay
+r.compression == 0
+r.bytes_saved == 0
 box.space._schema:insert({'dup'})
 test_run:cmd('switch replica')
 r = box.info.replication[1]
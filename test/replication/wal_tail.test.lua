@@ -0,0 +1,51 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+fiber = require('fiber')
+errinj = box.error.injection
+pad = string.rep('x', 100)
+
+--
+-- A replica that keeps up with the master is served from the
+-- in-memory WAL tail.
+--
+for i = 1, 100 do s:insert{i, pad} end
+test_run:cmd("switch replica")
+fiber = require('fiber')
+while box.space.test:count() < 100 do fiber.sleep(0.01) end
+box.space.test:count()
+test_run:cmd("switch default")
+test_run:grep_log('default', 'reading the in%-memory WAL tail') ~= nil
+
+--
+-- A replica that lags behind the tail falls back on reading
+-- xlog files.
+--
+errinj.set('ERRINJ_WAL_TAIL_SIZE', 4096)
+errinj.set('ERRINJ_RELAY_SEND_DELAY', true)
+s:insert{101, pad}
+test_run:cmd("switch replica")
+while box.space.test:count() < 101 do fiber.sleep(0.01) end
+test_run:cmd("switch default")
+-- the rows following the one being sent are evicted
+for i = 102, 300 do s:insert{i, pad} end
+errinj.set('ERRINJ_RELAY_SEND_DELAY', false)
+test_run:cmd("switch replica")
+while box.space.test:count() < 300 do fiber.sleep(0.01) end
+box.space.test:count()
+box.space.test:get{300}[1]
+test_run:cmd("switch default")
+test_run:grep_log('default', 'fell behind the in%-memory WAL tail') ~= nil
+errinj.set('ERRINJ_WAL_TAIL_SIZE', 0)
+
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
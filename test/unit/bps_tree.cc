@@ -755,6 +755,55 @@ approximate_count()
 	footer();
 }
 
+static void
+approximate_rank()
+{
+	header();
+	srand(0);
+
+	approx tree;
+	approx_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+
+	uint32_t in_leaf_max_count = BPS_TREE_approx_MAX_COUNT_IN_LEAF;
+	uint32_t in_leaf_min_count = in_leaf_max_count * 2 / 3;
+
+	/* Key i is repeated i % 7 times. */
+	const uint32_t key_count = 1000;
+	uint64_t count = 0;
+	for (uint64_t i = 0; i < key_count; i++)
+		for (uint64_t j = 0; j < i % 7; j++, count++)
+			approx_insert(&tree, (i << 32) | j, NULL);
+	printf("Count: %zu\n", tree.size);
+
+	int err_count = 0;
+	uint64_t less = 0;
+	for (uint32_t i = 0; i <= key_count; i++) {
+		uint64_t less_or_equal = less + (i < key_count ? i % 7 : 0);
+		uint64_t true_ranks[] = { less, less_or_equal };
+		for (int after = 0; after < 2; after++) {
+			uint64_t true_rank = true_ranks[after];
+			uint64_t rank = approx_approximate_rank(&tree, i, after);
+			if (rank > count)
+				err_count++;
+			if (true_rank < in_leaf_min_count) {
+				if (rank != true_rank)
+					err_count++;
+				continue;
+			}
+			double low = rank * 2. / 3 - in_leaf_max_count;
+			double up = rank * 3. / 2 + in_leaf_max_count;
+			if (true_rank < low || true_rank > up)
+				err_count++;
+		}
+		less = less_or_equal;
+	}
+	printf("Error count: %d\n", err_count);
+
+	approx_destroy(&tree);
+
+	footer();
+}
+
 int
 main(void)
 {
@@ -766,6 +815,7 @@ main(void)
 	printing_test();
 	white_box_test();
 	approximate_count();
+	approximate_rank();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 }
@@ -0,0 +1,377 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <vector>
+#include <time.h>
+
+#include "unit.h"
+
+typedef uint64_t hash_value_t;
+typedef uint32_t hash_t;
+
+static const size_t fhash_extent_size = 16 * 1024;
+static size_t extents_count = 0;
+
+hash_t
+hash(hash_value_t value)
+{
+	/* Spread the values over the high bits used for addressing. */
+	return (hash_t) (value * 2654435761u);
+}
+
+bool
+equal(hash_value_t v1, hash_value_t v2)
+{
+	return v1 == v2;
+}
+
+bool
+equal_key(hash_value_t v1, hash_value_t v2)
+{
+	return v1 == v2;
+}
+
+#define FHASH_NAME
+#define FHASH_DATA_TYPE uint64_t
+#define FHASH_KEY_TYPE uint64_t
+#define FHASH_CMP_ARG_TYPE int
+#define FHASH_EQUAL(a, b, arg) equal(a, b)
+#define FHASH_EQUAL_KEY(a, b, arg) equal_key(a, b)
+#include "salad/fhash.h"
+
+inline void *
+my_fhash_alloc(void *ctx)
+{
+	size_t *p_extents_count = (size_t *)ctx;
+	assert(p_extents_count == &extents_count);
+	++*p_extents_count;
+	return malloc(fhash_extent_size);
+}
+
+inline void
+my_fhash_free(void *ctx, void *p)
+{
+	size_t *p_extents_count = (size_t *)ctx;
+	assert(p_extents_count == &extents_count);
+	--*p_extents_count;
+	free(p);
+}
+
+/**
+ * Insert and delete random values, checking the hash against
+ * a reference after each step.
+ */
+static void
+check_random_ops(hash_t (*hash_func)(hash_value_t), size_t rounds,
+		 size_t max_limits)
+{
+	struct fhash_core ht;
+	fhash_create(&ht, fhash_extent_size,
+		     my_fhash_alloc, my_fhash_free, &extents_count, 0);
+	std::vector<bool> vect;
+	size_t count = 0;
+	for (size_t limits = 20; limits <= max_limits; limits *= 10) {
+		while (vect.size() < limits)
+			vect.push_back(false);
+		for (size_t i = 0; i < rounds; i++) {
+			hash_value_t val = rand() % limits;
+			hash_t h = hash_func(val);
+			bool has1 = fhash_find_key(&ht, h, val) != NULL;
+			bool has2 = vect[val];
+			if (has1 != has2) {
+				fail("find key failed!", "true");
+				return;
+			}
+
+			if (!has1) {
+				count++;
+				vect[val] = true;
+				hash_value_t replaced;
+				if (fhash_replace(&ht, h, val, &replaced) != 0)
+					fail("insert failed!", "true");
+			} else {
+				count--;
+				vect[val] = false;
+				if (fhash_delete_value(&ht, h, val) != 0)
+					fail("delete failed!", "true");
+			}
+
+			if (count != ht.count)
+				fail("count check failed!", "true");
+
+			bool identical = true;
+			for (hash_value_t test = 0; test < limits; test++) {
+				bool found = fhash_find_key(&ht, hash_func(test),
+							    test) != NULL;
+				if (found != vect[test])
+					identical = false;
+			}
+			if (!identical)
+				fail("internal test failed!", "true");
+
+			int check = fhash_selfcheck(&ht);
+			if (check)
+				fail("internal test failed!", "true");
+		}
+	}
+	fhash_destroy(&ht);
+}
+
+static void
+simple_test()
+{
+	header();
+	check_random_ops(hash, 1000, 2000);
+	footer();
+}
+
+static hash_t
+collision_hash(hash_value_t value)
+{
+	/* Only 4 distinct hashes: long overflow runs. */
+	return hash(value % 4);
+}
+
+static void
+collision_test()
+{
+	header();
+	check_random_ops(collision_hash, 100, 200);
+	footer();
+}
+
+static void
+replace_test()
+{
+	header();
+
+	struct fhash_core ht;
+	fhash_create(&ht, fhash_extent_size,
+		     my_fhash_alloc, my_fhash_free, &extents_count, 0);
+	hash_value_t replaced = 0;
+	if (fhash_replace(&ht, hash(1), 1, &replaced) != 0)
+		fail("insert failed!", "true");
+	if (fhash_replace(&ht, hash(1), 1, &replaced) != 1 || replaced != 1)
+		fail("replace failed!", "true");
+	if (ht.count != 1)
+		fail("count check failed!", "true");
+	if (fhash_delete_value(&ht, hash(2), 2) != 1)
+		fail("delete of a missing value succeeded!", "true");
+	fhash_destroy(&ht);
+
+	footer();
+}
+
+static void
+grow_test()
+{
+	header();
+
+	struct fhash_core ht;
+	fhash_create(&ht, fhash_extent_size,
+		     my_fhash_alloc, my_fhash_free, &extents_count, 0);
+	const hash_value_t count = 100000;
+	bool was_grown = false;
+	for (hash_value_t val = 0; val < count; val++) {
+		hash_value_t replaced;
+		if (fhash_replace(&ht, hash(val), val, &replaced) != 0)
+			fail("insert failed!", "true");
+		if (ht.old_table != NULL)
+			was_grown = true;
+		if (val % 1000 == 0 && fhash_selfcheck(&ht) != 0)
+			fail("internal test failed!", "true");
+	}
+	if (!was_grown)
+		fail("the hash was not grown!", "true");
+	for (hash_value_t val = 0; val < count; val++) {
+		hash_value_t *res = fhash_find_key(&ht, hash(val), val);
+		if (res == NULL || *res != val)
+			fail("find key failed!", "true");
+	}
+	for (hash_value_t val = 0; val < count; val += 2) {
+		if (fhash_delete_value(&ht, hash(val), val) != 0)
+			fail("delete failed!", "true");
+	}
+	for (hash_value_t val = 0; val < count; val++) {
+		bool found = fhash_find_key(&ht, hash(val), val) != NULL;
+		if (found != (val % 2 == 1))
+			fail("find key failed!", "true");
+	}
+	if (fhash_selfcheck(&ht) != 0)
+		fail("internal test failed!", "true");
+	fhash_destroy(&ht);
+
+	footer();
+}
+
+static void
+reserve_test()
+{
+	header();
+
+	struct fhash_core ht;
+	fhash_create(&ht, fhash_extent_size,
+		     my_fhash_alloc, my_fhash_free, &extents_count, 0);
+	const hash_value_t count = 10000;
+	if (fhash_reserve(&ht, count) != 0)
+		fail("reserve failed!", "true");
+	for (hash_value_t val = 0; val < count; val++) {
+		hash_value_t replaced;
+		if (fhash_replace(&ht, hash(val), val, &replaced) != 0)
+			fail("insert failed!", "true");
+		if (ht.old_table != NULL)
+			fail("the hash was grown!", "true");
+	}
+	if (fhash_selfcheck(&ht) != 0)
+		fail("internal test failed!", "true");
+	fhash_destroy(&ht);
+
+	footer();
+}
+
+static void
+iterator_test()
+{
+	header();
+
+	struct fhash_core ht;
+	fhash_create(&ht, fhash_extent_size,
+		     my_fhash_alloc, my_fhash_free, &extents_count, 0);
+	const size_t rounds = 1000;
+	const size_t start_limits = 20;
+
+	const size_t iterator_count = 16;
+	struct fhash_iterator iterators[iterator_count];
+	for (size_t i = 0; i < iterator_count; i++)
+		fhash_iterator_begin(&ht, iterators + i);
+	size_t cur_iterator = 0;
+	hash_value_t strage_thing = 0;
+
+	for(size_t limits = start_limits; limits <= 2 * rounds; limits *= 10) {
+		for (size_t i = 0; i < rounds; i++) {
+			hash_value_t val = rand() % limits;
+			hash_t h = hash(val);
+			if (fhash_delete_value(&ht, h, val) == 1) {
+				hash_value_t replaced;
+				fhash_replace(&ht, h, val, &replaced);
+			}
+
+			hash_value_t *pval = fhash_iterator_get_and_next(&ht, iterators + cur_iterator);
+			if (pval)
+				strage_thing ^= *pval;
+			if (!pval || (rand() % iterator_count) == 0) {
+				if (rand() % iterator_count) {
+					hash_value_t val = rand() % limits;
+					hash_t h = hash(val);
+					fhash_iterator_key(&ht, iterators + cur_iterator, h, val);
+				} else {
+					fhash_iterator_begin(&ht, iterators + cur_iterator);
+				}
+			}
+
+			cur_iterator++;
+			if (cur_iterator >= iterator_count)
+				cur_iterator = 0;
+		}
+	}
+	fhash_destroy(&ht);
+
+	if (strage_thing >> 20) {
+		printf("impossible!\n"); // prevent strage_thing to be optimized out
+	}
+
+	footer();
+}
+
+static void
+iterator_freeze_check()
+{
+	header();
+
+	const int test_data_size = 1000;
+	hash_value_t comp_buf[test_data_size];
+	const int test_data_mod = 2000;
+	srand(0);
+	struct fhash_core ht;
+
+	for (int i = 0; i < 10; i++) {
+		fhash_create(&ht, fhash_extent_size,
+			     my_fhash_alloc, my_fhash_free, &extents_count, 0);
+		int comp_buf_size = 0;
+		for (int j = 0; j < test_data_size; j++) {
+			hash_value_t val = rand() % test_data_mod;
+			hash_value_t replaced;
+			fhash_replace(&ht, hash(val), val, &replaced);
+		}
+		struct fhash_iterator iterator;
+		fhash_iterator_begin(&ht, &iterator);
+		hash_value_t *e;
+		while ((e = fhash_iterator_get_and_next(&ht, &iterator))) {
+			comp_buf[comp_buf_size++] = *e;
+		}
+		struct fhash_iterator iterator1;
+		fhash_iterator_begin(&ht, &iterator1);
+		fhash_iterator_freeze(&ht, &iterator1);
+		struct fhash_iterator iterator2;
+		fhash_iterator_begin(&ht, &iterator2);
+		fhash_iterator_freeze(&ht, &iterator2);
+		/* Grow the hash while the iterators are frozen. */
+		for (int j = 0; j < 4 * test_data_size; j++) {
+			hash_value_t val = test_data_mod + j;
+			hash_value_t replaced;
+			fhash_replace(&ht, hash(val), val, &replaced);
+		}
+		int tested_count = 0;
+		while ((e = fhash_iterator_get_and_next(&ht, &iterator1))) {
+			if (*e != comp_buf[tested_count]) {
+				fail("version restore failed (1)", "true");
+			}
+			tested_count++;
+			if (tested_count > comp_buf_size) {
+				fail("version restore failed (2)", "true");
+			}
+		}
+		fhash_iterator_destroy(&ht, &iterator1);
+		for (int j = 0; j < test_data_size; j++) {
+			hash_value_t val = rand() % test_data_mod;
+			fhash_delete_value(&ht, hash(val), val);
+		}
+
+		/* The tables must outlive the hash for frozen iterators. */
+		fhash_destroy(&ht);
+
+		tested_count = 0;
+		while ((e = fhash_iterator_get_and_next(&ht, &iterator2))) {
+			if (*e != comp_buf[tested_count]) {
+				fail("version restore failed (3)", "true");
+			}
+			tested_count++;
+			if (tested_count > comp_buf_size) {
+				fail("version restore failed (4)", "true");
+			}
+		}
+		if (tested_count != comp_buf_size)
+			fail("version restore failed (5)", "true");
+		fhash_iterator_destroy(&ht, &iterator2);
+	}
+
+	footer();
+}
+
+int
+main(int, const char**)
+{
+	srand(time(0));
+	simple_test();
+	collision_test();
+	replace_test();
+	grow_test();
+	reserve_test();
+	iterator_test();
+	iterator_freeze_check();
+	if (extents_count != 0)
+		fail("memory leak!", "true");
+}
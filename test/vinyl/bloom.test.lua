@@ -47,3 +47,21 @@ new_reflects() > 980
 new_seeks() < 20
 
 s:drop()
+
+-- bloom filters of key prefixes
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}, prefix_bloom = true})
+for i = 1,100 do for j = 1,10 do s:replace{i, j} end end
+box.snapshot()
+_ = new_reflects()
+_ = new_seeks()
+
+for i = 1,100 do s:select{i} end
+new_reflects() == 0
+new_seeks() == 100
+
+for i = 101,200 do s:select{i} end
+new_reflects() > 90
+new_seeks() < 10
+
+s:drop()
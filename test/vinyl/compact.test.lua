@@ -39,5 +39,22 @@ test_run:grep_log('default', 'UPSERT operation failed') ~= nil
 
 space:drop()
 
+-- compaction strategies
+space = box.schema.space.create("vinyl", { engine = 'vinyl' })
+_ = space:create_index('primary', { compaction = 'foo' })
+_ = space:create_index('primary', { compaction = 'time_window', compaction_window = 0 })
+
+-- leveled: compact as soon as there are two runs in a level
+_ = space:create_index('primary', { run_count_per_level = 10, compaction = 'leveled' })
+space:replace({1})
+box.snapshot()
+space:replace({2})
+box.snapshot()
+while vyinfo().run_count >= 2 do fiber.sleep(0.1) end
+vyinfo().run_count
+vyinfo().dump_size > 0
+vyinfo().compact_size > 0
+space:drop()
+
 fiber = nil
 test_run = nil
@@ -58,3 +58,21 @@ space = box.schema.space.create('test_len', { engine = 'vinyl' })
 _ = space:create_index('primary', { type = 'tree', parts = {1, 'string'}})
 space:len()
 space:drop()
+
+-------------------------------------------------------------------------------
+-- field_count can only be changed on an empty space
+-------------------------------------------------------------------------------
+
+space = box.schema.space.create('test_field_count', { engine = 'vinyl' })
+_ = space:create_index('primary')
+_ = box.space._space:update(space.id, {{'=', 5, 1}})
+space:insert({1})
+box.space._space:update(space.id, {{'=', 5, 2}})
+box.snapshot()
+box.space._space:update(space.id, {{'=', 5, 2}})
+space:delete({1})
+box.snapshot()
+_ = box.space._space:update(space.id, {{'=', 5, 2}})
+space:insert({1})
+space:insert({1, 2})
+space:drop()
@@ -0,0 +1,66 @@
+#!/usr/bin/env tarantool
+
+test_run = require('test_run').new()
+
+--
+-- index:count() with {approximate = true} estimates the number
+-- of matching tuples from run page metadata and in-memory tree
+-- ranks without reading the tuples.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {page_size = 1024})
+sk = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+
+function fill(from, to) for i = from, to do s:replace{i, i % 10, string.rep('x', 100)} end end
+function close(a, b) return math.abs(a - b) <= b / 10 + 1 end
+
+-- In-memory trees.
+fill(1, 1000)
+pk:count(nil, {approximate = true})
+close(pk:count(500, {iterator = 'GE', approximate = true}), 501)
+close(pk:count(500, {iterator = 'LT', approximate = true}), 499)
+pk:count(500, {approximate = true}) <= 1
+
+-- Runs.
+box.snapshot()
+close(pk:count(nil, {approximate = true}), 1000)
+close(pk:count(500, {iterator = 'GE', approximate = true}), 501)
+close(pk:count(500, {iterator = 'GT', approximate = true}), 500)
+close(pk:count(500, {iterator = 'LE', approximate = true}), 500)
+close(pk:count(500, {iterator = 'LT', approximate = true}), 499)
+pk:count(500, {approximate = true}) <= 1
+pk:count(5000, {approximate = true}) <= 1
+
+-- DELETE statements are subtracted from the estimate.
+for i = 1, 500 do s:delete{i} end
+box.snapshot()
+close(pk:count(nil, {approximate = true}), 500)
+close(pk:count(500, {iterator = 'GE', approximate = true}), 500)
+
+-- Exact count.
+s:count()
+pk:count(500, {iterator = 'GT'})
+sk:count(3)
+sk:count(3, {iterator = 'LE'})
+
+-- The number of DELETE statements is persisted in run meta.
+test_run:cmd('restart server default')
+
+s = box.space.test
+pk = s.index.pk
+function close(a, b) return math.abs(a - b) <= b / 10 + 1 end
+close(pk:count(nil, {approximate = true}), 500)
+close(pk:count(500, {iterator = 'GE', approximate = true}), 500)
+s:count()
+s:drop()
+
+-- memtx tree indexes support approximate count too.
+s = box.schema.space.create('test', {engine = 'memtx'})
+pk = s:create_index('pk')
+for i = 1, 1000 do s:replace{i} end
+function close(a, b) return math.abs(a - b) <= b / 10 + 1 end
+close(pk:count(500, {iterator = 'GE', approximate = true}), 501)
+close(pk:count(500, {iterator = 'LT', approximate = true}), 499)
+pk:count(500, {approximate = true}) <= 1
+pk:count(nil, {approximate = true})
+s:drop()
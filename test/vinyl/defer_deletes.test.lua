@@ -0,0 +1,66 @@
+test_run = require('test_run').new()
+
+-- DELETE by the primary key doesn't look up the old tuple
+s = box.schema.space.create('test', {engine = 'vinyl', defer_deletes = true})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+for i = 1, 10 do s:replace{i, i % 3} end
+box.snapshot()
+get = box.info.vinyl().performance.get.total
+for i = 1, 10, 2 do s:delete{i} end
+box.info.vinyl().performance.get.total - get
+-- stale secondary index entries are filtered out on read
+sk:select{}
+sk:select{1}
+-- a deleted key may be inserted with another secondary key
+s:insert{1, 2}
+sk:select{1}
+sk:select{2}
+box.snapshot()
+sk:select{}
+s:drop()
+
+-- lookup is not skipped if there is a unique secondary index
+s = box.schema.space.create('test', {engine = 'vinyl', defer_deletes = true})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+s:replace{1, 1}
+s:delete{1}
+s:insert{2, 1}
+sk:select{}
+s:drop()
+
+-- stale entries found on read are purged
+fiber = require('fiber')
+s = box.schema.space.create('test', {engine = 'vinyl', defer_deletes = true})
+pk = s:create_index('pk', {compaction = 'leveled'})
+sk = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+function purged() return box.info.vinyl().db[s.id..'/1'].purge_count end
+for i = 1, 10 do s:replace{i, i} end
+for i = 1, 10, 2 do s:delete{i} end
+sk:select{}
+purged()
+sk:select{}
+purged()
+sk:count()
+-- an entry written anew is not purged
+s:delete{2}
+s:insert{2, 2}
+sk:select{2}
+purged()
+
+-- stale entries of tuples deleted by compaction are purged
+box.snapshot()
+for i = 2, 10, 2 do s:delete{i} end
+box.snapshot()
+while purged() < 10 do fiber.sleep(0.01) end
+purged()
+sk:select{}
+purged()
+
+-- defer_deletes can't be switched off while there are
+-- secondary indexes that may contain stale entries
+_ = box.space._space:update(s.id, {{'=', 6, ''}})
+sk:drop()
+_ = box.space._space:update(s.id, {{'=', 6, ''}})
+s:drop()
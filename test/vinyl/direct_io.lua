@@ -0,0 +1,11 @@
+#!/usr/bin/env tarantool
+
+box.cfg {
+    listen            = os.getenv("LISTEN"),
+    vinyl_direct_io   = true,
+    vinyl_page_cache  = 10240, -- 10kB
+    vinyl_cache       = 10240, -- 10kB
+    vinyl_page_size   = 1024,
+}
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,57 @@
+test_run = require('test_run').new()
+
+--
+-- vinyl_direct_io: run files are read with O_DIRECT, in 4 KB
+-- aligned blocks. Caches are tiny, so that pages are read
+-- from disk.
+--
+test_run:cmd('create server direct_io with script="vinyl/direct_io.lua"')
+test_run:cmd('start server direct_io')
+test_run:cmd('switch direct_io')
+
+box.cfg.vinyl_direct_io
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+
+-- Tuple sizes are not a multiple of the block size, so pages
+-- are scattered over the file at unaligned offsets.
+function pad(i) return string.rep(string.char(string.byte('a') + i % 26), 100 + i % 333) end
+function fill(from, to) for i = from, to do s:replace{i, pad(i)} end end
+function check(from, to) local ok = true for i = from, to do local t = s:get{i} ok = ok and t ~= nil and t[2] == pad(i) end return ok end
+function check_select(from, to) local r = s:select{} if #r ~= to - from + 1 then return false end for i, t in ipairs(r) do if t[1] ~= from + i - 1 or t[2] ~= pad(t[1]) then return false end end return true end
+
+fill(1, 1000)
+box.snapshot()
+check(1, 1000)
+check_select(1, 1000)
+
+--
+-- If the file system does not support O_DIRECT, reads fall
+-- back on buffered I/O.
+--
+box.error.injection.set('ERRINJ_VY_RUN_DIRECT_IO', true)
+fill(1001, 2000)
+box.snapshot()
+box.error.injection.set('ERRINJ_VY_RUN_DIRECT_IO', false)
+check(1, 2000)
+check_select(1, 2000)
+
+test_run:cmd('switch default')
+test_run:grep_log('direct_io', 'O_DIRECT is not supported') ~= nil
+
+-- Runs are reopened with O_DIRECT on recovery.
+test_run:cmd('stop server direct_io')
+test_run:cmd('start server direct_io')
+test_run:cmd('switch direct_io')
+
+s = box.space.test
+function pad(i) return string.rep(string.char(string.byte('a') + i % 26), 100 + i % 333) end
+function check(from, to) local ok = true for i = from, to do local t = s:get{i} ok = ok and t ~= nil and t[2] == pad(i) end return ok end
+check(1, 2000)
+s:count()
+s:drop()
+
+test_run:cmd('switch default')
+test_run:cmd('stop server direct_io')
+test_run:cmd('cleanup server direct_io')
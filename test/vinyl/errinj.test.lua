@@ -130,3 +130,57 @@ for i=1,256 do s:upsert({0, 0}, {{'+', 2, 1}}) end
 s:drop() -- index is gone
 fiber.sleep(0.05)
 errinj.set("ERRINJ_VY_SQUASH_TIMEOUT", 0)
+
+--
+-- Time window compaction: the dump time of runs is injected,
+-- so the result doesn't depend on the wall clock.
+--
+function vyinfo() return box.info.vinyl().db[box.space.test.id..'/0'] end
+-- runs dumped in different windows are not merged
+s = box.schema.space.create('test', {engine='vinyl'})
+_ = s:create_index('pk', {run_count_per_level = 1, compaction = 'time_window', compaction_window = 3600})
+errinj.set("ERRINJ_VY_RUN_TIME", 3600 * 1000 + 3599)
+s:replace{1}
+box.snapshot()
+errinj.set("ERRINJ_VY_RUN_TIME", 3600 * 1001)
+s:replace{2}
+box.snapshot()
+errinj.set("ERRINJ_VY_RUN_TIME", 3600 * 1002 + 1)
+s:replace{3}
+box.snapshot()
+vyinfo().run_count
+vyinfo().compact_size
+s:select()
+s:drop()
+-- runs dumped in the same window are merged
+s = box.schema.space.create('test', {engine='vinyl'})
+_ = s:create_index('pk', {run_count_per_level = 1, compaction = 'time_window', compaction_window = 3600})
+errinj.set("ERRINJ_VY_RUN_TIME", 3600 * 1000)
+s:replace{1}
+box.snapshot()
+errinj.set("ERRINJ_VY_RUN_TIME", 3600 * 1000 + 3599)
+s:replace{2}
+box.snapshot()
+while vyinfo().run_count >= 2 do fiber.sleep(0.01) end
+vyinfo().run_count
+s:select()
+s:drop()
+errinj.set("ERRINJ_VY_RUN_TIME", 0)
+
+--
+-- Writers are throttled once memory is consumed faster than
+-- dumps reclaim it.
+--
+s = box.schema.space.create('test', {engine='vinyl'})
+_ = s:create_index('pk')
+function vyinfo() return box.info.vinyl().db[box.space.test.id..'/0'] end
+vyinfo().stall_count
+vyinfo().stall_histogram
+errinj.set("ERRINJ_VY_QUOTA_RATE", 10 * 1024)
+pad = string.rep('x', 1024)
+i = 0
+while vyinfo().stall_count < 3 do i = i + 1 s:replace{i, pad} fiber.sleep(0.01) end
+vyinfo().stall_histogram ~= ''
+errinj.set("ERRINJ_VY_QUOTA_RATE", 0)
+s:count() == i
+s:drop()
@@ -659,3 +659,29 @@ space:select({2}, {iterator = 'LE'})
 box.commit()
 
 space:drop()
+
+--
+-- Search in a page with many statements, which uses
+-- prefix-compressed keys stored in the page.
+--
+space = box.schema.space.create('test', { engine = 'vinyl' })
+pk = space:create_index('primary', { parts = { 1, 'string', 2, 'unsigned' }, page_size = 64 * 1024 })
+function key(i) return string.format('key%05d', i) end
+for i = 1, 200 do space:replace({key(i), i % 3}) end
+box.snapshot()
+function first(k, it) local t = space:select(k, {iterator = it, limit = 1})[1] return t and t[1] end
+ok = true
+for i = 1, 200 do ok = ok and space:get({key(i), i % 3}) ~= nil and space:get({key(i), i % 3 + 1}) == nil end
+ok
+for i = 1, 200 do ok = ok and first({key(i)}, 'GE') == key(i) and first({key(i)}, 'LE') == key(i) end
+ok
+for i = 1, 200 do ok = ok and first({key(i)}, 'GT') == (i < 200 and key(i + 1) or nil) end
+ok
+for i = 1, 200 do ok = ok and first({key(i)}, 'LT') == (i > 1 and key(i - 1) or nil) end
+ok
+for i = 1, 199 do ok = ok and first({key(i) .. 'a'}, 'GE') == key(i + 1) and first({key(i) .. 'a'}, 'LE') == key(i) end
+ok
+#space:select({key(100)}, {iterator = 'EQ'})
+first({key(0)}, 'GE')
+first({key(201)}, 'LE')
+space:drop()
@@ -0,0 +1,39 @@
+test_run = require('test_run').new()
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+i = s:create_index('test')
+
+function page_cache() return box.info.vinyl().performance.page_cache end
+
+pad = string.rep('x', 100)
+for k = 1, 100 do s:replace{k, pad} end
+box.snapshot()
+
+-- The first lookup reads the page from disk.
+old = page_cache()
+_ = s:get{1}
+new = page_cache()
+new.miss > old.miss
+new.count > old.count
+-- Every miss loads and caches exactly one page.
+new.miss - old.miss == new.count - old.count
+new.hit == old.hit
+new.used > old.used
+new.used <= new.limit
+
+-- Subsequent lookups in the same page are served from the cache.
+old = new
+_ = s:get{2}
+_ = s:select({3}, {iterator = 'GE', limit = 1})
+new = page_cache()
+new.hit - old.hit >= 2
+new.count == old.count
+
+-- A sequential scan reads the next pages ahead.
+old = new
+#s:select()
+new = page_cache()
+new.read_ahead > old.read_ahead
+new.hit > old.hit
+
+s:drop()
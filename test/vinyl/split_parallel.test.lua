@@ -0,0 +1,28 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+-- A large range is split into many parts in one go by several
+-- worker threads (vinyl_threads = 3, one is reserved for dumps).
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {run_count_per_level = 1})
+
+function vyinfo() return box.info.vinyl().db[s.id..'/0'] end
+
+range_size = vyinfo().range_size
+pad = string.rep('x', 1000)
+tuples_per_round = math.ceil(2 * range_size / #pad)
+
+for r = 0, 3 do for i = 1, tuples_per_round do s:replace{r * tuples_per_round + i, pad} end box.snapshot() end
+
+while vyinfo().split_count == 0 do fiber.sleep(0.01) end
+
+-- the range was split into more than two parts
+vyinfo().range_count > 2
+-- split subtasks were run in parallel with the parent task
+vyinfo().split_task_count > vyinfo().split_count
+
+s:count() == 4 * tuples_per_round
+s:get{1}[1]
+s:get{4 * tuples_per_round}[1] == 4 * tuples_per_round
+
+s:drop()
@@ -0,0 +1,47 @@
+#!/usr/bin/env tarantool
+
+test_run = require('test_run').new()
+
+--
+-- Check that runs compressed with a trained zstd dictionary
+-- can be read back, including after restart.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 4096, zstd_dict = true})
+
+function pad(i) return string.rep(string.format('key %08d ', i), 8) end
+function fill(v) for i = 1,2000 do s:replace{i, v, pad(i)} end end
+function check(v) local ok = true for i = 1,2000 do local t = s:get{i} ok = ok and t[2] == v and t[3] == pad(i) end return ok end
+function vyinfo() return box.info.vinyl().db[s.id..'/0'] end
+
+-- The first dump trains a dictionary.
+fill(1)
+box.snapshot()
+check(1)
+vyinfo().zdict_size > 0
+vyinfo().zdict_run_count
+
+-- The second dump compresses the new run with it.
+fill(2)
+box.snapshot()
+check(2)
+vyinfo().zdict_run_count > 0
+s:count()
+
+test_run:cmd('restart server default')
+
+s = box.space.test
+function pad(i) return string.rep(string.format('key %08d ', i), 8) end
+function check(v) local ok = true for i = 1,2000 do local t = s:get{i} ok = ok and t[2] == v and t[3] == pad(i) end return ok end
+function vyinfo() return box.info.vinyl().db[s.id..'/0'] end
+check(2)
+-- Runs keep their dictionaries after restart.
+vyinfo().zdict_run_count > 0
+s:count()
+
+s:drop()
+
+-- zstd_dict must be a boolean.
+s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {zstd_dict = 'yes'})
+s:drop()